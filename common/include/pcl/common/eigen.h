@@ -129,6 +129,44 @@ namespace pcl
   template <typename Matrix, typename Vector> void
   eigen33 (const Matrix &mat, Matrix &evecs, Vector &evals);
 
+  /** \brief Number of matrices that \ref eigen33Batch solves at once for single precision input:
+    * 16 with AVX-512, 8 with AVX and 1 (scalar code path) otherwise.
+    * \ingroup common
+    */
+#if defined (__AVX512F__)
+  constexpr std::size_t EIGEN33_BATCH_WIDTH = 16;
+#elif defined (__AVX__)
+  constexpr std::size_t EIGEN33_BATCH_WIDTH = 8;
+#else
+  constexpr std::size_t EIGEN33_BATCH_WIDTH = 1;
+#endif
+
+  /** \brief determines the eigenvalues of a batch of symmetric positive semi definite 3x3 matrices, together
+    * with the eigenvector corresponding to one of them.
+    *
+    * This solves the same closed-form cubic as \ref eigen33, but the matrices are given in
+    * structure-of-arrays layout (one array per coefficient of the upper triangle), so that for single
+    * precision input EIGEN33_BATCH_WIDTH matrices are processed branch-free in one SIMD register.
+    * \param[in] mat the six arrays holding the xx, xy, xz, yy, yz and zz coefficients of the n matrices
+    * \param[in] n the number of matrices in the batch
+    * \param[out] evals the three arrays receiving the eigenvalues of each matrix in ascending order
+    * \param[out] evec the three arrays receiving the x, y and z components of the (unit length) eigenvector
+    *             corresponding to evals[evec_index], or nullptr if no eigenvector is needed
+    * \param[in] evec_index the index (0: smallest, 2: largest) of the eigenvalue to compute the eigenvector for
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  eigen33Batch (const Scalar* const mat[6], std::size_t n, Scalar* const evals[3],
+                Scalar* const evec[3] = nullptr, int evec_index = 0);
+
+  /** \brief single precision overload of \ref eigen33Batch, dispatching full batches to the AVX or
+    * AVX-512 kernel when PCL is compiled with support for these instruction sets.
+    * \ingroup common
+    */
+  inline void
+  eigen33Batch (const float* const mat[6], std::size_t n, float* const evals[3],
+                float* const evec[3] = nullptr, int evec_index = 0);
+
   /** \brief Calculate the inverse of a 2x2 matrix
     * \param[in] matrix matrix to be inverted
     * \param[out] inverse the resultant inverted matrix
@@ -45,6 +45,10 @@
 #include <algorithm>
 #include <cmath>
 
+#if defined (__AVX__)
+#include <immintrin.h>
+#endif
+
 
 namespace pcl
 {
@@ -401,6 +405,340 @@ eigen33 (const Matrix& mat, Matrix& evecs, Vector& evals)
 }
 
 
+namespace detail
+{
+
+/** \brief The cross products of the rows of (scaled matrix - lambda * I) are not longer than this where lambda
+  * is (nearly) a repeated eigenvalue, e.g. for the covariance matrix of identical or collinear points. Their
+  * direction is then meaningless and the eigenvector is taken from the full decomposition instead.
+  */
+template <typename Scalar> inline Scalar
+eigen33BatchDegenerateLength ()
+{
+  return (std::sqrt (std::numeric_limits<Scalar>::epsilon ()));
+}
+
+/** \brief Overwrite the eigenvector of matrix i of a batch by the matching column of the full eigen33
+  * decomposition, which completes an orthonormal basis for repeated eigenvalues.
+  */
+template <typename Scalar> inline void
+eigen33BatchDegenerate (const Scalar* const mat[6], std::size_t i, Scalar* const evec[3], int evec_index)
+{
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  using Vector = Eigen::Matrix<Scalar, 3, 1>;
+
+  Matrix matrix;
+  matrix << mat[0][i], mat[1][i], mat[2][i],
+            mat[1][i], mat[3][i], mat[4][i],
+            mat[2][i], mat[4][i], mat[5][i];
+  Matrix vectors;
+  Vector values;
+  eigen33 (matrix, vectors, values);
+  evec[0][i] = vectors (0, evec_index);
+  evec[1][i] = vectors (1, evec_index);
+  evec[2][i] = vectors (2, evec_index);
+}
+
+}  // namespace detail
+
+
+template <typename Scalar> inline void
+eigen33Batch (const Scalar* const mat[6], std::size_t n, Scalar* const evals[3],
+              Scalar* const evec[3], int evec_index)
+{
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  using Vector = Eigen::Matrix<Scalar, 3, 1>;
+  const int vec_index = std::min (std::max (evec_index, 0), 2);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    Matrix scaledMat;
+    scaledMat << mat[0][i], mat[1][i], mat[2][i],
+                 mat[1][i], mat[3][i], mat[4][i],
+                 mat[2][i], mat[4][i], mat[5][i];
+
+    // Scale the matrix so its entries are in [-1,1], exactly as eigen33 does
+    Scalar scale = scaledMat.cwiseAbs ().maxCoeff ();
+    if (scale <= std::numeric_limits<Scalar>::min ())
+      scale = Scalar (1.0);
+    scaledMat /= scale;
+
+    Vector roots;
+    computeRoots (scaledMat, roots);
+
+    if (evec)
+    {
+      scaledMat.diagonal ().array () -= roots (vec_index);
+      const auto vec_len = detail::getLargest3x3Eigenvector<Vector> (scaledMat);
+      if (vec_len.length > detail::eigen33BatchDegenerateLength<Scalar> ())
+      {
+        evec[0][i] = vec_len.vector[0];
+        evec[1][i] = vec_len.vector[1];
+        evec[2][i] = vec_len.vector[2];
+      }
+      else
+        detail::eigen33BatchDegenerate (mat, i, evec, vec_index);
+    }
+
+    evals[0][i] = roots (0) * scale;
+    evals[1][i] = roots (1) * scale;
+    evals[2][i] = roots (2) * scale;
+  }
+}
+
+namespace detail
+{
+
+#if defined (__AVX__)
+/** \brief Packet operations used by eigen33BatchKernel for 8 floats in an AVX register. */
+struct Eigen33BatchAVX
+{
+  using Packet = __m256;
+  using Mask = __m256;
+  static constexpr std::size_t width = 8;
+
+  static inline Packet set (float v) { return _mm256_set1_ps (v); }
+  static inline Packet load (const float* p) { return _mm256_loadu_ps (p); }
+  static inline void store (float* p, const Packet& v) { _mm256_storeu_ps (p, v); }
+  static inline Packet add (const Packet& a, const Packet& b) { return _mm256_add_ps (a, b); }
+  static inline Packet sub (const Packet& a, const Packet& b) { return _mm256_sub_ps (a, b); }
+  static inline Packet mul (const Packet& a, const Packet& b) { return _mm256_mul_ps (a, b); }
+  static inline Packet div (const Packet& a, const Packet& b) { return _mm256_div_ps (a, b); }
+  static inline Packet min (const Packet& a, const Packet& b) { return _mm256_min_ps (a, b); }
+  static inline Packet max (const Packet& a, const Packet& b) { return _mm256_max_ps (a, b); }
+  static inline Packet sqrt (const Packet& a) { return _mm256_sqrt_ps (a); }
+  // The andnot-function realizes an abs-operation: the sign bit is removed
+  static inline Packet abs (const Packet& a) { return _mm256_andnot_ps (_mm256_set1_ps (-0.0f), a); }
+  static inline Mask lt (const Packet& a, const Packet& b) { return _mm256_cmp_ps (a, b, _CMP_LT_OQ); }
+  static inline Mask le (const Packet& a, const Packet& b) { return _mm256_cmp_ps (a, b, _CMP_LE_OQ); }
+  static inline Mask ge (const Packet& a, const Packet& b) { return _mm256_cmp_ps (a, b, _CMP_GE_OQ); }
+  static inline Mask logicalAnd (const Mask& a, const Mask& b) { return _mm256_and_ps (a, b); }
+  static inline Mask logicalOr (const Mask& a, const Mask& b) { return _mm256_or_ps (a, b); }
+  /** \brief one bit per lane, set where !(a > b) */
+  static inline unsigned notGreaterBits (const Packet& a, const Packet& b) { return static_cast<unsigned> (_mm256_movemask_ps (_mm256_cmp_ps (a, b, _CMP_NGT_UQ))); }
+  /** \brief per lane: mask ? a : b */
+  static inline Packet select (const Mask& mask, const Packet& a, const Packet& b) { return _mm256_blendv_ps (b, a, mask); }
+};
+#endif // defined (__AVX__)
+
+#if defined (__AVX512F__)
+/** \brief Packet operations used by eigen33BatchKernel for 16 floats in an AVX-512 register. */
+struct Eigen33BatchAVX512
+{
+  using Packet = __m512;
+  using Mask = __mmask16;
+  static constexpr std::size_t width = 16;
+
+  static inline Packet set (float v) { return _mm512_set1_ps (v); }
+  static inline Packet load (const float* p) { return _mm512_loadu_ps (p); }
+  static inline void store (float* p, const Packet& v) { _mm512_storeu_ps (p, v); }
+  static inline Packet add (const Packet& a, const Packet& b) { return _mm512_add_ps (a, b); }
+  static inline Packet sub (const Packet& a, const Packet& b) { return _mm512_sub_ps (a, b); }
+  static inline Packet mul (const Packet& a, const Packet& b) { return _mm512_mul_ps (a, b); }
+  static inline Packet div (const Packet& a, const Packet& b) { return _mm512_div_ps (a, b); }
+  static inline Packet min (const Packet& a, const Packet& b) { return _mm512_min_ps (a, b); }
+  static inline Packet max (const Packet& a, const Packet& b) { return _mm512_max_ps (a, b); }
+  static inline Packet sqrt (const Packet& a) { return _mm512_sqrt_ps (a); }
+  static inline Packet abs (const Packet& a) { return _mm512_abs_ps (a); }
+  static inline Mask lt (const Packet& a, const Packet& b) { return _mm512_cmp_ps_mask (a, b, _CMP_LT_OQ); }
+  static inline Mask le (const Packet& a, const Packet& b) { return _mm512_cmp_ps_mask (a, b, _CMP_LE_OQ); }
+  static inline Mask ge (const Packet& a, const Packet& b) { return _mm512_cmp_ps_mask (a, b, _CMP_GE_OQ); }
+  static inline Mask logicalAnd (const Mask& a, const Mask& b) { return static_cast<Mask> (a & b); }
+  static inline Mask logicalOr (const Mask& a, const Mask& b) { return static_cast<Mask> (a | b); }
+  /** \brief one bit per lane, set where !(a > b) */
+  static inline unsigned notGreaterBits (const Packet& a, const Packet& b) { return static_cast<unsigned> (_mm512_cmp_ps_mask (a, b, _CMP_NGT_UQ)); }
+  /** \brief per lane: mask ? a : b */
+  static inline Packet select (const Mask& mask, const Packet& a, const Packet& b) { return _mm512_mask_blend_ps (mask, b, a); }
+};
+#endif // defined (__AVX512F__)
+
+/** \brief Branch-free version of computeRoots and getLargest3x3Eigenvector for Ops::width matrices,
+  * starting at offset i of the structure-of-arrays input.
+  */
+template <typename Ops> inline void
+eigen33BatchKernel (const float* const mat[6], std::size_t i, float* const evals[3],
+                    float* const evec[3], int evec_index)
+{
+  using Packet = typename Ops::Packet;
+  using Mask = typename Ops::Mask;
+
+  const Packet zero = Ops::set (0.0f);
+  const Packet one = Ops::set (1.0f);
+  const Packet two = Ops::set (2.0f);
+  const Packet half = Ops::set (0.5f);
+  const Packet inv3 = Ops::set (1.0f / 3.0f);
+  const Packet sqrt3 = Ops::set (1.7320508075688772f);
+
+  Packet xx = Ops::load (mat[0] + i);
+  Packet xy = Ops::load (mat[1] + i);
+  Packet xz = Ops::load (mat[2] + i);
+  Packet yy = Ops::load (mat[3] + i);
+  Packet yz = Ops::load (mat[4] + i);
+  Packet zz = Ops::load (mat[5] + i);
+
+  // Scale the matrices so their entries are in [-1,1]
+  Packet scale = Ops::max (Ops::max (Ops::max (Ops::abs (xx), Ops::abs (xy)), Ops::max (Ops::abs (xz), Ops::abs (yy))),
+                           Ops::max (Ops::abs (yz), Ops::abs (zz)));
+  scale = Ops::select (Ops::le (scale, Ops::set (std::numeric_limits<float>::min ())), one, scale);
+  xx = Ops::div (xx, scale);
+  xy = Ops::div (xy, scale);
+  xz = Ops::div (xz, scale);
+  yy = Ops::div (yy, scale);
+  yz = Ops::div (yz, scale);
+  zz = Ops::div (zz, scale);
+
+  // The characteristic equation is x^3 - c2*x^2 + c1*x - c0 = 0 (see computeRoots)
+  const Packet c0 = Ops::sub (Ops::sub (Ops::sub (Ops::add (Ops::mul (Ops::mul (xx, yy), zz),
+                                                            Ops::mul (two, Ops::mul (Ops::mul (xy, xz), yz))),
+                                                   Ops::mul (xx, Ops::mul (yz, yz))),
+                                          Ops::mul (yy, Ops::mul (xz, xz))),
+                              Ops::mul (zz, Ops::mul (xy, xy)));
+  const Packet c1 = Ops::sub (Ops::add (Ops::sub (Ops::add (Ops::sub (Ops::mul (xx, yy), Ops::mul (xy, xy)), Ops::mul (xx, zz)),
+                                                  Ops::mul (xz, xz)),
+                                        Ops::mul (yy, zz)),
+                              Ops::mul (yz, yz));
+  const Packet c2 = Ops::add (Ops::add (xx, yy), zz);
+
+  // Roots of the quadratic equation, used where one root is 0 (see computeRoots2)
+  const Packet sd = Ops::sqrt (Ops::max (Ops::sub (Ops::mul (c2, c2), Ops::mul (Ops::set (4.0f), c1)), zero));
+  const Packet quad_1 = Ops::mul (half, Ops::sub (c2, sd));
+  const Packet quad_2 = Ops::mul (half, Ops::add (c2, sd));
+
+  // Closed form solution of the cubic equation
+  const Packet c2_over_3 = Ops::mul (c2, inv3);
+  const Packet a_over_3 = Ops::min (Ops::mul (Ops::sub (c1, Ops::mul (c2, c2_over_3)), inv3), zero);
+  const Packet half_b = Ops::mul (half, Ops::add (c0, Ops::mul (c2_over_3, Ops::sub (Ops::mul (two, Ops::mul (c2_over_3, c2_over_3)), c1))));
+  const Packet q = Ops::min (Ops::add (Ops::mul (half_b, half_b), Ops::mul (a_over_3, Ops::mul (a_over_3, a_over_3))), zero);
+  const Packet rho = Ops::sqrt (Ops::sub (zero, a_over_3));
+
+  // theta = atan2 (y, x) / 3 with y = sqrt (-q) >= 0, so that atan2 lies in [0, pi]. The arctangent of
+  // t = min / max in [0, 1] is evaluated with the Cephes single precision polynomial after reducing t to
+  // [0, tan (pi / 8)].
+  const Packet y = Ops::sqrt (Ops::sub (zero, q));
+  const Packet ax = Ops::abs (half_b);
+  const Packet t = Ops::div (Ops::min (ax, y), Ops::max (Ops::max (ax, y), Ops::set (std::numeric_limits<float>::min ())));
+  const Mask t_reduce = Ops::lt (Ops::set (0.41421356237309503f), t);
+  const Packet tr = Ops::select (t_reduce, Ops::div (Ops::sub (t, one), Ops::add (t, one)), t);
+  const Packet tr2 = Ops::mul (tr, tr);
+  Packet atan = Ops::add (Ops::mul (Ops::mul (Ops::sub (Ops::mul (Ops::add (Ops::mul (Ops::sub (Ops::mul (Ops::set (8.05374449538e-2f), tr2),
+                                                                                            Ops::set (1.38776856032e-1f)), tr2),
+                                                                          Ops::set (1.99777106478e-1f)), tr2),
+                                                        Ops::set (3.33329491539e-1f)), tr2), tr), tr);
+  atan = Ops::select (t_reduce, Ops::add (atan, Ops::set (static_cast<float> (M_PI / 4.0))), atan);
+  atan = Ops::select (Ops::lt (ax, y), Ops::sub (Ops::set (static_cast<float> (M_PI / 2.0)), atan), atan);
+  atan = Ops::select (Ops::lt (half_b, zero), Ops::sub (Ops::set (static_cast<float> (M_PI)), atan), atan);
+  const Packet theta = Ops::mul (atan, inv3);
+
+  // theta lies in [0, pi/3]: evaluate sin and cos of u = theta - pi/6 in [-pi/6, pi/6] with the Cephes
+  // polynomials and rotate the result back by pi/6
+  const Packet u = Ops::sub (theta, Ops::set (static_cast<float> (M_PI / 6.0)));
+  const Packet u2 = Ops::mul (u, u);
+  const Packet sin_u = Ops::add (u, Ops::mul (Ops::mul (u, u2),
+                                              Ops::add (Ops::set (-1.6666654611e-1f),
+                                                        Ops::mul (u2, Ops::add (Ops::set (8.3321608736e-3f),
+                                                                                Ops::mul (u2, Ops::set (-1.9515295891e-4f)))))));
+  const Packet cos_u = Ops::add (Ops::sub (one, Ops::mul (half, u2)),
+                                 Ops::mul (Ops::mul (u2, u2),
+                                           Ops::add (Ops::set (4.166664568298827e-2f),
+                                                     Ops::mul (u2, Ops::add (Ops::set (-1.388731625493765e-3f),
+                                                                             Ops::mul (u2, Ops::set (2.443315711809948e-5f)))))));
+  const Packet half_sqrt3 = Ops::set (0.8660254037844386f);
+  const Packet cos_theta = Ops::sub (Ops::mul (cos_u, half_sqrt3), Ops::mul (sin_u, half));
+  const Packet sin_theta = Ops::add (Ops::mul (sin_u, half_sqrt3), Ops::mul (cos_u, half));
+
+  // With theta in [0, pi/3] the three roots are already in ascending order
+  const Packet cubic_0 = Ops::sub (c2_over_3, Ops::mul (rho, Ops::add (cos_theta, Ops::mul (sqrt3, sin_theta))));
+  const Packet cubic_1 = Ops::sub (c2_over_3, Ops::mul (rho, Ops::sub (cos_theta, Ops::mul (sqrt3, sin_theta))));
+  const Packet cubic_2 = Ops::add (c2_over_3, Ops::mul (two, Ops::mul (rho, cos_theta)));
+
+  // Fall back to the quadratic equation where one root is 0, or where the smallest root of the cubic is not
+  // positive (eigenvalues of a symmetric positive semi-definite matrix can not be negative)
+  const Mask quadratic = Ops::logicalOr (Ops::lt (Ops::abs (c0), Ops::set (std::numeric_limits<float>::epsilon ())),
+                                         Ops::le (cubic_0, zero));
+  const Packet root_0 = Ops::select (quadratic, zero, cubic_0);
+  const Packet root_1 = Ops::select (quadratic, quad_1, cubic_1);
+  const Packet root_2 = Ops::select (quadratic, quad_2, cubic_2);
+
+  if (evec)
+  {
+    const Packet lambda = (evec_index <= 0 ? root_0 : (evec_index == 1 ? root_1 : root_2));
+    const Packet dxx = Ops::sub (xx, lambda);
+    const Packet dyy = Ops::sub (yy, lambda);
+    const Packet dzz = Ops::sub (zz, lambda);
+
+    // Cross products of the rows of (mat - lambda * I), see getLargest3x3Eigenvector
+    const Packet v1x = Ops::sub (Ops::mul (xy, yz), Ops::mul (xz, dyy));
+    const Packet v1y = Ops::sub (Ops::mul (xz, xy), Ops::mul (dxx, yz));
+    const Packet v1z = Ops::sub (Ops::mul (dxx, dyy), Ops::mul (xy, xy));
+    const Packet v2x = Ops::sub (Ops::mul (xy, dzz), Ops::mul (xz, yz));
+    const Packet v2y = Ops::sub (Ops::mul (xz, xz), Ops::mul (dxx, dzz));
+    const Packet v2z = Ops::sub (Ops::mul (dxx, yz), Ops::mul (xy, xz));
+    const Packet v3x = Ops::sub (Ops::mul (dyy, dzz), Ops::mul (yz, yz));
+    const Packet v3y = Ops::sub (Ops::mul (yz, xz), Ops::mul (xy, dzz));
+    const Packet v3z = Ops::sub (Ops::mul (xy, yz), Ops::mul (dyy, xz));
+
+    const Packet len1 = Ops::add (Ops::add (Ops::mul (v1x, v1x), Ops::mul (v1y, v1y)), Ops::mul (v1z, v1z));
+    const Packet len2 = Ops::add (Ops::add (Ops::mul (v2x, v2x), Ops::mul (v2y, v2y)), Ops::mul (v2z, v2z));
+    const Packet len3 = Ops::add (Ops::add (Ops::mul (v3x, v3x), Ops::mul (v3y, v3y)), Ops::mul (v3z, v3z));
+
+    // Keep the first of several equally long vectors, like maxCoeff does
+    const Mask take1 = Ops::logicalAnd (Ops::ge (len1, len2), Ops::ge (len1, len3));
+    const Mask take2 = Ops::ge (len2, len3);
+    const Packet vx = Ops::select (take1, v1x, Ops::select (take2, v2x, v3x));
+    const Packet vy = Ops::select (take1, v1y, Ops::select (take2, v2y, v3y));
+    const Packet vz = Ops::select (take1, v1z, Ops::select (take2, v2z, v3z));
+    const Packet len = Ops::sqrt (Ops::select (take1, len1, Ops::select (take2, len2, len3)));
+
+    Ops::store (evec[0] + i, Ops::div (vx, len));
+    Ops::store (evec[1] + i, Ops::div (vy, len));
+    Ops::store (evec[2] + i, Ops::div (vz, len));
+
+    // Repeated eigenvalues (e.g. zero or rank 1 matrices) are rare, solve them one by one
+    const unsigned degenerate = Ops::notGreaterBits (len, Ops::set (eigen33BatchDegenerateLength<float> ()));
+    if (degenerate)
+      for (std::size_t lane = 0; lane < Ops::width; ++lane)
+        if (degenerate & (1u << lane))
+          eigen33BatchDegenerate (mat, i + lane, evec, std::min (std::max (evec_index, 0), 2));
+  }
+
+  // Rescale back to the original size
+  Ops::store (evals[0] + i, Ops::mul (root_0, scale));
+  Ops::store (evals[1] + i, Ops::mul (root_1, scale));
+  Ops::store (evals[2] + i, Ops::mul (root_2, scale));
+}
+
+}  // namespace detail
+
+
+inline void
+eigen33Batch (const float* const mat[6], std::size_t n, float* const evals[3],
+              float* const evec[3], int evec_index)
+{
+  std::size_t i = 0;
+#if defined (__AVX512F__)
+  for (; i + detail::Eigen33BatchAVX512::width <= n; i += detail::Eigen33BatchAVX512::width)
+    detail::eigen33BatchKernel<detail::Eigen33BatchAVX512> (mat, i, evals, evec, evec_index);
+#endif
+#if defined (__AVX__)
+  for (; i + detail::Eigen33BatchAVX::width <= n; i += detail::Eigen33BatchAVX::width)
+    detail::eigen33BatchKernel<detail::Eigen33BatchAVX> (mat, i, evals, evec, evec_index);
+#endif
+  if (i == n)
+    return;
+
+  // Solve the remaining matrices with the scalar code path
+  const float* const mat_tail[6] = {mat[0] + i, mat[1] + i, mat[2] + i, mat[3] + i, mat[4] + i, mat[5] + i};
+  float* const evals_tail[3] = {evals[0] + i, evals[1] + i, evals[2] + i};
+  if (evec)
+  {
+    float* const evec_tail[3] = {evec[0] + i, evec[1] + i, evec[2] + i};
+    eigen33Batch<float> (mat_tail, n - i, evals_tail, evec_tail, evec_index);
+  }
+  else
+    eigen33Batch<float> (mat_tail, n - i, evals_tail, nullptr, evec_index);
+}
+
+
 template <typename Matrix> inline typename Matrix::Scalar
 invert2x2 (const Matrix& matrix, Matrix& inverse)
 {
@@ -0,0 +1,86 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/feature.h>
+
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Compute a descriptor for each cloud of a model database in parallel.
+    *
+    * Every thread works on its own copy of \a estimator, so all of its parameters are used
+    * for each cloud. Its input cloud, indices, search surface and search method are replaced:
+    * every cloud is used as its own search surface and gets a new search method built by
+    * pcl::Feature::initCompute. This is meant for global descriptors such as
+    * pcl::ESFEstimation, which compute one signature for the whole cloud.
+    *
+    * \param[in] estimator the configured feature estimator that is copied for each cloud
+    * \param[in] clouds the input clouds
+    * \param[out] descriptors the descriptors computed for each cloud, in the order of \a clouds
+    * \param[in] nr_threads the number of hardware threads to use (0 sets the value to automatic)
+    * \ingroup features
+    */
+  template <typename FeatureT> void
+  computeFeatureBatch (const FeatureT &estimator,
+                       const std::vector<typename FeatureT::PointCloudConstPtr> &clouds,
+                       std::vector<typename FeatureT::PointCloudOut> &descriptors,
+                       unsigned int nr_threads = 0);
+
+  /** \brief Compute a descriptor for each cloud of a model database in parallel, for estimators
+    * that need surface normals, such as pcl::VFHEstimation, pcl::CVFHEstimation and
+    * pcl::OURCVFHEstimation.
+    *
+    * See the overload without normals for how \a estimator is used.
+    *
+    * \param[in] estimator the configured feature estimator that is copied for each cloud
+    * \param[in] clouds the input clouds
+    * \param[in] normals the normals of each input cloud
+    * \param[out] descriptors the descriptors computed for each cloud, in the order of \a clouds
+    * \param[in] nr_threads the number of hardware threads to use (0 sets the value to automatic)
+    * \ingroup features
+    */
+  template <typename FeatureT> void
+  computeFeatureBatch (const FeatureT &estimator,
+                       const std::vector<typename FeatureT::PointCloudConstPtr> &clouds,
+                       const std::vector<typename FeatureT::PointCloudNConstPtr> &normals,
+                       std::vector<typename FeatureT::PointCloudOut> &descriptors,
+                       unsigned int nr_threads = 0);
+}
+
+#include <pcl/features/impl/batch_estimation.hpp>
@@ -86,7 +86,8 @@ namespace pcl
         cluster_tolerance_ (leaf_size_ * 3), 
         eps_angle_threshold_ (0.125f), 
         min_points_ (50),
-        radius_normals_ (leaf_size_ * 3)
+        radius_normals_ (leaf_size_ * 3),
+        threads_ (1)
       {
         search_radius_ = 0;
         k_ = 1;
@@ -94,6 +95,13 @@ namespace pcl
       }
       ;
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * The VFH signatures of the dominant clusters are computed in parallel. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Removes normals with high curvature caused by real edges or noisy data
         * \param[in] cloud pointcloud to be filtered
         * \param[in] indices_to_use the indices to use
@@ -243,6 +251,9 @@ namespace pcl
       /** \brief Radius for the normals computation. */
       float radius_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Estimate the Clustered Viewpoint Feature Histograms (CVFH) descriptors at 
         * a set of points given by <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface ()
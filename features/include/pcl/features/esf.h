@@ -43,6 +43,8 @@
 #include <pcl/features/feature.h>
 #define GRIDSIZE 64
 #define GRIDSIZE_H GRIDSIZE/2
+#include <cstdint>
+#include <ctime>
 #include <vector>
 
 namespace pcl
@@ -74,21 +76,33 @@ namespace pcl
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : local_cloud_ ()
+      ESFEstimation () : lut_ (GRIDSIZE * GRIDSIZE * GRIDSIZE, 0), local_cloud_ (),
+                         threads_ (1), seed_ (static_cast<unsigned int> (std::time (nullptr)))
       {
         feature_name_ = "ESFEstimation";
-        lut_.resize (GRIDSIZE);
-        for (int i = 0; i < GRIDSIZE; ++i)
-        {
-          lut_[i].resize (GRIDSIZE);
-          for (int j = 0; j < GRIDSIZE; ++j)
-            lut_[i][j].resize (GRIDSIZE);
-        }
-        //lut_.resize (boost::extents[GRIDSIZE][GRIDSIZE][GRIDSIZE]);
         search_radius_ = 0;
         k_ = 5;
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * The 20000 point triplets are drawn in fixed-size batches, each with its own random
+        * stream, so the descriptor only depends on the seed and not on the number of threads. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Set the seed of the random number generators used to sample the point triplets.
+        * By default the seed is taken from the current time on construction.
+        * \param[in] seed the base seed; sample batch i uses seed + i
+        */
+      inline void
+      setSeed (unsigned int seed) { seed_ = seed; }
+
+      /** \brief Get the seed of the random number generators used to sample the point triplets. */
+      inline unsigned int
+      getSeed () const { return (seed_); }
+
       /** \brief Overloaded computed method from pcl::Feature.
         * \param[out] output the resultant point cloud model dataset containing the estimated features
         */
@@ -108,11 +122,37 @@ namespace pcl
       int
       lci (const int x1, const int y1, const int z1, 
            const int x2, const int y2, const int z2, 
-           float &ratio, int &incnt, int &pointcount);
+           float &ratio, int &incnt, int &pointcount) const;
      
       /** \brief ... */
       void
       computeESF (PointCloudIn &pc, std::vector<float> &hist);
+
+      /** \brief Draw one batch of point triplets and compute their D2, D3 and A3 shape functions.
+        * \param[in] pc the point cloud scaled to the voxel grid
+        * \param[in] batch the index of the batch; it selects both the random stream and the output range
+        * \param[out] d2v the three point distances of each triplet
+        * \param[out] wt_d2 the IN/OUT/MIXED classification of each point distance
+        * \param[out] d3v the square root of the area of each triplet
+        * \param[out] wt_d3 the IN/OUT/MIXED weight of each triplet
+        * \param[out] batch_hists the mixed ratio and A3 histograms of each batch
+        */
+      void
+      sampleTriplets (const PointCloudIn &pc, unsigned int batch,
+                      std::vector<float> &d2v, std::vector<int> &wt_d2,
+                      std::vector<float> &d3v, std::vector<float> &wt_d3,
+                      std::vector<float> &batch_hists);
+
+      /** \brief Look up whether a voxel of the occupancy grid is set.
+        * \param[in] x the voxel index along x
+        * \param[in] y the voxel index along y
+        * \param[in] z the voxel index along z
+        */
+      inline bool
+      isOccupied (const int x, const int y, const int z) const
+      {
+        return (lut_[(x * GRIDSIZE + y) * GRIDSIZE + z] != 0);
+      }
       
       /** \brief ... */
       void
@@ -128,11 +168,20 @@ namespace pcl
 
     private:
 
-      /** \brief ... */
-      std::vector<std::vector<std::vector<int> > > lut_;
+      /** \brief The GRIDSIZE^3 voxel occupancy grid, stored contiguously in x-major order. */
+      std::vector<std::uint8_t> lut_;
       
       /** \brief ... */
       PointCloudIn local_cloud_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The base seed of the per-batch random number generators. */
+      unsigned int seed_;
+
+      /** \brief The number of point triplets drawn by each sample batch. */
+      static constexpr unsigned int batch_size_ = 1250;
   };
 }
 
@@ -61,8 +61,7 @@ namespace pcl
     * </li>
     * </ul>
     *
-    * @note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * @note The RSD of the voxels is computed in parallel if more than one thread is set with setNumberOfThreads ().
     * \author Zoltan Csaba Marton
     * \ingroup features
     */
@@ -77,6 +76,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::search_radius_;
       using Feature<PointInT, PointOutT>::search_parameter_;
       using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using Feature<PointInT, PointOutT>::setSearchSurface;
       //using Feature<PointInT, PointOutT>::computeFeature;
@@ -86,7 +86,7 @@ namespace pcl
       using PointCloudInPtr = typename Feature<PointInT, PointOutT>::PointCloudInPtr;
 
       /** \brief Constructor. */
-      GRSDEstimation () : additive_ (true)
+      GRSDEstimation () : additive_ (true), threads_ (1)
       {
         feature_name_ = "GRSDEstimation";
         relative_coordinates_all_ = getAllNeighborCellIndices ();
@@ -104,6 +104,12 @@ namespace pcl
         */
       inline double
       getRadiusSearch () const { return (search_radius_); }
+
+      /** \brief Initialize the scheduler and set the number of threads to use for the RSD of the voxels. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
       
       /** \brief Get the type of the local surface based on the min and max radius computed. 
         * \return the integer that represents the type of the local surface with values as
@@ -137,6 +143,9 @@ namespace pcl
       /** \brief Pre-computed the relative cell indices of all the 26 neighbors. */
       Eigen::MatrixXi relative_coordinates_all_;
 
+      /** \brief The number of threads used for the RSD of the voxels. */
+      unsigned int threads_;
+
   };
 
 }
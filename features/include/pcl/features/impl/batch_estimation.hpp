@@ -0,0 +1,118 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCL_FEATURES_IMPL_BATCH_ESTIMATION_H_
+#define PCL_FEATURES_IMPL_BATCH_ESTIMATION_H_
+
+#include <pcl/features/batch_estimation.h>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compute the descriptors of all clouds, letting \a setup configure the estimator
+      * copy of each cloud before its descriptor is computed.
+      */
+    template <typename FeatureT, typename SetupFunctor> void
+    computeFeatureBatch (const FeatureT &estimator, std::size_t nr_clouds,
+                         std::vector<typename FeatureT::PointCloudOut> &descriptors,
+                         unsigned int nr_threads, SetupFunctor setup)
+    {
+#ifdef _OPENMP
+      if (nr_threads == 0)
+        nr_threads = omp_get_num_procs ();
+#else
+      nr_threads = 1;
+#endif
+      descriptors.resize (nr_clouds);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(descriptors, estimator, nr_clouds, setup) \
+  num_threads(nr_threads) \
+  schedule(dynamic, 1)
+      for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (nr_clouds); ++i)
+      {
+        FeatureT feature (estimator);
+        feature.setIndices (IndicesPtr ());
+        feature.setSearchSurface (nullptr);
+        feature.setSearchMethod (nullptr);
+        setup (feature, i);
+        feature.compute (descriptors[i]);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT> void
+pcl::computeFeatureBatch (const FeatureT &estimator,
+                          const std::vector<typename FeatureT::PointCloudConstPtr> &clouds,
+                          std::vector<typename FeatureT::PointCloudOut> &descriptors,
+                          unsigned int nr_threads)
+{
+  detail::computeFeatureBatch (estimator, clouds.size (), descriptors, nr_threads,
+                               [&clouds] (FeatureT &feature, std::size_t i)
+                               {
+                                 feature.setInputCloud (clouds[i]);
+                               });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT> void
+pcl::computeFeatureBatch (const FeatureT &estimator,
+                          const std::vector<typename FeatureT::PointCloudConstPtr> &clouds,
+                          const std::vector<typename FeatureT::PointCloudNConstPtr> &normals,
+                          std::vector<typename FeatureT::PointCloudOut> &descriptors,
+                          unsigned int nr_threads)
+{
+  if (clouds.size () != normals.size ())
+  {
+    PCL_ERROR ("[pcl::computeFeatureBatch] The number of input clouds (%zu) differs from the number of normal clouds (%zu)!\n",
+               clouds.size (), normals.size ());
+    descriptors.clear ();
+    return;
+  }
+
+  detail::computeFeatureBatch (estimator, clouds.size (), descriptors, nr_threads,
+                               [&clouds, &normals] (FeatureT &feature, std::size_t i)
+                               {
+                                 feature.setInputCloud (clouds[i]);
+                                 feature.setInputNormals (normals[i]);
+                               });
+}
+
+#endif    // PCL_FEATURES_IMPL_BATCH_ESTIMATION_H_
@@ -45,6 +45,20 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/common/centroid.h>
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT> void
 pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::compute (PointCloudOut &output)
@@ -209,6 +223,7 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   }
 
   centroids_dominant_orientations_.clear ();
+  dominant_normals_.clear ();
 
   // ---[ Step 0: remove normals with high curvature
   pcl::Indices indices_out;
@@ -285,8 +300,6 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
       avg_normal /= static_cast<float> (cluster.indices.size ());
       avg_centroid /= static_cast<float> (cluster.indices.size ());
 
-      Eigen::Vector4f centroid_test;
-      pcl::compute3DCentroid (*normals_filtered_cloud, centroid_test);
       avg_normal.normalize ();
 
       Eigen::Vector3f avg_norm (avg_normal[0], avg_normal[1], avg_normal[2]);
@@ -301,7 +314,15 @@ pcl::CVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     output.resize (dominant_normals_.size ());
     output.width = dominant_normals_.size ();
 
-    for (std::size_t i = 0; i < dominant_normals_.size (); ++i)
+    // Every thread works on its own copy of the VFH estimator; the search method is shared
+    // and already initialized on surface_, so it is only read from
+#pragma omp parallel for \
+  default(none) \
+  shared(output) \
+  firstprivate(vfh) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (dominant_normals_.size ()); ++i)
     {
       //configure VFH computation for CVFH
       vfh.setNormalToUse (dominant_normals_[i]);
@@ -45,39 +45,37 @@
 #include <pcl/common/distances.h>
 #include <pcl/common/transforms.h>
 #include <vector>
-#include <ctime> // for time
+#include <random>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
-    PointCloudIn &pc, std::vector<float> &hist)
+pcl::ESFEstimation<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  const int binsize = 64;
-  unsigned int sample_size = 20000;
-  // @TODO: Replace with c++ stdlib uniform_random_generator
-  srand (static_cast<unsigned int> (time (nullptr)));
-  const auto maxindex = pc.size ();
-
-  std::vector<float> d2v, d1v, d3v, wt_d3;
-  std::vector<int> wt_d2;
-  d1v.reserve (sample_size);
-  d2v.reserve (sample_size * 3);
-  d3v.reserve (sample_size);
-  wt_d2.reserve (sample_size * 3);
-  wt_d3.reserve (sample_size);
-
-  float h_in[binsize] = {0};
-  float h_out[binsize] = {0};
-  float h_mix[binsize] = {0};
-  float h_mix_ratio[binsize] = {0};
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
 
-  float h_a3_in[binsize] = {0};
-  float h_a3_out[binsize] = {0};
-  float h_a3_mix[binsize] = {0};
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::sampleTriplets (
+    const PointCloudIn &pc, unsigned int batch,
+    std::vector<float> &d2v, std::vector<int> &wt_d2,
+    std::vector<float> &d3v, std::vector<float> &wt_d3, std::vector<float> &batch_hists)
+{
+  const int binsize = 64;
+  std::mt19937 rng (seed_ + batch);
+  std::uniform_int_distribution<index_t> dist (0, static_cast<index_t> (pc.size ()) - 1);
 
-  float h_d3_in[binsize] = {0};
-  float h_d3_out[binsize] = {0};
-  float h_d3_mix[binsize] = {0};
+  float *h_mix_ratio = &batch_hists[batch * 4 * binsize];
+  float *h_a3_in = h_mix_ratio + binsize;
+  float *h_a3_out = h_mix_ratio + 2 * binsize;
+  float *h_a3_mix = h_mix_ratio + 3 * binsize;
 
   float ratio=0.0;
   float pih = static_cast<float>(M_PI) / 2.0f;
@@ -85,12 +83,14 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   int th1,th2,th3;
   int vxlcnt = 0;
   int pcnt1,pcnt2,pcnt3;
-  for (std::size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  const std::size_t sample_begin = static_cast<std::size_t> (batch) * batch_size_;
+  const std::size_t sample_end = sample_begin + batch_size_;
+  for (std::size_t nn_idx = sample_begin; nn_idx < sample_end; ++nn_idx)
   {
     // get a new random point
-    int index1 = rand()%maxindex;
-    int index2 = rand()%maxindex;
-    int index3 = rand()%maxindex;
+    const index_t index1 = dist (rng);
+    const index_t index2 = dist (rng);
+    const index_t index3 = dist (rng);
 
     if (index1==index2 || index1 == index3 || index2 == index3)
     {
@@ -138,9 +138,9 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
     }
 
     // D2
-    d2v.push_back (pcl::euclideanDistance (pc[index1], pc[index2]));
-    d2v.push_back (pcl::euclideanDistance (pc[index1], pc[index3]));
-    d2v.push_back (pcl::euclideanDistance (pc[index2], pc[index3]));
+    d2v[nn_idx * 3] = pcl::euclideanDistance (pc[index1], pc[index2]);
+    d2v[nn_idx * 3 + 1] = pcl::euclideanDistance (pc[index1], pc[index3]);
+    d2v[nn_idx * 3 + 2] = pcl::euclideanDistance (pc[index2], pc[index3]);
 
     int vxlcnt_sum = 0;
     int p_cnt = 0;
@@ -152,8 +152,8 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p2[0] < 0.0? static_cast<int>(std::floor(p2[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[0])+GRIDSIZE_H-1);
       const int yt = p2[1] < 0.0? static_cast<int>(std::floor(p2[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[1])+GRIDSIZE_H-1);
       const int zt = p2[2] < 0.0? static_cast<int>(std::floor(p2[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p2[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
-      if (wt_d2.back () == 2)
+      wt_d2[nn_idx * 3 + 0] = this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1);
+      if (wt_d2[nn_idx * 3 + 0] == 2)
         h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt1;
@@ -166,8 +166,8 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
       const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
       const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
-      if (wt_d2.back () == 2)
+      wt_d2[nn_idx * 3 + 1] = this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2);
+      if (wt_d2[nn_idx * 3 + 1] == 2)
         h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt2;
@@ -180,18 +180,18 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
       const int xt = p3[0] < 0.0? static_cast<int>(std::floor(p3[0])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[0])+GRIDSIZE_H-1);
       const int yt = p3[1] < 0.0? static_cast<int>(std::floor(p3[1])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[1])+GRIDSIZE_H-1);
       const int zt = p3[2] < 0.0? static_cast<int>(std::floor(p3[2])+GRIDSIZE_H): static_cast<int>(std::ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
-      if (wt_d2.back () == 2)
+      wt_d2[nn_idx * 3 + 2] = this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3);
+      if (wt_d2[nn_idx * 3 + 2] == 2)
         h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
       vxlcnt_sum += vxlcnt;
       p_cnt += pcnt3;
     }
 
     // D3 ( herons formula )
-    d3v.push_back (std::sqrt (std::sqrt (s * (s-a) * (s-b) * (s-c))));
+    d3v[nn_idx] = std::sqrt (std::sqrt (s * (s-a) * (s-b) * (s-c)));
     if (vxlcnt_sum <= 21)
     {
-      wt_d3.push_back (0);
+      wt_d3[nn_idx] = 0;
       h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
       h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
       h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
@@ -202,16 +202,65 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
         h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
         h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
         h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (1);
+        wt_d3[nn_idx] = 1;
       }
       else
       {
         h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
         h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
         h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
+        wt_d3[nn_idx] = static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt);
       }
   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
+    PointCloudIn &pc, std::vector<float> &hist)
+{
+  const int binsize = 64;
+  const unsigned int sample_size = 20000;
+  unsigned int nr_batches = sample_size / batch_size_;
+
+  std::vector<float> d2v (sample_size * 3), d3v (sample_size), wt_d3 (sample_size);
+  std::vector<int> wt_d2 (sample_size * 3);
+  // Per batch mixed ratio and A3 histograms, merged in batch order below
+  std::vector<float> batch_hists (nr_batches * 4 * binsize, 0.0f);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(batch_hists, d2v, d3v, nr_batches, pc, wt_d2, wt_d3) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+  for (int batch = 0; batch < static_cast<int> (nr_batches); ++batch)
+    sampleTriplets (pc, batch, d2v, wt_d2, d3v, wt_d3, batch_hists);
+
+  float h_in[binsize] = {0};
+  float h_out[binsize] = {0};
+  float h_mix[binsize] = {0};
+  float h_mix_ratio[binsize] = {0};
+
+  float h_a3_in[binsize] = {0};
+  float h_a3_out[binsize] = {0};
+  float h_a3_mix[binsize] = {0};
+
+  float h_d3_in[binsize] = {0};
+  float h_d3_out[binsize] = {0};
+  float h_d3_mix[binsize] = {0};
+
+  for (unsigned int batch = 0; batch < nr_batches; ++batch)
+  {
+    const float *batch_hist = &batch_hists[batch * 4 * binsize];
+    for (int i = 0; i < binsize; ++i)
+    {
+      h_mix_ratio[i] += batch_hist[i];
+      h_a3_in[i] += batch_hist[binsize + i];
+      h_a3_out[i] += batch_hist[2 * binsize + i];
+      h_a3_mix[i] += batch_hist[3 * binsize + i];
+    }
+  }
+
   // Normalizing, get max
   float maxd2 = 0;
   float maxd3 = 0;
@@ -306,7 +355,7 @@ template <typename PointInT, typename PointOutT> int
 pcl::ESFEstimation<PointInT, PointOutT>::lci (
     const int x1, const int y1, const int z1, 
     const int x2, const int y2, const int z2, 
-    float &ratio, int &incnt, int &pointcount)
+    float &ratio, int &incnt, int &pointcount) const
 {
   int voxelcount = 0;
   int voxel_in = 0;
@@ -343,7 +392,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i = 1; i<l; i++)
     {
       voxelcount++;;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -366,7 +415,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<m; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[0] +=  x_inc;
@@ -389,7 +438,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<n; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -406,7 +455,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     }
   }
   voxelcount++;
-  voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+  voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
   incnt = voxel_in;
   pointcount = voxelcount;
 
@@ -443,7 +492,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::voxelize9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 1;
+            this->lut_[(xi * GRIDSIZE + yi) * GRIDSIZE + zi] = 1;
         }
   }
 }
@@ -471,7 +520,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::cleanup9 (PointCloudIn &cluster)
             ;
           }
           else
-            this->lut_[xi][yi][zi] = 0;
+            this->lut_[(xi * GRIDSIZE + yi) * GRIDSIZE + zi] = 0;
         }
   }
 }
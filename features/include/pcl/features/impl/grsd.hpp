@@ -88,6 +88,10 @@ pcl::GRSDEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   rsd.setSearchSurface (input_);
   rsd.setInputNormals (normals_);
   rsd.setRadiusSearch (std::max (search_radius_, std::sqrt (3.0) * width_ / 2));
+  rsd.setNumberOfThreads (threads_);
+  // The search method was already built on the input cloud, no need to build another one
+  if (surface_ == input_)
+    rsd.setSearchMethod (this->tree_);
   rsd.compute (*radii);
 
   // Save the type of each point
@@ -45,6 +45,8 @@
 #include <pcl/features/moment_of_inertia_estimation.h>
 #include <pcl/features/feature.h>
 
+#include <algorithm> // for min, max
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 pcl::MomentOfInertiaEstimation<PointT>::MomentOfInertiaEstimation () :
@@ -63,7 +65,9 @@ pcl::MomentOfInertiaEstimation<PointT>::MomentOfInertiaEstimation () :
   aabb_max_point_ (),
   obb_min_point_ (),
   obb_max_point_ (),
-  obb_position_ (0.0f, 0.0f, 0.0f)
+  obb_position_ (0.0f, 0.0f, 0.0f),
+  bounding_box_only_ (false),
+  threads_ (1)
 {
 }
 
@@ -129,6 +133,36 @@ pcl::MomentOfInertiaEstimation<PointT>::getPointMass () const
   return (point_mass_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MomentOfInertiaEstimation<PointT>::setBoundingBoxOnlyFlag (bool only_bounding_boxes)
+{
+  bounding_box_only_ = only_bounding_boxes;
+
+  is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::MomentOfInertiaEstimation<PointT>::getBoundingBoxOnlyFlag () const
+{
+  return (bounding_box_only_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MomentOfInertiaEstimation<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::MomentOfInertiaEstimation<PointT>::compute ()
@@ -150,43 +184,55 @@ pcl::MomentOfInertiaEstimation<PointT>::compute ()
       point_mass_ = 1.0f;
   }
 
-  computeMeanValue ();
+  Eigen::Matrix3d scatter_matrix;
+  computeMoments (scatter_matrix);
 
-  Eigen::Matrix <float, 3, 3> covariance_matrix;
-  covariance_matrix.setZero ();
-  computeCovarianceMatrix (covariance_matrix);
+  const auto number_of_points = indices_->size ();
+  const double factor = 1.0 / static_cast <double> ((number_of_points > 1) ? (number_of_points - 1) : 1);
+  Eigen::Matrix <float, 3, 3> covariance_matrix = (scatter_matrix * factor).cast <float> ();
 
   computeEigenVectors (covariance_matrix, major_axis_, middle_axis_, minor_axis_, major_value_, middle_value_, minor_value_);
 
-  float theta = 0.0f;
-  while (theta <= 90.0f)
+  if (!bounding_box_only_)
   {
-    float phi = 0.0f;
-    Eigen::Vector3f rotated_vector;
-    rotateVector (major_axis_, middle_axis_, theta, rotated_vector);
-    while (phi <= 360.0f)
+    std::vector <Eigen::Vector3f> axes;
+    float theta = 0.0f;
+    while (theta <= 90.0f)
     {
-      Eigen::Vector3f current_axis;
-      rotateVector (rotated_vector, minor_axis_, phi, current_axis);
-      current_axis.normalize ();
+      float phi = 0.0f;
+      Eigen::Vector3f rotated_vector;
+      rotateVector (major_axis_, middle_axis_, theta, rotated_vector);
+      while (phi <= 360.0f)
+      {
+        Eigen::Vector3f current_axis;
+        rotateVector (rotated_vector, minor_axis_, phi, current_axis);
+        current_axis.normalize ();
+        axes.push_back (current_axis);
+
+        phi += step_;
+      }
+      theta += step_;
+    }
+
+    moment_of_inertia_.resize (axes.size ());
+    eccentricity_.resize (axes.size ());
 
+#pragma omp parallel for \
+  default(none) \
+  shared(axes, covariance_matrix, scatter_matrix) \
+  num_threads(threads_) \
+  schedule(dynamic, 16)
+    for (std::ptrdiff_t i_axis = 0; i_axis < static_cast <std::ptrdiff_t> (axes.size ()); i_axis++)
+    {
       //compute moment of inertia for the current axis
-      float current_moment_of_inertia = calculateMomentOfInertia (current_axis, mean_value_);
-      moment_of_inertia_.push_back (current_moment_of_inertia);
-
-      //compute eccentricity for the current plane
-      typename pcl::PointCloud<PointT>::Ptr projected_cloud (new pcl::PointCloud<PointT> ());
-      getProjectedCloud (current_axis, mean_value_, projected_cloud);
-      Eigen::Matrix <float, 3, 3> covariance_matrix;
-      covariance_matrix.setZero ();
-      computeCovarianceMatrix (projected_cloud, covariance_matrix);
-      projected_cloud.reset ();
-      float current_eccentricity = computeEccentricity (covariance_matrix, current_axis);
-      eccentricity_.push_back (current_eccentricity);
-
-      phi += step_;
+      moment_of_inertia_[i_axis] = calculateMomentOfInertia (axes[i_axis], scatter_matrix);
+
+      //compute eccentricity for the current plane, the covariance matrix of the cloud
+      //projected on it is P * C * P with P = I - n * n^T
+      const Eigen::Matrix3f projection = Eigen::Matrix3f::Identity () - axes[i_axis] * axes[i_axis].transpose ();
+      const Eigen::Matrix3f projected_covariance_matrix = projection * covariance_matrix * projection;
+      eccentricity_[i_axis] = computeEccentricity (projected_covariance_matrix, axes[i_axis]);
     }
-    theta += step_;
   }
 
   computeOBB ();
@@ -228,30 +274,41 @@ pcl::MomentOfInertiaEstimation<PointT>::computeOBB ()
   obb_min_point_.y = std::numeric_limits <float>::max ();
   obb_min_point_.z = std::numeric_limits <float>::max ();
 
-  obb_max_point_.x = std::numeric_limits <float>::min ();
-  obb_max_point_.y = std::numeric_limits <float>::min ();
-  obb_max_point_.z = std::numeric_limits <float>::min ();
+  obb_max_point_.x = -std::numeric_limits <float>::max ();
+  obb_max_point_.y = -std::numeric_limits <float>::max ();
+  obb_max_point_.z = -std::numeric_limits <float>::max ();
+
+  std::size_t number_of_points = indices_->size ();
+  std::size_t number_of_blocks = (number_of_points + block_size_ - 1) / block_size_;
+  std::vector <Eigen::Array3f> block_min (number_of_blocks, Eigen::Array3f::Constant (std::numeric_limits <float>::max ()));
+  std::vector <Eigen::Array3f> block_max (number_of_blocks, Eigen::Array3f::Constant (-std::numeric_limits <float>::max ()));
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_min, block_max, number_of_blocks, number_of_points) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t i_block = 0; i_block < static_cast <std::ptrdiff_t> (number_of_blocks); i_block++)
+  {
+    const std::size_t end = std::min <std::size_t> ((i_block + 1) * block_size_, number_of_points);
+    for (std::size_t i_point = i_block * block_size_; i_point < end; i_point++)
+    {
+      const Eigen::Vector3f point = (*input_)[(*indices_)[i_point]].getVector3fMap () - mean_value_;
+      const Eigen::Array3f projection (point.dot (major_axis_), point.dot (middle_axis_), point.dot (minor_axis_));
+      block_min[i_block] = block_min[i_block].min (projection);
+      block_max[i_block] = block_max[i_block].max (projection);
+    }
+  }
 
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+  for (std::size_t i_block = 0; i_block < number_of_blocks; i_block++)
   {
-    float x = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * major_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * major_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * major_axis_ (2);
-    float y = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * middle_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * middle_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * middle_axis_ (2);
-    float z = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * minor_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * minor_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * minor_axis_ (2);
-
-    if (x <= obb_min_point_.x) obb_min_point_.x = x;
-    if (y <= obb_min_point_.y) obb_min_point_.y = y;
-    if (z <= obb_min_point_.z) obb_min_point_.z = z;
-
-    if (x >= obb_max_point_.x) obb_max_point_.x = x;
-    if (y >= obb_max_point_.y) obb_max_point_.y = y;
-    if (z >= obb_max_point_.z) obb_max_point_.z = z;
+    obb_min_point_.x = std::min (obb_min_point_.x, block_min[i_block] (0));
+    obb_min_point_.y = std::min (obb_min_point_.y, block_min[i_block] (1));
+    obb_min_point_.z = std::min (obb_min_point_.z, block_min[i_block] (2));
+
+    obb_max_point_.x = std::max (obb_max_point_.x, block_max[i_block] (0));
+    obb_max_point_.y = std::max (obb_max_point_.y, block_max[i_block] (1));
+    obb_max_point_.z = std::max (obb_max_point_.z, block_max[i_block] (2));
   }
 
   obb_rotational_matrix_ << major_axis_ (0), middle_axis_ (0), minor_axis_ (0),
@@ -318,11 +375,10 @@ pcl::MomentOfInertiaEstimation<PointT>::getEccentricity (std::vector <float>& ec
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::MomentOfInertiaEstimation<PointT>::computeMeanValue ()
+pcl::MomentOfInertiaEstimation<PointT>::computeMoments (Eigen::Matrix3d& scatter_matrix)
 {
-  mean_value_ (0) = 0.0f;
-  mean_value_ (1) = 0.0f;
-  mean_value_ (2) = 0.0f;
+  mean_value_.setZero ();
+  scatter_matrix.setZero ();
 
   aabb_min_point_.x = std::numeric_limits <float>::max ();
   aabb_min_point_.y = std::numeric_limits <float>::max ();
@@ -332,70 +388,59 @@ pcl::MomentOfInertiaEstimation<PointT>::computeMeanValue ()
   aabb_max_point_.y = -std::numeric_limits <float>::max ();
   aabb_max_point_.z = -std::numeric_limits <float>::max ();
 
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
-  {
-    mean_value_ (0) += (*input_)[(*indices_)[i_point]].x;
-    mean_value_ (1) += (*input_)[(*indices_)[i_point]].y;
-    mean_value_ (2) += (*input_)[(*indices_)[i_point]].z;
-
-    if ((*input_)[(*indices_)[i_point]].x <= aabb_min_point_.x) aabb_min_point_.x = (*input_)[(*indices_)[i_point]].x;
-    if ((*input_)[(*indices_)[i_point]].y <= aabb_min_point_.y) aabb_min_point_.y = (*input_)[(*indices_)[i_point]].y;
-    if ((*input_)[(*indices_)[i_point]].z <= aabb_min_point_.z) aabb_min_point_.z = (*input_)[(*indices_)[i_point]].z;
-
-    if ((*input_)[(*indices_)[i_point]].x >= aabb_max_point_.x) aabb_max_point_.x = (*input_)[(*indices_)[i_point]].x;
-    if ((*input_)[(*indices_)[i_point]].y >= aabb_max_point_.y) aabb_max_point_.y = (*input_)[(*indices_)[i_point]].y;
-    if ((*input_)[(*indices_)[i_point]].z >= aabb_max_point_.z) aabb_max_point_.z = (*input_)[(*indices_)[i_point]].z;
-  }
-
+  std::size_t number_of_points = indices_->size ();
   if (number_of_points == 0)
-    number_of_points = 1;
-
-  mean_value_ (0) /= number_of_points;
-  mean_value_ (1) /= number_of_points;
-  mean_value_ (2) /= number_of_points;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> void
-pcl::MomentOfInertiaEstimation<PointT>::computeCovarianceMatrix (Eigen::Matrix <float, 3, 3>& covariance_matrix) const
-{
-  covariance_matrix.setZero ();
+    return;
 
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  float factor = 1.0f / static_cast <float> ((number_of_points - 1 > 0)?(number_of_points - 1):1);
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+  // The sums are taken relative to the first point to avoid the cancellation of
+  // the one pass covariance formula. Every block of points is summed separately
+  // and the blocks are merged in order, so the result does not depend on the
+  // number of threads.
+  Eigen::Vector3d origin = (*input_)[(*indices_)[0]].getVector3fMap ().template cast <double> ();
+  std::size_t number_of_blocks = (number_of_points + block_size_ - 1) / block_size_;
+  std::vector <Eigen::Vector3d> block_sum (number_of_blocks, Eigen::Vector3d::Zero ());
+  std::vector <Eigen::Matrix3d> block_scatter (number_of_blocks, Eigen::Matrix3d::Zero ());
+  std::vector <Eigen::Array3f> block_min (number_of_blocks, Eigen::Array3f::Constant (std::numeric_limits <float>::max ()));
+  std::vector <Eigen::Array3f> block_max (number_of_blocks, Eigen::Array3f::Constant (-std::numeric_limits <float>::max ()));
+
+#pragma omp parallel for \
+  default(none) \
+  shared(origin, block_sum, block_scatter, block_min, block_max, number_of_blocks, number_of_points) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t i_block = 0; i_block < static_cast <std::ptrdiff_t> (number_of_blocks); i_block++)
   {
-    Eigen::Vector3f current_point (0.0f, 0.0f, 0.0f);
-    current_point (0) = (*input_)[(*indices_)[i_point]].x - mean_value_ (0);
-    current_point (1) = (*input_)[(*indices_)[i_point]].y - mean_value_ (1);
-    current_point (2) = (*input_)[(*indices_)[i_point]].z - mean_value_ (2);
-
-    covariance_matrix += current_point * current_point.transpose ();
+    const std::size_t end = std::min <std::size_t> ((i_block + 1) * block_size_, number_of_points);
+    for (std::size_t i_point = i_block * block_size_; i_point < end; i_point++)
+    {
+      const Eigen::Vector3f point = (*input_)[(*indices_)[i_point]].getVector3fMap ();
+      const Eigen::Vector3d shifted = point.template cast <double> () - origin;
+      block_sum[i_block] += shifted;
+      block_scatter[i_block].template triangularView <Eigen::Lower> () += shifted * shifted.transpose ();
+      block_min[i_block] = block_min[i_block].min (point.array ());
+      block_max[i_block] = block_max[i_block].max (point.array ());
+    }
   }
 
-  covariance_matrix *= factor;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> void
-pcl::MomentOfInertiaEstimation<PointT>::computeCovarianceMatrix (PointCloudConstPtr cloud, Eigen::Matrix <float, 3, 3>& covariance_matrix) const
-{
-  covariance_matrix.setZero ();
-
-  const auto number_of_points = cloud->size ();
-  float factor = 1.0f / static_cast <float> ((number_of_points - 1 > 0)?(number_of_points - 1):1);
-  Eigen::Vector3f current_point;
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+  Eigen::Vector3d sum = Eigen::Vector3d::Zero ();
+  for (std::size_t i_block = 0; i_block < number_of_blocks; i_block++)
   {
-    current_point (0) = (*cloud)[i_point].x - mean_value_ (0);
-    current_point (1) = (*cloud)[i_point].y - mean_value_ (1);
-    current_point (2) = (*cloud)[i_point].z - mean_value_ (2);
+    sum += block_sum[i_block];
+    scatter_matrix += block_scatter[i_block];
 
-    covariance_matrix += current_point * current_point.transpose ();
+    aabb_min_point_.x = std::min (aabb_min_point_.x, block_min[i_block] (0));
+    aabb_min_point_.y = std::min (aabb_min_point_.y, block_min[i_block] (1));
+    aabb_min_point_.z = std::min (aabb_min_point_.z, block_min[i_block] (2));
+
+    aabb_max_point_.x = std::max (aabb_max_point_.x, block_max[i_block] (0));
+    aabb_max_point_.y = std::max (aabb_max_point_.y, block_max[i_block] (1));
+    aabb_max_point_.z = std::max (aabb_max_point_.z, block_max[i_block] (2));
   }
 
-  covariance_matrix *= factor;
+  const Eigen::Vector3d shifted_mean = sum / static_cast <double> (number_of_points);
+  scatter_matrix.template triangularView <Eigen::Lower> () -= static_cast <double> (number_of_points) * shifted_mean * shifted_mean.transpose ();
+  scatter_matrix.template triangularView <Eigen::StrictlyUpper> () = scatter_matrix.transpose ();
+  mean_value_ = (origin + shifted_mean).cast <float> ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -479,49 +524,13 @@ pcl::MomentOfInertiaEstimation<PointT>::rotateVector (const Eigen::Vector3f& vec
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> float
-pcl::MomentOfInertiaEstimation<PointT>::calculateMomentOfInertia (const Eigen::Vector3f& current_axis, const Eigen::Vector3f& mean_value) const
+pcl::MomentOfInertiaEstimation<PointT>::calculateMomentOfInertia (const Eigen::Vector3f& current_axis, const Eigen::Matrix3d& scatter_matrix) const
 {
-  float moment_of_inertia = 0.0f;
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
-  {
-    Eigen::Vector3f vector;
-    vector (0) = mean_value (0) - (*input_)[(*indices_)[i_point]].x;
-    vector (1) = mean_value (1) - (*input_)[(*indices_)[i_point]].y;
-    vector (2) = mean_value (2) - (*input_)[(*indices_)[i_point]].z;
-
-    Eigen::Vector3f product = vector.cross (current_axis);
-
-    float distance = product (0) * product (0) + product (1) * product (1) + product (2) * product (2);
-
-    moment_of_inertia += distance;
-  }
-
-  return (point_mass_ * moment_of_inertia);
-}
+  // sum_i |d_i x a|^2 = sum_i (|d_i|^2 |a|^2 - (d_i . a)^2) = trace (S) |a|^2 - a^T S a
+  const Eigen::Vector3d axis = current_axis.cast <double> ();
+  const double moment_of_inertia = scatter_matrix.trace () * axis.squaredNorm () - axis.dot (scatter_matrix * axis);
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> void
-pcl::MomentOfInertiaEstimation<PointT>::getProjectedCloud (const Eigen::Vector3f& normal_vector, const Eigen::Vector3f& point, typename pcl::PointCloud <PointT>::Ptr projected_cloud) const
-{
-  const float D = - normal_vector.dot (point);
-
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  projected_cloud->points.resize (number_of_points, PointT ());
-
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
-  {
-    const unsigned int index = (*indices_)[i_point];
-    float K = - (D + normal_vector (0) * (*input_)[index].x + normal_vector (1) * (*input_)[index].y + normal_vector (2) * (*input_)[index].z);
-    PointT projected_point;
-    projected_point.x = (*input_)[index].x + K * normal_vector (0);
-    projected_point.y = (*input_)[index].y + K * normal_vector (1);
-    projected_point.z = (*input_)[index].z + K * normal_vector (2);
-    (*projected_cloud)[i_point] = projected_point;
-  }
-  projected_cloud->width = number_of_points;
-  projected_cloud->height = 1;
-  projected_cloud->header = input_->header;
+  return (point_mass_ * static_cast <float> (moment_of_inertia));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
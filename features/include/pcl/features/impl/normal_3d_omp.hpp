@@ -43,6 +43,8 @@
 
 #include <pcl/features/normal_3d_omp.h>
 
+#include <array>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
@@ -67,65 +69,88 @@ pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &ou
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
-  {
+  std::ptrdiff_t nr_chunks = static_cast<std::ptrdiff_t> ((indices_->size () + chunk_size_ - 1) / chunk_size_);
+
 #pragma omp parallel for \
   default(none) \
-  shared(output) \
+  shared(nr_chunks, output) \
   firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
-    {
-      Eigen::Vector4f n;
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-
-        output.is_dense = false;
-        continue;
-      }
+  num_threads(threads_) \
+  schedule(dynamic)
+  // Iterating over the entire index vector, one chunk of indices at a time
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+    computeChunk (chunk, nn_indices, nn_dists, output);
+}
 
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimationOMP<PointInT, PointOutT>::computeChunk (
+    std::size_t chunk, pcl::Indices &nn_indices, std::vector<float> &nn_dists, PointCloudOut &output)
+{
+  const std::size_t begin = chunk * chunk_size_;
+  const std::size_t size = std::min<std::size_t> (chunk_size_, indices_->size () - begin);
 
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
+  // Upper triangles of the covariance matrices, one array per coefficient
+  std::array<std::array<float, chunk_size_>, 6> covariances;
+  std::array<std::array<float, chunk_size_>, 3> eigen_values;
+  std::array<std::array<float, chunk_size_>, 3> eigen_vectors;
+  std::array<bool, chunk_size_> valid;
 
-    }
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    const auto index = (*indices_)[begin + i];
+    // Placeholder for the 3x3 covariance matrix at each surface patch
+    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix = Eigen::Matrix3f::Identity ();
+    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
+    Eigen::Vector4f xyz_centroid;
+
+    // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+    valid[i] = (input_->is_dense || isFinite ((*input_)[index])) &&
+               this->searchForNeighbors (index, search_parameter_, nn_indices, nn_dists) != 0 &&
+               nn_indices.size () >= 3 &&
+               computeMeanAndCovarianceMatrix (*surface_, nn_indices, covariance_matrix, xyz_centroid) != 0;
+    if (!valid[i])
+      covariance_matrix.setIdentity ();
+
+    covariances[0][i] = covariance_matrix.coeff (0, 0);
+    covariances[1][i] = covariance_matrix.coeff (0, 1);
+    covariances[2][i] = covariance_matrix.coeff (0, 2);
+    covariances[3][i] = covariance_matrix.coeff (1, 1);
+    covariances[4][i] = covariance_matrix.coeff (1, 2);
+    covariances[5][i] = covariance_matrix.coeff (2, 2);
   }
-  else
+
+  // Extract the smallest eigenvalues and their eigenvectors
+  const float* const mat[6] = {covariances[0].data (), covariances[1].data (), covariances[2].data (),
+                               covariances[3].data (), covariances[4].data (), covariances[5].data ()};
+  float* const evals[3] = {eigen_values[0].data (), eigen_values[1].data (), eigen_values[2].data ()};
+  float* const evecs[3] = {eigen_vectors[0].data (), eigen_vectors[1].data (), eigen_vectors[2].data ()};
+  pcl::eigen33Batch (mat, size, evals, evecs, 0);
+
+  for (std::size_t i = 0; i < size; ++i)
   {
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+    PointOutT &point = output[begin + i];
+    if (!valid[i])
     {
-      Eigen::Vector4f n;
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      point.normal[0] = point.normal[1] = point.normal[2] = point.curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
-        continue;
-      }
+      output.is_dense = false;
+      continue;
+    }
 
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
+    point.normal_x = eigen_vectors[0][i];
+    point.normal_y = eigen_vectors[1][i];
+    point.normal_z = eigen_vectors[2][i];
 
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
+    // Compute the curvature surface change
+    const float eig_sum = covariances[0][i] + covariances[3][i] + covariances[5][i];
+    if (eig_sum != 0)
+      point.curvature = std::abs (eigen_values[0][i] / eig_sum);
+    else
+      point.curvature = 0;
 
-    }
+    flipNormalTowardsViewpoint ((*input_)[(*indices_)[begin + i]], vpx_, vpy_, vpz_,
+                                point.normal[0], point.normal[1], point.normal[2]);
   }
 }
 
@@ -48,6 +48,20 @@
 #include <pcl/common/common.h> // for getMaxDistance
 #include <pcl/common/transforms.h>
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT> void
+pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT> void
 pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::compute (PointCloudOut &output)
@@ -386,22 +400,27 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeRFAndShapeDistribut
   cluster_axes_.clear ();
   cluster_axes_.resize (centroids_dominant_orientations_.size ());
 
-  for (std::size_t i = 0; i < centroids_dominant_orientations_.size (); i++)
+  // The clusters are processed in parallel; their reference frames and signatures are
+  // merged in cluster order afterwards so the output does not depend on the scheduling
+  std::vector<std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > > cluster_transformations (centroids_dominant_orientations_.size ());
+  std::vector<PointCloudOut> cluster_signatures (centroids_dominant_orientations_.size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cluster_indices, cluster_signatures, cluster_transformations, output, processed) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (centroids_dominant_orientations_.size ()); i++)
   {
 
-    std::vector < Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transformations;
+    auto &transformations = cluster_transformations[i];
     PointInTPtr grid (new pcl::PointCloud<PointInT>);
     sgurf (centroids_dominant_orientations_[i], dominant_normals_[i], processed, transformations, grid, cluster_indices[i]);
 
-    // Make a note of how many transformations correspond to each cluster
-    cluster_axes_[i] = transformations.size ();
-    
     for (const auto &transformation : transformations)
     {
 
       pcl::transformPointCloud (*processed, *grid, transformation);
-      transforms_.push_back (transformation);
-      valid_transforms_.push_back (true);
 
       std::vector < Eigen::VectorXf > quadrants (8);
       int size_hists = 13;
@@ -531,12 +550,20 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeRFAndShapeDistribut
         }
       }
 
-      ourcvfh_output.push_back (vfh_signature[0]);
-      ourcvfh_output.width = ourcvfh_output.size ();
+      cluster_signatures[i].push_back (vfh_signature[0]);
       delete[] weights;
     }
   }
 
+  for (std::size_t i = 0; i < centroids_dominant_orientations_.size (); i++)
+  {
+    // Make a note of how many transformations correspond to each cluster
+    cluster_axes_[i] = cluster_transformations[i].size ();
+    transforms_.insert (transforms_.end (), cluster_transformations[i].begin (), cluster_transformations[i].end ());
+    valid_transforms_.insert (valid_transforms_.end (), cluster_transformations[i].size (), true);
+    ourcvfh_output.insert (ourcvfh_output.end (), cluster_signatures[i].begin (), cluster_signatures[i].end ());
+  }
+
   if (!ourcvfh_output.empty ())
   {
     ourcvfh_output.height = 1;
@@ -705,7 +732,15 @@ pcl::OURCVFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
     output.resize (dominant_normals_.size ());
     output.width = dominant_normals_.size ();
 
-    for (std::size_t i = 0; i < dominant_normals_.size (); ++i)
+    // Every thread works on its own copy of the VFH estimator; the search method is shared
+    // and already initialized on surface_, so it is only read from
+#pragma omp parallel for \
+  default(none) \
+  shared(output) \
+  firstprivate(vfh) \
+  num_threads(threads_) \
+  schedule(dynamic, 1)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (dominant_normals_.size ()); ++i)
     {
       //configure VFH computation for CVFH
       vfh.setNormalToUse (dominant_normals_[i]);
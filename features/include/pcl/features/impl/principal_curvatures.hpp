@@ -44,12 +44,13 @@
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
+#include <array>
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
-      const pcl::PointCloud<PointNT> &normals, int p_idx, const pcl::Indices &indices,
-      float &pcx, float &pcy, float &pcz, float &pc1, float &pc2)
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeProjectedNormalsCovariance (
+      const pcl::PointCloud<PointNT> &normals, int p_idx, const pcl::Indices &indices)
 {
   EIGEN_ALIGN16 Eigen::Matrix3f I = Eigen::Matrix3f::Identity ();
   Eigen::Vector3f n_idx (normals[p_idx].normal[0], normals[p_idx].normal[1], normals[p_idx].normal[2]);
@@ -96,6 +97,16 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPr
     covariance_matrix_(2, 1) += static_cast<float> (demean_yz);
     covariance_matrix_(2, 2) += demean_[2] * demean_[2];
   }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
+      const pcl::PointCloud<PointNT> &normals, int p_idx, const pcl::Indices &indices,
+      float &pcx, float &pcy, float &pcz, float &pc1, float &pc2)
+{
+  computeProjectedNormalsCovariance (normals, p_idx, indices);
 
   // Extract the eigenvalues and eigenvectors
   pcl::eigen33 (covariance_matrix_, eigenvalues_);
@@ -119,45 +130,70 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
   pcl::Indices nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // The covariance matrices of chunk_size consecutive indices are gathered in structure-of-arrays layout
+  // (one array per upper triangular coefficient) and solved together by pcl::eigen33Batch
+  constexpr std::size_t chunk_size = 256;
+  std::array<std::array<float, chunk_size>, 6> covariances;
+  std::array<std::array<float, chunk_size>, 3> eigen_values;
+  std::array<std::array<float, chunk_size>, 3> eigen_vectors;
+  std::array<float, chunk_size> nr_neighbors;
+
+  const float* const mat[6] = {covariances[0].data (), covariances[1].data (), covariances[2].data (),
+                               covariances[3].data (), covariances[4].data (), covariances[5].data ()};
+  float* const evals[3] = {eigen_values[0].data (), eigen_values[1].data (), eigen_values[2].data ()};
+  float* const evecs[3] = {eigen_vectors[0].data (), eigen_vectors[1].data (), eigen_vectors[2].data ()};
+
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  // Iterating over the entire index vector
+  for (std::size_t begin = 0; begin < indices_->size (); begin += chunk_size)
   {
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+    const std::size_t size = std::min (chunk_size, indices_->size () - begin);
+
+    for (std::size_t i = 0; i < size; ++i)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      const auto index = (*indices_)[begin + i];
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[index])) ||
+          this->searchForNeighbors (index, search_parameter_, nn_indices, nn_dists) == 0)
       {
-        output[idx].principal_curvature[0] = output[idx].principal_curvature[1] = output[idx].principal_curvature[2] =
-          output[idx].pc1 = output[idx].pc2 = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
-        continue;
+        // Mark the point as invalid, the batched solver gets a well-defined dummy matrix
+        nr_neighbors[i] = 0;
+        covariance_matrix_.setIdentity ();
+      }
+      else
+      {
+        nr_neighbors[i] = static_cast<float> (nn_indices.size ());
+        computeProjectedNormalsCovariance (*normals_, index, nn_indices);
       }
 
-      // Estimate the principal curvatures at each patch
-      computePointPrincipalCurvatures (*normals_, (*indices_)[idx], nn_indices,
-                                       output[idx].principal_curvature[0], output[idx].principal_curvature[1], output[idx].principal_curvature[2],
-                                       output[idx].pc1, output[idx].pc2);
+      covariances[0][i] = covariance_matrix_.coeff (0, 0);
+      covariances[1][i] = covariance_matrix_.coeff (0, 1);
+      covariances[2][i] = covariance_matrix_.coeff (0, 2);
+      covariances[3][i] = covariance_matrix_.coeff (1, 1);
+      covariances[4][i] = covariance_matrix_.coeff (1, 2);
+      covariances[5][i] = covariance_matrix_.coeff (2, 2);
     }
-  }
-  else
-  {
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+
+    // Extract the eigenvalues and the eigenvectors of the largest eigenvalues
+    pcl::eigen33Batch (mat, size, evals, evecs, 2);
+
+    for (std::size_t i = 0; i < size; ++i)
     {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      PointOutT &point = output[begin + i];
+      if (nr_neighbors[i] == 0)
       {
-        output[idx].principal_curvature[0] = output[idx].principal_curvature[1] = output[idx].principal_curvature[2] =
-          output[idx].pc1 = output[idx].pc2 = std::numeric_limits<float>::quiet_NaN ();
+        point.principal_curvature[0] = point.principal_curvature[1] = point.principal_curvature[2] =
+          point.pc1 = point.pc2 = std::numeric_limits<float>::quiet_NaN ();
         output.is_dense = false;
         continue;
       }
 
-      // Estimate the principal curvatures at each patch
-      computePointPrincipalCurvatures (*normals_, (*indices_)[idx], nn_indices,
-                                       output[idx].principal_curvature[0], output[idx].principal_curvature[1], output[idx].principal_curvature[2],
-                                       output[idx].pc1, output[idx].pc2);
+      point.principal_curvature[0] = eigen_vectors[0][i];
+      point.principal_curvature[1] = eigen_vectors[1][i];
+      point.principal_curvature[2] = eigen_vectors[2][i];
+      const float indices_size = 1.0f / nr_neighbors[i];
+      point.pc1 = eigen_values[2][i] * indices_size;
+      point.pc2 = eigen_values[1][i] * indices_size;
     }
   }
 }
@@ -42,6 +42,7 @@
 
 #include <pcl/features/rops_estimation.h>
 
+#include <algorithm> // for sort, unique
 #include <array>
 #include <numeric> // for accumulate
 #include <Eigen/Eigenvalues> // for EigenSolver
@@ -55,7 +56,7 @@ pcl::ROPSEstimation <PointInT, PointOutT>::ROPSEstimation () :
   sqr_support_radius_ (1.0f),
   step_ (22.5f),
   triangles_ (0),
-  triangles_of_the_point_ (0)
+  threads_ (1)
 {
 }
 
@@ -64,7 +65,8 @@ template <typename PointInT, typename PointOutT>
 pcl::ROPSEstimation <PointInT, PointOutT>::~ROPSEstimation ()
 {
   triangles_.clear ();
-  triangles_of_the_point_.clear ();
+  point_triangles_.clear ();
+  point_triangles_offsets_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -123,6 +125,7 @@ template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::setTriangles (const std::vector <pcl::Vertices>& triangles)
 {
   triangles_ = triangles;
+  point_triangles_offsets_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -132,6 +135,20 @@ pcl::ROPSEstimation <PointInT, PointOutT>::getTriangles (std::vector <pcl::Verti
   triangles = triangles_;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ROPSEstimation <PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -142,18 +159,26 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
     return;
   }
 
-  buildListOfPointsTriangles ();
+  if (point_triangles_offsets_.size () != surface_->size () + 1)
+    buildListOfPointsTriangles ();
 
   //feature size = number_of_rotations * number_of_axis_to_rotate_around * number_of_projections * number_of_central_moments
   unsigned int feature_size = number_of_rotations_ * 3 * 3 * 5;
-  const auto number_of_points = indices_->size ();
-  output.clear ();
-  output.reserve (number_of_points);
-
-  for (const auto& idx: *indices_)
+  std::size_t number_of_points = indices_->size ();
+  output.resize (number_of_points);
+
+  std::vector <unsigned int> local_triangles;
+  pcl::Indices local_points;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(feature_size, number_of_points, output) \
+  firstprivate(local_points, local_triangles) \
+  num_threads(threads_) \
+  schedule(dynamic, 16)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_points); i_point++)
   {
-    std::set <unsigned int> local_triangles;
-    pcl::Indices local_points;
+    const auto idx = (*indices_)[i_point];
     getLocalSurface ((*input_)[idx], local_triangles, local_points);
 
     Eigen::Matrix3f lrf_matrix;
@@ -205,9 +230,8 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
     else
       invert_norm = 1.0f / norm;
 
-    output.emplace_back ();
     for (std::size_t i_dim = 0; i_dim < feature_size; i_dim++)
-      output.back().histogram[i_dim] = feature[i_dim] * invert_norm;
+      output[i_point].histogram[i_dim] = feature[i_dim] * invert_norm;
   }
 }
 
@@ -215,32 +239,42 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
 template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::buildListOfPointsTriangles ()
 {
-  triangles_of_the_point_.clear ();
+  // Count the triangles of every point, then fill them in with a second pass over the triangles
+  point_triangles_offsets_.assign (surface_->size () + 1, 0);
+  for (const auto& triangle: triangles_)
+    for (const auto& vertex: triangle.vertices)
+      point_triangles_offsets_[vertex + 1]++;
 
-  std::vector <unsigned int> dummy;
-  dummy.reserve (100);
-  triangles_of_the_point_.resize (surface_->points. size (), dummy);
+  for (std::size_t i_point = 0; i_point < surface_->size (); i_point++)
+    point_triangles_offsets_[i_point + 1] += point_triangles_offsets_[i_point];
 
+  point_triangles_.resize (point_triangles_offsets_.back ());
+  std::vector <std::size_t> next (point_triangles_offsets_.begin (), point_triangles_offsets_.end () - 1);
   for (std::size_t i_triangle = 0; i_triangle < triangles_.size (); i_triangle++)
     for (const auto& vertex: triangles_[i_triangle].vertices)
-      triangles_of_the_point_[vertex].push_back (i_triangle);
+      point_triangles_[next[vertex]++] = static_cast <unsigned int> (i_triangle);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ROPSEstimation <PointInT, PointOutT>::getLocalSurface (const PointInT& point, std::set <unsigned int>& local_triangles, pcl::Indices& local_points) const
+pcl::ROPSEstimation <PointInT, PointOutT>::getLocalSurface (const PointInT& point, std::vector <unsigned int>& local_triangles, pcl::Indices& local_points) const
 {
   std::vector <float> distances;
   tree_->radiusSearch (point, support_radius_, local_points, distances);
 
+  local_triangles.clear ();
   for (const auto& pt: local_points)
-    local_triangles.insert (triangles_of_the_point_[pt].begin (),
-                            triangles_of_the_point_[pt].end ());
+    local_triangles.insert (local_triangles.end (),
+                            point_triangles_.begin () + point_triangles_offsets_[pt],
+                            point_triangles_.begin () + point_triangles_offsets_[pt + 1]);
+
+  std::sort (local_triangles.begin (), local_triangles.end ());
+  local_triangles.erase (std::unique (local_triangles.begin (), local_triangles.end ()), local_triangles.end ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ROPSEstimation <PointInT, PointOutT>::computeLRF (const PointInT& point, const std::set <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const
+pcl::ROPSEstimation <PointInT, PointOutT>::computeLRF (const PointInT& point, const std::vector <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const
 {
   std::size_t number_of_triangles = local_triangles.size ();
 
@@ -163,66 +163,55 @@ pcl::computeRSD (const pcl::PointCloud<PointNT> &normals,
     return histogram;
   }
   
-  // Initialize minimum and maximum angle values in each distance bin
-  std::vector<std::vector<double> > min_max_angle_by_dist (nr_subdiv);
-  min_max_angle_by_dist[0].resize (2);
-  min_max_angle_by_dist[0][0] = min_max_angle_by_dist[0][1] = 0.0;
-  for (int di=1; di<nr_subdiv; di++)
-  {
-    min_max_angle_by_dist[di].resize (2);
-    min_max_angle_by_dist[di][0] = +DBL_MAX;
-    min_max_angle_by_dist[di][1] = -DBL_MAX;
-  }
+  // The angle between two normals (disregarding their orientation) is acos (|cosine|), which
+  // decreases monotonically with |cosine|. Tracking the extreme |cosine| values of each
+  // distance bin therefore gives the same minimum and maximum angles as tracking the angles,
+  // but needs only one acos per bin instead of one per neighbor.
+  // A negative maximum marks an empty bin; the first bin always contains the zero angle.
+  Eigen::ArrayXd min_abs_cosine = Eigen::ArrayXd::Constant (nr_subdiv, 1.0);
+  Eigen::ArrayXd max_abs_cosine = Eigen::ArrayXd::Constant (nr_subdiv, -1.0);
+  max_abs_cosine[0] = 1.0;
   
   // Compute distance by normal angle distribution for points
-  pcl::Indices::const_iterator i, begin (indices.begin()), end (indices.end());
-  for (i = begin+1; i != end; ++i)
+  const auto &reference = normals[indices[0]];
+  for (std::size_t i = 1; i < indices.size (); ++i)
   {
-    // compute angle between the two lines going through normals (disregard orientation!)
-    double cosine = normals[*i].normal[0] * normals[*begin].normal[0] +
-                    normals[*i].normal[1] * normals[*begin].normal[1] +
-                    normals[*i].normal[2] * normals[*begin].normal[2];
-    if (cosine > 1) cosine = 1;
-    if (cosine < -1) cosine = -1;
-    double angle  = std::acos (cosine);
-    if (angle > M_PI/2) angle = M_PI - angle; /// \note: orientation is neglected!
-
     // Compute point to point distance
-    double dist = sqrt (sqr_dists[i-begin]);
+    double dist = std::sqrt (sqr_dists[i]);
 
     if (dist > max_dist)
       continue; /// \note: we neglect points that are outside the specified interval!
 
+    // compute cosine of the angle between the two lines going through normals (disregard orientation!)
+    const auto &normal = normals[indices[i]];
+    const double cosine = normal.normal[0] * reference.normal[0] +
+                          normal.normal[1] * reference.normal[1] +
+                          normal.normal[2] * reference.normal[2];
+    if (!std::isfinite (cosine))
+      continue; /// \note: points without a valid normal (or a reference point without one) are neglected too
+    double abs_cosine = std::min (1.0, std::abs (cosine));
+
     // compute bins and increase
-    int bin_d = static_cast<int> (std::floor (nr_subdiv * dist / max_dist));
+    int bin_d = std::min (nr_subdiv - 1, static_cast<int> (std::floor (nr_subdiv * dist / max_dist)));
     if (compute_histogram)
     {
+      double angle = std::acos (abs_cosine);
       int bin_a = std::min (nr_subdiv-1, static_cast<int> (std::floor (nr_subdiv * angle / (M_PI/2))));
       histogram(bin_a, bin_d)++;
     }
 
     // update min-max values for distance bins
-    if (min_max_angle_by_dist[bin_d][0] > angle) min_max_angle_by_dist[bin_d][0] = angle;
-    if (min_max_angle_by_dist[bin_d][1] < angle) min_max_angle_by_dist[bin_d][1] = angle;
+    min_abs_cosine[bin_d] = std::min (abs_cosine, min_abs_cosine[bin_d]);
+    max_abs_cosine[bin_d] = std::max (abs_cosine, max_abs_cosine[bin_d]);
   }
 
-  // Estimate radius from min and max lines
-  double Amint_Amin = 0, Amint_d = 0;
-  double Amaxt_Amax = 0, Amaxt_d = 0;
-  for (int di=0; di<nr_subdiv; di++)
-  {
-    // combute the members of A'*A*r = A'*D
-    if (min_max_angle_by_dist[di][1] >= 0)
-    {
-      double p_min = min_max_angle_by_dist[di][0];
-      double p_max = min_max_angle_by_dist[di][1];
-      double f = (di+0.5)*max_dist/nr_subdiv;
-      Amint_Amin += p_min * p_min;
-      Amint_d += p_min * f;
-      Amaxt_Amax += p_max * p_max;
-      Amaxt_d += p_max * f;
-    }
-  }
+  // Estimate radius from min and max lines by solving A'*A*r = A'*D for all non-empty bins at once
+  const Eigen::ArrayXd bin_filled = (max_abs_cosine >= 0).cast<double> ();
+  const Eigen::ArrayXd p_min = bin_filled * max_abs_cosine.max (0.0).acos ();
+  const Eigen::ArrayXd p_max = bin_filled * min_abs_cosine.acos ();
+  const Eigen::ArrayXd f = (Eigen::ArrayXd::LinSpaced (nr_subdiv, 0, nr_subdiv - 1) + 0.5) * max_dist / nr_subdiv;
+  double Amint_Amin = p_min.square ().sum (), Amint_d = (p_min * f).sum ();
+  double Amaxt_Amax = p_max.square ().sum (), Amaxt_d = (p_max * f).sum ();
   float min_radius = Amint_Amin == 0.0f ? float (plane_radius) : float (std::min (Amint_d/Amint_Amin, plane_radius));
   float max_radius = Amaxt_Amax == 0.0f ? float (plane_radius) : float (std::min (Amaxt_d/Amaxt_Amax, plane_radius));
 
@@ -243,6 +232,20 @@ pcl::computeRSD (const pcl::PointCloud<PointNT> &normals,
   return histogram;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::RSDEstimation<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::RSDEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -256,37 +259,54 @@ pcl::RSDEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     return;
   }
 
+  // Check if the given neighborhoods match the indices
+  if (neighborhoods_ && (!neighborhood_sqr_dists_ ||
+                         neighborhoods_->size () != indices_->size () ||
+                         neighborhood_sqr_dists_->size () != indices_->size ()))
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] The number of neighborhoods and their distances has to match the number of indices (%zu)!\n",
+               getClassName ().c_str (), indices_->size ());
+    output.width = output.height = 0;
+    output.clear ();
+    return;
+  }
+
   // List of indices and corresponding squared distances for a neighborhood
   // \note resize is irrelevant for a radiusSearch ().
   pcl::Indices nn_indices;
   std::vector<float> nn_sqr_dists;
 
-  // Check if the full histogram has to be saved or not
+  // Only keep the full histograms if they were requested
   if (save_histograms_)
-  {
-    // Reserve space for the output histogram dataset
-    histograms_.reset (new std::vector<Eigen::MatrixXf, Eigen::aligned_allocator<Eigen::MatrixXf> >);
-    histograms_->reserve (output.size ());
-    
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      // Compute and store r_min and r_max in the output cloud
-      this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_sqr_dists);
-      //histograms_->push_back (computeRSD (*surface_, *normals_, nn_indices, search_radius_, nr_subdiv_, plane_radius_, output[idx], true));
-      histograms_->push_back (computeRSD (*normals_, nn_indices, nn_sqr_dists, search_radius_, nr_subdiv_, plane_radius_, output[idx], true));
-    }
-  }
+    histograms_.reset (new std::vector<Eigen::MatrixXf, Eigen::aligned_allocator<Eigen::MatrixXf> > (indices_->size ()));
   else
+    histograms_.reset ();
+
+  // Iterating over the entire index vector
+#pragma omp parallel for \
+  default(none) \
+  shared(output) \
+  firstprivate(nn_indices, nn_sqr_dists) \
+  num_threads(threads_) \
+  schedule(dynamic, 64)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    // Iterating over the entire index vector
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+    // Use the given neighborhood if there is one, search for it otherwise
+    const pcl::Indices *neighbors = &nn_indices;
+    const std::vector<float> *sqr_dists = &nn_sqr_dists;
+    if (neighborhoods_)
     {
-      // Compute and store r_min and r_max in the output cloud
-      this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_sqr_dists);
-      //computeRSD (*surface_, *normals_, nn_indices, search_radius_, nr_subdiv_, plane_radius_, output[idx], false);
-      computeRSD (*normals_, nn_indices, nn_sqr_dists, search_radius_, nr_subdiv_, plane_radius_, output[idx], false);
+      neighbors = &(*neighborhoods_)[idx];
+      sqr_dists = &(*neighborhood_sqr_dists_)[idx];
     }
+    else
+      this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_sqr_dists);
+
+    // Compute and store r_min and r_max in the output cloud
+    if (save_histograms_)
+      (*histograms_)[idx] = computeRSD (*normals_, *neighbors, *sqr_dists, search_radius_, nr_subdiv_, plane_radius_, output[idx], true);
+    else
+      computeRSD (*normals_, *neighbors, *sqr_dists, search_radius_, nr_subdiv_, plane_radius_, output[idx], false);
   }
 }
 
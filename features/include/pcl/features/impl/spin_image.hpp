@@ -46,6 +46,7 @@
 #include <pcl/exceptions.h>
 #include <pcl/features/spin_image.h>
 #include <cmath>
+#include <exception> // for exception_ptr
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT>
@@ -54,7 +55,7 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::SpinImageEstimation (
   input_normals_ (), rotation_axes_cloud_ (), 
   is_angular_ (false), rotation_axis_ (), use_custom_axis_(false), use_custom_axes_cloud_ (false), 
   is_radial_ (false), image_width_ (image_width), support_angle_cos_ (support_angle_cos), 
-  min_pts_neighb_ (min_pts_neighb)
+  min_pts_neighb_ (min_pts_neighb), threads_ (1)
 {
   assert (support_angle_cos_ <= 1.0 && support_angle_cos_ >= 0.0); // may be permit negative cosine?
 
@@ -317,13 +318,53 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::initCompute ()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 { 
-  for (std::size_t i_input = 0; i_input < indices_->size (); ++i_input)
+  // Exceptions must not leave the parallel region; keep the one thrown for the
+  // earliest point (the one the serial loop would have thrown) and rethrow it afterwards
+  std::exception_ptr first_error;
+  std::ptrdiff_t first_error_index = static_cast<std::ptrdiff_t> (indices_->size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(output, first_error, first_error_index) \
+  num_threads(threads_) \
+  schedule(dynamic, 16)
+  for (std::ptrdiff_t i_input = 0; i_input < static_cast<std::ptrdiff_t> (indices_->size ()); ++i_input)
   {
-    Eigen::ArrayXXd res = computeSiForPoint (indices_->at (i_input));
+    Eigen::ArrayXXd res;
+    try
+    {
+      res = computeSiForPoint ((*indices_)[i_input]);
+    }
+    catch (...)
+    {
+#pragma omp critical
+      {
+        if (i_input < first_error_index)
+        {
+          first_error_index = i_input;
+          first_error = std::current_exception ();
+        }
+      }
+      continue;
+    }
 
     // Copy into the resultant cloud
     for (Eigen::Index iRow = 0; iRow < res.rows () ; iRow++)
@@ -334,6 +375,9 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClo
       }
     }   
   } 
+
+  if (first_error)
+    std::rethrow_exception (first_error);
 }
 
 #define PCL_INSTANTIATE_SpinImageEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::SpinImageEstimation<T,NT,OutT>;
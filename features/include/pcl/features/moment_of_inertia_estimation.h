@@ -144,6 +144,25 @@ namespace pcl
       float
       getPointMass () const;
 
+      /** \brief This method allows to skip the computation of the moments of inertia and
+        * eccentricities. If set to true, compute () only estimates the mass center, the eigen
+        * vectors and values, the AABB and the OBB, and getMomentOfInertia () and getEccentricity ()
+        * return empty vectors. Default value is false.
+        * \param[in] only_bounding_boxes desired value
+        */
+      void
+      setBoundingBoxOnlyFlag (bool only_bounding_boxes);
+
+      /** \brief Returns the bounding_box_only_ flag. */
+      bool
+      getBoundingBoxOnlyFlag () const;
+
+      /** \brief Initialize the scheduler and set the number of threads to use. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief This method launches the computation of all features. After execution
         * it sets is_valid_ flag to true and each feature can be accessed with the
         * corresponding get method.
@@ -224,28 +243,17 @@ namespace pcl
       void
       rotateVector (const Eigen::Vector3f& vector, const Eigen::Vector3f& axis, const float angle, Eigen::Vector3f& rotated_vector) const;
 
-      /** \brief This method computes center of mass and axis aligned bounding box. */
+      /** \brief This method computes center of mass, axis aligned bounding box and the scatter
+        * matrix of the input_ cloud in a single pass over the points.
+        * \param[out] scatter_matrix sum of the outer products of the points relative to the center of mass
+        */
       void
-      computeMeanValue ();
+      computeMoments (Eigen::Matrix3d& scatter_matrix);
 
       /** \brief This method computes the oriented bounding box. */
       void
       computeOBB ();
 
-      /** \brief This method computes the covariance matrix for the input_ cloud.
-        * \param[out] covariance_matrix stores the computed covariance matrix
-        */
-      void
-      computeCovarianceMatrix (Eigen::Matrix <float, 3, 3>& covariance_matrix) const;
-
-      /** \brief This method computes the covariance matrix for the given cloud.
-        * It uses all points in the cloud, unlike the previous method that uses indices.
-        * \param[in] cloud cloud for which covariance matrix will be computed
-        * \param[out] covariance_matrix stores the computed covariance matrix
-        */
-      void
-      computeCovarianceMatrix (PointCloudConstPtr cloud, Eigen::Matrix <float, 3, 3>& covariance_matrix) const;
-
       /** \brief This method calculates the eigen values and eigen vectors
         * for the given covariance matrix. Note that it returns normalized eigen
         * vectors that always form the right-handed coordinate system.
@@ -266,19 +274,10 @@ namespace pcl
         * Note that when moment of inertia is computed it is multiplied by the point mass.
         * Point mass can be accessed with the corresponding get/set methods.
         * \param[in] current_axis axis that will be used in moment of inertia computation
-        * \param[in] mean_value mean value(center of mass) of the cloud
+        * \param[in] scatter_matrix scatter matrix of the cloud around its center of mass
         */
       float
-      calculateMomentOfInertia (const Eigen::Vector3f& current_axis, const Eigen::Vector3f& mean_value) const;
-
-      /** \brief This method simply projects the given input_ cloud on the plane specified with
-        * the normal vector.
-        * \param[in] normal_vector nrmal vector of the plane
-        * \param[in] point point belonging to the plane
-        * \param[out] projected_cloud projected cloud
-        */
-      void
-      getProjectedCloud (const Eigen::Vector3f& normal_vector, const Eigen::Vector3f& point, typename pcl::PointCloud <PointT>::Ptr projected_cloud) const;
+      calculateMomentOfInertia (const Eigen::Vector3f& current_axis, const Eigen::Matrix3d& scatter_matrix) const;
 
       /** \brief This method returns the eccentricity of the projected cloud.
         * \param[in] covariance_matrix covariance matrix of the projected cloud
@@ -347,6 +346,15 @@ namespace pcl
       /** \brief Stores the rotational matrix of the oriented bounding box */
       Eigen::Matrix3f obb_rotational_matrix_;
 
+      /** \brief Stores the flag for skipping the moment of inertia and eccentricity computation */
+      bool bounding_box_only_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Number of points accumulated together, the partial results are merged in order. */
+      static constexpr std::size_t block_size_ = 4096;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -91,12 +91,26 @@ namespace pcl
       unsigned int threads_;
 
     private:
+      /** \brief The number of consecutive indices whose covariance matrices are solved together by pcl::eigen33Batch. */
+      static constexpr std::size_t chunk_size_ = 256;
+
       /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface () and the spatial locator in setSearchMethod ()
         * \param output the resultant point cloud model dataset that contains surface normals and curvatures
         */
       void
       computeFeature (PointCloudOut &output) override;
+
+      /** \brief Estimate the normals of the indices [chunk * chunk_size_, (chunk + 1) * chunk_size_): the covariance
+        * matrices of their neighborhoods are gathered in structure-of-arrays layout and their smallest eigenvectors
+        * are computed in one pcl::eigen33Batch call.
+        * \param[in] chunk the index of the chunk to process
+        * \param[out] nn_indices temporary storage for the indices of the nearest neighbors
+        * \param[out] nn_dists temporary storage for the distances to the nearest neighbors
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        */
+      void
+      computeChunk (std::size_t chunk, pcl::Indices &nn_indices, std::vector<float> &nn_dists, PointCloudOut &output);
   };
 }
 
@@ -75,7 +75,7 @@ namespace pcl
       /** \brief Empty constructor. */
       OURCVFHEstimation () :
         vpx_ (0), vpy_ (0), vpz_ (0), leaf_size_ (0.005f), normalize_bins_ (false), curv_threshold_ (0.03f), cluster_tolerance_ (leaf_size_ * 3),
-            eps_angle_threshold_ (0.125f), min_points_ (50), radius_normals_ (leaf_size_ * 3)
+            eps_angle_threshold_ (0.125f), min_points_ (50), radius_normals_ (leaf_size_ * 3), threads_ (1)
       {
         search_radius_ = 0;
         k_ = 1;
@@ -86,6 +86,14 @@ namespace pcl
       }
       ;
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+       * The VFH signatures, SGURFs and shape distributions of the stable clusters are computed
+       * in parallel. Default: 1.
+       * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Creates an affine transformation from the RF axes
        * \param[in] evx the x-axis
        * \param[in] evy the y-axis
@@ -351,6 +359,9 @@ namespace pcl
       /** \brief Radius for the normals computation. */
       float radius_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Factor for the cluster refinement */
       float refine_clusters_;
 
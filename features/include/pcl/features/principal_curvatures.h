@@ -113,6 +113,16 @@ namespace pcl
       computeFeature (PointCloudOut &output) override;
 
     private:
+      /** \brief Compute the covariance matrix of the point normals of a surface patch, projected into the tangent
+        * plane of the given point normal, and store it in covariance_matrix_.
+        * \param[in] normals the point cloud normals
+        * \param[in] p_idx the query point at which the least-squares plane was estimated
+        * \param[in] indices the point cloud indices that need to be used
+        */
+      void
+      computeProjectedNormalsCovariance (const pcl::PointCloud<PointNT> &normals,
+                                         int p_idx, const pcl::Indices &indices);
+
       /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
       std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projected_normals_;
 
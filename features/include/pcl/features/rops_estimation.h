@@ -43,7 +43,6 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/Vertices.h> // for Vertices
 #include <pcl/features/feature.h>
-#include <set>
 
 namespace pcl
 {
@@ -116,6 +115,12 @@ namespace pcl
       void
       getTriangles (std::vector <pcl::Vertices>& triangles) const;
 
+      /** \brief Initialize the scheduler and set the number of threads to use. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     private:
 
       /** \brief Abstract feature estimation method.
@@ -126,6 +131,8 @@ namespace pcl
 
       /** \brief This method simply builds the list of triangles for every point.
         * The list of triangles for each point consists of indices of triangles it belongs to.
+        * The lists are stored back to back in point_triangles_, and are only rebuilt when the
+        * triangles or the number of points of the surface change.
         * The only purpose of this method is to improve performance of the algorithm.
         */
       void
@@ -133,11 +140,11 @@ namespace pcl
 
       /** \brief This method crops all the triangles within the given radius of the given point.
         * \param[in] point point for which the local surface is computed
-        * \param[out] local_triangles stores the indices of the triangles that belong to the local surface
+        * \param[out] local_triangles stores the sorted indices of the triangles that belong to the local surface
         * \param[out] local_points stores the indices of the points that belong to the local surface
         */
       void
-      getLocalSurface (const PointInT& point, std::set <unsigned int>& local_triangles, pcl::Indices& local_points) const;
+      getLocalSurface (const PointInT& point, std::vector <unsigned int>& local_triangles, pcl::Indices& local_points) const;
 
       /** \brief This method computes LRF (Local Reference Frame) matrix for the given point.
         * \param[in] point point for which the LRF is computed
@@ -145,7 +152,7 @@ namespace pcl
         * \paran[out] lrf_matrix stores computed LRF matrix for the given point
         */
       void
-      computeLRF (const PointInT& point, const std::set <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const;
+      computeLRF (const PointInT& point, const std::vector <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const;
 
       /** \brief This method calculates the eigen values and eigen vectors
         * for the given covariance matrix. Note that it returns normalized eigen
@@ -219,8 +226,16 @@ namespace pcl
       /** \brief Stores the set of triangles representing the mesh. */
       std::vector <pcl::Vertices> triangles_;
 
-      /** \brief Stores the set of triangles for each point. Its purpose is to improve performance. */
-      std::vector <std::vector <unsigned int> > triangles_of_the_point_;
+      /** \brief Stores the set of triangles for each point. Its purpose is to improve performance.
+        * The triangles of point i are point_triangles_[point_triangles_offsets_[i] .. point_triangles_offsets_[i + 1]).
+        */
+      std::vector <unsigned int> point_triangles_;
+
+      /** \brief Stores where the triangles of each point start in point_triangles_; empty if they need to be rebuilt. */
+      std::vector <std::size_t> point_triangles_offsets_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
 
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
@@ -123,7 +123,8 @@ namespace pcl
     * </li>
     * </ul>
     *
-    * @note The code is stateful as we do not expect this class to be multicore parallelized.
+    * @note The points are processed in parallel if more than one thread is set with setNumberOfThreads (). The
+    * neighborhoods can be given with setNeighborhoods (), e.g. to share them with other features using the same radius.
     * \author Zoltan-Csaba Marton
     * \ingroup features
     */
@@ -147,7 +148,7 @@ namespace pcl
 
 
       /** \brief Empty constructor. */
-      RSDEstimation () : nr_subdiv_ (5), plane_radius_ (0.2), save_histograms_ (false)
+      RSDEstimation () : nr_subdiv_ (5), plane_radius_ (0.2), save_histograms_ (false), threads_ (1)
       {
         feature_name_ = "RadiusSurfaceDescriptor";
       };
@@ -204,6 +205,28 @@ namespace pcl
       inline shared_ptr<std::vector<Eigen::MatrixXf, Eigen::aligned_allocator<Eigen::MatrixXf> > >
       getHistograms () const { return (histograms_); }
 
+      /** \brief Initialize the scheduler and set the number of threads to use. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Provide precomputed neighborhoods instead of searching for them, e.g. the result of
+        * pcl::search::Search::radiusSearch () for all indices, shared with other features.
+        * \note There has to be one neighborhood for each of the indices given by setIndices (), in the same order.
+        * The first neighbor of each neighborhood is used as the reference point, as returned by a sorted search,
+        * and neighbors farther than the search radius are ignored.
+        * \param[in] neighborhoods the neighbor indices of each point (set to nullptr to search for them again)
+        * \param[in] sqr_dists the squared distances of the neighbors of each point to their reference point
+        */
+      inline void
+      setNeighborhoods (const shared_ptr<const std::vector<pcl::Indices> > &neighborhoods,
+                        const shared_ptr<const std::vector<std::vector<float> > > &sqr_dists)
+      {
+        neighborhoods_ = neighborhoods;
+        neighborhood_sqr_dists_ = sqr_dists;
+      }
+
     protected:
 
       /** \brief Estimate the estimates the Radius-based Surface Descriptor (RSD) at a set of points given by
@@ -227,6 +250,15 @@ namespace pcl
       /** \brief Signals whether the full distance-angle histograms are being saved. */
       bool save_histograms_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The precomputed neighborhoods of all indices, if given. */
+      shared_ptr<const std::vector<pcl::Indices> > neighborhoods_;
+
+      /** \brief The squared distances of the precomputed neighborhoods. */
+      shared_ptr<const std::vector<std::vector<float> > > neighborhood_sqr_dists_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
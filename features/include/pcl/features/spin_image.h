@@ -163,6 +163,12 @@ namespace pcl
         min_pts_neighb_ = min_pts_neighb;
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use. Default: 1.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Provide a pointer to the input dataset that contains the point normals of 
         * the input XYZ dataset given by \ref setInputCloud
         * 
@@ -276,6 +282,9 @@ namespace pcl
       unsigned int image_width_;
       double support_angle_cos_;
       unsigned int min_pts_neighb_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
@@ -53,6 +53,8 @@ template<typename PointT> void
 pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
 {
   voxel_centroids_leaf_indices_.clear ();
+  usable_leaves_.clear ();
+  usable_leaves_owner_ = nullptr;
 
   // Has the input dataset been set already?
   if (!input_)
@@ -362,9 +364,24 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
     }
   }
 
+  // Hash the usable voxels for the direct neighbor lookups
+  hashUsableLeaves ();
+
   output.width = output.size ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::VoxelGridCovariance<PointT>::hashUsableLeaves ()
+{
+  usable_leaves_.clear ();
+  usable_leaves_.reserve (leaves_.size ());
+  for (const auto& leaf : leaves_)
+    if (leaf.second.nr_points >= min_points_per_voxel_)
+      usable_leaves_.emplace (leaf.first, &leaf.second);
+  usable_leaves_owner_ = &leaves_;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> int
 pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::Matrix<int, 3, Eigen::Dynamic>& relative_coordinates, const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
@@ -385,7 +402,16 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::Matrix<in
     // Checking if the specified cell is in the grid
     if ((diff2min <= displacement.array ()).all () && (diff2max >= displacement.array ()).all ())
     {
-      const auto leaf_iter = leaves_.find (((ijk + displacement - min_b_).dot (divb_mul_)));
+      const std::size_t leaf_index = (ijk + displacement - min_b_).dot (divb_mul_);
+      if (usable_leaves_owner_ == &leaves_)
+      {
+        const auto leaf_iter = usable_leaves_.find (leaf_index);
+        if (leaf_iter != usable_leaves_.end ())
+          neighbors.push_back (leaf_iter->second);
+        continue;
+      }
+
+      const auto leaf_iter = leaves_.find (leaf_index);
       if (leaf_iter != leaves_.end () && leaf_iter->second.nr_points >= min_points_per_voxel_)
       {
         LeafConstPtr leaf = &(leaf_iter->second);
@@ -401,7 +427,7 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::Matrix<in
 template<typename PointT> int
 pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
 {
-  Eigen::MatrixXi relative_coordinates = pcl::getAllNeighborCellIndices();
+  static const Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates = pcl::getAllNeighborCellIndices();
   return getNeighborhoodAtPoint(relative_coordinates, reference_point, neighbors);
 }
 
@@ -409,21 +435,27 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const PointT& referenc
 template<typename PointT> int
 pcl::VoxelGridCovariance<PointT>::getVoxelAtPoint(const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
 {
-  return getNeighborhoodAtPoint(Eigen::Matrix<int, 3, Eigen::Dynamic>::Zero(3,1), reference_point, neighbors);
+  static const Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates = Eigen::Matrix<int, 3, Eigen::Dynamic>::Zero(3,1);
+  return getNeighborhoodAtPoint(relative_coordinates, reference_point, neighbors);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> int
 pcl::VoxelGridCovariance<PointT>::getFaceNeighborsAtPoint(const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
 {
-  Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates(3, 7);
-  relative_coordinates.setZero();
-  relative_coordinates(0, 1) = 1;
-  relative_coordinates(0, 2) = -1;
-  relative_coordinates(1, 3) = 1;
-  relative_coordinates(1, 4) = -1;
-  relative_coordinates(2, 5) = 1;
-  relative_coordinates(2, 6) = -1;
+  // The relative coordinates are built once, the lookups being used in tight loops
+  static const Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates = []
+  {
+    Eigen::Matrix<int, 3, Eigen::Dynamic> coordinates(3, 7);
+    coordinates.setZero();
+    coordinates(0, 1) = 1;
+    coordinates(0, 2) = -1;
+    coordinates(1, 3) = 1;
+    coordinates(1, 4) = -1;
+    coordinates(2, 5) = 1;
+    coordinates(2, 6) = -1;
+    return coordinates;
+  } ();
 
   return getNeighborhoodAtPoint(relative_coordinates, reference_point, neighbors);
 }
@@ -432,9 +464,13 @@ pcl::VoxelGridCovariance<PointT>::getFaceNeighborsAtPoint(const PointT& referenc
 template<typename PointT> int
 pcl::VoxelGridCovariance<PointT>::getAllNeighborsAtPoint(const PointT& reference_point, std::vector<LeafConstPtr> &neighbors) const
 {
-  Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates(3, 27);
-  relative_coordinates.col(0).setZero();
-  relative_coordinates.rightCols(26) = pcl::getAllNeighborCellIndices();
+  static const Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates = []
+  {
+    Eigen::Matrix<int, 3, Eigen::Dynamic> coordinates(3, 27);
+    coordinates.col(0).setZero();
+    coordinates.rightCols(26) = pcl::getAllNeighborCellIndices();
+    return coordinates;
+  } ();
 
   return getNeighborhoodAtPoint(relative_coordinates, reference_point, neighbors);
 }
@@ -478,6 +514,137 @@ pcl::VoxelGridCovariance<PointT>::getDisplayCloud (pcl::PointCloud<PointXYZ>& ce
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::VoxelGridCovariance<PointT>::serialize (std::ostream &stream) const
+{
+  const auto write = [&stream] (const auto& value)
+  {
+    stream.write (reinterpret_cast<const char*> (&value), sizeof (value));
+  };
+  const auto write_matrix = [&stream] (const auto& matrix)
+  {
+    stream.write (reinterpret_cast<const char*> (matrix.data ()), sizeof (*matrix.data ()) * matrix.size ());
+  };
+
+  write_matrix (leaf_size_);
+  write_matrix (inverse_leaf_size_);
+  write_matrix (min_b_);
+  write_matrix (max_b_);
+  write_matrix (div_b_);
+  write_matrix (divb_mul_);
+  write (downsample_all_data_);
+  write (searchable_);
+  write (min_points_per_voxel_);
+  write (min_covar_eigvalue_mult_);
+
+  write (static_cast<std::uint64_t> (leaves_.size ()));
+  for (const auto& leaf : leaves_)
+  {
+    write (static_cast<std::uint64_t> (leaf.first));
+    write (leaf.second.nr_points);
+    write_matrix (leaf.second.mean_);
+    write (static_cast<std::uint64_t> (leaf.second.centroid.size ()));
+    write_matrix (leaf.second.centroid);
+    write_matrix (leaf.second.cov_);
+    write_matrix (leaf.second.icov_);
+    write_matrix (leaf.second.evecs_);
+    write_matrix (leaf.second.evals_);
+  }
+
+  const std::uint64_t nr_centroids = voxel_centroids_ ? voxel_centroids_->size () : 0;
+  write (nr_centroids);
+  if (nr_centroids > 0)
+    stream.write (reinterpret_cast<const char*> (voxel_centroids_->data ()), sizeof (PointT) * nr_centroids);
+  write (static_cast<std::uint64_t> (voxel_centroids_leaf_indices_.size ()));
+  stream.write (reinterpret_cast<const char*> (voxel_centroids_leaf_indices_.data ()),
+                sizeof (int) * voxel_centroids_leaf_indices_.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::VoxelGridCovariance<PointT>::deserialize (std::istream &stream)
+{
+  const auto read = [&stream] (auto& value)
+  {
+    stream.read (reinterpret_cast<char*> (&value), sizeof (value));
+  };
+  const auto read_matrix = [&stream] (auto& matrix)
+  {
+    stream.read (reinterpret_cast<char*> (matrix.data ()), sizeof (*matrix.data ()) * matrix.size ());
+  };
+
+  leaves_.clear ();
+  usable_leaves_.clear ();
+  usable_leaves_owner_ = nullptr;
+  voxel_centroids_leaf_indices_.clear ();
+  voxel_centroids_.reset (new PointCloud);
+
+  read_matrix (leaf_size_);
+  read_matrix (inverse_leaf_size_);
+  read_matrix (min_b_);
+  read_matrix (max_b_);
+  read_matrix (div_b_);
+  read_matrix (divb_mul_);
+  read (downsample_all_data_);
+  read (searchable_);
+  read (min_points_per_voxel_);
+  read (min_covar_eigvalue_mult_);
+
+  std::uint64_t nr_leaves = 0;
+  read (nr_leaves);
+  for (std::uint64_t i = 0; i < nr_leaves && stream; ++i)
+  {
+    std::uint64_t index = 0, centroid_size = 0;
+    read (index);
+    Leaf& leaf = leaves_[index];
+    read (leaf.nr_points);
+    read_matrix (leaf.mean_);
+    read (centroid_size);
+    if (!stream)
+      break;
+    leaf.centroid.resize (centroid_size);
+    read_matrix (leaf.centroid);
+    read_matrix (leaf.cov_);
+    read_matrix (leaf.icov_);
+    read_matrix (leaf.evecs_);
+    read_matrix (leaf.evals_);
+  }
+
+  std::uint64_t nr_centroids = 0;
+  read (nr_centroids);
+  if (stream && nr_centroids > 0)
+  {
+    voxel_centroids_->resize (nr_centroids);
+    stream.read (reinterpret_cast<char*> (voxel_centroids_->data ()), sizeof (PointT) * nr_centroids);
+  }
+  voxel_centroids_->width = voxel_centroids_->size ();
+  voxel_centroids_->height = 1;
+  voxel_centroids_->is_dense = true;
+
+  std::uint64_t nr_leaf_indices = 0;
+  read (nr_leaf_indices);
+  if (stream)
+  {
+    voxel_centroids_leaf_indices_.resize (nr_leaf_indices);
+    stream.read (reinterpret_cast<char*> (voxel_centroids_leaf_indices_.data ()), sizeof (int) * nr_leaf_indices);
+  }
+
+  if (!stream)
+  {
+    PCL_ERROR ("[pcl::%s::deserialize] Could not read the voxel structure!\n", getClassName ().c_str ());
+    leaves_.clear ();
+    voxel_centroids_->clear ();
+    voxel_centroids_leaf_indices_.clear ();
+    return (false);
+  }
+
+  hashUsableLeaves ();
+  if (searchable_ && !voxel_centroids_->empty ())
+    kdtree_.setInputCloud (voxel_centroids_);
+  return (true);
+}
+
 #define PCL_INSTANTIATE_VoxelGridCovariance(T) template class PCL_EXPORTS pcl::VoxelGridCovariance<T>;
 
 #endif    // PCL_VOXEL_GRID_COVARIANCE_IMPL_H_
@@ -38,7 +38,10 @@
 #pragma once
 
 #include <pcl/filters/voxel_grid.h>
+#include <istream>
 #include <map>
+#include <ostream>
+#include <unordered_map>
 #include <pcl/point_types.h>
 #include <pcl/kdtree/kdtree_flann.h>
 
@@ -200,6 +203,7 @@ namespace pcl
         min_points_per_voxel_ (6),
         min_covar_eigvalue_mult_ (0.01),
         leaves_ (),
+        usable_leaves_owner_ (nullptr),
         voxel_centroids_ (),
         kdtree_ ()
       {
@@ -432,6 +436,20 @@ namespace pcl
       void
       getDisplayCloud (pcl::PointCloud<PointXYZ>& cell_cloud);
 
+      /** \brief Write the voxel structure to a binary stream, so that it can be restored by \ref deserialize without filtering the input cloud again.
+       * \note The leaves and the voxel centroids are written in their in-memory representation, the format is not portable across architectures.
+       * \param[out] stream the output stream
+       */
+      void
+      serialize (std::ostream &stream) const;
+
+      /** \brief Restore a voxel structure written by \ref serialize. The kdtree is rebuilt if the structure was searchable.
+       * \param[in] stream the input stream
+       * \return true if the voxel structure could be read
+       */
+      bool
+      deserialize (std::istream &stream);
+
       /** \brief Search for the k-nearest occupied voxels for the given query point.
        * \note Only voxels containing a sufficient number of points are used.
        * \param[in] point the given query point
@@ -557,6 +575,10 @@ namespace pcl
        */
       void applyFilter (PointCloud &output) override;
 
+      /** \brief Fill \ref usable_leaves_ from \ref leaves_. */
+      void
+      hashUsableLeaves ();
+
       /** \brief Flag to determine if voxel structure is searchable. */
       bool searchable_;
 
@@ -569,6 +591,12 @@ namespace pcl
       /** \brief Voxel structure containing all leaf nodes (includes voxels with less than a sufficient number of points). */
       std::map<std::size_t, Leaf> leaves_;
 
+      /** \brief Voxels of \ref leaves_ containing a sufficient number of points, hashed by leaf index (used for direct neighbor lookups). */
+      std::unordered_map<std::size_t, LeafConstPtr> usable_leaves_;
+
+      /** \brief The \ref leaves_ that \ref usable_leaves_ points into, so that a copy of this object does not use the leaves of the original. */
+      const std::map<std::size_t, Leaf>* usable_leaves_owner_;
+
       /** \brief Point cloud containing centroids of voxels containing atleast minimum number of points. */
       PointCloudPtr voxel_centroids_;
 
@@ -38,13 +38,15 @@
 #ifndef PCL_ISS_KEYPOINT3D_IMPL_H_
 #define PCL_ISS_KEYPOINT3D_IMPL_H_
 
-#include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
+#include <pcl/common/eigen.h>
 #include <pcl/features/boundary.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 
 #include <pcl/keypoints/iss_3d.h>
 
+#include <array>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> void
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::setSalientRadius (double salient_radius)
@@ -327,65 +329,78 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
     }
   }
 
-#ifdef _OPENMP
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads_];
-
-  for (std::size_t i = 0; i < threads_; i++)
-    omp_mem[i].setZero (3);
-#else
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[1];
-
-  omp_mem[0].setZero (3);
-#endif
-
   double *prg_local_mem = new double[input_->size () * 3];
   double **prg_mem = new double * [input_->size ()];
 
   for (std::size_t i = 0; i < input_->size (); i++)
     prg_mem[i] = prg_local_mem + 3 * i;
 
+  // The scatter matrices of chunk_size_ consecutive points are gathered in structure-of-arrays layout (one
+  // array per upper triangular coefficient) and their eigenvalues are computed in one pcl::eigen33Batch call
+  std::ptrdiff_t nr_chunks = static_cast<std::ptrdiff_t> ((input_->size () + chunk_size_ - 1) / chunk_size_);
+
 #pragma omp parallel for \
   default(none) \
-  shared(borders, omp_mem, prg_mem) \
-  num_threads(threads_)
-  for (int index = 0; index < static_cast<int> (input_->size ()); index++)
+  shared(borders, nr_chunks, prg_mem) \
+  num_threads(threads_) \
+  schedule(dynamic)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; chunk++)
   {
-#ifdef _OPENMP
-    int tid = omp_get_thread_num ();
-#else
-    int tid = 0;
-#endif
-    PointInT current_point = (*input_)[index];
+    const std::size_t begin = chunk * chunk_size_;
+    const std::size_t size = std::min<std::size_t> (chunk_size_, input_->size () - begin);
+
+    std::array<std::array<double, chunk_size_>, 6> scatter;
+    std::array<std::array<double, chunk_size_>, 3> eigen_values;
+    std::array<bool, chunk_size_> valid;
 
-    if ((!borders[index]) && pcl::isFinite(current_point))
+    for (std::size_t i = 0; i < size; i++)
     {
-      //if the considered point is not a border point and the point is "finite", then compute the scatter matrix
+      const int index = static_cast<int> (begin + i);
       Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
-      getScatterMatrix (static_cast<int> (index), cov_m);
 
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov_m);
+      //if the considered point is not a border point and the point is "finite", then compute the scatter matrix
+      valid[i] = (!borders[index]) && pcl::isFinite((*input_)[index]);
+      if (valid[i])
+        getScatterMatrix (index, cov_m);
+
+      scatter[0][i] = cov_m.coeff (0, 0);
+      scatter[1][i] = cov_m.coeff (0, 1);
+      scatter[2][i] = cov_m.coeff (0, 2);
+      scatter[3][i] = cov_m.coeff (1, 1);
+      scatter[4][i] = cov_m.coeff (1, 2);
+      scatter[5][i] = cov_m.coeff (2, 2);
+    }
 
-      const double& e1c = solver.eigenvalues ()[2];
-      const double& e2c = solver.eigenvalues ()[1];
-      const double& e3c = solver.eigenvalues ()[0];
+    const double* const mat[6] = {scatter[0].data (), scatter[1].data (), scatter[2].data (),
+                                  scatter[3].data (), scatter[4].data (), scatter[5].data ()};
+    double* const evals[3] = {eigen_values[0].data (), eigen_values[1].data (), eigen_values[2].data ()};
+    pcl::eigen33Batch (mat, size, evals);
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+      const int index = static_cast<int> (begin + i);
+      prg_mem[index][0] = prg_mem[index][1] = prg_mem[index][2] = 0.0;
+      if (!valid[i])
+        continue;
+
+      const double& e1c = eigen_values[2][i];
+      const double& e2c = eigen_values[1][i];
+      const double& e3c = eigen_values[0][i];
 
       if (!std::isfinite (e1c) || !std::isfinite (e2c) || !std::isfinite (e3c))
-	continue;
+        continue;
 
       if (e3c < 0)
       {
-	PCL_WARN ("[pcl::%s::detectKeypoints] : The third eigenvalue is negative! Skipping the point with index %i.\n",
-	          name_.c_str (), index);
-	continue;
+        PCL_WARN ("[pcl::%s::detectKeypoints] : The third eigenvalue is negative! Skipping the point with index %i.\n",
+                  name_.c_str (), index);
+        continue;
       }
 
-      omp_mem[tid][0] = e2c / e1c;
-      omp_mem[tid][1] = e3c / e2c;;
-      omp_mem[tid][2] = e3c;
+      prg_mem[index][0] = e2c / e1c;
+      prg_mem[index][1] = e3c / e2c;
+      prg_mem[index][2] = e3c;
     }
-
-    for (Eigen::Index d = 0; d < omp_mem[tid].size (); d++)
-        prg_mem[index][d] = omp_mem[tid][d];
   }
 
   for (int index = 0; index < int (input_->size ()); index++)
@@ -459,7 +474,6 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   delete[] prg_mem;
   delete[] prg_local_mem;
   delete[] feat_max;
-  delete[] omp_mem;
 }
 
 #define PCL_INSTANTIATE_ISSKeypoint3D(T,U,N) template class PCL_EXPORTS pcl::ISSKeypoint3D<T,U,N>;
@@ -267,6 +267,8 @@ namespace pcl
       /** \brief The number of threads that has to be used by the scheduler. */
       unsigned int threads_;
 
+      /** \brief The number of consecutive points whose scatter matrices are solved together by pcl::eigen33Batch. */
+      static constexpr std::size_t chunk_size_ = 256;
   };
 
 }
@@ -47,6 +47,7 @@
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
 
+#include <algorithm> // for remove_if
 #include <string>
 
 namespace pcl {
@@ -98,6 +99,7 @@ public:
   , source_cloud_updated_(true)
   , force_no_recompute_(false)
   , force_no_recompute_reciprocal_(false)
+  , threads_(1)
   {}
 
   /** \brief Empty destructor */
@@ -285,6 +287,32 @@ public:
     point_representation_ = point_representation;
   }
 
+  /** \brief Set the number of threads used to search the correspondences, if OpenMP is
+   * activated. The correspondences are returned in the order of the source indices,
+   * independently of the number of threads. Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  inline void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \return the number of threads used to search the correspondences. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
   /** \brief Clone and cast to CorrespondenceEstimationBase */
   virtual typename CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::Ptr
   clone() const = 0;
@@ -329,6 +357,21 @@ protected:
   bool
   initComputeReciprocal();
 
+  /** \brief Remove the entries that were not set by the search (their match index is
+   * still UNAVAILABLE), keeping the remaining correspondences in source index order.
+   * \param[in,out] correspondences one entry per source index
+   */
+  inline void
+  removeUnmatched(pcl::Correspondences& correspondences) const
+  {
+    correspondences.erase(std::remove_if(correspondences.begin(),
+                                         correspondences.end(),
+                                         [](const pcl::Correspondence& corr) {
+                                           return (corr.index_match == UNAVAILABLE);
+                                         }),
+                          correspondences.end());
+  }
+
   /** \brief Variable that stores whether we have a new target cloud, meaning we need to
    * pre-process it again. This way, we avoid rebuilding the kd-tree for the target
    * cloud every time the determineCorrespondences () method is called. */
@@ -344,6 +387,9 @@ protected:
   /** \brief A flag which, if set, means the tree operating on the source cloud
    * will never be recomputed*/
   bool force_no_recompute_reciprocal_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 
 /** \brief @b CorrespondenceEstimation represents the base class for
@@ -392,6 +438,8 @@ public:
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::indices_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_fields_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::removeUnmatched;
   using PCLBase<PointSource>::deinitCompute;
 
   using KdTree = pcl::search::KdTree<PointTarget>;
@@ -74,6 +74,8 @@ public:
   using PCLBase<PointSource>::input_;
   using PCLBase<PointSource>::indices_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::getClassName;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::removeUnmatched;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::
       point_representation_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::target_indices_;
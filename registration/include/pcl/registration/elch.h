@@ -92,7 +92,8 @@ public:
   , loop_end_(0)
   , reg_(new pcl::IterativeClosestPoint<PointT, PointT>)
   , compute_loop_(true)
-  , vd_(){};
+  , vd_()
+  , threads_(1){};
 
   /** \brief Empty destructor */
   ~ELCH() {}
@@ -194,6 +195,32 @@ public:
     compute_loop_ = false;
   }
 
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * \details The point clouds of the loop are transformed in parallel.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  inline void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
   /** \brief Computes new poses for all point clouds by closing the loop
    * between start and end point cloud. This will transform all given point
    * clouds for now!
@@ -245,6 +272,9 @@ private:
   /** \brief previously added node in the loop_graph_. */
   typename boost::graph_traits<LoopGraph>::vertex_descriptor vd_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -111,6 +111,7 @@ public:
   , max_inner_iterations_(20)
   , translation_gradient_tolerance_(1e-2)
   , rotation_gradient_tolerance_(1e-2)
+  , threads_(1)
   {
     min_number_correspondences_ = 4;
     reg_name_ = "GeneralizedIterativeClosestPoint";
@@ -161,6 +162,18 @@ public:
     input_covariances_ = covariances;
   }
 
+  /** \brief Get the covariances of the input source, as set by the user or as computed
+   * by the last call to align(). They can be handed to setSourceCovariances() of
+   * another registration object working on the same source cloud, so that they are
+   * not computed again.
+   * \return the input source covariances (empty if not yet computed)
+   */
+  inline MatricesVectorPtr
+  getSourceCovariances() const
+  {
+    return input_covariances_;
+  }
+
   /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
    * to align the input source to) \param[in] target the input point cloud target
    */
@@ -183,6 +196,18 @@ public:
     target_covariances_ = covariances;
   }
 
+  /** \brief Get the covariances of the input target, as set by the user or as computed
+   * by the last call to align(). They can be handed to setTargetCovariances() of
+   * another registration object working on the same target cloud, so that they are
+   * not computed again.
+   * \return the input target covariances (empty if not yet computed)
+   */
+  inline MatricesVectorPtr
+  getTargetCovariances() const
+  {
+    return target_covariances_;
+  }
+
   /** \brief Estimate a rigid rotation transformation between a source and a target
    * point cloud using an iterative non-linear Levenberg-Marquardt approach. \param[in]
    * cloud_src the source point cloud dataset \param[in] indices_src the vector of
@@ -216,6 +241,21 @@ public:
   void
   computeRDerivative(const Vector6d& x, const Eigen::Matrix3d& R, Vector6d& g) const;
 
+  /** \brief compute points covariances matrices according to the K nearest
+   * neighbors. K is set via setCorrespondenceRandomness() method. The result can be
+   * given to setSourceCovariances() or setTargetCovariances(), e.g. to compute the
+   * covariances of a static target only once.
+   * \param cloud pointer to point cloud
+   * \param tree KD tree performer for nearest neighbors search, already built on
+   * \a cloud
+   * \param[out] cloud_covariances covariances matrices for each point in the cloud
+   */
+  template <typename PointT>
+  void
+  computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud,
+                     const typename pcl::search::KdTree<PointT>::Ptr tree,
+                     MatricesVector& cloud_covariances);
+
   /** \brief Set the rotation epsilon (maximum allowable difference between two
    * consecutive rotations) in order for an optimization to be considered as having
    * converged to the final solution.
@@ -309,6 +349,31 @@ public:
     return rotation_gradient_tolerance_;
   }
 
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
 protected:
   /** \brief The number of neighbors used for covariances computation.
    * default: 20
@@ -360,17 +425,12 @@ protected:
   /** \brief minimal rotation gradient for early optimization stop */
   double rotation_gradient_tolerance_;
 
-  /** \brief compute points covariances matrices according to the K nearest
-   * neighbors. K is set via setCorrespondenceRandomness() method.
-   * \param cloud pointer to point cloud
-   * \param tree KD tree performer for nearest neighbors search
-   * \param[out] cloud_covariances covariances matrices for each point in the cloud
-   */
-  template <typename PointT>
-  void
-  computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud,
-                     const typename pcl::search::KdTree<PointT>::Ptr tree,
-                     MatricesVector& cloud_covariances);
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief The number of covariance matrices decomposed at once in
+   * computeCovariances(). */
+  static constexpr std::size_t covariance_chunk_size_ = 256;
 
   /** \return trace of mat1^t . mat2
    * \param mat1 matrix of dimension nxm
@@ -430,6 +490,11 @@ protected:
     fdf(const Vector6d& x, double& f, Vector6d& df) override;
     BFGSSpace::Status
     checkGradient(const Vector6d& g) override;
+    /** \brief Compute the cost \a f and, if \a g is not null, its gradient at \a x.
+     * The sum is split in fixed blocks so that it does not depend on the number of
+     * threads. */
+    void
+    evaluate(const Vector6d& x, double& f, Vector6d* g);
 
     const GeneralizedIterativeClosestPoint* gicp_;
   };
@@ -351,6 +351,11 @@ protected:
   /** \brief Search for corresponding point pairs given the distance between two base
    * points.
    *
+   * Instead of testing all pairs of source points, the pairs are extracted from the
+   * pair index (see buildPairIndex), which only visits pairs of boxes whose distance
+   * range intersects the spherical shell around the reference distance. The resulting
+   * pairs are the same and in the same order as the ones of an exhaustive search.
+   *
    * \param[in] idx1 first index of current base segment (in source cloud)
    * \param[in] idx2 second index of current base segment (in source cloud)
    * \param[out] pairs resulting point pairs with point-to-point distance close to
@@ -361,6 +366,33 @@ protected:
   virtual int
   bruteForceCorrespondences(int idx1, int idx2, pcl::Correspondences& pairs);
 
+  /** \brief Build the pair index over the (sampled) source points, a balanced
+   * bounding box hierarchy used to extract all point pairs of a given length in time
+   * roughly proportional to the number of resulting pairs, similar to the pair
+   * extraction of "Super 4PCS: Fast Global Pointcloud Registration via Smart Indexing",
+   * Nicolas Mellado, Dror Aiger, Niloy J. Mitra. Computer Graphics Forum, vol. 33(5),
+   * 2014.
+   */
+  void
+  buildPairIndex();
+
+  /** \brief Recursively collect the point pairs of two nodes of the pair index whose
+   * squared point-to-point distance lies within [min_dist_sqr, max_dist_sqr].
+   *
+   * \param[in] node_a first node of the pair index
+   * \param[in] node_b second node of the pair index (may be equal to node_a)
+   * \param[in] min_dist_sqr minimum squared point-to-point distance
+   * \param[in] max_dist_sqr maximum squared point-to-point distance
+   * \param[out] pairs positions (in source_indices_) of the found pairs, the smaller
+   * position first
+   */
+  void
+  searchPairIndex(int node_a,
+                  int node_b,
+                  float min_dist_sqr,
+                  float max_dist_sqr,
+                  std::vector<std::pair<int, int>>& pairs) const;
+
   /** \brief Determine base matches by combining the point pair candidate and search for
    * coinciding intersection points using the diagonal segment ratios of base B. The
    * coincidation threshold is calculated during initialization (coincidation_limit_).
@@ -526,6 +558,27 @@ protected:
   /** \brief A pointer to the vector of target point indices to use after sampling. */
   pcl::IndicesPtr target_indices_;
 
+  /** \brief Node of the pair index, holding the bounding box of the points
+   * pair_index_[begin, end). The second child directly follows the first one; leaves
+   * have no child (child = -1).
+   */
+  struct PairIndexNode {
+    Eigen::Vector3f min_pt;
+    Eigen::Vector3f max_pt;
+    int begin;
+    int end;
+    int child;
+  };
+
+  /** \brief Nodes of the pair index, the root node comes first. */
+  std::vector<PairIndexNode> pair_index_nodes_;
+
+  /** \brief Positions in source_indices_, ordered according to the pair index. */
+  std::vector<int> pair_index_;
+
+  /** \brief Coordinates of the source points, ordered according to the pair index. */
+  std::vector<Eigen::Vector3f> pair_index_points_;
+
   /** \brief Maximal difference between corresponding point pairs in source and target.
    * \note Internally calculated using an estimation of the point density.
    */
@@ -44,15 +44,24 @@
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <pcl/memory.h>
 
+#include <random>
+
 namespace pcl {
 /** \brief @b SampleConsensusInitialAlignment is an implementation of the initial
  * alignment algorithm described in section IV of "Fast Point Feature Histograms (FPFH)
- * for 3D Registration," Rusu et al. \author Michael Dixon, Radu B. Rusu \ingroup
- * registration
+ * for 3D Registration," Rusu et al.
+ *
+ * The iterations can be distributed over several threads with
+ * \ref setNumberOfThreads(). They are drawn in fixed blocks, each with its own random
+ * number generator seeded from a single call to std::rand(), so for a given seed of
+ * std::rand() the result does not depend on the number of threads.
+ * \author Michael Dixon, Radu B. Rusu \ingroup registration
  */
 template <typename PointSource, typename PointTarget, typename FeatureT>
 class SampleConsensusInitialAlignment : public Registration<PointSource, PointTarget> {
 public:
+  using Matrix4 = typename Registration<PointSource, PointTarget>::Matrix4;
+
   using Registration<PointSource, PointTarget>::reg_name_;
   using Registration<PointSource, PointTarget>::input_;
   using Registration<PointSource, PointTarget>::indices_;
@@ -147,6 +156,7 @@ public:
   , k_correspondences_(10)
   , feature_tree_(new pcl::KdTreeFLANN<FeatureT>)
   , error_functor_()
+  , threads_(1)
   {
     reg_name_ = "SampleConsensusInitialAlignment";
     max_iterations_ = 1000;
@@ -257,39 +267,124 @@ public:
     return (error_functor_);
   }
 
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
 protected:
   /** \brief Choose a random index between 0 and n-1
    * \param n the number of possible indices to choose from
+   * \param rng the random number generator to draw from
    */
   inline int
+  getRandomIndex(int n, std::mt19937& rng) const
+  {
+    return (std::uniform_int_distribution<int>(0, n - 1)(rng));
+  };
+
+  /** \brief Choose a random index between 0 and n-1, drawn with a generator seeded
+   * from std::rand().
+   * \param n the number of possible indices to choose from
+   */
+  PCL_DEPRECATED(1, 14, "Use `getRandomIndex(int, std::mt19937&)` instead")
+  inline int
   getRandomIndex(int n)
   {
-    return (static_cast<int>(n * (rand() / (RAND_MAX + 1.0))));
+    std::mt19937 rng(std::rand());
+    return (getRandomIndex(n, rng));
   };
 
   /** \brief Select \a nr_samples sample points from cloud while making sure that their
    * pairwise distances are greater than a user-defined minimum distance, \a
    * min_sample_distance. \param cloud the input point cloud \param nr_samples the
    * number of samples to select \param min_sample_distance the minimum distance between
+   * any two samples, halved if no valid sample can be found \param sample_indices the
+   * resulting sample indices \param rng the random number generator to draw from
+   */
+  void
+  selectSamples(const PointCloudSource& cloud,
+                int nr_samples,
+                float& min_sample_distance,
+                std::vector<int>& sample_indices,
+                std::mt19937& rng) const;
+
+  /** \brief Select \a nr_samples sample points from cloud as in the overload taking a
+   * random number generator, drawing with a generator seeded from std::rand(). If no
+   * valid sample can be found, the relaxed minimum distance is stored in
+   * min_sample_distance_. \param cloud the input point cloud \param nr_samples the
+   * number of samples to select \param min_sample_distance the minimum distance between
    * any two samples \param sample_indices the resulting sample indices
    */
+  PCL_DEPRECATED(1,
+                 14,
+                 "Use `selectSamples(const PointCloudSource&, int, float&, "
+                 "std::vector<int>&, std::mt19937&)` instead")
   void
   selectSamples(const PointCloudSource& cloud,
                 int nr_samples,
                 float min_sample_distance,
-                std::vector<int>& sample_indices);
+                std::vector<int>& sample_indices)
+  {
+    std::mt19937 rng(std::rand());
+    const float initial_min_sample_distance = min_sample_distance;
+    selectSamples(cloud, nr_samples, min_sample_distance, sample_indices, rng);
+    if (min_sample_distance < initial_min_sample_distance)
+      min_sample_distance_ = min_sample_distance;
+  }
 
   /** \brief For each of the sample points, find a list of points in the target cloud
    * whose features are similar to the sample points' features. From these, select one
    * randomly which will be considered that sample point's correspondence. \param
    * input_features a cloud of feature descriptors \param sample_indices the indices of
    * each sample point \param corresponding_indices the resulting indices of each
-   * sample's corresponding point in the target cloud
+   * sample's corresponding point in the target cloud \param rng the random number
+   * generator to draw from
    */
   void
   findSimilarFeatures(const FeatureCloud& input_features,
                       const std::vector<int>& sample_indices,
-                      std::vector<int>& corresponding_indices);
+                      std::vector<int>& corresponding_indices,
+                      std::mt19937& rng) const;
+
+  /** \brief For each of the sample points, select the correspondence as in the
+   * overload taking a random number generator, drawing with a generator seeded from
+   * std::rand(). \param input_features a cloud of feature descriptors \param
+   * sample_indices the indices of each sample point \param corresponding_indices the
+   * resulting indices of each sample's corresponding point in the target cloud
+   */
+  PCL_DEPRECATED(1,
+                 14,
+                 "Use `findSimilarFeatures(const FeatureCloud&, const "
+                 "std::vector<int>&, std::vector<int>&, std::mt19937&)` instead")
+  void
+  findSimilarFeatures(const FeatureCloud& input_features,
+                      const std::vector<int>& sample_indices,
+                      std::vector<int>& corresponding_indices)
+  {
+    std::mt19937 rng(std::rand());
+    findSimilarFeatures(input_features, sample_indices, corresponding_indices, rng);
+  }
 
   /** \brief An error metric for that computes the quality of the alignment between the
    * given cloud and the target. \param cloud the input cloud \param threshold distances
@@ -298,6 +393,16 @@ protected:
   float
   computeErrorMetric(const PointCloudSource& cloud, float threshold);
 
+  /** \brief Compute the error metric of the input cloud transformed with the given
+   * transformation, as in computeErrorMetric(const PointCloudSource&, float). The
+   * evaluation stops early, with a partial error larger than \a max_error, as soon as
+   * the error exceeds \a max_error.
+   * \param transformation the transformation to evaluate
+   * \param max_error the error above which the evaluation stops
+   */
+  float
+  computeErrorMetric(const Matrix4& transformation, float max_error) const;
+
   /** \brief Rigid transformation computation method.
    * \param output the transformed input point cloud dataset using the rigid
    * transformation found \param guess The computed transforamtion
@@ -327,6 +432,12 @@ protected:
 
   ErrorFunctorPtr error_functor_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief The number of iterations drawn with the same random number generator. */
+  static constexpr int iterations_block_size_ = 16;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
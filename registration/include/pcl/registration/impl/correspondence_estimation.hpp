@@ -122,49 +122,52 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineCorresponde
 
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize(indices_->size());
+  // Every source index owns one entry, the unmatched ones are removed afterwards so
+  // that the result is in source index order for any number of threads
+  correspondences.assign(indices_->size(), pcl::Correspondence());
 
   std::vector<int> index(1);
   std::vector<float> distance(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
 
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
   if (isSamePointType<PointSource, PointTarget>()) {
     // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_dist_sqr)           \
+    firstprivate(index, distance) num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx = (*indices_)[i];
       tree_->nearestKSearch((*input_)[idx], 1, index, distance);
       if (distance[0] > max_dist_sqr)
         continue;
 
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
     }
   }
   else {
-    PointTarget pt;
-
     // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_dist_sqr)           \
+    firstprivate(index, distance) num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx = (*indices_)[i];
       // Copy the source data to a target PointTarget format so we can search in the
       // tree
+      PointTarget pt;
       copyPoint((*input_)[idx], pt);
 
       tree_->nearestKSearch(pt, 1, index, distance);
       if (distance[0] > max_dist_sqr)
         continue;
 
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
     }
   }
-  correspondences.resize(nr_valid_correspondences);
+  removeUnmatched(correspondences);
   deinitCompute();
 }
 
@@ -183,56 +186,59 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::
     return;
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize(indices_->size());
+  correspondences.assign(indices_->size(), pcl::Correspondence());
   std::vector<int> index(1);
   std::vector<float> distance(1);
   std::vector<int> index_reciprocal(1);
   std::vector<float> distance_reciprocal(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
 
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
   if (isSamePointType<PointSource, PointTarget>()) {
     // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_dist_sqr)           \
+    firstprivate(index, distance, index_reciprocal, distance_reciprocal)               \
+    num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx = (*indices_)[i];
       tree_->nearestKSearch((*input_)[idx], 1, index, distance);
       if (distance[0] > max_dist_sqr)
         continue;
 
-      target_idx = index[0];
+      const int target_idx = index[0];
 
       tree_reciprocal_->nearestKSearch(
           (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
       if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
         continue;
 
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
     }
   }
   else {
-    PointTarget pt_src;
-    PointSource pt_tgt;
-
     // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_dist_sqr)           \
+    firstprivate(index, distance, index_reciprocal, distance_reciprocal)               \
+    num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx = (*indices_)[i];
       // Copy the source data to a target PointTarget format so we can search in the
       // tree
+      PointTarget pt_src;
       copyPoint((*input_)[idx], pt_src);
 
       tree_->nearestKSearch(pt_src, 1, index, distance);
       if (distance[0] > max_dist_sqr)
         continue;
 
-      target_idx = index[0];
+      const int target_idx = index[0];
 
       // Copy the target data to a target PointSource format so we can search in the
       // tree_reciprocal
+      PointSource pt_tgt;
       copyPoint((*target_)[target_idx], pt_tgt);
 
       tree_reciprocal_->nearestKSearch(
@@ -240,13 +246,12 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::
       if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
         continue;
 
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx;
+      correspondences[i].index_match = index[0];
+      correspondences[i].distance = distance[0];
     }
   }
-  correspondences.resize(nr_valid_correspondences);
+  removeUnmatched(correspondences);
   deinitCompute();
 }
 
@@ -71,23 +71,25 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initCompute())
     return;
 
-  correspondences.resize(indices_->size());
+  // Every source index owns one entry, the unmatched ones are removed afterwards so
+  // that the result is in source index order for any number of threads
+  correspondences.assign(indices_->size(), pcl::Correspondence());
 
   std::vector<int> nn_indices(k_);
   std::vector<float> nn_dists(k_);
 
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
   if (isSamePointType<PointSource, PointTarget>()) {
-    PointTarget pt;
     // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_distance)           \
+    firstprivate(nn_indices, nn_dists) num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx_i = (*indices_)[i];
+      int min_index = 0;
+      PointTarget pt;
+
       tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
 
       // Among the K nearest neighbours find the one with minimum perpendicular distance
@@ -117,17 +119,20 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
       if (min_dist > max_distance)
         continue;
 
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx_i;
+      correspondences[i].index_match = nn_indices[min_index];
+      correspondences[i].distance = nn_dists[min_index]; // min_dist;
     }
   }
   else {
-    PointTarget pt;
-
     // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_distance)           \
+    firstprivate(nn_indices, nn_dists) num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx_i = (*indices_)[i];
+      int min_index = 0;
+      PointTarget pt;
+
       tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
 
       // Among the K nearest neighbours find the one with minimum perpendicular distance
@@ -162,13 +167,12 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
       if (min_dist > max_distance)
         continue;
 
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx_i;
+      correspondences[i].index_match = nn_indices[min_index];
+      correspondences[i].distance = nn_dists[min_index]; // min_dist;
     }
   }
-  correspondences.resize(nr_valid_correspondences);
+  removeUnmatched(correspondences);
   deinitCompute();
 }
 
@@ -186,26 +190,28 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initComputeReciprocal())
     return;
 
-  correspondences.resize(indices_->size());
+  // Every source index owns one entry, the unmatched ones are removed afterwards so
+  // that the result is in source index order for any number of threads
+  correspondences.assign(indices_->size(), pcl::Correspondence());
 
   std::vector<int> nn_indices(k_);
   std::vector<float> nn_dists(k_);
   std::vector<int> index_reciprocal(1);
   std::vector<float> distance_reciprocal(1);
 
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
   if (isSamePointType<PointSource, PointTarget>()) {
-    PointTarget pt;
     // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_distance)           \
+    firstprivate(nn_indices, nn_dists, index_reciprocal, distance_reciprocal)          \
+    num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx_i = (*indices_)[i];
+      int min_index = 0;
+      PointTarget pt;
+
       tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
 
       // Among the K nearest neighbours find the one with minimum perpendicular distance
@@ -236,7 +242,7 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
         continue;
 
       // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
+      const int target_idx = nn_indices[min_index];
       tree_reciprocal_->nearestKSearch(
           (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
 
@@ -244,17 +250,21 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
         continue;
 
       // Correspondence IS reciprocal, save it and continue
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx_i;
+      correspondences[i].index_match = nn_indices[min_index];
+      correspondences[i].distance = nn_dists[min_index]; // min_dist;
     }
   }
   else {
-    PointTarget pt;
-
     // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
+#pragma omp parallel for default(none) shared(correspondences, max_distance)           \
+    firstprivate(nn_indices, nn_dists, index_reciprocal, distance_reciprocal)          \
+    num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+      const auto idx_i = (*indices_)[i];
+      int min_index = 0;
+      PointTarget pt;
+
       tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
 
       // Among the K nearest neighbours find the one with minimum perpendicular distance
@@ -290,7 +300,7 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
         continue;
 
       // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
+      const int target_idx = nn_indices[min_index];
       tree_reciprocal_->nearestKSearch(
           (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
 
@@ -298,13 +308,12 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
         continue;
 
       // Correspondence IS reciprocal, save it and continue
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      correspondences[i].index_query = idx_i;
+      correspondences[i].index_match = nn_indices[min_index];
+      correspondences[i].distance = nn_dists[min_index]; // min_dist;
     }
   }
-  correspondences.resize(nr_valid_correspondences);
+  removeUnmatched(correspondences);
   deinitCompute();
 }
 
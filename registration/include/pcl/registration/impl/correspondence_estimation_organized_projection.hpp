@@ -80,10 +80,14 @@ CorrespondenceEstimationOrganizedProjection<PointSource, PointTarget, Scalar>::
   if (!initCompute())
     return;
 
-  correspondences.resize(indices_->size());
-  std::size_t c_index = 0;
-
-  for (const auto& src_idx : (*indices_)) {
+  // Every source index owns one entry, the unmatched ones are removed afterwards so
+  // that the result is in source index order for any number of threads
+  correspondences.assign(indices_->size(), pcl::Correspondence());
+
+#pragma omp parallel for default(none) shared(correspondences, max_distance)           \
+    num_threads(threads_) schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(indices_->size()); i++) {
+    const auto src_idx = (*indices_)[i];
     if (isFinite((*input_)[src_idx])) {
       Eigen::Vector4f p_src(src_to_tgt_transformation_ *
                             (*input_)[src_idx].getVector4fMap());
@@ -108,13 +112,13 @@ CorrespondenceEstimationOrganizedProjection<PointSource, PointTarget, Scalar>::
 
         double dist = (p_src3 - pt_tgt.getVector3fMap()).norm();
         if (dist < max_distance)
-          correspondences[c_index++] = pcl::Correspondence(
+          correspondences[i] = pcl::Correspondence(
               src_idx, v * target_->width + u, static_cast<float>(dist));
       }
     }
   }
 
-  correspondences.resize(c_index);
+  removeUnmatched(correspondences);
 }
 
 template <typename PointSource, typename PointTarget, typename Scalar>
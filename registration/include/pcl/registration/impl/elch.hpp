@@ -48,6 +48,7 @@
 #include <algorithm>
 #include <list>
 #include <tuple>
+#include <vector>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -218,23 +219,22 @@ pcl::registration::ELCH<PointT>::compute()
     return;
   }
 
-  LOAGraph grb[4];
+  // All edges carry the same unit weight for the x, y, z and rotation components, so
+  // the loop optimizer is run once and its weights are shared by all four components.
+  // Separate graphs are only needed once per component variances are used.
+  LOAGraph grb;
 
   typename boost::graph_traits<LoopGraph>::edge_iterator edge_it, edge_it_end;
   for (std::tie(edge_it, edge_it_end) = edges(*loop_graph_); edge_it != edge_it_end;
        edge_it++) {
-    for (auto& j : grb)
-      add_edge(source(*edge_it, *loop_graph_),
-               target(*edge_it, *loop_graph_),
-               1,
-               j); // TODO add variance
+    add_edge(source(*edge_it, *loop_graph_),
+             target(*edge_it, *loop_graph_),
+             1,
+             grb); // TODO add variance
   }
 
-  double* weights[4];
-  for (int i = 0; i < 4; i++) {
-    weights[i] = new double[num_vertices(*loop_graph_)];
-    loopOptimizerAlgorithm(grb[i], weights[i]);
-  }
+  std::vector<double> weights(num_vertices(*loop_graph_));
+  loopOptimizerAlgorithm(grb, weights.data());
 
   // TODO use pose
   // Eigen::Vector4f cend;
@@ -243,20 +243,19 @@ pcl::registration::ELCH<PointT>::compute()
   // Eigen::Affine3f aend (tend);
   // Eigen::Affine3f aendI = aend.inverse ();
 
-  // TODO iterate ovr loop_graph_
-  // typename boost::graph_traits<LoopGraph>::vertex_iterator vertex_it, vertex_it_end;
-  // for (std::tie (vertex_it, vertex_it_end) = vertices (*loop_graph_); vertex_it !=
-  // vertex_it_end; vertex_it++)
-  for (std::size_t i = 0; i < num_vertices(*loop_graph_); i++) {
-    Eigen::Vector3f t2;
-    t2[0] = loop_transform_(0, 3) * static_cast<float>(weights[0][i]);
-    t2[1] = loop_transform_(1, 3) * static_cast<float>(weights[1][i]);
-    t2[2] = loop_transform_(2, 3) * static_cast<float>(weights[2][i]);
-
-    Eigen::Affine3f bl(loop_transform_);
-    Eigen::Quaternionf q(bl.rotation());
+  Eigen::Affine3f bl(loop_transform_);
+  Eigen::Quaternionf q(bl.rotation());
+
+  // Every vertex owns its point cloud, so the clouds are transformed in parallel
+  int nr_vertices = static_cast<int>(num_vertices(*loop_graph_));
+#pragma omp parallel for default(none) shared(weights, q, nr_vertices)                 \
+    num_threads(threads_) schedule(dynamic)
+  for (int i = 0; i < nr_vertices; i++) {
+    Eigen::Vector3f t2 =
+        loop_transform_.block<3, 1>(0, 3) * static_cast<float>(weights[i]);
+
     Eigen::Quaternionf q2;
-    q2 = Eigen::Quaternionf::Identity().slerp(static_cast<float>(weights[3][i]), q);
+    q2 = Eigen::Quaternionf::Identity().slerp(static_cast<float>(weights[i]), q);
 
     // TODO use rotation from branch start
     Eigen::Translation3f t3(t2);
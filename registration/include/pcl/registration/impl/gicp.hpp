@@ -41,9 +41,12 @@
 #ifndef PCL_REGISTRATION_IMPL_GICP_HPP_
 #define PCL_REGISTRATION_IMPL_GICP_HPP_
 
+#include <pcl/common/eigen.h>
 #include <pcl/registration/boost.h>
 #include <pcl/registration/exceptions.h>
 
+#include <array>
+
 namespace pcl {
 
 template <typename PointSource, typename PointTarget>
@@ -62,7 +65,6 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(
     return;
   }
 
-  Eigen::Vector3d mean;
   std::vector<int> nn_indecies;
   nn_indecies.reserve(k_correspondences_);
   std::vector<float> nn_dist_sq;
@@ -72,14 +74,14 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(
   if (cloud_covariances.size() < cloud->size())
     cloud_covariances.resize(cloud->size());
 
-  MatricesVector::iterator matrices_iterator = cloud_covariances.begin();
-  for (auto points_iterator = cloud->begin(); points_iterator != cloud->end();
-       ++points_iterator, ++matrices_iterator) {
-    const PointT& query_point = *points_iterator;
-    Eigen::Matrix3d& cov = *matrices_iterator;
+#pragma omp parallel for default(none) shared(cloud, kdtree, cloud_covariances)        \
+    firstprivate(nn_indecies, nn_dist_sq) num_threads(threads_) schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(cloud->size()); ++i) {
+    const PointT& query_point = (*cloud)[i];
+    Eigen::Matrix3d& cov = cloud_covariances[i];
     // Zero out the cov and mean
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
     cov.setZero();
-    mean.setZero();
 
     // Search for the K nearest neighbours
     kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
@@ -110,19 +112,55 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(
         cov(k, l) -= mean[k] * mean[l];
         cov(l, k) = cov(k, l);
       }
+  }
 
-    // Compute the SVD (covariance matrix is symmetric so U = V')
-    Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
-    cov.setZero();
-    Eigen::Matrix3d U = svd.matrixU();
-    // Reconstitute the covariance matrix with modified singular values using the column
-    // // vectors in V.
-    for (int k = 0; k < 3; k++) {
-      Eigen::Vector3d col = U.col(k);
-      double v = 1.; // biggest 2 singular values replaced by 1
-      if (k == 2)    // smallest singular value replaced by gicp_epsilon
-        v = gicp_epsilon_;
-      cov += v * col * col.transpose();
+  // Reconstitute the covariance matrices with the two biggest eigenvalues replaced by
+  // 1 and the smallest one replaced by gicp_epsilon_. As the eigenvectors are
+  // orthonormal, this is I - (1 - gicp_epsilon_) * v * v' with v the eigenvector of
+  // the smallest eigenvalue, which pcl::eigen33Batch computes for a chunk of matrices
+  // at once.
+  std::ptrdiff_t number_of_chunks =
+      (cloud->size() + covariance_chunk_size_ - 1) / covariance_chunk_size_;
+
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, cloud_covariances, number_of_chunks) num_threads(threads_)           \
+    schedule(dynamic, 1)
+  for (std::ptrdiff_t chunk = 0; chunk < number_of_chunks; ++chunk) {
+    std::array<std::array<double, covariance_chunk_size_>, 6> coefficients;
+    std::array<std::array<double, covariance_chunk_size_>, 3> eigen_values;
+    std::array<std::array<double, covariance_chunk_size_>, 3> eigen_vectors;
+    const double* const mat[6] = {coefficients[0].data(),
+                                  coefficients[1].data(),
+                                  coefficients[2].data(),
+                                  coefficients[3].data(),
+                                  coefficients[4].data(),
+                                  coefficients[5].data()};
+    double* const evals[3] = {
+        eigen_values[0].data(), eigen_values[1].data(), eigen_values[2].data()};
+    double* const evecs[3] = {
+        eigen_vectors[0].data(), eigen_vectors[1].data(), eigen_vectors[2].data()};
+
+    const std::size_t begin = chunk * covariance_chunk_size_;
+    const std::size_t size = (cloud->size() - begin < covariance_chunk_size_)
+                                 ? cloud->size() - begin
+                                 : covariance_chunk_size_;
+    for (std::size_t i = 0; i < size; ++i) {
+      const Eigen::Matrix3d& cov = cloud_covariances[begin + i];
+      coefficients[0][i] = cov(0, 0);
+      coefficients[1][i] = cov(0, 1);
+      coefficients[2][i] = cov(0, 2);
+      coefficients[3][i] = cov(1, 1);
+      coefficients[4][i] = cov(1, 2);
+      coefficients[5][i] = cov(2, 2);
+    }
+
+    pcl::eigen33Batch(mat, size, evals, evecs, 0);
+
+    for (std::size_t i = 0; i < size; ++i) {
+      const Eigen::Vector3d col(
+          eigen_vectors[0][i], eigen_vectors[1][i], eigen_vectors[2][i]);
+      cloud_covariances[begin + i] =
+          Eigen::Matrix3d::Identity() - (1. - gicp_epsilon_) * col * col.transpose();
     }
   }
 }
@@ -261,27 +299,9 @@ inline double
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
     OptimizationFunctorWithIndices::operator()(const Vector6d& x)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
   double f = 0;
-  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // Estimate the distance (cost function)
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // increment= res'*temp/num_matches = temp'*M*temp/num_matches (we postpone
-    // 1/num_matches after the loop closes)
-    f += double(res.transpose() * temp);
-  }
-  return f / m;
+  evaluate(x, f, nullptr);
+  return f;
 }
 
 template <typename PointSource, typename PointTarget>
@@ -289,78 +309,88 @@ inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
     OptimizationFunctorWithIndices::df(const Vector6d& x, Vector6d& g)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  // Zero out g
-  g.setZero();
-  // Eigen::Vector3d g_t = g.head<3> ();
-  Eigen::Matrix3d R = Eigen::Matrix3d::Zero();
-  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += temp;
-    // Increment rotation gradient
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
-    R += p_src3 * temp.transpose();
-  }
-  g.head<3>() *= 2.0 / m;
-  R *= 2.0 / m;
-  gicp_->computeRDerivative(x, R, g);
+  double f = 0;
+  evaluate(x, f, &g);
 }
 
 template <typename PointSource, typename PointTarget>
 inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
     OptimizationFunctorWithIndices::fdf(const Vector6d& x, double& f, Vector6d& g)
+{
+  evaluate(x, f, &g);
+}
+
+template <typename PointSource, typename PointTarget>
+void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
+    OptimizationFunctorWithIndices::evaluate(const Vector6d& x, double& f, Vector6d* g)
 {
   Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
   gicp_->applyState(transformation_matrix, x);
+  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
+
+  // The correspondences are summed in fixed blocks which are then added up in order,
+  // so that the result does not depend on the number of threads
+  int block_size = 512;
+  int number_of_blocks = (m + block_size - 1) / block_size;
+  std::vector<double> block_f(number_of_blocks, 0.);
+  std::vector<Eigen::Vector3d> block_g(number_of_blocks, Eigen::Vector3d::Zero());
+  std::vector<Eigen::Matrix3d> block_R(number_of_blocks, Eigen::Matrix3d::Zero());
+  bool compute_gradient = (g != nullptr);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(transformation_matrix, m, block_size, number_of_blocks, block_f, block_g,   \
+           block_R, compute_gradient) num_threads(gicp_->threads_) schedule(dynamic, 1)
+  for (int block = 0; block < number_of_blocks; ++block) {
+    const int end = (block + 1) * block_size < m ? (block + 1) * block_size : m;
+    for (int i = block * block_size; i < end; ++i) {
+      // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in
+      // registration.hpp
+      Vector4fMapConst p_src =
+          (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
+      // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in
+      // registration.hpp
+      Vector4fMapConst p_tgt =
+          (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
+      Eigen::Vector4f pp(transformation_matrix * p_src);
+      // The last coordinate is still guaranteed to be set to 1.0
+      Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
+      // temp = M*res
+      Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
+      // Increment total error
+      // increment= res'*temp/num_matches = temp'*M*temp/num_matches (we postpone
+      // 1/num_matches after the loop closes)
+      block_f[block] += double(res.transpose() * temp);
+      if (!compute_gradient)
+        continue;
+      // Increment translation gradient
+      // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop
+      // closes)
+      block_g[block] += temp;
+      pp = gicp_->base_transformation_ * p_src;
+      Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
+      // Increment rotation gradient
+      block_R[block] += p_src3 * temp.transpose();
+    }
+  }
+
   f = 0;
-  g.setZero();
+  Eigen::Vector3d g_t = Eigen::Vector3d::Zero();
   Eigen::Matrix3d R = Eigen::Matrix3d::Zero();
-  const int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment total error
-    f += double(res.transpose() * temp);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += temp;
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
-    // Increment rotation gradient
-    R += p_src3 * temp.transpose();
+  for (int block = 0; block < number_of_blocks; ++block) {
+    f += block_f[block];
+    g_t += block_g[block];
+    R += block_R[block];
   }
   f /= double(m);
-  g.head<3>() *= double(2.0 / m);
+  if (!compute_gradient)
+    return;
+
+  g->setZero();
+  g->head<3>() = g_t * (2.0 / m);
   R *= 2.0 / m;
-  gicp_->computeRDerivative(x, R, g);
+  gicp_->computeRDerivative(x, R, *g);
 }
 
 template <typename PointSource, typename PointTarget>
@@ -395,7 +425,7 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
   // Difference between consecutive transforms
   double delta = 0;
   // Get the size of the target
-  const std::size_t N = indices_->size();
+  std::size_t N = indices_->size();
   // Set the mahalanobis matrices to identity
   mahalanobis_.resize(N, Eigen::Matrix3d::Identity());
   // Compute target cloud covariance matrices
@@ -415,6 +445,9 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
   std::vector<int> nn_indices(1);
   std::vector<float> nn_dists(1);
+  // For every source point, the index of its target correspondence, -1 if the
+  // neighbour is too far and -2 if no neighbour was found
+  std::vector<int> matches(N);
 
   pcl::transformPointCloud(output, output, guess);
 
@@ -432,16 +465,16 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
 
     Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
 
-    for (std::size_t i = 0; i < N; i++) {
+#pragma omp parallel for default(none)                                                 \
+    shared(N, output, R, dist_threshold, matches) firstprivate(nn_indices, nn_dists)   \
+    num_threads(threads_) schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(N); i++) {
       PointSource query = output[i];
       query.getVector4fMap() = transformation_ * query.getVector4fMap();
 
       if (!searchForNeighbors(query, nn_indices, nn_dists)) {
-        PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
-                  "in the target dataset for point %d in the source!\n",
-                  getClassName().c_str(),
-                  (*indices_)[i]);
-        return;
+        matches[i] = -2;
+        continue;
       }
 
       // Check if the distance to the nearest neighbor is smaller than the user imposed
@@ -457,8 +490,23 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
         temp += C2;
         // M = temp^-1
         M = temp.inverse();
+        matches[i] = nn_indices[0];
+      }
+      else
+        matches[i] = -1;
+    }
+
+    for (std::size_t i = 0; i < N; i++) {
+      if (matches[i] == -2) {
+        PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
+                  "in the target dataset for point %d in the source!\n",
+                  getClassName().c_str(),
+                  (*indices_)[i]);
+        return;
+      }
+      if (matches[i] >= 0) {
         source_indices[cnt] = static_cast<int>(i);
-        target_indices[cnt] = nn_indices[0];
+        target_indices[cnt] = matches[i];
         cnt++;
       }
     }
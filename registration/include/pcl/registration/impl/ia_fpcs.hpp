@@ -271,6 +271,9 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
   else
     source_indices_ = indices_;
 
+  // build the pair index used to search for point pairs of a given length
+  buildPairIndex();
+
   // check usage of normals
   if (source_normals_ && target_normals_ && source_normals_->size() == input_->size() &&
       target_normals_->size() == target_->size())
@@ -587,37 +590,66 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
                           .norm()
                     : 0.f);
 
-  // loop over all pairs of points in source point cloud
-  auto it_out = source_indices_->begin(), it_out_e = source_indices_->end() - 1;
-  auto it_in_e = source_indices_->end();
-  for (; it_out != it_out_e; it_out++) {
-    auto it_in = it_out + 1;
-    const PointSource* pt1 = &(*input_)[*it_out];
-    for (; it_in != it_in_e; it_in++) {
-      const PointSource* pt2 = &(*input_)[*it_in];
+  // collect all pairs of points in source point cloud with a distance close to the
+  // reference dist (from base); the bounds are slightly relaxed to be robust against
+  // rounding, the exact test is done below
+  std::vector<std::pair<int, int>> candidates;
+  if (!pair_index_nodes_.empty()) {
+    const float min_dist = std::max(ref_dist - max_pair_diff_, 0.f);
+    const float max_dist = ref_dist + max_pair_diff_;
+    searchPairIndex(0,
+                    0,
+                    min_dist * min_dist * (1.f - small_error_),
+                    max_dist * max_dist * (1.f + small_error_),
+                    candidates);
+  }
+
+  // restore the order of an exhaustive search over all pairs: bucket the candidates by
+  // their first position and sort the (short) buckets by the second one
+  const std::size_t nr_points = source_indices_->size();
+  std::vector<std::size_t> offsets(nr_points + 1, 0);
+  for (const auto& candidate : candidates)
+    offsets[candidate.first + 1]++;
+  for (std::size_t i = 0; i < nr_points; i++)
+    offsets[i + 1] += offsets[i];
+
+  std::vector<int> partners(candidates.size());
+  std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+  for (const auto& candidate : candidates)
+    partners[next[candidate.first]++] = candidate.second;
+
+  for (std::size_t i = 0; i < nr_points; i++) {
+    const auto it_begin = partners.begin() + offsets[i];
+    const auto it_end = partners.begin() + offsets[i + 1];
+    std::sort(it_begin, it_end);
+
+    const int idx_out = (*source_indices_)[i];
+    for (auto it = it_begin; it != it_end; ++it) {
+      const int idx_in = (*source_indices_)[*it];
 
       // check point distance compared to reference dist (from base)
-      float dist = pcl::euclideanDistance(*pt1, *pt2);
-      if (std::abs(dist - ref_dist) < max_pair_diff_) {
-        // add here normal evaluation if normals are given
-        if (use_normals_) {
-          const NormalT* pt1_n = &((*source_normals_)[*it_out]);
-          const NormalT* pt2_n = &((*source_normals_)[*it_in]);
-
-          float norm_angle_1 =
-              (pt1_n->getNormalVector3fMap() - pt2_n->getNormalVector3fMap()).norm();
-          float norm_angle_2 =
-              (pt1_n->getNormalVector3fMap() + pt2_n->getNormalVector3fMap()).norm();
-
-          float norm_diff = std::min<float>(std::abs(norm_angle_1 - ref_norm_angle),
-                                            std::abs(norm_angle_2 - ref_norm_angle));
-          if (norm_diff > max_norm_diff)
-            continue;
-        }
+      float dist = pcl::euclideanDistance((*input_)[idx_out], (*input_)[idx_in]);
+      if (std::abs(dist - ref_dist) >= max_pair_diff_)
+        continue;
+
+      // add here normal evaluation if normals are given
+      if (use_normals_) {
+        const NormalT* pt1_n = &((*source_normals_)[idx_out]);
+        const NormalT* pt2_n = &((*source_normals_)[idx_in]);
 
-        pairs.push_back(pcl::Correspondence(*it_in, *it_out, dist));
-        pairs.push_back(pcl::Correspondence(*it_out, *it_in, dist));
+        float norm_angle_1 =
+            (pt1_n->getNormalVector3fMap() - pt2_n->getNormalVector3fMap()).norm();
+        float norm_angle_2 =
+            (pt1_n->getNormalVector3fMap() + pt2_n->getNormalVector3fMap()).norm();
+
+        float norm_diff = std::min<float>(std::abs(norm_angle_1 - ref_norm_angle),
+                                          std::abs(norm_angle_2 - ref_norm_angle));
+        if (norm_diff > max_norm_diff)
+          continue;
       }
+
+      pairs.push_back(pcl::Correspondence(idx_in, idx_out, dist));
+      pairs.push_back(pcl::Correspondence(idx_out, idx_in, dist));
     }
   }
 
@@ -625,6 +657,120 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
   return (pairs.empty() ? -1 : 0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar>
+void
+pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
+    buildPairIndex()
+{
+  const int max_leaf_size = 16;
+  const int nr_points = static_cast<int>(source_indices_->size());
+
+  pair_index_nodes_.clear();
+  pair_index_.resize(nr_points);
+  for (int i = 0; i < nr_points; i++)
+    pair_index_[i] = i;
+
+  if (nr_points == 0) {
+    pair_index_points_.clear();
+    return;
+  }
+
+  // split the nodes at the median of their largest extent, children are appended to
+  // the node list so it is processed breadth first
+  pair_index_nodes_.push_back(
+      {Eigen::Vector3f::Zero(), Eigen::Vector3f::Zero(), 0, nr_points, -1});
+  for (std::size_t n = 0; n < pair_index_nodes_.size(); n++) {
+    const int begin = pair_index_nodes_[n].begin;
+    const int end = pair_index_nodes_[n].end;
+
+    Eigen::Vector3f min_pt = Eigen::Vector3f::Constant(FLT_MAX);
+    Eigen::Vector3f max_pt = Eigen::Vector3f::Constant(-FLT_MAX);
+    for (int i = begin; i < end; i++) {
+      const Eigen::Vector3f pt =
+          (*input_)[(*source_indices_)[pair_index_[i]]].getVector3fMap();
+      min_pt = min_pt.cwiseMin(pt);
+      max_pt = max_pt.cwiseMax(pt);
+    }
+    pair_index_nodes_[n].min_pt = min_pt;
+    pair_index_nodes_[n].max_pt = max_pt;
+
+    if (end - begin <= max_leaf_size)
+      continue;
+
+    int axis;
+    (max_pt - min_pt).maxCoeff(&axis);
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(pair_index_.begin() + begin,
+                     pair_index_.begin() + mid,
+                     pair_index_.begin() + end,
+                     [this, axis](int a, int b) {
+                       return (*input_)[(*source_indices_)[a]].data[axis] <
+                              (*input_)[(*source_indices_)[b]].data[axis];
+                     });
+
+    pair_index_nodes_[n].child = static_cast<int>(pair_index_nodes_.size());
+    pair_index_nodes_.push_back({min_pt, max_pt, begin, mid, -1});
+    pair_index_nodes_.push_back({min_pt, max_pt, mid, end, -1});
+  }
+
+  // store the coordinates in index order for a cache friendly access during search
+  pair_index_points_.resize(nr_points);
+  for (int i = 0; i < nr_points; i++)
+    pair_index_points_[i] =
+        (*input_)[(*source_indices_)[pair_index_[i]]].getVector3fMap();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar>
+void
+pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
+    searchPairIndex(int node_a,
+                    int node_b,
+                    float min_dist_sqr,
+                    float max_dist_sqr,
+                    std::vector<std::pair<int, int>>& pairs) const
+{
+  const PairIndexNode& a = pair_index_nodes_[node_a];
+  const PairIndexNode& b = pair_index_nodes_[node_b];
+
+  // skip the nodes if no pair of their points can lie within the spherical shell
+  const Eigen::Vector3f gap = (a.min_pt - b.max_pt)
+                                  .cwiseMax(b.min_pt - a.max_pt)
+                                  .cwiseMax(Eigen::Vector3f::Zero());
+  const Eigen::Vector3f span = (a.max_pt - b.min_pt).cwiseMax(b.max_pt - a.min_pt);
+  if (gap.squaredNorm() > max_dist_sqr || span.squaredNorm() < min_dist_sqr)
+    return;
+
+  // test all pairs of two leaves
+  if (a.child < 0 && b.child < 0) {
+    for (int i = a.begin; i < a.end; i++) {
+      for (int j = (node_a == node_b ? i + 1 : b.begin); j < b.end; j++) {
+        float dist_sqr = (pair_index_points_[i] - pair_index_points_[j]).squaredNorm();
+        if (dist_sqr >= min_dist_sqr && dist_sqr <= max_dist_sqr)
+          pairs.push_back(std::minmax(pair_index_[i], pair_index_[j]));
+      }
+    }
+    return;
+  }
+
+  // descend into the children, splitting the larger node first
+  if (node_a == node_b) {
+    searchPairIndex(a.child, a.child, min_dist_sqr, max_dist_sqr, pairs);
+    searchPairIndex(a.child, a.child + 1, min_dist_sqr, max_dist_sqr, pairs);
+    searchPairIndex(
+        a.child + 1, a.child + 1, min_dist_sqr, max_dist_sqr, pairs);
+  }
+  else if (b.child < 0 || (a.child >= 0 && a.end - a.begin >= b.end - b.begin)) {
+    searchPairIndex(a.child, node_b, min_dist_sqr, max_dist_sqr, pairs);
+    searchPairIndex(a.child + 1, node_b, min_dist_sqr, max_dist_sqr, pairs);
+  }
+  else {
+    searchPairIndex(node_a, b.child, min_dist_sqr, max_dist_sqr, pairs);
+    searchPairIndex(node_a, b.child + 1, min_dist_sqr, max_dist_sqr, pairs);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar>
 int
@@ -646,14 +792,32 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
   dist_base[3] =
       pcl::euclideanDistance((*target_)[base_indices[1]], (*target_)[base_indices[3]]);
 
+  // the dot product of the two diagonals is determined by the four edge lengths, hence
+  // matches whose diagonals enclose a different angle than the ones of the base can be
+  // rejected before checking the edges; the tolerance follows from max_edge_diff_
+  const Eigen::Vector3f base_u = (*target_)[base_indices[1]].getVector3fMap() -
+                                 (*target_)[base_indices[0]].getVector3fMap();
+  const Eigen::Vector3f base_v = (*target_)[base_indices[3]].getVector3fMap() -
+                                 (*target_)[base_indices[2]].getVector3fMap();
+  const float base_dot = base_u.dot(base_v);
+  const float max_dot_diff =
+      max_edge_diff_ *
+          (dist_base[0] + dist_base[1] + dist_base[2] + dist_base[3] +
+           2.f * max_edge_diff_) *
+          (1.f + small_error_) +
+      small_error_;
+
   // loop over first point pair correspondences and store intermediate points 'e' in new
   // point cloud
   PointCloudSourcePtr cloud_e(new PointCloudSource);
   cloud_e->resize(pairs_a.size() * 2);
+  std::vector<Eigen::Vector3f> diagonals_a(pairs_a.size());
   PointCloudSourceIterator it_pt = cloud_e->begin();
+  auto it_diagonal = diagonals_a.begin();
   for (const auto& pair : pairs_a) {
     const PointSource* pt1 = &((*input_)[pair.index_match]);
     const PointSource* pt2 = &((*input_)[pair.index_query]);
+    *(it_diagonal++) = pt2->getVector3fMap() - pt1->getVector3fMap();
 
     // calculate intermediate points using both ratios from base (r1,r2)
     for (int i = 0; i < 2; i++, it_pt++) {
@@ -674,6 +838,7 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
   for (const auto& pair : pairs_b) {
     const PointTarget* pt1 = &((*input_)[pair.index_match]);
     const PointTarget* pt2 = &((*input_)[pair.index_query]);
+    const Eigen::Vector3f diagonal_b = pt2->getVector3fMap() - pt1->getVector3fMap();
 
     // calculate intermediate points using both ratios from base (r1,r2)
     for (const float& r : ratio) {
@@ -685,6 +850,10 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
       // search for corresponding intermediate points
       tree_e->radiusSearch(pt_e, coincidation_limit_, ids, dists_sqr);
       for (const auto& id : ids) {
+        // reject matches with a wrong angle between the diagonals
+        if (std::abs(diagonals_a[id / 2].dot(diagonal_b) - base_dot) > max_dot_diff)
+          continue;
+
         std::vector<int> match_indices(4);
 
         match_indices[0] =
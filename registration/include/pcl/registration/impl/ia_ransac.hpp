@@ -42,6 +42,9 @@
 #define IA_RANSAC_HPP_
 
 #include <pcl/common/distances.h>
+#include <pcl/common/transforms.h>
+
+#include <cstdlib>
 
 namespace pcl {
 
@@ -79,8 +82,9 @@ void
 SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSamples(
     const PointCloudSource& cloud,
     int nr_samples,
-    float min_sample_distance,
-    std::vector<int>& sample_indices)
+    float& min_sample_distance,
+    std::vector<int>& sample_indices,
+    std::mt19937& rng) const
 {
   if (nr_samples > static_cast<int>(cloud.size())) {
     PCL_ERROR("[pcl::%s::selectSamples] ", getClassName().c_str());
@@ -97,7 +101,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSampl
   sample_indices.clear();
   while (static_cast<int>(sample_indices.size()) < nr_samples) {
     // Choose a sample at random
-    int sample_index = getRandomIndex(static_cast<int>(cloud.size()));
+    int sample_index = getRandomIndex(static_cast<int>(cloud.size()), rng);
 
     // Check to see if the sample is 1) unique and 2) far away from the other samples
     bool valid_sample = true;
@@ -129,8 +133,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSampl
                static_cast<std::size_t>(iterations_without_a_sample),
                0.5 * min_sample_distance);
 
-      min_sample_distance_ *= 0.5f;
-      min_sample_distance = min_sample_distance_;
+      min_sample_distance *= 0.5f;
       iterations_without_a_sample = 0;
     }
   }
@@ -141,7 +144,8 @@ void
 SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
     findSimilarFeatures(const FeatureCloud& input_features,
                         const std::vector<int>& sample_indices,
-                        std::vector<int>& corresponding_indices)
+                        std::vector<int>& corresponding_indices,
+                        std::mt19937& rng) const
 {
   std::vector<int> nn_indices(k_correspondences_);
   std::vector<float> nn_distances(k_correspondences_);
@@ -156,7 +160,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
                                   nn_distances);
 
     // Select one at random and add it to corresponding_indices
-    int random_correspondence = getRandomIndex(k_correspondences_);
+    int random_correspondence = getRandomIndex(k_correspondences_, rng);
     corresponding_indices[i] = nn_indices[random_correspondence];
   }
 }
@@ -183,6 +187,35 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErro
   return (error);
 }
 
+template <typename PointSource, typename PointTarget, typename FeatureT>
+float
+SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric(
+    const Matrix4& transformation, float max_error) const
+{
+  std::vector<int> nn_index(1);
+  std::vector<float> nn_distance(1);
+
+  const ErrorFunctor& compute_error = *error_functor_;
+  float error = 0;
+
+  // Transform the points one at a time, so that the evaluation can stop early
+  const pcl::detail::Transformer<float> tf(transformation);
+  for (const auto& point : *input_) {
+    PointSource point_transformed = point;
+    tf.se3(point_transformed.data, point_transformed.data);
+
+    // Find the distance between the transformed point and its nearest neighbor in the
+    // target point cloud
+    tree_->nearestKSearch(point_transformed, 1, nn_index, nn_distance);
+
+    // Compute the error, which only grows as the penalties are never negative
+    error += compute_error(nn_distance[0]);
+    if (error > max_error)
+      break;
+  }
+  return (error);
+}
+
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
@@ -223,43 +256,82 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
   if (!error_functor_)
     error_functor_.reset(new TruncatedError(static_cast<float>(corr_dist_threshold_)));
 
-  std::vector<int> sample_indices(nr_samples_);
-  std::vector<int> corresponding_indices(nr_samples_);
-  PointCloudSource input_transformed;
-  float lowest_error(0);
+  float lowest_error = std::numeric_limits<float>::max();
 
   final_transformation_ = guess;
-  int i_iter = 0;
+  int nr_iterations = max_iterations_;
   converged_ = false;
   if (!guess.isApprox(Eigen::Matrix4f::Identity(), 0.01f)) {
     // If guess is not the Identity matrix we check it.
-    transformPointCloud(*input_, input_transformed, final_transformation_);
-    lowest_error =
-        computeErrorMetric(input_transformed, static_cast<float>(corr_dist_threshold_));
-    i_iter = 1;
+    lowest_error = computeErrorMetric(final_transformation_, lowest_error);
+    --nr_iterations;
   }
 
-  for (; i_iter < max_iterations_; ++i_iter) {
-    // Draw nr_samples_ random samples
-    selectSamples(*input_, nr_samples_, min_sample_distance_, sample_indices);
-
-    // Find corresponding features in the target cloud
-    findSimilarFeatures(*input_features_, sample_indices, corresponding_indices);
-
-    // Estimate the transform from the samples to their corresponding points
-    transformation_estimation_->estimateRigidTransformation(
-        *input_, sample_indices, *target_, corresponding_indices, transformation_);
-
-    // Transform the data and compute the error
-    transformPointCloud(*input_, input_transformed, transformation_);
-    float error =
-        computeErrorMetric(input_transformed, static_cast<float>(corr_dist_threshold_));
+  // The iterations are drawn in blocks, each with its own random number generator.
+  // The blocks of a round are evaluated in parallel and merged in order, so the result
+  // does not depend on the number of threads. The lowest error of the previous rounds
+  // bounds the evaluation of the hypotheses.
+  unsigned int seed = static_cast<unsigned int>(std::rand());
+  int nr_threads = static_cast<int>(threads_);
+  std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>> block_transformations(
+      nr_threads);
+  std::vector<float> block_errors(nr_threads);
+
+  for (int first_block = 0; first_block * iterations_block_size_ < nr_iterations;
+       first_block += nr_threads) {
+#pragma omp parallel for default(none)                                                 \
+    shared(seed, nr_iterations, first_block, nr_threads, lowest_error,                 \
+           block_transformations, block_errors) num_threads(threads_)                  \
+    schedule(dynamic, 1)
+    for (int block = first_block; block < first_block + nr_threads; ++block) {
+      const int b = block - first_block;
+      block_errors[b] = std::numeric_limits<float>::max();
+      if (block * iterations_block_size_ >= nr_iterations)
+        continue;
+
+      std::seed_seq seed_sequence{seed, static_cast<unsigned int>(block)};
+      std::mt19937 rng(seed_sequence);
+
+      std::vector<int> sample_indices(nr_samples_);
+      std::vector<int> corresponding_indices(nr_samples_);
+      float min_sample_distance = min_sample_distance_;
+      Matrix4 transformation;
+
+      const int end = std::min((block + 1) * iterations_block_size_, nr_iterations);
+      for (int i = block * iterations_block_size_; i < end; ++i) {
+        // Draw nr_samples_ random samples
+        selectSamples(
+            *input_, nr_samples_, min_sample_distance, sample_indices, rng);
+
+        // Find corresponding features in the target cloud
+        findSimilarFeatures(
+            *input_features_, sample_indices, corresponding_indices, rng);
+
+        // Estimate the transform from the samples to their corresponding points
+        transformation_estimation_->estimateRigidTransformation(
+            *input_, sample_indices, *target_, corresponding_indices, transformation);
+
+        // Transform the data and compute the error, as long as it can be lower than
+        // the lowest one so far
+        const float error = computeErrorMetric(
+            transformation, std::min(block_errors[b], lowest_error));
+
+        // If the new error is lower, update the best transformation of the block
+        if (error < block_errors[b]) {
+          block_errors[b] = error;
+          block_transformations[b] = transformation;
+        }
+      }
+    }
 
-    // If the new error is lower, update the final transformation
-    if (i_iter == 0 || error < lowest_error) {
-      lowest_error = error;
-      final_transformation_ = transformation_;
-      converged_ = true;
+    // If the new error is lower, update the final transformation, with the blocks in
+    // order
+    for (int b = 0; b < nr_threads; ++b) {
+      if (block_errors[b] < lowest_error) {
+        lowest_error = block_errors[b];
+        final_transformation_ = block_transformations[b];
+        converged_ = true;
+      }
     }
   }
 
@@ -41,6 +41,8 @@
 #ifndef PCL_REGISTRATION_IMPL_LUM_HPP_
 #define PCL_REGISTRATION_IMPL_LUM_HPP_
 
+#include <Eigen/Sparse>
+
 #include <tuple>
 
 namespace pcl {
@@ -96,6 +98,27 @@ LUM<PointT>::getConvergenceThreshold() const
   return (convergence_threshold_);
 }
 
+template <typename PointT>
+void
+LUM<PointT>::setNumberOfThreads(unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+template <typename PointT>
+inline unsigned int
+LUM<PointT>::getNumberOfThreads() const
+{
+  return (threads_);
+}
+
 template <typename PointT>
 typename LUM<PointT>::Vertex
 LUM<PointT>::addPointCloud(const PointCloudPtr& cloud, const Eigen::Vector6f& pose)
@@ -226,44 +249,73 @@ LUM<PointT>::compute()
               "vertices.\n");
     return;
   }
+  // The edges are linearized independently of each other, so gather them once for the
+  // parallel loop
+  std::vector<Edge> edge_list;
+  edge_list.reserve(num_edges(*slam_graph_));
+  typename SLAMGraph::edge_iterator e, e_end;
+  for (std::tie(e, e_end) = edges(*slam_graph_); e != e_end; ++e)
+    edge_list.push_back(*e);
+  int nr_edges = static_cast<int>(edge_list.size());
+
   for (int i = 0; i < max_iterations_; ++i) {
     // Linearized computation of C^-1 and C^-1*D and convergence checking for all edges
     // in the graph (results stored in slam_graph_)
-    typename SLAMGraph::edge_iterator e, e_end;
-    for (std::tie(e, e_end) = edges(*slam_graph_); e != e_end; ++e)
-      computeEdge(*e);
-
-    // Declare matrices G and B
-    Eigen::MatrixXf G = Eigen::MatrixXf::Zero(6 * (n - 1), 6 * (n - 1));
+#pragma omp parallel for default(none) shared(edge_list, nr_edges)                     \
+    num_threads(threads_) schedule(dynamic)
+    for (int ei = 0; ei < nr_edges; ++ei)
+      computeEdge(edge_list[ei]);
+
+    // Assemble the sparse block matrix G and the vector B. Every vertex uses its
+    // forward edge to a neighbor, otherwise the backward edge. Vertex 0 is the
+    // reference pose and has no row or column in the system.
+    std::vector<Eigen::Triplet<float>> triplets;
+    triplets.reserve(4 * 36 * edge_list.size());
     Eigen::VectorXf B = Eigen::VectorXf::Zero(6 * (n - 1));
-
-    // Start at 1 because 0 is the reference pose
-    for (int vi = 1; vi != n; ++vi) {
-      for (int vj = 0; vj != n; ++vj) {
-        // Attempt to use the forward edge, otherwise use backward edge, otherwise there
-        // was no edge
-        Edge e;
-        bool present1;
-        std::tie(e, present1) = edge(vi, vj, *slam_graph_);
-        if (!present1) {
-          bool present2;
-          std::tie(e, present2) = edge(vj, vi, *slam_graph_);
-          if (!present2)
-            continue;
-        }
-
-        // Fill in elements of G and B
-        if (vj > 0)
-          G.block(6 * (vi - 1), 6 * (vj - 1), 6, 6) = -(*slam_graph_)[e].cinv_;
-        G.block(6 * (vi - 1), 6 * (vi - 1), 6, 6) += (*slam_graph_)[e].cinv_;
-        B.segment(6 * (vi - 1), 6) += (present1 ? 1 : -1) * (*slam_graph_)[e].cinvd_;
-      }
+    bool symmetric = true;
+    const auto add_blocks =
+        [&](int vi, int vj, const EdgeProperties& props, float sign) {
+          if (vi == 0)
+            return;
+          const int row = 6 * (vi - 1);
+          const int col = 6 * (vj - 1);
+          for (int r = 0; r < 6; ++r) {
+            for (int c = 0; c < 6; ++c) {
+              triplets.emplace_back(row + r, row + c, props.cinv_(r, c));
+              if (vj > 0)
+                triplets.emplace_back(row + r, col + c, -props.cinv_(r, c));
+            }
+          }
+          B.segment(row, 6) += sign * props.cinvd_;
+        };
+    for (const Edge& edge_ij : edge_list) {
+      const int vs = static_cast<int>(source(edge_ij, *slam_graph_));
+      const int vt = static_cast<int>(target(edge_ij, *slam_graph_));
+      const EdgeProperties& props = (*slam_graph_)[edge_ij];
+      add_blocks(vs, vt, props, 1.0f);
+      // The target vertex only falls back to this edge if it has no forward edge itself
+      if (edge(vt, vs, *slam_graph_).second)
+        symmetric = false;
+      else
+        add_blocks(vt, vs, props, -1.0f);
     }
+    Eigen::SparseMatrix<float> G(6 * (n - 1), 6 * (n - 1));
+    G.setFromTriplets(triplets.begin(), triplets.end());
 
     // Computation of the linear equation system: GX = B
-    // TODO investigate accuracy vs. speed tradeoff and find the best solving method for
-    // our type of linear equation (sparse)
-    Eigen::VectorXf X = G.colPivHouseholderQr().solve(B);
+    // G is symmetric positive semi-definite unless a vertex pair is connected in both
+    // directions, or parts of the graph are not connected to the reference pose. Use a
+    // sparse Cholesky factorization and fall back to a rank revealing sparse QR.
+    Eigen::VectorXf X;
+    if (symmetric) {
+      Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>> ldlt(G);
+      if (ldlt.info() == Eigen::Success)
+        X = ldlt.solve(B);
+    }
+    if (X.size() != B.size() || !X.allFinite()) {
+      Eigen::SparseQR<Eigen::SparseMatrix<float>, Eigen::COLAMDOrdering<int>> qr(G);
+      X = qr.solve(B);
+    }
 
     // Update the poses
     float sum = 0.0;
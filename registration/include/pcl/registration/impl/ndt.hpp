@@ -52,6 +52,8 @@ NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributionsTrans
 , gauss_d1_()
 , gauss_d2_()
 , trans_probability_()
+, search_method_(NeighborSearchMethod::KDTREE)
+, threads_(1)
 {
   reg_name_ = "NormalDistributionsTransform";
 
@@ -195,41 +197,103 @@ NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives(
   // Precompute Angular Derivatives (eq. 6.19 and 6.21)[Magnusson 2009]
   computeAngleDerivatives(transform);
 
-  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->size(); idx++) {
-    // Transformed Point
-    const auto& x_trans_pt = trans_cloud[idx];
+  // The points are processed in fixed blocks whose contributions are then added up in
+  // order, so that the result does not depend on the number of threads
+  std::ptrdiff_t number_of_points = input_->size();
+  std::ptrdiff_t number_of_blocks =
+      (number_of_points + derivatives_block_size_ - 1) / derivatives_block_size_;
+  std::vector<double> block_score(number_of_blocks, 0.);
+  std::vector<Eigen::Matrix<double, 6, 1>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1>>>
+      block_gradient(number_of_blocks, Eigen::Matrix<double, 6, 1>::Zero());
+  std::vector<Eigen::Matrix<double, 6, 6>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6>>>
+      block_hessian(number_of_blocks, Eigen::Matrix<double, 6, 6>::Zero());
 
-    // Find neighbors (Radius search has been experimentally faster than direct neighbor
-    // checking.
+  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
+#pragma omp parallel for default(none)                                                 \
+    shared(trans_cloud, compute_hessian, number_of_points, number_of_blocks,           \
+           block_score, block_gradient, block_hessian)                                 \
+    num_threads(threads_) schedule(dynamic, 1)
+  for (std::ptrdiff_t block = 0; block < number_of_blocks; ++block) {
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
+    Eigen::Matrix<double, 3, 6> point_jacobian = point_jacobian_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
 
-    for (const auto& cell : neighborhood) {
-      // Original Point
-      const auto& x_pt = (*input_)[idx];
-      const Eigen::Vector3d x = x_pt.getVector3fMap().template cast<double>();
+    const std::ptrdiff_t end =
+        std::min(number_of_points, (block + 1) * derivatives_block_size_);
+    for (std::ptrdiff_t idx = block * derivatives_block_size_; idx < end; idx++) {
+      // Transformed Point
+      const auto& x_trans_pt = trans_cloud[idx];
 
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      const Eigen::Vector3d x_trans =
-          x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
-      // Inverse Covariance of Occupied Voxel
-      // Uses precomputed covariance for speed.
-      const Eigen::Matrix3d c_inv = cell->getInverseCov();
+      // Find neighbors
+      getNeighborhood(x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty())
+        continue;
 
+      // Original Point
+      const Eigen::Vector3d x = (*input_)[idx].getVector3fMap().template cast<double>();
       // Compute derivative of transform function w.r.t. transform vector, J_E and H_E
       // in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives(x);
-      // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to
-      // Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-      score +=
-          updateDerivatives(score_gradient, hessian, x_trans, c_inv, compute_hessian);
+      computePointDerivatives(x, point_jacobian, point_hessian, compute_hessian);
+
+      for (const auto& cell : neighborhood) {
+        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+        const Eigen::Vector3d x_trans =
+            x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
+        // Inverse Covariance of Occupied Voxel
+        // Uses precomputed covariance for speed.
+        const Eigen::Matrix3d c_inv = cell->getInverseCov();
+
+        // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to
+        // Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+        block_score[block] += updateDerivatives(block_gradient[block],
+                                                block_hessian[block],
+                                                point_jacobian,
+                                                point_hessian,
+                                                x_trans,
+                                                c_inv,
+                                                compute_hessian);
+      }
     }
   }
+
+  for (std::ptrdiff_t block = 0; block < number_of_blocks; ++block) {
+    score += block_score[block];
+    score_gradient += block_gradient[block];
+    hessian += block_hessian[block];
+  }
   return score;
 }
 
+template <typename PointSource, typename PointTarget>
+void
+NormalDistributionsTransform<PointSource, PointTarget>::getNeighborhood(
+    const PointSource& x_trans_pt,
+    std::vector<TargetGridLeafConstPtr>& neighborhood,
+    std::vector<float>& distances) const
+{
+  const TargetGrid& target_cells =
+      external_target_cells_ ? *external_target_cells_ : target_cells_;
+  switch (search_method_) {
+  case NeighborSearchMethod::KDTREE:
+    // Radius search has been experimentally faster than direct neighbor checking
+    // through the voxel map; the DIRECT methods use a hash of the voxels instead
+    target_cells.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
+    break;
+  case NeighborSearchMethod::DIRECT26:
+    target_cells.getAllNeighborsAtPoint(x_trans_pt, neighborhood);
+    break;
+  case NeighborSearchMethod::DIRECT7:
+    target_cells.getFaceNeighborsAtPoint(x_trans_pt, neighborhood);
+    break;
+  case NeighborSearchMethod::DIRECT1:
+    target_cells.getVoxelAtPoint(x_trans_pt, neighborhood);
+    break;
+  }
+}
+
 template <typename PointSource, typename PointTarget>
 void
 NormalDistributionsTransform<PointSource, PointTarget>::computeAngleDerivatives(
@@ -318,20 +382,31 @@ template <typename PointSource, typename PointTarget>
 void
 NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives(
     const Eigen::Vector3d& x, bool compute_hessian)
+{
+  computePointDerivatives(x, point_jacobian_, point_hessian_, compute_hessian);
+}
+
+template <typename PointSource, typename PointTarget>
+void
+NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives(
+    const Eigen::Vector3d& x,
+    Eigen::Matrix<double, 3, 6>& point_jacobian,
+    Eigen::Matrix<double, 18, 6>& point_hessian,
+    bool compute_hessian) const
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector.
   // Derivative w.r.t. ith element of transform vector corresponds to column i,
   // Equation 6.18 and 6.19 [Magnusson 2009]
   Eigen::Matrix<double, 8, 1> point_angular_jacobian =
       angular_jacobian_ * Eigen::Vector4d(x[0], x[1], x[2], 0.0);
-  point_jacobian_(1, 3) = point_angular_jacobian[0];
-  point_jacobian_(2, 3) = point_angular_jacobian[1];
-  point_jacobian_(0, 4) = point_angular_jacobian[2];
-  point_jacobian_(1, 4) = point_angular_jacobian[3];
-  point_jacobian_(2, 4) = point_angular_jacobian[4];
-  point_jacobian_(0, 5) = point_angular_jacobian[5];
-  point_jacobian_(1, 5) = point_angular_jacobian[6];
-  point_jacobian_(2, 5) = point_angular_jacobian[7];
+  point_jacobian(1, 3) = point_angular_jacobian[0];
+  point_jacobian(2, 3) = point_angular_jacobian[1];
+  point_jacobian(0, 4) = point_angular_jacobian[2];
+  point_jacobian(1, 4) = point_angular_jacobian[3];
+  point_jacobian(2, 4) = point_angular_jacobian[4];
+  point_jacobian(0, 5) = point_angular_jacobian[5];
+  point_jacobian(1, 5) = point_angular_jacobian[6];
+  point_jacobian(2, 5) = point_angular_jacobian[7];
 
   if (compute_hessian) {
     Eigen::Matrix<double, 15, 1> point_angular_hessian =
@@ -348,15 +423,15 @@ NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives(
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform
     // vector. Derivative w.r.t. ith and jth elements of transform vector corresponds to
     // the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -368,6 +443,26 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives(
     const Eigen::Vector3d& x_trans,
     const Eigen::Matrix3d& c_inv,
     bool compute_hessian) const
+{
+  return updateDerivatives(score_gradient,
+                           hessian,
+                           point_jacobian_,
+                           point_hessian_,
+                           x_trans,
+                           c_inv,
+                           compute_hessian);
+}
+
+template <typename PointSource, typename PointTarget>
+double
+NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives(
+    Eigen::Matrix<double, 6, 1>& score_gradient,
+    Eigen::Matrix<double, 6, 6>& hessian,
+    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+    const Eigen::Matrix<double, 18, 6>& point_hessian,
+    const Eigen::Vector3d& x_trans,
+    const Eigen::Matrix3d& c_inv,
+    bool compute_hessian) const
 {
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
   double e_x_cov_x = std::exp(-gauss_d2_ * x_trans.dot(c_inv * x_trans) / 2);
@@ -388,7 +483,7 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives(
   for (int i = 0; i < 6; i++) {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson
     // 2009]
-    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian_.col(i);
+    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian.col(i);
 
     // Update gradient, Equation 6.12 [Magnusson 2009]
     score_gradient(i) += x_trans.dot(cov_dxd_pi) * e_x_cov_x;
@@ -398,9 +493,9 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives(
         // Update hessian, Equation 6.13 [Magnusson 2009]
         hessian(i, j) +=
             e_x_cov_x * (-gauss_d2_ * x_trans.dot(cov_dxd_pi) *
-                             x_trans.dot(c_inv * point_jacobian_.col(j)) +
-                         x_trans.dot(c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                         point_jacobian_.col(j).dot(cov_dxd_pi));
+                             x_trans.dot(c_inv * point_jacobian.col(j)) +
+                         x_trans.dot(c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                         point_jacobian.col(j).dot(cov_dxd_pi));
       }
     }
   }
@@ -417,43 +512,77 @@ NormalDistributionsTransform<PointSource, PointTarget>::computeHessian(
 
   // Precompute Angular Derivatives unessisary because only used after regular
   // derivative calculation Update hessian for each point, line 17 in Algorithm 2
-  // [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->size(); idx++) {
-    // Transformed Point
-    const auto& x_trans_pt = trans_cloud[idx];
-
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor
-    // checking.
+  // [Magnusson 2009]. The points are processed in fixed blocks, as in
+  // computeDerivatives()
+  std::ptrdiff_t number_of_points = input_->size();
+  std::ptrdiff_t number_of_blocks =
+      (number_of_points + derivatives_block_size_ - 1) / derivatives_block_size_;
+  std::vector<Eigen::Matrix<double, 6, 6>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6>>>
+      block_hessian(number_of_blocks, Eigen::Matrix<double, 6, 6>::Zero());
+
+#pragma omp parallel for default(none)                                                 \
+    shared(trans_cloud, number_of_points, number_of_blocks, block_hessian)             \
+    num_threads(threads_) schedule(dynamic, 1)
+  for (std::ptrdiff_t block = 0; block < number_of_blocks; ++block) {
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch(x_trans_pt, resolution_, neighborhood, distances);
+    Eigen::Matrix<double, 3, 6> point_jacobian = point_jacobian_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
 
-    for (const auto& cell : neighborhood) {
-      // Original Point
-      const auto& x_pt = (*input_)[idx];
-      const Eigen::Vector3d x = x_pt.getVector3fMap().template cast<double>();
+    const std::ptrdiff_t end =
+        std::min(number_of_points, (block + 1) * derivatives_block_size_);
+    for (std::ptrdiff_t idx = block * derivatives_block_size_; idx < end; idx++) {
+      // Transformed Point
+      const auto& x_trans_pt = trans_cloud[idx];
 
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      const Eigen::Vector3d x_trans =
-          x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
-      // Inverse Covariance of Occupied Voxel
-      // Uses precomputed covariance for speed.
-      const Eigen::Matrix3d c_inv = cell->getInverseCov();
+      // Find nieghbors
+      getNeighborhood(x_trans_pt, neighborhood, distances);
+      if (neighborhood.empty())
+        continue;
 
+      // Original Point
+      const Eigen::Vector3d x = (*input_)[idx].getVector3fMap().template cast<double>();
       // Compute derivative of transform function w.r.t. transform vector, J_E and H_E
       // in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives(x);
-      // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12
-      // and 6.13, respectively [Magnusson 2009]
-      updateHessian(hessian, x_trans, c_inv);
+      computePointDerivatives(x, point_jacobian, point_hessian);
+
+      for (const auto& cell : neighborhood) {
+        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+        const Eigen::Vector3d x_trans =
+            x_trans_pt.getVector3fMap().template cast<double>() - cell->getMean();
+        // Inverse Covariance of Occupied Voxel
+        // Uses precomputed covariance for speed.
+        const Eigen::Matrix3d c_inv = cell->getInverseCov();
+
+        // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12
+        // and 6.13, respectively [Magnusson 2009]
+        updateHessian(
+            block_hessian[block], point_jacobian, point_hessian, x_trans, c_inv);
+      }
     }
   }
+
+  for (std::ptrdiff_t block = 0; block < number_of_blocks; ++block)
+    hessian += block_hessian[block];
+}
+
+template <typename PointSource, typename PointTarget>
+void
+NormalDistributionsTransform<PointSource, PointTarget>::updateHessian(
+    Eigen::Matrix<double, 6, 6>& hessian,
+    const Eigen::Vector3d& x_trans,
+    const Eigen::Matrix3d& c_inv) const
+{
+  updateHessian(hessian, point_jacobian_, point_hessian_, x_trans, c_inv);
 }
 
 template <typename PointSource, typename PointTarget>
 void
 NormalDistributionsTransform<PointSource, PointTarget>::updateHessian(
     Eigen::Matrix<double, 6, 6>& hessian,
+    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+    const Eigen::Matrix<double, 18, 6>& point_hessian,
     const Eigen::Vector3d& x_trans,
     const Eigen::Matrix3d& c_inv) const
 {
@@ -472,15 +601,15 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateHessian(
   for (int i = 0; i < 6; i++) {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson
     // 2009]
-    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian_.col(i);
+    const Eigen::Vector3d cov_dxd_pi = c_inv * point_jacobian.col(i);
 
     for (Eigen::Index j = 0; j < hessian.cols(); j++) {
       // Update hessian, Equation 6.13 [Magnusson 2009]
       hessian(i, j) +=
           e_x_cov_x * (-gauss_d2_ * x_trans.dot(cov_dxd_pi) *
-                           x_trans.dot(c_inv * point_jacobian_.col(j)) +
-                       x_trans.dot(c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                       point_jacobian_.col(j).dot(cov_dxd_pi));
+                           x_trans.dot(c_inv * point_jacobian.col(j)) +
+                       x_trans.dot(c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                       point_jacobian.col(j).dot(cov_dxd_pi));
     }
   }
 }
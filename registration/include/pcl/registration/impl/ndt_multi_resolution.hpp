@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_NDT_MULTI_RESOLUTION_IMPL_H_
+#define PCL_REGISTRATION_NDT_MULTI_RESOLUTION_IMPL_H_
+
+namespace pcl {
+
+template <typename PointT>
+void
+VoxelGridCovariancePyramid<PointT>::build(const PointCloudConstPtr& cloud,
+                                          const std::vector<float>& resolutions)
+{
+  resolutions_ = resolutions;
+  levels_.clear();
+  levels_.reserve(resolutions_.size());
+  for (const float resolution : resolutions_) {
+    shared_ptr<Grid> grid(new Grid);
+    grid->setLeafSize(resolution, resolution, resolution);
+    grid->setInputCloud(cloud);
+    // Initiate voxel structure.
+    grid->filter(true);
+    levels_.push_back(grid);
+  }
+}
+
+template <typename PointT>
+void
+VoxelGridCovariancePyramid<PointT>::serialize(std::ostream& stream) const
+{
+  const std::uint64_t nr_levels = levels_.size();
+  stream.write(reinterpret_cast<const char*>(&nr_levels), sizeof(nr_levels));
+  stream.write(reinterpret_cast<const char*>(resolutions_.data()),
+               sizeof(float) * nr_levels);
+  for (const auto& level : levels_)
+    level->serialize(stream);
+}
+
+template <typename PointT>
+bool
+VoxelGridCovariancePyramid<PointT>::deserialize(std::istream& stream)
+{
+  resolutions_.clear();
+  levels_.clear();
+
+  std::uint64_t nr_levels = 0;
+  stream.read(reinterpret_cast<char*>(&nr_levels), sizeof(nr_levels));
+  if (!stream)
+    return false;
+  resolutions_.resize(nr_levels);
+  stream.read(reinterpret_cast<char*>(resolutions_.data()), sizeof(float) * nr_levels);
+  for (std::uint64_t level = 0; level < nr_levels && stream; ++level) {
+    shared_ptr<Grid> grid(new Grid);
+    if (!grid->deserialize(stream))
+      break;
+    levels_.push_back(grid);
+  }
+
+  if (!stream || levels_.size() != nr_levels) {
+    PCL_ERROR("[pcl::VoxelGridCovariancePyramid::deserialize] Could not read the "
+              "pyramid!\n");
+    resolutions_.clear();
+    levels_.clear();
+    return false;
+  }
+  return true;
+}
+
+template <typename PointSource, typename PointTarget>
+void
+NormalDistributionsTransformMultiResolution<PointSource, PointTarget>::
+    buildTargetPyramid()
+{
+  if (target_pyramid_given_ || !target_grids_updated_)
+    return;
+  target_grids_updated_ = false;
+
+  if (resolutions_.empty()) {
+    target_pyramid_.reset();
+    init();
+    return;
+  }
+
+  TargetPyramidPtr pyramid(new TargetPyramid);
+  pyramid->build(target_, resolutions_);
+  target_pyramid_ = pyramid;
+}
+
+template <typename PointSource, typename PointTarget>
+void
+NormalDistributionsTransformMultiResolution<PointSource, PointTarget>::
+    computeTransformation(PointCloudSource& output, const Eigen::Matrix4f& guess)
+{
+  buildTargetPyramid();
+  if (!target_pyramid_ || target_pyramid_->size() == 0) {
+    NormalDistributionsTransform<PointSource, PointTarget>::computeTransformation(
+        output, guess);
+    return;
+  }
+
+  // Every level starts from the transformation estimated on the previous one, which
+  // output has already been transformed with
+  const float resolution = resolution_;
+  const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+  int nr_iterations = 0;
+  for (std::size_t level = 0; level < target_pyramid_->size(); ++level) {
+    resolution_ = target_pyramid_->getResolutions()[level];
+    external_target_cells_ = target_pyramid_->getLevel(level);
+    NormalDistributionsTransform<PointSource, PointTarget>::computeTransformation(
+        output, level == 0 ? guess : identity);
+    nr_iterations += nr_iterations_;
+  }
+  external_target_cells_.reset();
+  resolution_ = resolution;
+  nr_iterations_ = nr_iterations;
+}
+
+} // namespace pcl
+
+#endif // PCL_REGISTRATION_NDT_MULTI_RESOLUTION_IMPL_H_
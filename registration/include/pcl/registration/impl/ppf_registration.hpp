@@ -47,6 +47,9 @@
 #include <pcl/features/pfh_tools.h> // for computePairFeatures
 #include <pcl/features/ppf.h>
 #include <pcl/registration/ppf_registration.h>
+
+#include <unordered_map>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget>
 void
@@ -77,138 +80,162 @@ pcl::PPFRegistration<PointSource, PointTarget>::computeTransformation(
               "(guess) not implemented!\n");
   }
 
-  const auto aux_size = static_cast<std::size_t>(
+  std::size_t aux_size = static_cast<std::size_t>(
       std::floor(2 * M_PI / search_method_->getAngleDiscretizationStep()));
 
-  const std::vector<unsigned int> tmp_vec(aux_size, 0);
-  std::vector<std::vector<unsigned int>> accumulator_array(input_->size(), tmp_vec);
+  PCL_INFO("Accumulator array size: %zu x %zu.\n",
+           static_cast<std::size_t>(input_->size()),
+           aux_size);
 
-  PCL_INFO("Accumulator array size: %u x %u.\n",
-           accumulator_array.size(),
-           accumulator_array.back().size());
-
-  PoseWithVotesList voted_poses;
   // Consider every <scene_reference_point_sampling_rate>-th point as the reference
-  // point => fix s_r
-  float f1, f2, f3, f4;
-  for (index_t scene_reference_index = 0;
-       scene_reference_index < static_cast<index_t>(target_->size());
-       scene_reference_index += scene_reference_point_sampling_rate_) {
-    Eigen::Vector3f scene_reference_point =
-                        (*target_)[scene_reference_index].getVector3fMap(),
-                    scene_reference_normal =
-                        (*target_)[scene_reference_index].getNormalVector3fMap();
-
-    float rotation_angle_sg =
-        std::acos(scene_reference_normal.dot(Eigen::Vector3f::UnitX()));
-    bool parallel_to_x_sg =
-        (scene_reference_normal.y() == 0.0f && scene_reference_normal.z() == 0.0f);
-    Eigen::Vector3f rotation_axis_sg =
-        (parallel_to_x_sg)
-            ? (Eigen::Vector3f::UnitY())
-            : (scene_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
-    Eigen::AngleAxisf rotation_sg(rotation_angle_sg, rotation_axis_sg);
-    Eigen::Affine3f transform_sg(
-        Eigen::Translation3f(rotation_sg * ((-1) * scene_reference_point)) *
-        rotation_sg);
-
-    // For every other point in the scene => now have pair (s_r, s_i) fixed
+  // point => fix s_r. Each reference point votes for one pose, independently of the
+  // other ones.
+  std::ptrdiff_t nr_scene_reference_points = static_cast<std::ptrdiff_t>(
+      (target_->size() + scene_reference_point_sampling_rate_ - 1) /
+      scene_reference_point_sampling_rate_);
+  std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f>> max_transforms(
+      nr_scene_reference_points);
+  std::vector<unsigned int> max_votes(nr_scene_reference_points, 0);
+
+#pragma omp parallel default(none)                                                     \
+    shared(aux_size, nr_scene_reference_points, max_transforms, max_votes)             \
+    num_threads(threads_)
+  {
+    // Flat accumulator array of the thread, indexed by model reference point and
+    // discretized angle, and the entries of it that received a vote
+    std::vector<unsigned int> accumulator_array(input_->size() * aux_size, 0);
+    std::vector<std::size_t> voted_entries;
     std::vector<int> indices;
     std::vector<float> distances;
-    scene_search_tree_->radiusSearch((*target_)[scene_reference_index],
-                                     search_method_->getModelDiameter() / 2,
-                                     indices,
-                                     distances);
-    for (const auto& scene_point_index : indices)
-    //    for(std::size_t i = 0; i < target_->size (); ++i)
-    {
-      // size_t scene_point_index = i;
-      if (scene_reference_index != scene_point_index) {
-        if (/*pcl::computePPFPairFeature*/ pcl::computePairFeatures(
-            (*target_)[scene_reference_index].getVector4fMap(),
-            (*target_)[scene_reference_index].getNormalVector4fMap(),
-            (*target_)[scene_point_index].getVector4fMap(),
-            (*target_)[scene_point_index].getNormalVector4fMap(),
-            f1,
-            f2,
-            f3,
-            f4)) {
-          std::vector<std::pair<std::size_t, std::size_t>> nearest_indices;
-          search_method_->nearestNeighborSearch(f1, f2, f3, f4, nearest_indices);
-
-          // Compute alpha_s angle
-          Eigen::Vector3f scene_point = (*target_)[scene_point_index].getVector3fMap();
-
-          Eigen::Vector3f scene_point_transformed = transform_sg * scene_point;
-          float alpha_s =
-              std::atan2(-scene_point_transformed(2), scene_point_transformed(1));
-          if (std::sin(alpha_s) * scene_point_transformed(2) < 0.0f)
-            alpha_s *= (-1);
-          alpha_s *= (-1);
-
-          // Go through point pairs in the model with the same discretized feature
-          for (const auto& nearest_index : nearest_indices) {
-            std::size_t model_reference_index = nearest_index.first;
-            std::size_t model_point_index = nearest_index.second;
-            // Calculate angle alpha = alpha_m - alpha_s
-            float alpha =
-                search_method_->alpha_m_[model_reference_index][model_point_index] -
-                alpha_s;
-            unsigned int alpha_discretized = static_cast<unsigned int>(
-                std::floor(alpha) +
-                std::floor(M_PI / search_method_->getAngleDiscretizationStep()));
-            accumulator_array[model_reference_index][alpha_discretized]++;
-          }
-        }
-        else
+    float f1, f2, f3, f4;
+
+#pragma omp for schedule(dynamic, 1)
+    for (std::ptrdiff_t reference_i = 0; reference_i < nr_scene_reference_points;
+         ++reference_i) {
+      const index_t scene_reference_index =
+          static_cast<index_t>(reference_i * scene_reference_point_sampling_rate_);
+      Eigen::Vector3f scene_reference_point =
+                          (*target_)[scene_reference_index].getVector3fMap(),
+                      scene_reference_normal =
+                          (*target_)[scene_reference_index].getNormalVector3fMap();
+
+      float rotation_angle_sg =
+          std::acos(scene_reference_normal.dot(Eigen::Vector3f::UnitX()));
+      bool parallel_to_x_sg =
+          (scene_reference_normal.y() == 0.0f && scene_reference_normal.z() == 0.0f);
+      Eigen::Vector3f rotation_axis_sg =
+          (parallel_to_x_sg)
+              ? (Eigen::Vector3f::UnitY())
+              : (scene_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
+      Eigen::AngleAxisf rotation_sg(rotation_angle_sg, rotation_axis_sg);
+      Eigen::Affine3f transform_sg(
+          Eigen::Translation3f(rotation_sg * ((-1) * scene_reference_point)) *
+          rotation_sg);
+
+      // For every other point in the scene => now have pair (s_r, s_i) fixed
+      scene_search_tree_->radiusSearch((*target_)[scene_reference_index],
+                                       search_method_->getModelDiameter() / 2,
+                                       indices,
+                                       distances);
+      for (const auto& scene_point_index : indices) {
+        if (scene_reference_index == scene_point_index)
+          continue;
+
+        if (!pcl::computePairFeatures(
+                (*target_)[scene_reference_index].getVector4fMap(),
+                (*target_)[scene_reference_index].getNormalVector4fMap(),
+                (*target_)[scene_point_index].getVector4fMap(),
+                (*target_)[scene_point_index].getNormalVector4fMap(),
+                f1,
+                f2,
+                f3,
+                f4)) {
           PCL_ERROR("[pcl::PPFRegistration::computeTransformation] Computing pair "
                     "feature vector between points %u and %u went wrong.\n",
                     scene_reference_index,
                     scene_point_index);
-      }
-    }
+          continue;
+        }
+
+        const auto nearest_pairs = search_method_->getPairsInBin(f1, f2, f3, f4);
 
-    std::size_t max_votes_i = 0, max_votes_j = 0;
-    unsigned int max_votes = 0;
+        // Compute alpha_s angle
+        Eigen::Vector3f scene_point = (*target_)[scene_point_index].getVector3fMap();
 
-    for (std::size_t i = 0; i < accumulator_array.size(); ++i)
-      for (std::size_t j = 0; j < accumulator_array.back().size(); ++j) {
-        if (accumulator_array[i][j] > max_votes) {
-          max_votes = accumulator_array[i][j];
-          max_votes_i = i;
-          max_votes_j = j;
+        Eigen::Vector3f scene_point_transformed = transform_sg * scene_point;
+        float alpha_s =
+            std::atan2(-scene_point_transformed(2), scene_point_transformed(1));
+        if (std::sin(alpha_s) * scene_point_transformed(2) < 0.0f)
+          alpha_s *= (-1);
+        alpha_s *= (-1);
+
+        // Go through point pairs in the model with the same discretized feature
+        for (auto pair_it = nearest_pairs.first; pair_it != nearest_pairs.second;
+             ++pair_it) {
+          std::size_t model_reference_index = pair_it->first;
+          std::size_t model_point_index = pair_it->second;
+          // Calculate angle alpha = alpha_m - alpha_s
+          float alpha =
+              search_method_->alpha_m_[model_reference_index][model_point_index] -
+              alpha_s;
+          unsigned int alpha_discretized = static_cast<unsigned int>(
+              std::floor(alpha) +
+              std::floor(M_PI / search_method_->getAngleDiscretizationStep()));
+          const std::size_t entry =
+              model_reference_index * aux_size + alpha_discretized;
+          if (accumulator_array[entry]++ == 0)
+            voted_entries.push_back(entry);
         }
-        // Reset accumulator_array for the next set of iterations with a new scene
-        // reference point
-        accumulator_array[i][j] = 0;
       }
 
-    Eigen::Vector3f model_reference_point = (*input_)[max_votes_i].getVector3fMap(),
-                    model_reference_normal =
-                        (*input_)[max_votes_i].getNormalVector3fMap();
-    float rotation_angle_mg =
-        std::acos(model_reference_normal.dot(Eigen::Vector3f::UnitX()));
-    bool parallel_to_x_mg =
-        (model_reference_normal.y() == 0.0f && model_reference_normal.z() == 0.0f);
-    Eigen::Vector3f rotation_axis_mg =
-        (parallel_to_x_mg)
-            ? (Eigen::Vector3f::UnitY())
-            : (model_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
-    Eigen::AngleAxisf rotation_mg(rotation_angle_mg, rotation_axis_mg);
-    Eigen::Affine3f transform_mg(
-        Eigen::Translation3f(rotation_mg * ((-1) * model_reference_point)) *
-        rotation_mg);
-    Eigen::Affine3f max_transform =
-        transform_sg.inverse() *
-        Eigen::AngleAxisf((static_cast<float>(max_votes_j) -
-                           std::floor(static_cast<float>(M_PI) /
-                                      search_method_->getAngleDiscretizationStep())) *
-                              search_method_->getAngleDiscretizationStep(),
-                          Eigen::Vector3f::UnitX()) *
-        transform_mg;
-
-    voted_poses.push_back(PoseWithVotes(max_transform, max_votes));
+      // Find the entry with the most votes, the first one in case of a tie, and reset
+      // the accumulator array for the next scene reference point
+      std::size_t max_votes_entry = 0;
+      for (const auto& entry : voted_entries) {
+        if (accumulator_array[entry] > max_votes[reference_i] ||
+            (accumulator_array[entry] == max_votes[reference_i] &&
+             entry < max_votes_entry)) {
+          max_votes[reference_i] = accumulator_array[entry];
+          max_votes_entry = entry;
+        }
+        accumulator_array[entry] = 0;
+      }
+      voted_entries.clear();
+      const std::size_t max_votes_i = max_votes_entry / aux_size,
+                        max_votes_j = max_votes_entry % aux_size;
+
+      Eigen::Vector3f model_reference_point = (*input_)[max_votes_i].getVector3fMap(),
+                      model_reference_normal =
+                          (*input_)[max_votes_i].getNormalVector3fMap();
+      float rotation_angle_mg =
+          std::acos(model_reference_normal.dot(Eigen::Vector3f::UnitX()));
+      bool parallel_to_x_mg =
+          (model_reference_normal.y() == 0.0f && model_reference_normal.z() == 0.0f);
+      Eigen::Vector3f rotation_axis_mg =
+          (parallel_to_x_mg)
+              ? (Eigen::Vector3f::UnitY())
+              : (model_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
+      Eigen::AngleAxisf rotation_mg(rotation_angle_mg, rotation_axis_mg);
+      Eigen::Affine3f transform_mg(
+          Eigen::Translation3f(rotation_mg * ((-1) * model_reference_point)) *
+          rotation_mg);
+      max_transforms[reference_i] =
+          transform_sg.inverse() *
+          Eigen::AngleAxisf((static_cast<float>(max_votes_j) -
+                             std::floor(static_cast<float>(M_PI) /
+                                        search_method_->getAngleDiscretizationStep())) *
+                                search_method_->getAngleDiscretizationStep(),
+                            Eigen::Vector3f::UnitX()) *
+          transform_mg;
+    }
   }
+
+  PoseWithVotesList voted_poses;
+  voted_poses.reserve(nr_scene_reference_points);
+  for (std::ptrdiff_t reference_i = 0; reference_i < nr_scene_reference_points;
+       ++reference_i)
+    voted_poses.push_back(
+        PoseWithVotes(max_transforms[reference_i], max_votes[reference_i]));
   PCL_DEBUG("Done with the Hough Transform ...\n");
 
   // Cluster poses for filtering out outliers and obtaining more precise results
@@ -232,27 +259,66 @@ pcl::PPFRegistration<PointSource, PointTarget>::clusterPoses(
   // Start off by sorting the poses by the number of votes
   sort(poses.begin(), poses.end(), poseWithVotesCompareFunction);
 
+  // The clusters are indexed by the cell of their first pose on a grid with the size
+  // of the position threshold, so that a pose can only belong to the clusters in its
+  // own cell or the neighboring ones
+  struct CellHash {
+    std::size_t
+    operator()(const Eigen::Vector3i& cell) const noexcept
+    {
+      return static_cast<std::size_t>(cell[0]) * 73856093 ^
+             static_cast<std::size_t>(cell[1]) * 19349669 ^
+             static_cast<std::size_t>(cell[2]) * 83492791;
+    }
+  };
+  std::unordered_map<Eigen::Vector3i, std::vector<std::size_t>, CellHash> cell_clusters;
+  const float cell_size = clustering_position_diff_threshold_;
+
   std::vector<PoseWithVotesList> clusters;
   std::vector<std::pair<std::size_t, unsigned int>> cluster_votes;
   for (std::size_t poses_i = 0; poses_i < poses.size(); ++poses_i) {
-    bool found_cluster = false;
-    for (std::size_t clusters_i = 0; clusters_i < clusters.size(); ++clusters_i) {
-      if (posesWithinErrorBounds(poses[poses_i].pose,
-                                 clusters[clusters_i].front().pose)) {
-        found_cluster = true;
-        clusters[clusters_i].push_back(poses[poses_i]);
-        cluster_votes[clusters_i].second += poses[poses_i].votes;
-        break;
-      }
+    // A pose belongs to the first cluster whose first pose is close enough
+    std::size_t cluster_i = clusters.size();
+    Eigen::Vector3i cell = Eigen::Vector3i::Zero();
+    const bool gridded =
+        cell_size > 0.0f && poses[poses_i].pose.translation().allFinite();
+    if (gridded) {
+      cell = (poses[poses_i].pose.translation() / cell_size)
+                 .array()
+                 .floor()
+                 .template cast<int>();
+      for (int dx = -1; dx <= 1; ++dx)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dz = -1; dz <= 1; ++dz) {
+            const auto cell_it = cell_clusters.find(cell + Eigen::Vector3i(dx, dy, dz));
+            if (cell_it == cell_clusters.end())
+              continue;
+            // The clusters of a cell are in creation order
+            for (const auto& candidate : cell_it->second) {
+              if (candidate >= cluster_i)
+                break;
+              if (posesWithinErrorBounds(poses[poses_i].pose,
+                                         clusters[candidate].front().pose)) {
+                cluster_i = candidate;
+                break;
+              }
+            }
+          }
     }
 
-    if (!found_cluster) {
+    if (cluster_i < clusters.size()) {
+      clusters[cluster_i].push_back(poses[poses_i]);
+      cluster_votes[cluster_i].second += poses[poses_i].votes;
+    }
+    else {
       // Create a new cluster with the current pose
       PoseWithVotesList new_cluster;
       new_cluster.push_back(poses[poses_i]);
       clusters.push_back(new_cluster);
       cluster_votes.push_back(std::pair<std::size_t, unsigned int>(
           clusters.size() - 1, poses[poses_i].votes));
+      if (gridded)
+        cell_clusters[cell].push_back(clusters.size() - 1);
     }
   }
 
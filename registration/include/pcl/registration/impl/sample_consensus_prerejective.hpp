@@ -41,6 +41,11 @@
 #ifndef PCL_REGISTRATION_SAMPLE_CONSENSUS_PREREJECTIVE_HPP_
 #define PCL_REGISTRATION_SAMPLE_CONSENSUS_PREREJECTIVE_HPP_
 
+#include <pcl/common/transforms.h>
+
+#include <cmath>
+#include <cstdlib>
+
 namespace pcl {
 
 template <typename PointSource, typename PointTarget, typename FeatureT>
@@ -75,7 +80,10 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::setTargetFeatur
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::selectSamples(
-    const PointCloudSource& cloud, int nr_samples, std::vector<int>& sample_indices)
+    const PointCloudSource& cloud,
+    int nr_samples,
+    std::vector<int>& sample_indices,
+    std::mt19937& rng)
 {
   if (nr_samples > static_cast<int>(cloud.size())) {
     PCL_ERROR("[pcl::%s::selectSamples] ", getClassName().c_str());
@@ -92,7 +100,7 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::selectSamples(
   // Draw random samples until n samples is reached
   for (int i = 0; i < nr_samples; i++) {
     // Select a random number
-    sample_indices[i] = getRandomIndex(static_cast<int>(cloud.size()) - i);
+    sample_indices[i] = getRandomIndex(static_cast<int>(cloud.size()) - i, rng);
 
     // Run trough list of numbers, starting at the lowest, to avoid duplicates
     for (int j = 0; j < i; j++) {
@@ -120,7 +128,8 @@ void
 SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::findSimilarFeatures(
     const std::vector<int>& sample_indices,
     std::vector<std::vector<int>>& similar_features,
-    std::vector<int>& corresponding_indices)
+    std::vector<int>& corresponding_indices,
+    std::mt19937& rng)
 {
   // Allocate results
   corresponding_indices.resize(sample_indices.size());
@@ -131,21 +140,23 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::findSimilarFeat
     // Current feature index
     const int idx = sample_indices[i];
 
+    // Select one of the neighbors at random, before entering the critical section so
+    // that the draws do not depend on the cache
+    const int random_correspondence =
+        (k_correspondences_ == 1 ? 0 : getRandomIndex(k_correspondences_, rng));
+
     // Find the k nearest feature neighbors to the sampled input feature if they are not
-    // in the cache already
-    if (similar_features[idx].empty())
-      feature_tree_->nearestKSearch(*input_features_,
-                                    idx,
-                                    k_correspondences_,
-                                    similar_features[idx],
-                                    nn_distances);
-
-    // Select one at random and add it to corresponding_indices
-    if (k_correspondences_ == 1)
-      corresponding_indices[i] = similar_features[idx][0];
-    else
-      corresponding_indices[i] =
-          similar_features[idx][getRandomIndex(k_correspondences_)];
+    // in the cache already, and add the selected one to corresponding_indices
+#pragma omp critical(similar_features)
+    {
+      if (similar_features[idx].empty())
+        feature_tree_->nearestKSearch(*input_features_,
+                                      idx,
+                                      k_correspondences_,
+                                      similar_features[idx],
+                                      nn_distances);
+      corresponding_indices[i] = similar_features[idx][random_correspondence];
+    }
   }
 }
 
@@ -221,15 +232,12 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::computeTransfor
   float lowest_error = std::numeric_limits<float>::max();
   converged_ = false;
 
-  // Temporaries
-  std::vector<int> inliers;
-  float inlier_fraction;
-  float error;
-
   // If guess is not the Identity matrix we check it
   if (!guess.isApprox(Eigen::Matrix4f::Identity(), 0.01f)) {
+    std::vector<int> inliers;
+    float error;
     getFitness(inliers, error);
-    inlier_fraction =
+    const float inlier_fraction =
         static_cast<float>(inliers.size()) / static_cast<float>(input_->size());
 
     if (inlier_fraction >= inlier_fraction_ && error < lowest_error) {
@@ -242,51 +250,107 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::computeTransfor
   // Feature correspondence cache
   std::vector<std::vector<int>> similar_features(input_->size());
 
+  // The iterations are drawn in blocks, each with its own random number generator.
+  // The blocks of a round are evaluated in parallel and merged in order, and the
+  // maximum number of iterations is only lowered in between, always to a whole number
+  // of blocks, which makes the result independent of the number of threads.
+  unsigned int seed = static_cast<unsigned int>(std::rand());
+  int nr_iterations = max_iterations_;
+  int nr_threads = static_cast<int>(threads_);
+  std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>> block_transformations(
+      nr_threads);
+  std::vector<std::vector<int>> block_inliers(nr_threads);
+  std::vector<float> block_errors(nr_threads);
+  std::vector<int> block_rejections(nr_threads);
+  const double log_probability = std::log(1.0 - probability_);
+
   // Start
-  for (int i = 0; i < max_iterations_; ++i) {
-    // Temporary containers
-    std::vector<int> sample_indices;
-    std::vector<int> corresponding_indices;
-
-    // Draw nr_samples_ random samples
-    selectSamples(*input_, nr_samples_, sample_indices);
-
-    // Find corresponding features in the target cloud
-    findSimilarFeatures(sample_indices, similar_features, corresponding_indices);
-
-    // Apply prerejection
-    if (!correspondence_rejector_poly_->thresholdPolygon(sample_indices,
-                                                         corresponding_indices)) {
-      ++num_rejections;
-      continue;
+  for (int first_block = 0; first_block * iterations_block_size_ < nr_iterations;
+       first_block += nr_threads) {
+#pragma omp parallel for default(none)                                                 \
+    shared(similar_features, seed, nr_iterations, first_block, nr_threads,             \
+           block_transformations, block_inliers, block_errors, block_rejections)       \
+    num_threads(threads_) schedule(dynamic, 1)
+    for (int block = first_block; block < first_block + nr_threads; ++block) {
+      const int b = block - first_block;
+      block_errors[b] = std::numeric_limits<float>::max();
+      block_rejections[b] = 0;
+      if (block * iterations_block_size_ >= nr_iterations)
+        continue;
+
+      std::seed_seq seed_sequence{seed, static_cast<unsigned int>(block)};
+      std::mt19937 rng(seed_sequence);
+
+      // Temporary containers
+      std::vector<int> sample_indices;
+      std::vector<int> corresponding_indices;
+      std::vector<int> inliers;
+      Matrix4 transformation;
+      float error;
+
+      const int end = std::min((block + 1) * iterations_block_size_, nr_iterations);
+      for (int i = block * iterations_block_size_; i < end; ++i) {
+        // Draw nr_samples_ random samples
+        selectSamples(*input_, nr_samples_, sample_indices, rng);
+
+        // Find corresponding features in the target cloud
+        findSimilarFeatures(
+            sample_indices, similar_features, corresponding_indices, rng);
+
+        // Apply prerejection
+        if (!correspondence_rejector_poly_->thresholdPolygon(sample_indices,
+                                                             corresponding_indices)) {
+          ++block_rejections[b];
+          continue;
+        }
+
+        // Estimate the transform from the correspondences
+        transformation_estimation_->estimateRigidTransformation(
+            *input_, sample_indices, *target_, corresponding_indices, transformation);
+
+        // Transform the input and compute the error
+        getFitness(transformation, inliers, error);
+
+        // Keep the best pose hypothesis of the block
+        const float inlier_fraction =
+            static_cast<float>(inliers.size()) / static_cast<float>(input_->size());
+        if (inlier_fraction >= inlier_fraction_ && error < block_errors[b]) {
+          block_inliers[b].swap(inliers);
+          block_errors[b] = error;
+          block_transformations[b] = transformation;
+        }
+      }
     }
 
-    // Estimate the transform from the correspondences, write to transformation_
-    transformation_estimation_->estimateRigidTransformation(
-        *input_, sample_indices, *target_, corresponding_indices, transformation_);
-
-    // Take a backup of previous result
-    const Matrix4 final_transformation_prev = final_transformation_;
-
-    // Set final result to current transformation
-    final_transformation_ = transformation_;
-
-    // Transform the input and compute the error (uses input_ and final_transformation_)
-    getFitness(inliers, error);
-
-    // Restore previous result
-    final_transformation_ = final_transformation_prev;
-
-    // If the new fit is better, update results
-    inlier_fraction =
-        static_cast<float>(inliers.size()) / static_cast<float>(input_->size());
-
-    // Update result if pose hypothesis is better
-    if (inlier_fraction >= inlier_fraction_ && error < lowest_error) {
-      inliers_ = inliers;
-      lowest_error = error;
+    // Update the result with the blocks in order, as long as they are within the
+    // number of iterations
+    for (int b = 0; b < nr_threads &&
+                    (first_block + b) * iterations_block_size_ < nr_iterations;
+         ++b) {
+      num_rejections += block_rejections[b];
+      if (block_errors[b] >= lowest_error)
+        continue;
+
+      inliers_.swap(block_inliers[b]);
+      lowest_error = block_errors[b];
       converged_ = true;
-      final_transformation_ = transformation_;
+      final_transformation_ = block_transformations[b];
+
+      if (probability_ > 0.0) {
+        // Compute the number of iterations needed to reach the desired probability
+        const double w =
+            static_cast<double>(inliers_.size()) / static_cast<double>(input_->size());
+        double p_no_outliers = 1.0 - std::pow(w, static_cast<double>(nr_samples_));
+        // Avoid division by -Inf and by 0
+        p_no_outliers = std::max(std::numeric_limits<double>::epsilon(), p_no_outliers);
+        p_no_outliers =
+            std::min(1.0 - std::numeric_limits<double>::epsilon(), p_no_outliers);
+        const double k = std::ceil(log_probability / std::log(p_no_outliers) /
+                                   iterations_block_size_) *
+                         iterations_block_size_;
+        if (k < nr_iterations)
+          nr_iterations = static_cast<int>(k);
+      }
     }
   }
 
@@ -299,13 +363,23 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::computeTransfor
             "hypotheses.\n",
             getClassName().c_str(),
             num_rejections,
-            max_iterations_);
+            nr_iterations);
 }
 
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::getFitness(
     std::vector<int>& inliers, float& fitness_score)
+{
+  getFitness(final_transformation_, inliers, fitness_score);
+}
+
+template <typename PointSource, typename PointTarget, typename FeatureT>
+void
+SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::getFitness(
+    const Matrix4& transformation,
+    std::vector<int>& inliers,
+    float& fitness_score) const
 {
   // Initialize variables
   inliers.clear();
@@ -315,26 +389,42 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::getFitness(
   // Use squared distance for comparison with NN search results
   const float max_range = corr_dist_threshold_ * corr_dist_threshold_;
 
-  // Transform the input dataset using the final transformation
-  PointCloudSource input_transformed;
-  input_transformed.resize(input_->size());
-  transformPointCloud(*input_, input_transformed, final_transformation_);
+  // The number of outliers above which the inlier fraction cannot be reached anymore
+  const std::size_t max_outliers =
+      input_->size() -
+      static_cast<std::size_t>(std::ceil(inlier_fraction_ * input_->size()));
+  std::size_t nr_outliers = 0;
+
+  // Transform the points one at a time, so that the evaluation can stop early
+  const pcl::detail::Transformer<float> tf(transformation);
+  std::vector<int> nn_indices(1);
+  std::vector<float> nn_dists(1);
 
   // For each point in the source dataset
-  for (std::size_t i = 0; i < input_transformed.size(); ++i) {
-    // Find its nearest neighbor in the target
-    std::vector<int> nn_indices(1);
-    std::vector<float> nn_dists(1);
-    tree_->nearestKSearch(input_transformed[i], 1, nn_indices, nn_dists);
+  for (std::size_t i = 0; i < input_->size(); ++i) {
+    // Non-finite points are never inliers
+    bool inlier = false;
+    if (input_->is_dense || isFinite((*input_)[i])) {
+      PointSource point_transformed = (*input_)[i];
+      tf.se3(point_transformed.data, point_transformed.data);
+
+      // Find its nearest neighbor in the target
+      tree_->nearestKSearch(point_transformed, 1, nn_indices, nn_dists);
+      inlier = nn_dists[0] < max_range;
+    }
 
     // Check if point is an inlier
-    if (nn_dists[0] < max_range) {
+    if (inlier) {
       // Update inliers
       inliers.push_back(static_cast<int>(i));
 
       // Update fitness score
       fitness_score += nn_dists[0];
     }
+    else if (++nr_outliers > max_outliers) {
+      fitness_score = std::numeric_limits<float>::max();
+      return;
+    }
   }
 
   // Calculate MSE
@@ -0,0 +1,132 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_REGISTRATION_TARGET_MODEL_IMPL_H_
+#define PCL_REGISTRATION_TARGET_MODEL_IMPL_H_
+
+#include <pcl/features/normal_3d_omp.h>
+
+namespace pcl {
+namespace registration {
+
+template <typename PointTarget>
+TargetModel<PointTarget>::TargetModel(const PointCloudTargetConstPtr& target)
+: target_(target), tree_(new KdTree)
+{
+  tree_->setInputCloud(target_);
+}
+
+template <typename PointTarget>
+void
+TargetModel<PointTarget>::computeNormals(int k, unsigned int nr_threads)
+{
+  pcl::NormalEstimationOMP<PointTarget, PointTarget> ne(nr_threads);
+  ne.setInputCloud(target_);
+  ne.setSearchMethod(tree_);
+  ne.setKSearch(k);
+
+  // Only the normals and curvatures of the copy are overwritten
+  PointCloudTargetPtr target(new PointCloudTarget(*target_));
+  ne.compute(*target);
+  target_ = target;
+
+  tree_.reset(new KdTree);
+  tree_->setInputCloud(target_);
+}
+
+template <typename PointTarget>
+void
+TargetModel<PointTarget>::computeCovariances(int k, unsigned int nr_threads)
+{
+  GeneralizedIterativeClosestPoint<PointTarget, PointTarget> gicp;
+  gicp.setCorrespondenceRandomness(k);
+  gicp.setNumberOfThreads(nr_threads);
+
+  MatricesVectorPtr covariances(new MatricesVector);
+  gicp.template computeCovariances<PointTarget>(target_, tree_, *covariances);
+  covariances_ = covariances;
+}
+
+template <typename PointTarget>
+void
+TargetModel<PointTarget>::computeTargetPyramid(const std::vector<float>& resolutions)
+{
+  TargetPyramidPtr pyramid(new TargetPyramid);
+  pyramid->build(target_, resolutions);
+  target_pyramid_ = pyramid;
+}
+
+template <typename PointTarget>
+template <typename PointSource, typename Scalar>
+void
+TargetModel<PointTarget>::apply(
+    Registration<PointSource, PointTarget, Scalar>& reg) const
+{
+  reg.setInputTarget(target_);
+  // The tree is already built on target_, and must not be rebuilt while it is used by
+  // other registration objects
+  reg.setSearchMethodTarget(tree_, true);
+}
+
+template <typename PointTarget>
+template <typename PointSource>
+void
+TargetModel<PointTarget>::apply(
+    GeneralizedIterativeClosestPoint<PointSource, PointTarget>& reg) const
+{
+  apply<PointSource, float>(reg);
+  if (covariances_)
+    reg.setTargetCovariances(covariances_);
+}
+
+template <typename PointTarget>
+template <typename PointSource>
+void
+TargetModel<PointTarget>::apply(
+    NormalDistributionsTransformMultiResolution<PointSource, PointTarget>& reg) const
+{
+  apply<PointSource, float>(reg);
+  if (target_pyramid_)
+    reg.setTargetPyramid(target_pyramid_);
+}
+
+} // namespace registration
+} // namespace pcl
+
+#endif // PCL_REGISTRATION_TARGET_MODEL_IMPL_H_
@@ -0,0 +1,291 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/cloud_iterator.h>
+
+#include <algorithm>
+
+namespace pcl {
+
+namespace registration {
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+inline void
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                                const pcl::PointCloud<PointTarget>& cloud_tgt,
+                                Matrix4& transformation_matrix) const
+{
+  const auto nr_points = cloud_src.size();
+  if (cloud_tgt.size() != nr_points) {
+    PCL_ERROR("[pcl::TransformationEstimationPointToPlaneRobust::"
+              "estimateRigidTransformation] Number or points in source (%zu) differs "
+              "from target (%zu)!\n",
+              static_cast<std::size_t>(nr_points),
+              static_cast<std::size_t>(cloud_tgt.size()));
+    return;
+  }
+
+  ConstCloudIterator<PointSource> source_it(cloud_src);
+  ConstCloudIterator<PointTarget> target_it(cloud_tgt);
+  estimateRigidTransformation(source_it, target_it, transformation_matrix);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                                const std::vector<int>& indices_src,
+                                const pcl::PointCloud<PointTarget>& cloud_tgt,
+                                Matrix4& transformation_matrix) const
+{
+  const auto nr_points = indices_src.size();
+  if (cloud_tgt.size() != nr_points) {
+    PCL_ERROR("[pcl::TransformationEstimationPointToPlaneRobust::"
+              "estimateRigidTransformation] Number or points in source (%zu) differs "
+              "than target (%zu)!\n",
+              nr_points,
+              static_cast<std::size_t>(cloud_tgt.size()));
+    return;
+  }
+
+  ConstCloudIterator<PointSource> source_it(cloud_src, indices_src);
+  ConstCloudIterator<PointTarget> target_it(cloud_tgt);
+  estimateRigidTransformation(source_it, target_it, transformation_matrix);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+inline void
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                                const std::vector<int>& indices_src,
+                                const pcl::PointCloud<PointTarget>& cloud_tgt,
+                                const std::vector<int>& indices_tgt,
+                                Matrix4& transformation_matrix) const
+{
+  const auto nr_points = indices_src.size();
+  if (indices_tgt.size() != nr_points) {
+    PCL_ERROR("[pcl::TransformationEstimationPointToPlaneRobust::"
+              "estimateRigidTransformation] Number or points in source (%zu) differs "
+              "than target (%zu)!\n",
+              nr_points,
+              indices_tgt.size());
+    return;
+  }
+
+  ConstCloudIterator<PointSource> source_it(cloud_src, indices_src);
+  ConstCloudIterator<PointTarget> target_it(cloud_tgt, indices_tgt);
+  estimateRigidTransformation(source_it, target_it, transformation_matrix);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+inline void
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                                const pcl::PointCloud<PointTarget>& cloud_tgt,
+                                const pcl::Correspondences& correspondences,
+                                Matrix4& transformation_matrix) const
+{
+  ConstCloudIterator<PointSource> source_it(cloud_src, correspondences, true);
+  ConstCloudIterator<PointTarget> target_it(cloud_tgt, correspondences, false);
+  estimateRigidTransformation(source_it, target_it, transformation_matrix);
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+inline double
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    computeWeight(double residual, double width) const
+{
+  if (!(width > 0.))
+    return (1.);
+
+  const double u = residual / width;
+  switch (kernel_) {
+  case RobustKernel::HUBER:
+    return (std::abs(u) <= 1. ? 1. : 1. / std::abs(u));
+  case RobustKernel::CAUCHY:
+    return (1. / (1. + u * u));
+  case RobustKernel::GEMAN_MCCLURE:
+    return (1. / ((1. + u * u) * (1. + u * u)));
+  case RobustKernel::TUKEY:
+    return (std::abs(u) < 1. ? (1. - u * u) * (1. - u * u) : 0.);
+  default:
+    return (1.);
+  }
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationPointToPlaneRobust<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformation(ConstCloudIterator<PointSource>& source_it,
+                                ConstCloudIterator<PointTarget>& target_it,
+                                Matrix4& transformation_matrix) const
+{
+  using Vector6d = Eigen::Matrix<double, 6, 1>;
+  using Matrix6d = Eigen::Matrix<double, 6, 6>;
+
+  // collect the valid correspondences
+  std::vector<Eigen::Vector3d> points, targets, normals;
+  points.reserve(source_it.size());
+  targets.reserve(source_it.size());
+  normals.reserve(source_it.size());
+  source_it.reset();
+  target_it.reset();
+  for (; source_it.isValid() && target_it.isValid(); ++source_it, ++target_it) {
+    if (!std::isfinite(source_it->x) || !std::isfinite(source_it->y) ||
+        !std::isfinite(source_it->z) || !std::isfinite(target_it->x) ||
+        !std::isfinite(target_it->y) || !std::isfinite(target_it->z) ||
+        !std::isfinite(target_it->normal_x) || !std::isfinite(target_it->normal_y) ||
+        !std::isfinite(target_it->normal_z))
+      continue;
+
+    points.emplace_back(source_it->x, source_it->y, source_it->z);
+    targets.emplace_back(target_it->x, target_it->y, target_it->z);
+    normals.emplace_back(
+        target_it->normal_x, target_it->normal_y, target_it->normal_z);
+  }
+
+  Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+  int nr_points = static_cast<int>(points.size());
+  int nr_blocks = (nr_points + block_size_ - 1) / block_size_;
+  std::vector<double> residuals(nr_points), abs_residuals;
+  std::vector<Matrix6d, Eigen::aligned_allocator<Matrix6d>> blocks_ATA(nr_blocks);
+  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d>> blocks_ATb(nr_blocks);
+
+  for (int iteration = 0; iteration < max_iterations_ && nr_points > 0; ++iteration) {
+    Eigen::Matrix3d rotation = transformation.topLeftCorner<3, 3>();
+    Eigen::Vector3d translation = transformation.topRightCorner<3, 1>();
+
+    // signed point-to-plane residuals of the current estimate
+#pragma omp parallel for default(none)                                                 \
+    shared(nr_points, normals, points, residuals, rotation, targets, translation)      \
+    num_threads(threads_)
+    for (int i = 0; i < nr_points; ++i)
+      residuals[i] = normals[i].dot(rotation * points[i] + translation - targets[i]);
+
+    // robust estimate of the residual scale (median absolute deviation)
+    double width = kernel_width_;
+    if (kernel_ != RobustKernel::NONE && !(width > 0.)) {
+      abs_residuals.resize(nr_points);
+      double mean_abs_residual = 0.;
+      for (int i = 0; i < nr_points; ++i) {
+        abs_residuals[i] = std::abs(residuals[i]);
+        mean_abs_residual += abs_residuals[i];
+      }
+      mean_abs_residual /= nr_points;
+      auto it_median = abs_residuals.begin() + nr_points / 2;
+      std::nth_element(abs_residuals.begin(), it_median, abs_residuals.end());
+
+      // if more than half of the residuals are exactly zero the median is zero too,
+      // which would switch the kernel off, so the scale is kept above a small fraction
+      // of the mean absolute residual
+      const double min_scale = min_scale_to_mean_ratio_ * mean_abs_residual;
+      const double scale = std::max(*it_median, min_scale);
+
+      double tuning = 1.;
+      if (kernel_ == RobustKernel::HUBER)
+        tuning = 1.345;
+      else if (kernel_ == RobustKernel::CAUCHY)
+        tuning = 2.3849;
+      else if (kernel_ == RobustKernel::TUKEY)
+        tuning = 4.6851;
+      width = tuning * 1.4826 * scale;
+    }
+
+    // accumulate the weighted normal equations in fixed blocks, so the summation order
+    // does not depend on the number of threads
+#pragma omp parallel for default(none)                                                 \
+    shared(blocks_ATA,                                                                 \
+           blocks_ATb,                                                                 \
+           nr_blocks,                                                                  \
+           nr_points,                                                                  \
+           normals,                                                                    \
+           points,                                                                     \
+           residuals,                                                                  \
+           rotation,                                                                   \
+           translation,                                                                \
+           width)                                                                      \
+    num_threads(threads_)
+    for (int block = 0; block < nr_blocks; ++block) {
+      Matrix6d& ATA = blocks_ATA[block];
+      Vector6d& ATb = blocks_ATb[block];
+      ATA.setZero();
+      ATb.setZero();
+
+      const int end = std::min(nr_points, (block + 1) * block_size_);
+      for (int i = block * block_size_; i < end; ++i) {
+        const double weight = computeWeight(residuals[i], width);
+        if (weight == 0.)
+          continue;
+
+        Vector6d v;
+        v << (rotation * points[i] + translation).cross(normals[i]), normals[i];
+        ATA.noalias() += (weight * v) * v.transpose();
+        ATb -= (weight * residuals[i]) * v;
+      }
+    }
+
+    Matrix6d ATA = Matrix6d::Zero();
+    Vector6d ATb = Vector6d::Zero();
+    for (int block = 0; block < nr_blocks; ++block) {
+      ATA += blocks_ATA[block];
+      ATb += blocks_ATb[block];
+    }
+
+    // Solve A*x = b and apply the increment (rotation about x, y, z and translation)
+    const Vector6d x = ATA.ldlt().solve(ATb);
+    if (!x.allFinite())
+      break;
+
+    const Eigen::Affine3d increment =
+        Eigen::Translation3d(x.tail<3>()) *
+        Eigen::AngleAxisd(x(2), Eigen::Vector3d::UnitZ()) *
+        Eigen::AngleAxisd(x(1), Eigen::Vector3d::UnitY()) *
+        Eigen::AngleAxisd(x(0), Eigen::Vector3d::UnitX());
+    transformation = increment.matrix() * transformation;
+
+    if (x.squaredNorm() < 1e-12)
+      break;
+  }
+
+  transformation_matrix = transformation.cast<Scalar>();
+}
+
+} // namespace registration
+} // namespace pcl
@@ -140,7 +140,12 @@ public:
 
   /** \brief Empty constructor.
    */
-  LUM() : slam_graph_(new SLAMGraph), max_iterations_(5), convergence_threshold_(0.0) {}
+  LUM()
+  : slam_graph_(new SLAMGraph)
+  , max_iterations_(5)
+  , convergence_threshold_(0.0)
+  , threads_(1)
+  {}
 
   /** \brief Set the internal SLAM graph structure.
    * \details All data used and produced by LUM is stored in this boost::adjacency_list.
@@ -202,6 +207,19 @@ public:
   inline float
   getConvergenceThreshold() const;
 
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * \details The edges of the SLAM graph are linearized in parallel.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Return the number of threads used. */
+  inline unsigned int
+  getNumberOfThreads() const;
+
   /** \brief Add a new point cloud to the SLAM graph.
    * \details This method will add a new vertex to the SLAM graph and attach a point
    * cloud to that vertex. Optionally you can specify a pose estimate for this point
@@ -348,6 +366,9 @@ private:
 
   /** \brief The convergence threshold for the summed vector lengths of all poses. */
   float convergence_threshold_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace registration
 } // namespace pcl
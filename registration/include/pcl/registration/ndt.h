@@ -89,6 +89,19 @@ public:
   using ConstPtr =
       shared_ptr<const NormalDistributionsTransform<PointSource, PointTarget>>;
 
+  /** \brief The ways to find the target voxels a transformed source point is scored
+   * against. */
+  enum class NeighborSearchMethod {
+    /** \brief All voxels whose centroid is within the resolution (kd-tree search) */
+    KDTREE,
+    /** \brief The voxel containing the point and its 26 neighbors */
+    DIRECT26,
+    /** \brief The voxel containing the point and its 6 face neighbors */
+    DIRECT7,
+    /** \brief Only the voxel containing the point */
+    DIRECT1
+  };
+
   /** \brief Constructor.
    * Sets \ref outlier_ratio_ to 0.35, \ref step_size_ to 0.05 and \ref resolution_
    * to 1.0
@@ -168,6 +181,50 @@ public:
     outlier_ratio_ = outlier_ratio;
   }
 
+  /** \brief Set the way the target voxels a source point is scored against are
+   * found. The DIRECT methods look the voxels up by their index and do not use the
+   * kd-tree. Default: KDTREE.
+   * \param[in] method the neighbor search method
+   */
+  inline void
+  setNeighborSearchMethod(NeighborSearchMethod method)
+  {
+    search_method_ = method;
+  }
+
+  /** \brief Get the way the target voxels a source point is scored against are found.
+   */
+  inline NeighborSearchMethod
+  getNeighborSearchMethod() const
+  {
+    return search_method_;
+  }
+
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value
+   * back to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
   /** \brief Get the registration alignment probability.
    * \return transformation probability
    */
@@ -289,6 +346,28 @@ protected:
                     const Eigen::Matrix3d& c_inv,
                     bool compute_hessian = true) const;
 
+  /** \brief Compute individual point contirbutions to derivatives of probability
+   * function w.r.t. the transformation vector, using the given point derivatives
+   * instead of \ref point_jacobian_ and \ref point_hessian_.
+   * \param[in,out] score_gradient the gradient vector of the probability function
+   * w.r.t. the transformation vector \param[in,out] hessian the hessian matrix of the
+   * probability function w.r.t. the transformation vector \param[in] point_jacobian
+   * the first order derivative of the transformation of the point \param[in]
+   * point_hessian the second order derivative of the transformation of the point
+   * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+   * \param[in] c_inv covariance of occupied covariance voxel
+   * \param[in] compute_hessian flag to calculate hessian, unnessissary for step
+   * calculation.
+   */
+  double
+  updateDerivatives(Eigen::Matrix<double, 6, 1>& score_gradient,
+                    Eigen::Matrix<double, 6, 6>& hessian,
+                    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                    const Eigen::Matrix<double, 18, 6>& point_hessian,
+                    const Eigen::Vector3d& x_trans,
+                    const Eigen::Matrix3d& c_inv,
+                    bool compute_hessian = true) const;
+
   /** \brief Precompute anglular components of derivatives.
    * \note Equation 6.19 and 6.21 [Magnusson 2009].
    * \param[in] transform the current transform vector
@@ -308,6 +387,22 @@ protected:
   void
   computePointDerivatives(const Eigen::Vector3d& x, bool compute_hessian = true);
 
+  /** \brief Compute point derivatives into the given matrices.
+   * \note Equation 6.18-21 [Magnusson 2009].
+   * \param[in] x point from the input cloud
+   * \param[in,out] point_jacobian \f$ J_E \f$ in Equation 6.18 (only the angular
+   * entries are written)
+   * \param[in,out] point_hessian \f$ H_E \f$ in Equation 6.20 (only the angular
+   * entries are written)
+   * \param[in] compute_hessian flag to calculate hessian, unnessissary for step
+   * calculation.
+   */
+  void
+  computePointDerivatives(const Eigen::Vector3d& x,
+                          Eigen::Matrix<double, 3, 6>& point_jacobian,
+                          Eigen::Matrix<double, 18, 6>& point_hessian,
+                          bool compute_hessian = true) const;
+
   /** \brief Compute hessian of probability function w.r.t. the transformation vector.
    * \note Equation 6.13 [Magnusson 2009].
    * \param[out] hessian the hessian matrix of the probability function w.r.t. the
@@ -344,6 +439,35 @@ protected:
                 const Eigen::Vector3d& x_trans,
                 const Eigen::Matrix3d& c_inv) const;
 
+  /** \brief Compute individual point contirbutions to hessian of probability function
+   * w.r.t. the transformation vector, using the given point derivatives instead of
+   * \ref point_jacobian_ and \ref point_hessian_.
+   * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the
+   * transformation vector \param[in] point_jacobian the first order derivative of the
+   * transformation of the point \param[in] point_hessian the second order derivative
+   * of the transformation of the point \param[in] x_trans transformed point minus mean
+   * of occupied covariance voxel \param[in] c_inv covariance of occupied covariance
+   * voxel
+   */
+  void
+  updateHessian(Eigen::Matrix<double, 6, 6>& hessian,
+                const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                const Eigen::Matrix<double, 18, 6>& point_hessian,
+                const Eigen::Vector3d& x_trans,
+                const Eigen::Matrix3d& c_inv) const;
+
+  /** \brief Find the target voxels a transformed point is scored against, according
+   * to \ref search_method_.
+   * \param[in] x_trans_pt transformed point
+   * \param[out] neighborhood the voxels found
+   * \param[out] distances the squared distances to the voxel centroids (kd-tree search
+   * only)
+   */
+  void
+  getNeighborhood(const PointSource& x_trans_pt,
+                  std::vector<TargetGridLeafConstPtr>& neighborhood,
+                  std::vector<float>& distances) const;
+
   /** \brief Compute line search step length and update transform and probability
    * derivatives using More-Thuente method. \note Search Algorithm [More, Thuente 1994]
    * \param[in] transform initial transformation vector, \f$ x \f$ in Equation 1.3
@@ -469,6 +593,10 @@ protected:
    * covariances. */
   TargetGrid target_cells_;
 
+  /** \brief A voxel grid of the target searched instead of \ref target_cells_ when
+   * set, e.g. a level of a pyramid of grids built once for the target. */
+  shared_ptr<const TargetGrid> external_target_cells_;
+
   /** \brief The side length of voxels. */
   float resolution_;
 
@@ -509,6 +637,16 @@ protected:
    * transform vector, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]. */
   Eigen::Matrix<double, 18, 6> point_hessian_;
 
+  /** \brief The way the target voxels a source point is scored against are found. */
+  NeighborSearchMethod search_method_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief The number of source points whose contributions to the derivatives are
+   * summed together before being added up in order. */
+  static constexpr std::ptrdiff_t derivatives_block_size_ = 256;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -0,0 +1,254 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/ndt.h>
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace pcl {
+/** \brief A pyramid of VoxelGridCovariance grids of the same cloud, one per
+ * resolution. The grids are built once and can then be shared read-only between
+ * registration objects, or serialized alongside the cloud and restored without
+ * filtering it again.
+ * \ingroup registration
+ */
+template <typename PointT>
+class VoxelGridCovariancePyramid {
+public:
+  using Ptr = shared_ptr<VoxelGridCovariancePyramid<PointT>>;
+  using ConstPtr = shared_ptr<const VoxelGridCovariancePyramid<PointT>>;
+
+  using Grid = VoxelGridCovariance<PointT>;
+  using GridConstPtr = shared_ptr<const Grid>;
+  using PointCloudConstPtr = typename PointCloud<PointT>::ConstPtr;
+
+  /** \brief Build one searchable voxel grid of \a cloud per resolution.
+   * \param[in] cloud the cloud to build the grids from
+   * \param[in] resolutions the side lengths of the voxels of each level
+   */
+  void
+  build(const PointCloudConstPtr& cloud, const std::vector<float>& resolutions);
+
+  /** \brief Get the number of levels of the pyramid. */
+  inline std::size_t
+  size() const
+  {
+    return levels_.size();
+  }
+
+  /** \brief Get the side lengths of the voxels of each level. */
+  inline const std::vector<float>&
+  getResolutions() const
+  {
+    return resolutions_;
+  }
+
+  /** \brief Get the grid of the given level.
+   * \param[in] level the level of the pyramid
+   */
+  inline GridConstPtr
+  getLevel(std::size_t level) const
+  {
+    return levels_[level];
+  }
+
+  /** \brief Write the pyramid to a binary stream, see
+   * VoxelGridCovariance::serialize().
+   * \param[out] stream the output stream
+   */
+  void
+  serialize(std::ostream& stream) const;
+
+  /** \brief Restore a pyramid written by serialize().
+   * \param[in] stream the input stream
+   * \return true if the pyramid could be read
+   */
+  bool
+  deserialize(std::istream& stream);
+
+protected:
+  /** \brief The side lengths of the voxels of each level. */
+  std::vector<float> resolutions_;
+
+  /** \brief The voxel grids, one per level. */
+  std::vector<GridConstPtr> levels_;
+};
+
+/** \brief A coarse-to-fine NormalDistributionsTransform. The target is represented
+ * by a pyramid of voxel grids, one per resolution given to setResolutions(), which is
+ * built by the first call to align() after the target is set and reused for every
+ * source aligned to it afterwards. Each
+ * call to align() optimizes the transformation on every level, from the first
+ * (coarsest) to the last (finest), each level starting from the result of the
+ * previous one. The maximum number of iterations applies to each level.
+ *
+ * The pyramid can be shared with other registration objects aligning to the same
+ * target with getTargetPyramid() and setTargetPyramid(), or serialized with
+ * VoxelGridCovariancePyramid::serialize().
+ * \ingroup registration
+ */
+template <typename PointSource, typename PointTarget>
+class NormalDistributionsTransformMultiResolution
+: public NormalDistributionsTransform<PointSource, PointTarget> {
+protected:
+  using PointCloudSource =
+      typename NormalDistributionsTransform<PointSource, PointTarget>::PointCloudSource;
+  using PointCloudTargetConstPtr = typename NormalDistributionsTransform<PointSource,
+                                                                        PointTarget>::
+      PointCloudTargetConstPtr;
+
+public:
+  using Ptr =
+      shared_ptr<NormalDistributionsTransformMultiResolution<PointSource, PointTarget>>;
+  using ConstPtr = shared_ptr<
+      const NormalDistributionsTransformMultiResolution<PointSource, PointTarget>>;
+
+  using TargetPyramid = VoxelGridCovariancePyramid<PointTarget>;
+  using TargetPyramidPtr = typename TargetPyramid::Ptr;
+  using TargetPyramidConstPtr = typename TargetPyramid::ConstPtr;
+
+  /** \brief Constructor. */
+  NormalDistributionsTransformMultiResolution()
+  {
+    reg_name_ = "NormalDistributionsTransformMultiResolution";
+  }
+
+  /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
+   * to align the input source to). Its pyramid of voxel grids (or, without resolutions
+   * set, its single grid as in NormalDistributionsTransform) is built by the next call
+   * to align(), unless a pyramid was given with setTargetPyramid().
+   * \param[in] cloud the input point cloud target
+   */
+  inline void
+  setInputTarget(const PointCloudTargetConstPtr& cloud) override
+  {
+    Registration<PointSource, PointTarget>::setInputTarget(cloud);
+    target_grids_updated_ = true;
+  }
+
+  /** \brief Set the side lengths of the voxels of each level of the pyramid, from the
+   * coarsest to the finest. The pyramid is rebuilt by the next call to align(), also
+   * if it was given with setTargetPyramid().
+   * \param[in] resolutions the side lengths of the voxels of each level
+   */
+  inline void
+  setResolutions(const std::vector<float>& resolutions)
+  {
+    resolutions_ = resolutions;
+    target_pyramid_given_ = false;
+    target_grids_updated_ = true;
+  }
+
+  /** \brief Get the side lengths of the voxels of each level of the pyramid. */
+  inline const std::vector<float>&
+  getResolutions() const
+  {
+    return resolutions_;
+  }
+
+  /** \brief Use a pyramid built elsewhere for the target, e.g. by another
+   * registration object or restored from a stream, instead of building one. The
+   * pyramid must have been built from the input target, and replaces the resolutions.
+   * It is kept when the input target is set, before or after it.
+   * \param[in] pyramid the pyramid of voxel grids of the input target
+   */
+  inline void
+  setTargetPyramid(const TargetPyramidConstPtr& pyramid)
+  {
+    target_pyramid_ = pyramid;
+    resolutions_ = pyramid->getResolutions();
+    target_pyramid_given_ = true;
+  }
+
+  /** \brief Get the pyramid of voxel grids of the input target, or nullptr if it has
+   * not been built by align() nor given with setTargetPyramid() yet. */
+  inline TargetPyramidConstPtr
+  getTargetPyramid() const
+  {
+    return target_pyramid_;
+  }
+
+protected:
+  using NormalDistributionsTransform<PointSource, PointTarget>::reg_name_;
+  using NormalDistributionsTransform<PointSource, PointTarget>::getClassName;
+  using NormalDistributionsTransform<PointSource, PointTarget>::target_;
+  using NormalDistributionsTransform<PointSource, PointTarget>::nr_iterations_;
+  using NormalDistributionsTransform<PointSource, PointTarget>::resolution_;
+  using NormalDistributionsTransform<PointSource, PointTarget>::external_target_cells_;
+  using NormalDistributionsTransform<PointSource, PointTarget>::init;
+  using NormalDistributionsTransform<PointSource, PointTarget>::computeTransformation;
+
+  /** \brief Estimate the transformation on each level of the pyramid and returns the
+   * transformed source (input) as output.
+   * \param[out] output the resultant input transformed point cloud dataset
+   * \param[in] guess the initial gross estimation of the transformation
+   */
+  void
+  computeTransformation(PointCloudSource& output,
+                        const Eigen::Matrix4f& guess) override;
+
+  /** \brief Build \ref target_pyramid_ from the input target and \ref resolutions_,
+   * or the single grid of NormalDistributionsTransform if there are no resolutions.
+   * Nothing is built if the grids are up to date or the pyramid was given with
+   * setTargetPyramid(). */
+  void
+  buildTargetPyramid();
+
+  /** \brief The side lengths of the voxels of each level, from the coarsest to the
+   * finest. */
+  std::vector<float> resolutions_;
+
+  /** \brief The pyramid of voxel grids of the input target. */
+  TargetPyramidConstPtr target_pyramid_;
+
+  /** \brief Whether \ref target_pyramid_ was given with setTargetPyramid() instead of
+   * being built from the input target. */
+  bool target_pyramid_given_{false};
+
+  /** \brief Whether the input target or the resolutions changed since the grids were
+   * last built. */
+  bool target_grids_updated_{true};
+};
+} // namespace pcl
+
+#include <pcl/registration/impl/ndt_multi_resolution.hpp>
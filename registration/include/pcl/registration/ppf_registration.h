@@ -44,8 +44,14 @@
 #include <pcl/registration/registration.h>
 
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace pcl {
+/** \brief Search structure for the PPFRegistration class, which groups the point pairs
+ * of the model by their discretized PPF feature. The pairs are stored in flat arrays
+ * sorted by the discretized feature, with the pairs of each bin stored contiguously.
+ */
 class PCL_EXPORTS PPFHashMapSearch {
 public:
   /** \brief Data structure to hold the information for the key in the feature hash map
@@ -74,11 +80,16 @@ public:
       return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3);
     }
   };
-  using FeatureHashMapType =
+  using FeatureHashMapType PCL_DEPRECATED(1, 14, "pairs are stored in flat arrays") =
       std::unordered_multimap<HashKeyStruct,
                               std::pair<std::size_t, std::size_t>,
                               HashKeyStruct>;
-  using FeatureHashMapTypePtr = shared_ptr<FeatureHashMapType>;
+  using FeatureHashMapTypePtr PCL_DEPRECATED(1, 14, "pairs are stored in flat arrays") =
+      shared_ptr<std::unordered_multimap<HashKeyStruct,
+                                         std::pair<std::size_t, std::size_t>,
+                                         HashKeyStruct>>;
+  using PairIndicesConstIterator =
+      std::vector<std::pair<std::size_t, std::size_t>>::const_iterator;
   using Ptr = shared_ptr<PPFHashMapSearch>;
   using ConstPtr = shared_ptr<const PPFHashMapSearch>;
 
@@ -91,8 +102,7 @@ public:
   PPFHashMapSearch(float angle_discretization_step = 12.0f / 180.0f *
                                                      static_cast<float>(M_PI),
                    float distance_discretization_step = 0.01f)
-  : feature_hash_map_(new FeatureHashMapType)
-  , internals_initialized_(false)
+  : internals_initialized_(false)
   , angle_discretization_step_(angle_discretization_step)
   , distance_discretization_step_(distance_discretization_step)
   , max_dist_(-1.0f)
@@ -119,6 +129,19 @@ public:
                         float& f4,
                         std::vector<std::pair<std::size_t, std::size_t>>& indices);
 
+  /** \brief Get the feature pairs in the bin of the discretized hash map corresponding
+   * to the given feature, without copying them. Unlike nearestNeighborSearch(), this
+   * method can be called from several threads at once.
+   * \param[in] f1 The 1st value describing the query PPFSignature feature
+   * \param[in] f2 The 2nd value describing the query PPFSignature feature
+   * \param[in] f3 The 3rd value describing the query PPFSignature feature
+   * \param[in] f4 The 4th value describing the query PPFSignature feature
+   * \return the range of the pair indices (model reference point, model point) in the
+   * bin, empty if the input feature cloud has not been set
+   */
+  std::pair<PairIndicesConstIterator, PairIndicesConstIterator>
+  getPairsInBin(float f1, float f2, float f3, float f4) const;
+
   /** \brief Convenience method for returning a copy of the class instance as a
    * shared_ptr */
   Ptr
@@ -154,7 +177,20 @@ public:
   std::vector<std::vector<float>> alpha_m_;
 
 private:
-  FeatureHashMapTypePtr feature_hash_map_;
+  /** \brief Discretize a feature to the key of its bin. */
+  HashKeyStruct
+  discretizeFeature(float f1, float f2, float f3, float f4) const;
+
+  /** \brief The keys of the bins holding at least one pair, in ascending order. */
+  std::vector<HashKeyStruct> keys_;
+
+  /** \brief The index in \ref pairs_ of the first pair of each bin in \ref keys_,
+   * followed by the total number of pairs. */
+  std::vector<std::size_t> offsets_;
+
+  /** \brief The indices of the feature pairs, grouped by bin. */
+  std::vector<std::pair<std::size_t, std::size_t>> pairs_;
+
   bool internals_initialized_;
 
   float angle_discretization_step_, distance_discretization_step_;
@@ -214,6 +250,7 @@ public:
   , scene_reference_point_sampling_rate_(5)
   , clustering_position_diff_threshold_(0.01f)
   , clustering_rotation_diff_threshold_(20.0f / 180.0f * static_cast<float>(M_PI))
+  , threads_(1)
   {}
 
   /** \brief Method for setting the position difference clustering parameter
@@ -298,6 +335,32 @@ public:
   void
   setInputTarget(const PointCloudTargetConstPtr& cloud) override;
 
+  /** \brief Initialize the scheduler and set the number of threads to use for voting
+   * over the scene reference points.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
 private:
   /** \brief Method that calculates the transformation between the input_ and target_
    * point clouds, based on the PPF features */
@@ -321,6 +384,9 @@ private:
    * through the point cloud */
   typename pcl::KdTreeFLANN<PointTarget>::Ptr scene_search_tree_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
   /** \brief static method used for the std::sort function to order two PoseWithVotes
    * instances by their number of votes*/
   static bool
@@ -334,7 +400,9 @@ private:
 
   /** \brief Method that clusters a set of given poses by using the clustering
    * thresholds and their corresponding number of votes (see publication for more
-   * details) */
+   * details). The clusters are indexed by the position of their first pose on a grid
+   * with the size of the position threshold, so that each pose is only compared to the
+   * clusters in the neighboring cells. */
   void
   clusterPoses(PoseWithVotesList& poses, PoseWithVotesList& result);
 
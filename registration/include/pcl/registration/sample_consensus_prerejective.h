@@ -45,6 +45,8 @@
 #include <pcl/registration/transformation_estimation_svd.h>
 #include <pcl/registration/transformation_validation.h>
 
+#include <random>
+
 namespace pcl {
 /** \brief Pose estimation and alignment class using a prerejective RANSAC routine.
  *
@@ -62,6 +64,11 @@ namespace pcl {
  * using \ref setSimilarityThreshold() in [0,1[, where a value of 0 means disabled,
  * and 1 is maximally rejective.
  *
+ * The iterations can be distributed over several threads with
+ * \ref setNumberOfThreads(). They are drawn in fixed blocks, each with its own random
+ * number generator seeded from a single call to std::rand(), so for a given seed of
+ * std::rand() the result does not depend on the number of threads.
+ *
  * If you use this in academic work, please cite:
  *
  * A. G. Buch, D. Kraft, J.-K. Kämäräinen, H. G. Petersen and N. Krüger.
@@ -126,6 +133,8 @@ public:
   , feature_tree_(new pcl::KdTreeFLANN<FeatureT>)
   , correspondence_rejector_poly_(new CorrespondenceRejectorPoly)
   , inlier_fraction_(0.0f)
+  , probability_(0.0)
+  , threads_(1)
   {
     reg_name_ = "SampleConsensusPrerejective";
     correspondence_rejector_poly_->setSimilarityThreshold(0.6f);
@@ -236,6 +245,52 @@ public:
     return inlier_fraction_;
   }
 
+  /** \brief Set the desired probability of choosing at least one sample free from
+   * outliers. If set, the iterations stop before the maximum number of iterations once
+   * this probability is reached, with the fraction of outliers estimated from the best
+   * hypothesis so far.
+   * Default: 0 (disabled).
+   * \param[in] probability the desired probability in [0,1[
+   */
+  inline void
+  setProbability(double probability)
+  {
+    probability_ = probability;
+  }
+
+  /** \brief Get the desired probability of choosing at least one sample free from
+   * outliers, as set by the user. */
+  inline double
+  getProbability() const
+  {
+    return probability_;
+  }
+
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
   /** \brief Get the inlier indices of the source point cloud under the final
    * transformation
    * @return inlier indices
@@ -249,35 +304,91 @@ public:
 protected:
   /** \brief Choose a random index between 0 and n-1
    * \param n the number of possible indices to choose from
+   * \param rng the random number generator to draw from
    */
   inline int
+  getRandomIndex(int n, std::mt19937& rng) const
+  {
+    return (std::uniform_int_distribution<int>(0, n - 1)(rng));
+  };
+
+  /** \brief Choose a random index between 0 and n-1, drawn with a generator seeded
+   * from std::rand().
+   * \param n the number of possible indices to choose from
+   */
+  PCL_DEPRECATED(1, 14, "Use `getRandomIndex(int, std::mt19937&)` instead")
+  inline int
   getRandomIndex(int n) const
   {
-    return (static_cast<int>(n * (rand() / (RAND_MAX + 1.0))));
+    std::mt19937 rng(std::rand());
+    return (getRandomIndex(n, rng));
   };
 
   /** \brief Select \a nr_samples sample points from cloud while making sure that their
    * pairwise distances are greater than a user-defined minimum distance, \a
    * min_sample_distance. \param cloud the input point cloud \param nr_samples the
    * number of samples to select \param sample_indices the resulting sample indices
+   * \param rng the random number generator to draw from
    */
   void
   selectSamples(const PointCloudSource& cloud,
                 int nr_samples,
-                std::vector<int>& sample_indices);
+                std::vector<int>& sample_indices,
+                std::mt19937& rng);
+
+  /** \brief Select \a nr_samples sample points from cloud as in the overload taking a
+   * random number generator, drawing with a generator seeded from std::rand().
+   * \param cloud the input point cloud \param nr_samples the number of samples to
+   * select \param sample_indices the resulting sample indices
+   */
+  PCL_DEPRECATED(1,
+                 14,
+                 "Use `selectSamples(const PointCloudSource&, int, std::vector<int>&, "
+                 "std::mt19937&)` instead")
+  void
+  selectSamples(const PointCloudSource& cloud,
+                int nr_samples,
+                std::vector<int>& sample_indices)
+  {
+    std::mt19937 rng(std::rand());
+    selectSamples(cloud, nr_samples, sample_indices, rng);
+  }
 
   /** \brief For each of the sample points, find a list of points in the target cloud
    * whose features are similar to the sample points' features. From these, select one
    * randomly which will be considered that sample point's correspondence. \param
    * sample_indices the indices of each sample point \param similar_features
-   * correspondence cache, which is used to read/write already computed correspondences
-   * \param corresponding_indices the resulting indices of each sample's corresponding
-   * point in the target cloud
+   * correspondence cache, which is used to read/write already computed correspondences,
+   * and may be shared by several threads \param corresponding_indices the resulting
+   * indices of each sample's corresponding point in the target cloud \param rng the
+   * random number generator to draw from
+   */
+  void
+  findSimilarFeatures(const std::vector<int>& sample_indices,
+                      std::vector<std::vector<int>>& similar_features,
+                      std::vector<int>& corresponding_indices,
+                      std::mt19937& rng);
+
+  /** \brief For each of the sample points, select the correspondence as in the
+   * overload taking a random number generator, drawing with a generator seeded from
+   * std::rand(). \param sample_indices the indices of each sample point \param
+   * similar_features correspondence cache, which is used to read/write already
+   * computed correspondences \param corresponding_indices the resulting indices of
+   * each sample's corresponding point in the target cloud
    */
+  PCL_DEPRECATED(1,
+                 14,
+                 "Use `findSimilarFeatures(const std::vector<int>&, "
+                 "std::vector<std::vector<int>>&, std::vector<int>&, std::mt19937&)` "
+                 "instead")
   void
   findSimilarFeatures(const std::vector<int>& sample_indices,
                       std::vector<std::vector<int>>& similar_features,
-                      std::vector<int>& corresponding_indices);
+                      std::vector<int>& corresponding_indices)
+  {
+    std::mt19937 rng(std::rand());
+    findSimilarFeatures(sample_indices, similar_features, corresponding_indices, rng);
+  }
 
   /** \brief Rigid transformation computation method.
    * \param output the transformed input point cloud dataset using the rigid
@@ -298,6 +409,19 @@ protected:
   void
   getFitness(std::vector<int>& inliers, float& fitness_score);
 
+  /** \brief Obtain the fitness of the given transformation, as in
+   * getFitness(std::vector<int>&, float&). The evaluation stops early, with an
+   * incomplete list of inliers and the largest possible fitness score, as soon as
+   * the required inlier fraction cannot be reached anymore.
+   * \param transformation the transformation to evaluate
+   * \param inliers indices of source point cloud inliers
+   * \param fitness_score output fitness score as RMSE
+   */
+  void
+  getFitness(const Matrix4& transformation,
+             std::vector<int>& inliers,
+             float& fitness_score) const;
+
   /** \brief The source point cloud's feature descriptors. */
   FeatureCloudConstPtr input_features_;
 
@@ -323,6 +447,16 @@ protected:
 
   /** \brief Inlier points of final transformation as indices into source */
   std::vector<int> inliers_;
+
+  /** \brief The desired probability of choosing at least one sample free from
+   * outliers, 0 to always run the maximum number of iterations. */
+  double probability_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief The number of iterations drawn with the same random number generator. */
+  static constexpr int iterations_block_size_ = 16;
 };
 } // namespace pcl
 
@@ -0,0 +1,205 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/gicp.h>
+#include <pcl/registration/ndt_multi_resolution.h>
+#include <pcl/registration/registration.h>
+#include <pcl/search/kdtree.h>
+
+#include <vector>
+
+namespace pcl {
+namespace registration {
+/** \brief The state derived from a static registration target: the search tree used
+ * to find correspondences, the point normals, the per point covariances of
+ * GeneralizedIterativeClosestPoint and the voxel grids of
+ * NormalDistributionsTransformMultiResolution.
+ *
+ * Each part is computed once, on demand, and then handed to any number of
+ * registration objects with apply(), which sets the target without rebuilding the
+ * search tree. Once computed, the model is only read by the registration objects, so
+ * a single model can be applied to many registration objects aligning different
+ * sources in parallel, e.g. when localizing a batch of scans against one map.
+ *
+ * \code
+ * pcl::registration::TargetModel<pcl::PointNormal> model(map);
+ * model.computeNormals(10);
+ * #pragma omp parallel for
+ * for (int i = 0; i < nr_scans; ++i) {
+ *   pcl::IterativeClosestPointWithNormals<pcl::PointNormal, pcl::PointNormal> icp;
+ *   model.apply(icp);
+ *   icp.setInputSource(scans[i]);
+ *   icp.align(aligned[i]);
+ * }
+ * \endcode
+ * \note The compute methods are not thread safe, and must not be called while the
+ * model is applied to registration objects that are still in use.
+ * \ingroup registration
+ */
+template <typename PointTarget>
+class TargetModel {
+public:
+  using PointCloudTarget = pcl::PointCloud<PointTarget>;
+  using PointCloudTargetPtr = typename PointCloudTarget::Ptr;
+  using PointCloudTargetConstPtr = typename PointCloudTarget::ConstPtr;
+
+  using KdTree = pcl::search::KdTree<PointTarget>;
+  using KdTreePtr = typename KdTree::Ptr;
+
+  using MatricesVector =
+      typename GeneralizedIterativeClosestPoint<PointTarget,
+                                                PointTarget>::MatricesVector;
+  using MatricesVectorPtr =
+      typename GeneralizedIterativeClosestPoint<PointTarget,
+                                                PointTarget>::MatricesVectorPtr;
+
+  using TargetPyramid = VoxelGridCovariancePyramid<PointTarget>;
+  using TargetPyramidPtr = typename TargetPyramid::Ptr;
+  using TargetPyramidConstPtr = typename TargetPyramid::ConstPtr;
+
+  using Ptr = shared_ptr<TargetModel<PointTarget>>;
+  using ConstPtr = shared_ptr<const TargetModel<PointTarget>>;
+
+  /** \brief Constructor. Builds the search tree of the target.
+   * \param[in] target the input point cloud target
+   */
+  TargetModel(const PointCloudTargetConstPtr& target);
+
+  /** \brief Get the target point cloud, with the normals if computeNormals() was
+   * called. */
+  inline PointCloudTargetConstPtr
+  getTarget() const
+  {
+    return target_;
+  }
+
+  /** \brief Get the search tree built on the target point cloud. */
+  inline KdTreePtr
+  getSearchMethodTarget() const
+  {
+    return tree_;
+  }
+
+  /** \brief Estimate the normals and curvatures of the target from its \a k nearest
+   * neighbors. The target is replaced by a copy holding the normals, and its search
+   * tree is rebuilt. Only available for point types with normals.
+   * \param[in] k the number of neighbors to use
+   * \param[in] nr_threads the number of threads to use (0 sets the value to
+   * automatic)
+   */
+  void
+  computeNormals(int k, unsigned int nr_threads = 1);
+
+  /** \brief Compute the covariances of the target points used by
+   * GeneralizedIterativeClosestPoint.
+   * \param[in] k the number of neighbors to use, see
+   * GeneralizedIterativeClosestPoint::setCorrespondenceRandomness()
+   * \param[in] nr_threads the number of threads to use (0 sets the value to
+   * automatic)
+   */
+  void
+  computeCovariances(int k = 20, unsigned int nr_threads = 1);
+
+  /** \brief Get the covariances of the target points (empty if not computed). */
+  inline MatricesVectorPtr
+  getCovariances() const
+  {
+    return covariances_;
+  }
+
+  /** \brief Build the voxel grids of the target used by
+   * NormalDistributionsTransformMultiResolution.
+   * \param[in] resolutions the side lengths of the voxels of each level, from the
+   * coarsest to the finest
+   */
+  void
+  computeTargetPyramid(const std::vector<float>& resolutions);
+
+  /** \brief Get the voxel grids of the target (empty if not computed). */
+  inline TargetPyramidConstPtr
+  getTargetPyramid() const
+  {
+    return target_pyramid_;
+  }
+
+  /** \brief Set the target of a registration object, and have it use the search tree
+   * of the model instead of building its own.
+   * \param[in,out] reg the registration object
+   */
+  template <typename PointSource, typename Scalar>
+  void
+  apply(Registration<PointSource, PointTarget, Scalar>& reg) const;
+
+  /** \brief Set the target of a GeneralizedIterativeClosestPoint object, have it use
+   * the search tree of the model, and the covariances of the model if computed.
+   * \param[in,out] reg the registration object
+   */
+  template <typename PointSource>
+  void
+  apply(GeneralizedIterativeClosestPoint<PointSource, PointTarget>& reg) const;
+
+  /** \brief Set the target of a NormalDistributionsTransformMultiResolution object,
+   * and have it use the voxel grids of the model if computed instead of building its
+   * own.
+   * \param[in,out] reg the registration object
+   */
+  template <typename PointSource>
+  void
+  apply(NormalDistributionsTransformMultiResolution<PointSource, PointTarget>& reg)
+      const;
+
+protected:
+  /** \brief The target point cloud. */
+  PointCloudTargetConstPtr target_;
+
+  /** \brief The search tree built on \ref target_. */
+  KdTreePtr tree_;
+
+  /** \brief The covariances of the target points. */
+  MatricesVectorPtr covariances_;
+
+  /** \brief The voxel grids of the target. */
+  TargetPyramidConstPtr target_pyramid_;
+};
+} // namespace registration
+} // namespace pcl
+
+#include <pcl/registration/impl/target_model.hpp>
@@ -0,0 +1,266 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/transformation_estimation.h>
+#include <pcl/cloud_iterator.h>
+
+namespace pcl {
+namespace registration {
+/** \brief @b TransformationEstimationPointToPlaneRobust minimizes a robust
+ * point-to-plane error between two clouds of corresponding points with normals.
+ *
+ * The point-to-plane residuals are down-weighted with an M-estimator (Huber, Cauchy,
+ * Geman-McClure or Tukey) by iteratively reweighted least squares. Every iteration
+ * solves the linearized (Gauss-Newton) point-to-plane system of
+ * TransformationEstimationPointToPlaneLLS with the current weights, so gross outliers
+ * are handled inside a single ICP iteration instead of by an additional correspondence
+ * rejector. The normal equations are accumulated in fixed blocks of correspondences
+ * which can be distributed over several threads; the result does not depend on the
+ * number of threads.
+ *
+ * For additional details, see
+ *   "Linear Least-Squares Optimization for Point-to-Plane ICP Surface Registration",
+ * Kok-Lim Low, 2004
+ *   "Parameter Estimation Techniques: A Tutorial with Application to Conic Fitting",
+ * Zhengyou Zhang, 1997
+ *
+ * \note The class is templated on the source and target point types as well as on the
+ * output scalar of the transformation matrix (i.e., float or double). Default: float.
+ * \ingroup registration
+ */
+template <typename PointSource, typename PointTarget, typename Scalar = float>
+class TransformationEstimationPointToPlaneRobust
+: public TransformationEstimation<PointSource, PointTarget, Scalar> {
+public:
+  using Ptr = shared_ptr<TransformationEstimationPointToPlaneRobust<PointSource,
+                                                                    PointTarget,
+                                                                    Scalar>>;
+  using ConstPtr =
+      shared_ptr<const TransformationEstimationPointToPlaneRobust<PointSource,
+                                                                  PointTarget,
+                                                                  Scalar>>;
+
+  using Matrix4 =
+      typename TransformationEstimation<PointSource, PointTarget, Scalar>::Matrix4;
+
+  /** \brief The M-estimators available to weight the point-to-plane residuals. */
+  enum class RobustKernel {
+    /** \brief All residuals have the same weight (plain Gauss-Newton) */
+    NONE,
+    /** \brief Quadratic up to the kernel width, linear beyond */
+    HUBER,
+    /** \brief Logarithmic, weights decrease with the squared residual */
+    CAUCHY,
+    /** \brief Bounded, weights decrease with the fourth power of the residual */
+    GEMAN_MCCLURE,
+    /** \brief Biweight, residuals larger than the kernel width are ignored */
+    TUKEY
+  };
+
+  /** \brief Constructor.
+   * Sets the kernel to Huber with an automatically estimated width and the maximum
+   * number of reweighting iterations to 10.
+   */
+  TransformationEstimationPointToPlaneRobust()
+  : kernel_(RobustKernel::HUBER)
+  , kernel_width_(0.)
+  , max_iterations_(10)
+  , threads_(1){};
+  ~TransformationEstimationPointToPlaneRobust(){};
+
+  /** \brief Estimate a rigid rotation transformation between a source and a target
+   * point cloud. \param[in] cloud_src the source point cloud dataset
+   * \param[in] cloud_tgt the target point cloud dataset
+   * \param[out] transformation_matrix the resultant transformation matrix
+   */
+  inline void
+  estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                              const pcl::PointCloud<PointTarget>& cloud_tgt,
+                              Matrix4& transformation_matrix) const override;
+
+  /** \brief Estimate a rigid rotation transformation between a source and a target
+   * point cloud. \param[in] cloud_src the source point cloud dataset
+   * \param[in] indices_src the vector of indices describing the points of interest in
+   * \a cloud_src \param[in] cloud_tgt the target point cloud dataset \param[out]
+   * transformation_matrix the resultant transformation matrix
+   */
+  inline void
+  estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                              const std::vector<int>& indices_src,
+                              const pcl::PointCloud<PointTarget>& cloud_tgt,
+                              Matrix4& transformation_matrix) const override;
+
+  /** \brief Estimate a rigid rotation transformation between a source and a target
+   * point cloud. \param[in] cloud_src the source point cloud dataset
+   * \param[in] indices_src the vector of indices describing the points of interest in
+   * \a cloud_src \param[in] cloud_tgt the target point cloud dataset \param[in]
+   * indices_tgt the vector of indices describing the correspondences of the interest
+   * points from \a indices_src \param[out] transformation_matrix the resultant
+   * transformation matrix
+   */
+  inline void
+  estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                              const std::vector<int>& indices_src,
+                              const pcl::PointCloud<PointTarget>& cloud_tgt,
+                              const std::vector<int>& indices_tgt,
+                              Matrix4& transformation_matrix) const override;
+
+  /** \brief Estimate a rigid rotation transformation between a source and a target
+   * point cloud. \param[in] cloud_src the source point cloud dataset
+   * \param[in] cloud_tgt the target point cloud dataset
+   * \param[in] correspondences the vector of correspondences between source and target
+   * point cloud \param[out] transformation_matrix the resultant transformation matrix
+   */
+  inline void
+  estimateRigidTransformation(const pcl::PointCloud<PointSource>& cloud_src,
+                              const pcl::PointCloud<PointTarget>& cloud_tgt,
+                              const pcl::Correspondences& correspondences,
+                              Matrix4& transformation_matrix) const override;
+
+  /** \brief Set the M-estimator used to weight the residuals.
+   * \param[in] kernel the robust kernel
+   * \param[in] width the kernel width in units of the point-to-plane distance. If it is
+   * not positive, the width is estimated in every iteration from the median absolute
+   * residual, scaled with the usual tuning constant of the kernel (Huber 1.345, Cauchy
+   * 2.3849, Tukey 4.6851, Geman-McClure 1). The median is kept above 1e-3 times the mean
+   * absolute residual, so the kernel still applies when most residuals are zero.
+   */
+  inline void
+  setKernel(RobustKernel kernel, double width = 0.)
+  {
+    kernel_ = kernel;
+    kernel_width_ = width;
+  }
+
+  /** \brief Get the M-estimator used to weight the residuals. */
+  inline RobustKernel
+  getKernel() const
+  {
+    return (kernel_);
+  }
+
+  /** \brief Get the kernel width (not positive if it is estimated automatically). */
+  inline double
+  getKernelWidth() const
+  {
+    return (kernel_width_);
+  }
+
+  /** \brief Set the maximum number of reweighting (Gauss-Newton) iterations.
+   * \param[in] max_iterations the maximum number of iterations per estimation
+   */
+  inline void
+  setMaximumIterations(int max_iterations)
+  {
+    max_iterations_ = max_iterations;
+  }
+
+  /** \brief Get the maximum number of reweighting (Gauss-Newton) iterations. */
+  inline int
+  getMaximumIterations() const
+  {
+    return (max_iterations_);
+  }
+
+  /** \brief Initialize the scheduler and set the number of threads to use.
+   * Default: 1.
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   * to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    if (nr_threads == 0)
+#ifdef _OPENMP
+      threads_ = omp_get_num_procs();
+#else
+      threads_ = 1;
+#endif
+    else
+      threads_ = nr_threads;
+  }
+
+  /** \brief Return the number of threads used. */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
+protected:
+  /** \brief Estimate a rigid rotation transformation between a source and a target
+   * \param[in] source_it an iterator over the source point cloud dataset
+   * \param[in] target_it an iterator over the target point cloud dataset
+   * \param[out] transformation_matrix the resultant transformation matrix
+   */
+  void
+  estimateRigidTransformation(ConstCloudIterator<PointSource>& source_it,
+                              ConstCloudIterator<PointTarget>& target_it,
+                              Matrix4& transformation_matrix) const;
+
+  /** \brief Compute the weight of a residual according to the robust kernel.
+   * \param[in] residual the point-to-plane residual
+   * \param[in] width the kernel width
+   */
+  inline double
+  computeWeight(double residual, double width) const;
+
+  /** \brief The M-estimator used to weight the residuals. */
+  RobustKernel kernel_;
+
+  /** \brief The kernel width, estimated from the residuals if not positive. */
+  double kernel_width_;
+
+  /** \brief The maximum number of reweighting iterations. */
+  int max_iterations_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief The number of correspondences accumulated per block. */
+  static constexpr int block_size_ = 256;
+
+  /** \brief Lower bound of the automatically estimated residual scale, relative to the
+   * mean absolute residual. */
+  static constexpr double min_scale_to_mean_ratio_ = 1e-3;
+};
+} // namespace registration
+} // namespace pcl
+
+#include <pcl/registration/impl/transformation_estimation_point_to_plane_robust.hpp>
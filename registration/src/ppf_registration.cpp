@@ -38,6 +38,8 @@
 
 #include <pcl/registration/ppf_registration.h>
 
+#include <algorithm>
+
 //#ifndef PCL_NO_PRECOMPILE
 //#include <pcl/point_types.h>
 //#include <pcl/impl/instantiate.hpp>
@@ -50,36 +52,41 @@ void
 pcl::PPFHashMapSearch::setInputFeatureCloud(
     PointCloud<PPFSignature>::ConstPtr feature_cloud)
 {
-  // Discretize the feature cloud and insert it in the hash map
-  feature_hash_map_->clear();
+  // Discretize the feature cloud, remembering the pair of each feature
   unsigned int n =
       static_cast<unsigned int>(std::sqrt(static_cast<float>(feature_cloud->size())));
-  int d1, d2, d3, d4;
+  std::vector<std::pair<HashKeyStruct, std::size_t>> pair_keys;
+  pair_keys.reserve(static_cast<std::size_t>(n) * n);
   max_dist_ = -1.0;
   alpha_m_.resize(n);
   for (std::size_t i = 0; i < n; ++i) {
     std::vector<float> alpha_m_row(n);
     for (std::size_t j = 0; j < n; ++j) {
-      d1 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f1 / angle_discretization_step_));
-      d2 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f2 / angle_discretization_step_));
-      d3 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f3 / angle_discretization_step_));
-      d4 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f4 / distance_discretization_step_));
-      feature_hash_map_->insert(
-          std::pair<HashKeyStruct, std::pair<std::size_t, std::size_t>>(
-              HashKeyStruct(d1, d2, d3, d4),
-              std::pair<std::size_t, std::size_t>(i, j)));
-      alpha_m_row[j] = (*feature_cloud)[i * n + j].alpha_m;
+      const PPFSignature& feature = (*feature_cloud)[i * n + j];
+      pair_keys.emplace_back(
+          discretizeFeature(feature.f1, feature.f2, feature.f3, feature.f4), i * n + j);
+      alpha_m_row[j] = feature.alpha_m;
 
-      if (max_dist_ < (*feature_cloud)[i * n + j].f4)
-        max_dist_ = (*feature_cloud)[i * n + j].f4;
+      if (max_dist_ < feature.f4)
+        max_dist_ = feature.f4;
     }
     alpha_m_[i] = alpha_m_row;
   }
 
+  // Sort the pairs by key, and store the pairs of each bin contiguously
+  std::sort(pair_keys.begin(), pair_keys.end());
+  keys_.clear();
+  offsets_.clear();
+  pairs_.resize(pair_keys.size());
+  for (std::size_t k = 0; k < pair_keys.size(); ++k) {
+    if (keys_.empty() || keys_.back() != pair_keys[k].first) {
+      keys_.push_back(pair_keys[k].first);
+      offsets_.push_back(k);
+    }
+    pairs_[k] = std::make_pair(pair_keys[k].second / n, pair_keys[k].second % n);
+  }
+  offsets_.push_back(pairs_.size());
+
   internals_initialized_ = true;
 }
 
@@ -98,15 +105,32 @@ pcl::PPFHashMapSearch::nearestNeighborSearch(
     return;
   }
 
-  int d1 = static_cast<int>(std::floor(f1 / angle_discretization_step_)),
-      d2 = static_cast<int>(std::floor(f2 / angle_discretization_step_)),
-      d3 = static_cast<int>(std::floor(f3 / angle_discretization_step_)),
-      d4 = static_cast<int>(std::floor(f4 / distance_discretization_step_));
+  const auto pairs = getPairsInBin(f1, f2, f3, f4);
+  indices.assign(pairs.first, pairs.second);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::pair<pcl::PPFHashMapSearch::PairIndicesConstIterator,
+          pcl::PPFHashMapSearch::PairIndicesConstIterator>
+pcl::PPFHashMapSearch::getPairsInBin(float f1, float f2, float f3, float f4) const
+{
+  const HashKeyStruct key = discretizeFeature(f1, f2, f3, f4);
+  const auto key_it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (key_it == keys_.end() || *key_it != key)
+    return std::make_pair(pairs_.end(), pairs_.end());
+
+  const std::size_t bin = key_it - keys_.begin();
+  return std::make_pair(pairs_.begin() + offsets_[bin],
+                        pairs_.begin() + offsets_[bin + 1]);
+}
 
-  indices.clear();
-  HashKeyStruct key = HashKeyStruct(d1, d2, d3, d4);
-  auto map_iterator_pair = feature_hash_map_->equal_range(key);
-  for (; map_iterator_pair.first != map_iterator_pair.second; ++map_iterator_pair.first)
-    indices.emplace_back(map_iterator_pair.first->second.first,
-                         map_iterator_pair.first->second.second);
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::PPFHashMapSearch::HashKeyStruct
+pcl::PPFHashMapSearch::discretizeFeature(float f1, float f2, float f3, float f4) const
+{
+  return HashKeyStruct(
+      static_cast<int>(std::floor(f1 / angle_discretization_step_)),
+      static_cast<int>(std::floor(f2 / angle_discretization_step_)),
+      static_cast<int>(std::floor(f3 / angle_discretization_step_)),
+      static_cast<int>(std::floor(f4 / distance_discretization_step_)));
 }
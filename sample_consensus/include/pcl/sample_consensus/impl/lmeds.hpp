@@ -57,91 +57,99 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   iterations_ = 0;
   double d_best_penalty = std::numeric_limits<double>::max();
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients;
-  std::vector<double> distances;
-
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Hypotheses are drawn in batches, evaluated in parallel and then accepted in the order they were drawn
+  const std::size_t batch_size = this->getHypothesisBatchSize ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> coefficients (batch_size);
+  std::vector<char> valid (batch_size);
+  std::vector<double> penalties (batch_size);
+  const bool is_dense = sac_model_->getInputCloud ()->is_dense;
+
   // Iterate
   while ((iterations_ < max_iterations_) && (skipped_count < max_skip))
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ())
-    {
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-
-    double d_cur_penalty;
-    // d_cur_penalty = sum (min (dist, threshold))
+    this->drawSamples (batch_size, samples);
 
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    // No distances? The model must not respect the user given constraints
-    if (distances.empty ())
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    // Move all NaNs in distances to the end
-    const auto new_end = (sac_model_->getInputCloud()->is_dense ? distances.end() : std::partition (distances.begin(), distances.end(), [](double d){return !std::isnan (d);}));
-    const auto nr_valid_dists = std::distance (distances.begin (), new_end);
-
-    // d_cur_penalty = median (distances)
-    const std::size_t mid = nr_valid_dists / 2;
-    PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] There are %lu valid distances remaining after removing NaN values.\n", nr_valid_dists);
-    if (nr_valid_dists == 0)
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-
-    // Do we have a "middle" point or should we "estimate" one ?
-    if ((nr_valid_dists % 2) == 0)
-    {
-      // Looking at two values instead of one probably doesn't matter because they are mostly barely different, but let's do it for accuracy's sake
-      std::nth_element (distances.begin (), distances.begin () + (mid - 1), new_end);
-      const double tmp = distances[mid-1];
-      const double tmp2 = *(std::min_element (distances.begin () + mid, new_end));
-      d_cur_penalty = (sqrt (tmp) + sqrt (tmp2)) / 2.0;
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Computing median with two values (%g and %g) because number of distances is even.\n", tmp, distances[mid]);
-    }
-    else
+      valid[h] = false;
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (samples[h], coefficients[h]))
+        return;
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      std::vector<double> cur_distances;
+      sac_model_->getDistancesToModel (coefficients[h], cur_distances);
+
+      // No distances? The model must not respect the user given constraints
+      if (cur_distances.empty ())
+        return;
+
+      // Move all NaNs in distances to the end
+      const auto new_end = (is_dense ? cur_distances.end() : std::partition (cur_distances.begin(), cur_distances.end(), [](double d){return !std::isnan (d);}));
+      const auto nr_valid_dists = std::distance (cur_distances.begin (), new_end);
+
+      // d_cur_penalty = median (distances)
+      const std::size_t mid = nr_valid_dists / 2;
+      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] There are %lu valid distances remaining after removing NaN values.\n", nr_valid_dists);
+      if (nr_valid_dists == 0)
+        return;
+
+      // Do we have a "middle" point or should we "estimate" one ?
+      if ((nr_valid_dists % 2) == 0)
+      {
+        // Looking at two values instead of one probably doesn't matter because they are mostly barely different, but let's do it for accuracy's sake
+        std::nth_element (cur_distances.begin (), cur_distances.begin () + (mid - 1), new_end);
+        const double tmp = cur_distances[mid-1];
+        const double tmp2 = *(std::min_element (cur_distances.begin () + mid, new_end));
+        penalties[h] = (sqrt (tmp) + sqrt (tmp2)) / 2.0;
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Computing median with two values (%g and %g) because number of distances is even.\n", tmp, cur_distances[mid]);
+      }
+      else
+      {
+        std::nth_element (cur_distances.begin (), cur_distances.begin () + mid, new_end);
+        penalties[h] = sqrt (cur_distances[mid]);
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Computing median with one value (%g) because number of distances is odd.\n", cur_distances[mid]);
+      }
+      valid[h] = true;
+    });
+
+    for (std::size_t h = 0; h < samples.size () && (iterations_ < max_iterations_) && (skipped_count < max_skip); ++h)
     {
-      std::nth_element (distances.begin (), distances.begin () + mid, new_end);
-      d_cur_penalty = sqrt (distances[mid]);
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Computing median with one value (%g) because number of distances is odd.\n", distances[mid]);
+      // Invalid model coefficients, or no valid distances to the model
+      if (!valid[h])
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = coefficients[h];
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+      {
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+      }
     }
 
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
+    // No more samples could be selected
+    if (samples.size () < batch_size)
     {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-    {
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+      break;
     }
   }
 
@@ -161,6 +169,7 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   //double threshold = 2.5 * sigma;
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   // No distances? The model must not respect the user given constraints
   if (distances.empty ())
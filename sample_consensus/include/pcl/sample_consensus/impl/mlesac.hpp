@@ -59,10 +59,6 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients;
-  std::vector<double> distances;
-
   // Compute sigma - remember to set threshold_ correctly !
   sigma_ = computeMedianAbsoluteDeviation (sac_model_->getInputCloud (), sac_model_->getIndices (), threshold_);
   if (debug_verbosity_level > 1)
@@ -75,98 +71,119 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   double v = sqrt (max_pt.dot (max_pt));
 
   int n_inliers_count = 0;
-  std::size_t indices_size;
+  const std::size_t indices_size = sac_model_->getIndices ()->size ();
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Hypotheses are drawn in batches, evaluated in parallel and then accepted in the order they were drawn
+  const std::size_t batch_size = this->getHypothesisBatchSize ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> coefficients (batch_size);
+  std::vector<char> valid (batch_size);
+  std::vector<double> penalties (batch_size);
+  std::vector<int> inlier_counts (batch_size);
+
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
+    this->drawSamples (batch_size, samples);
 
-    if (distances.empty ())
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    
-    // Use Expectiation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
-    {
-      // Likelihood of a datum given that it is an inlier
-      for (std::size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = gamma * std::exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
-                           (sqrt (2 * M_PI) * sigma_);
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
+      valid[h] = false;
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (samples[h], coefficients[h]))
+        return;
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      std::vector<double> cur_distances;
+      sac_model_->getDistancesToModel (coefficients[h], cur_distances);
+      if (cur_distances.empty ())
+        return;
+
+      // Use Expectiation-Maximization to find out the right value for d_cur_penalty
+      // ---[ Initial estimate for the gamma mixing parameter = 1/2
+      double gamma = 0.5;
+      double p_outlier_prob = 0;
+
+      std::vector<double> p_inlier_prob (indices_size);
+      for (int j = 0; j < iterations_EM_; ++j)
+      {
+        // Likelihood of a datum given that it is an inlier
+        for (std::size_t i = 0; i < indices_size; ++i)
+          p_inlier_prob[i] = gamma * std::exp (- (cur_distances[i] * cur_distances[i] ) / 2 * (sigma_ * sigma_) ) /
+                             (sqrt (2 * M_PI) * sigma_);
+
+        // Likelihood of a datum given that it is an outlier
+        p_outlier_prob = (1 - gamma) / v;
+
+        gamma = 0;
+        for (std::size_t i = 0; i < indices_size; ++i)
+          gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+        gamma /= static_cast<double>(indices_size);
+      }
+
+      // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
+      double d_cur_penalty = 0;
       for (std::size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (std::size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
+        d_cur_penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
+      penalties[h] = - d_cur_penalty;
 
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
       // Need to compute the number of inliers for this model to adapt k
-      for (const double &distance : distances)
+      int cur_inliers_count = 0;
+      for (const double &distance : cur_distances)
         if (distance <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - std::pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = std::log (1 - probability_) / std::log (p_no_outliers);
-    }
+          cur_inliers_count++;
+      inlier_counts[h] = cur_inliers_count;
+      valid[h] = true;
+    });
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+    for (std::size_t h = 0; h < samples.size () && iterations_ < k && skipped_count < max_skip; ++h)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
+      // Invalid model coefficients, or no distances to the model
+      if (!valid[h])
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = coefficients[h];
+        n_inliers_count     = inlier_counts[h];
+
+        // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (indices_size);
+        double p_no_outliers = 1 - std::pow (w, static_cast<double> (samples[h].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = std::log (1 - probability_) / std::log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
+
+    // No more samples could be selected
+    if (samples.size () < batch_size)
+      break;
   }
 
   if (model_.empty ())
@@ -177,6 +194,7 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   }
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   Indices &indices = *sac_model_->getIndices ();
   if (distances.size () != indices.size ())
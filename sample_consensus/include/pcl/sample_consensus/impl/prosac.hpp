@@ -84,7 +84,6 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
 
   Indices inliers;
   Indices selection;
-  Eigen::VectorXf model_coefficients;
 
   // We will increase the pool so the indices_ vector can only contain m elements at first
   Indices index_pool;
@@ -92,133 +91,172 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   for (unsigned int i = 0; i < n; ++i)
     index_pool.push_back (sac_model_->indices_->operator[](i));
 
+  // Hypotheses are drawn in batches, evaluated in parallel and then accepted in the order they were drawn.
+  // The growth of the pool only depends on the number of iterations, so it can be done while drawing.
+  const std::size_t batch_size = this->getHypothesisBatchSize ();
+  std::vector<Indices> samples;
+  samples.reserve (batch_size);
+  std::vector<Eigen::VectorXf> coefficients (batch_size);
+  std::vector<char> valid (batch_size);
+  std::vector<std::size_t> inlier_counts (batch_size);
+
   // Iterate
-  while (static_cast<unsigned int> (iterations_) < k_n_star)
+  bool done = false;
+  while (!done && static_cast<unsigned int> (iterations_) < k_n_star)
   {
     // Choose the samples
-
-    // Step 1
-    // According to Equation 5 in the text text, not the algorithm
-    if ((iterations_ == T_prime_n) && (n < n_star))
+    samples.clear ();
+    bool last_batch = false;
+    for (int it = iterations_; samples.size () < batch_size; ++it)
     {
-      // Increase the pool
-      ++n;
-      if (n >= N)
-        break;
-      index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-      // Update other variables
-      float T_n_minus_1 = T_n;
-      T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
-      T_prime_n += std::ceil (T_n - T_n_minus_1);
-    }
+      // Step 1
+      // According to Equation 5 in the text text, not the algorithm
+      if ((it == T_prime_n) && (n < n_star))
+      {
+        // Increase the pool
+        ++n;
+        if (n >= N)
+        {
+          last_batch = true;
+          break;
+        }
+        index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+        // Update other variables
+        float T_n_minus_1 = T_n;
+        T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
+        T_prime_n += std::ceil (T_n - T_n_minus_1);
+      }
 
-    // Step 2
-    sac_model_->indices_->swap (index_pool);
-    selection.clear ();
-    sac_model_->getSamples (iterations_, selection);
-    if (T_prime_n < iterations_)
-    {
-      selection.pop_back ();
-      selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-    }
+      // Step 2
+      sac_model_->indices_->swap (index_pool);
+      selection.clear ();
+      int iterations = it;
+      sac_model_->getSamples (iterations, selection);
+      if (T_prime_n < it)
+      {
+        selection.pop_back ();
+        selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+      }
 
-    // Make sure we use the right indices for testing
-    sac_model_->indices_->swap (index_pool);
+      // Make sure we use the right indices for testing
+      sac_model_->indices_->swap (index_pool);
 
-    if (selection.empty ())
-    {
-      PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
+      if (selection.empty ())
+      {
+        PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
+        last_batch = true;
+        break;
+      }
+      samples.push_back (selection);
     }
 
     // Search for inliers in the point cloud for the current model
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      ++iterations_;
-      continue;
-    }
+      valid[h] = sac_model_->computeModelCoefficients (samples[h], coefficients[h]);
+      // Count the inliers that are within threshold_ from the model
+      if (valid[h])
+        inlier_counts[h] = sac_model_->countWithinDistance (coefficients[h], threshold_);
+    });
 
-    // Select the inliers that are within threshold_ from the model
-    inliers.clear ();
-    sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
+    for (std::size_t h = 0; h < samples.size () && static_cast<unsigned int> (iterations_) < k_n_star; ++h)
+    {
+      if (!valid[h])
+      {
+        ++iterations_;
+        continue;
+      }
 
-    std::size_t I_N = inliers.size ();
+      std::size_t I_N = inlier_counts[h];
 
-    // If we find more inliers than before
-    if (I_N > I_N_best)
-    {
-      I_N_best = I_N;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      inliers_ = inliers;
-      model_ = selection;
-      model_coefficients_ = model_coefficients;
-
-      // We estimate I_n_star for different possible values of n_star by using the inliers
-      std::sort (inliers.begin (), inliers.end ());
-
-      // Try to find a better n_star
-      // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
-      std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
-      float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
-
-      // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
-      std::size_t I_possible_n_star = I_N;
-      for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
-           last_inlier != inliers_end; 
-           ++last_inlier, --I_possible_n_star)
+      // If we find more inliers than before
+      if (I_N > I_N_best)
       {
-        // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
-        unsigned int possible_n_star = (*last_inlier) + 1;
-        if (possible_n_star <= m)
-          break;
+        // Select the inliers that are within threshold_ from the model
+        inliers.clear ();
+        sac_model_->selectWithinDistance (coefficients[h], threshold_, inliers);
+        I_N = inliers.size ();
+      }
 
-        // If we find a better epsilon_n_star
-        float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
-        // Make sure we have a better epsilon_possible_n_star
-        if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+      if (I_N > I_N_best)
+      {
+        I_N_best = I_N;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        inliers_ = inliers;
+        model_ = samples[h];
+        model_coefficients_ = coefficients[h];
+
+        // We estimate I_n_star for different possible values of n_star by using the inliers
+        std::sort (inliers.begin (), inliers.end ());
+
+        // Try to find a better n_star
+        // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
+        std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
+        float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
+
+        // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
+        std::size_t I_possible_n_star = I_N;
+        for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
+             last_inlier != inliers_end; 
+             ++last_inlier, --I_possible_n_star)
         {
-          // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
-          std::size_t I_possible_n_star_min = m
-                           + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
-          // If Equation 9 is not verified, exit
-          if (I_possible_n_star < I_possible_n_star_min)
+          // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
+          unsigned int possible_n_star = (*last_inlier) + 1;
+          if (possible_n_star <= m)
             break;
 
-          possible_n_star_best = possible_n_star;
-          I_possible_n_star_best = I_possible_n_star;
-          epsilon_possible_n_star_best = epsilon_possible_n_star;
+          // If we find a better epsilon_n_star
+          float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
+          // Make sure we have a better epsilon_possible_n_star
+          if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+          {
+            // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
+            std::size_t I_possible_n_star_min = m
+                             + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
+            // If Equation 9 is not verified, exit
+            if (I_possible_n_star < I_possible_n_star_min)
+              break;
+
+            possible_n_star_best = possible_n_star;
+            I_possible_n_star_best = I_possible_n_star;
+            epsilon_possible_n_star_best = epsilon_possible_n_star;
+          }
+        }
+
+        // Check if we get a better epsilon
+        if (epsilon_possible_n_star_best > epsilon_n_star)
+        {
+          // update the best value
+          epsilon_n_star = epsilon_possible_n_star_best;
+
+          // Compute the new k_n_star
+          float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
+          if (bottom_log == 0)
+            k_n_star = 1;
+          else if (bottom_log == 1)
+            k_n_star = T_N;
+          else
+            k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
+          // It seems weird to have very few iterations, so do have a few (totally empirical)
+          k_n_star = (std::max)(k_n_star, 2 * m);
         }
       }
 
-      // Check if we get a better epsilon
-      if (epsilon_possible_n_star_best > epsilon_n_star)
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
+      if (iterations_ > max_iterations_)
       {
-        // update the best value
-        epsilon_n_star = epsilon_possible_n_star_best;
-
-        // Compute the new k_n_star
-        float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
-        if (bottom_log == 0)
-          k_n_star = 1;
-        else if (bottom_log == 1)
-          k_n_star = T_N;
-        else
-          k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
-        // It seems weird to have very few iterations, so do have a few (totally empirical)
-        k_n_star = (std::max)(k_n_star, 2 * m);
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
       }
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+    if (last_batch)
       break;
-    }
   }
 
   if (debug_verbosity_level > 0)
@@ -58,91 +58,140 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients;
-  std::vector<double> distances;
-  std::set<index_t> indices_subset;
-
   int n_inliers_count = 0;
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
   // Number of samples to try randomly
   std::size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
+  // Hypotheses are drawn in batches, evaluated in parallel and then accepted in the order they were drawn
+  const std::size_t batch_size = this->getHypothesisBatchSize ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> coefficients (batch_size);
+  std::vector<char> valid (batch_size), verified (batch_size), scored (batch_size), has_distances (batch_size);
+  std::vector<std::set<index_t> > indices_subsets (batch_size);
+  std::vector<double> penalties (batch_size);
+  std::vector<int> inlier_counts (batch_size);
+
+  // Compute the penalty of a hypothesis and its number of inliers
+  const auto score = [&] (std::size_t h)
+  {
+    // Iterate through the 3d points and calculate the distances from them to the model
+    std::vector<double> cur_distances;
+    sac_model_->getDistancesToModel (coefficients[h], cur_distances);
+    has_distances[h] = !cur_distances.empty ();
+
+    double d_cur_penalty = 0;
+    int cur_inliers_count = 0;
+    for (const double &distance : cur_distances)
+    {
+      d_cur_penalty += std::min (distance, threshold_);
+      // Need to compute the number of inliers for this model to adapt k
+      if (distance <= threshold_)
+        cur_inliers_count++;
+    }
+    penalties[h] = d_cur_penalty;
+    inlier_counts[h] = cur_inliers_count;
+    scored[h] = true;
+  };
+
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
+    this->drawSamples (batch_size, samples);
 
     // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
+      valid[h] = sac_model_->computeModelCoefficients (samples[h], coefficients[h]);
+    });
 
     // RMSAC addon: verify a random fraction of the data
     // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
+    for (std::size_t h = 0; h < samples.size (); ++h)
+      if (valid[h])
+        this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subsets[h]);
 
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
+    // Hypotheses failing the verification are only scored as long as no model was found
+    const bool score_unverified = (k == 1.0);
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
+    {
+      scored[h] = false;
+      if (!valid[h])
+        return;
+      verified[h] = sac_model_->doSamplesVerifyModel (indices_subsets[h], coefficients[h], threshold_);
+      if (verified[h] || score_unverified)
+        score (h);
+    });
+
+    for (std::size_t h = 0; h < samples.size () && iterations_ < k && skipped_count < max_skip; ++h)
     {
-      // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
-      if (k != 1.0)
+      if (!valid[h])
       {
-        ++iterations_;
+        //iterations_++;
+        ++ skipped_count;
         continue;
       }
-    }
 
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    if (distances.empty () && k > 1.0)
-      continue;
-
-    for (const double &distance : distances)
-      d_cur_penalty += std::min (distance, threshold_);
+      if (!verified[h])
+      {
+        // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
+        if (k != 1.0)
+        {
+          ++iterations_;
+          if (iterations_ > max_iterations_)
+          {
+            if (debug_verbosity_level > 0)
+              PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+            done = true;
+            break;
+          }
+          continue;
+        }
+        if (!scored[h])
+          score (h);
+      }
 
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
+      if (!has_distances[h] && k > 1.0)
+        continue;
 
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = coefficients[h];
+        n_inliers_count     = inlier_counts[h];
+
+        // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double>(sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - std::pow (w, static_cast<double> (samples[h].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = std::log (1 - probability_) / std::log (p_no_outliers);
+      }
 
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (const double &distance : distances)
-        if (distance <= threshold_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double>(sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - std::pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = std::log (1 - probability_) / std::log (p_no_outliers);
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+    // No more samples could be selected
+    if (samples.size () < batch_size)
       break;
-    }
   }
 
   if (model_.empty ())
@@ -153,6 +202,7 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
   }
 
   // Iterate through the 3d points and calculate the distances from them to the model again
+  std::vector<double> distances;
   sac_model_->getDistancesToModel (model_coefficients_, distances);
   Indices &indices = *sac_model_->getIndices ();
   if (distances.size () != indices.size ())
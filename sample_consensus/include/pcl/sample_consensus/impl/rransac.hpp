@@ -58,10 +58,6 @@ pcl::RandomizedRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_
   std::size_t n_best_inliers_count = 0;
   double k = std::numeric_limits<double>::max();
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients;
-  std::set<index_t> indices_subset;
-
   const double log_probability  = std::log (1.0 - probability_);
   const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
 
@@ -73,73 +69,110 @@ pcl::RandomizedRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_
   // Number of samples to try randomly
   const std::size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
+  // Hypotheses are drawn in batches, evaluated in parallel and then accepted in the order they were drawn
+  const std::size_t batch_size = this->getHypothesisBatchSize ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> coefficients (batch_size);
+  std::vector<char> valid (batch_size), verified (batch_size);
+  std::vector<std::set<index_t> > indices_subsets (batch_size);
+  std::vector<std::size_t> inlier_counts (batch_size);
+
   // Iterate
-  while (iterations_ < k)
+  bool done = false;
+  while (!done && iterations_ < k)
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
+    this->drawSamples (batch_size, samples);
 
-    if (selection.empty ())
+    // Search for inliers in the point cloud for the current plane model M
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      PCL_ERROR ("[pcl::RandomizedRandomSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
+      valid[h] = sac_model_->computeModelCoefficients (samples[h], coefficients[h]);
+    });
 
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    // RRANSAC addon: verify a random fraction of the data
+    // Get X random samples which satisfy the model criterion
+    for (std::size_t h = 0; h < samples.size (); ++h)
+      if (valid[h])
+        this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subsets[h]);
+
+    this->evaluateHypotheses (samples.size (), [&] (std::size_t h)
     {
-      //iterations_++;
-      ++skipped_count;
-      if (skipped_count < max_skip)
+      if (!valid[h])
+        return;
+      verified[h] = sac_model_->doSamplesVerifyModel (indices_subsets[h], coefficients[h], threshold_);
+      // Select the inliers that are within threshold_ from the model
+      if (verified[h])
+        inlier_counts[h] = sac_model_->countWithinDistance (coefficients[h], threshold_);
+    });
+
+    for (std::size_t h = 0; h < samples.size () && iterations_ < k; ++h)
+    {
+      if (!valid[h])
       {
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, so continue with next iteration.\n");
+        //iterations_++;
+        ++skipped_count;
+        if (skipped_count < max_skip)
+        {
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, so continue with next iteration.\n");
+          continue;
+        }
+        else
+        {
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, and RRANSAC reached the maximum number of trials.\n");
+          done = true;
+          break;
+        }
+      }
+
+      if (!verified[h])
+      {
+        ++iterations_;
+        if (iterations_ > max_iterations_)
+        {
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function doSamplesVerifyModel failed, and RRANSAC reached the maximum number of trials.\n");
+          done = true;
+          break;
+        }
+        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function doSamplesVerifyModel failed, so continue with next iteration.\n");
         continue;
       }
-      else
+
+      n_inliers_count = inlier_counts[h];
+
+      // Better match ?
+      if (n_inliers_count > n_best_inliers_count)
       {
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function computeModelCoefficients failed, and RRANSAC reached the maximum number of trials.\n");
-        break;
+        n_best_inliers_count = n_inliers_count;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = coefficients[h];
+
+        // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+        const double w = static_cast<double> (n_inliers_count) * one_over_indices;
+        double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (samples[h].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log_probability / std::log (p_no_outliers);
       }
-    }
 
-    // RRANSAC addon: verify a random fraction of the data
-    // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
-    {
       ++iterations_;
-      PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] The function doSamplesVerifyModel failed, so continue with next iteration.\n");
-      continue;
-    }
 
-    // Select the inliers that are within threshold_ from the model
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
-
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
-    {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      const double w = static_cast<double> (n_inliers_count) * one_over_indices;
-      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log_probability / std::log (p_no_outliers);
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %u inliers (best is: %u so far).\n", iterations_, static_cast<int> (std::ceil (k)), n_inliers_count, n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
 
-    ++iterations_;
-
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %u inliers (best is: %u so far).\n", iterations_, static_cast<int> (std::ceil (k)), n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
+    if (!done && iterations_ < k && samples.size () < batch_size)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
+      PCL_ERROR ("[pcl::RandomizedRandomSampleConsensus::computeModel] No samples could be selected!\n");
       break;
     }
   }
@@ -150,8 +150,26 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::getDistancesToModel (
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
   float ptdotdir = line_pt.dot (line_dir);
   float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist8 (i, model_coefficients));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist4 (i, model_coefficients));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the cylinder
+  for (; i < indices_->size (); ++i)
   {
     // Approximate the distance from the point to the cylinder as the difference between
     // dist(point,cylinder_axis) and cylinder radius
@@ -175,6 +193,46 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> bool
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::getDistancesToModelChunk (
+      const Eigen::VectorXf &model_coefficients, const Indices &chunk, std::vector<double> &distances) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return (true);
+  }
+
+  distances.resize (chunk.size ());
+
+  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
+  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
+  float ptdotdir = line_pt.dot (line_dir);
+  float dirdotdir = 1.0f / line_dir.dot (line_dir);
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+  {
+    Eigen::Vector4f pt ((*input_)[chunk[i]].x, (*input_)[chunk[i]].y, (*input_)[chunk[i]].z, 0.0f);
+
+    const double weighted_euclid_dist = (1.0 - normal_distance_weight_) * std::abs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
+
+    // Calculate the point's projection on the cylinder axis
+    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
+    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
+    Eigen::Vector4f dir = pt - pt_proj;
+    dir.normalize ();
+
+    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
+    Eigen::Vector4f n ((*normals_)[chunk[i]].normal[0], (*normals_)[chunk[i]].normal[1], (*normals_)[chunk[i]].normal[2], 0.0f);
+    double d_normal = std::abs (getAngle3D (n, dir));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+
+    distances[i] = std::abs (normal_distance_weight_ * d_normal + weighted_euclid_dist);
+  }
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelCylinder<PointT, PointNT>::selectWithinDistance (
@@ -196,8 +254,48 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::selectWithinDistance (
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
   float ptdotdir = line_pt.dot (line_dir);
   float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = dist8 (i, model_coefficients);
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (dist_vec, threshold_vec, _CMP_LT_OQ)); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[7 - j]);
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = dist4 (i, model_coefficients);
+    const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist_vec, threshold_vec)); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[3 - j]);
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the cylinder
+  for (; i < indices_->size (); ++i)
   {
     // Approximate the distance from the point to the cylinder as the difference between
     // dist(point,cylinder_axis) and cylinder radius
@@ -236,14 +334,28 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+#if defined (__AVX__) && defined (__AVX2__)
+  return countWithinDistanceAVX (model_coefficients, threshold);
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  return countWithinDistanceSSE (model_coefficients, threshold);
+#else
+  return countWithinDistanceStandard (model_coefficients, threshold);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
   std::size_t nr_p = 0;
 
   Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   float ptdotdir = line_pt.dot (line_dir);
   float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Iterate through the 3d points and calculate the distances from them to the cylinder
+  for (; i < indices_->size (); ++i)
   {
     // Approximate the distance from the point to the cylinder as the difference between
     // dist(point,cylinder_axis) and cylinder radius
@@ -269,6 +381,134 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  __m128i res = _mm_set1_epi32(0); // This corresponds to nr_p: 4 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 mask = _mm_cmplt_ps (dist4 (i, model_coefficients), threshold_vec); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm_add_epi32 (res, _mm_and_si128 (_mm_set1_epi32 (1), _mm_castps_si128 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm_extract_epi32 (res, 0);
+  nr_p += _mm_extract_epi32 (res, 1);
+  nr_p += _mm_extract_epi32 (res, 2);
+  nr_p += _mm_extract_epi32 (res, 3);
+
+  // Process the remaining points (at most 3)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined (__AVX__) && defined (__AVX2__)
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  __m256i res = _mm256_set1_epi32(0); // This corresponds to nr_p: 8 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 mask = _mm256_cmp_ps (dist8 (i, model_coefficients), threshold_vec, _CMP_LT_OQ); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm256_add_epi32 (res, _mm256_and_si256 (_mm256_set1_epi32 (1), _mm256_castps_si256 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm256_extract_epi32 (res, 0);
+  nr_p += _mm256_extract_epi32 (res, 1);
+  nr_p += _mm256_extract_epi32 (res, 2);
+  nr_p += _mm256_extract_epi32 (res, 3);
+  nr_p += _mm256_extract_epi32 (res, 4);
+  nr_p += _mm256_extract_epi32 (res, 5);
+  nr_p += _mm256_extract_epi32 (res, 6);
+  nr_p += _mm256_extract_epi32 (res, 7);
+
+  // Process the remaining points (at most 7)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+#define AT(POS) ((*input_)[(*indices_)[(POS)]])
+#define NT(POS) ((*normals_)[(*indices_)[(POS)]])
+
+#ifdef __AVX__
+// This function computes the distances of 8 points to the cylinder, combining the distance to the cylinder surface
+// and the angle between the point normal and the cylinder normal like countWithinDistanceStandard. The distance of
+// point i is in the highest element. The angle is computed with an approximate acos, see getAcuteAngle3DAVX.
+template <typename PointT, typename PointNT> inline __m256
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::dist8 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m256 ux = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 uy = _mm256_set1_ps (model_coefficients[4]);
+  const __m256 uz = _mm256_set1_ps (model_coefficients[5]);
+  // Vector from the point on the axis to the points
+  const __m256 dx = _mm256_sub_ps (_mm256_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x, AT(i+4).x, AT(i+5).x, AT(i+6).x, AT(i+7).x), _mm256_set1_ps (model_coefficients[0]));
+  const __m256 dy = _mm256_sub_ps (_mm256_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y, AT(i+4).y, AT(i+5).y, AT(i+6).y, AT(i+7).y), _mm256_set1_ps (model_coefficients[1]));
+  const __m256 dz = _mm256_sub_ps (_mm256_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z, AT(i+4).z, AT(i+5).z, AT(i+6).z, AT(i+7).z), _mm256_set1_ps (model_coefficients[2]));
+  // Remove the component along the axis: r = d - (d.u / u.u) u points from the axis to the points
+  const __m256 k = _mm256_div_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, ux), _mm256_mul_ps (dy, uy)), _mm256_mul_ps (dz, uz)),
+                                  _mm256_set1_ps (model_coefficients[3] * model_coefficients[3] + model_coefficients[4] * model_coefficients[4] + model_coefficients[5] * model_coefficients[5]));
+  const __m256 rx = _mm256_sub_ps (dx, _mm256_mul_ps (k, ux));
+  const __m256 ry = _mm256_sub_ps (dy, _mm256_mul_ps (k, uy));
+  const __m256 rz = _mm256_sub_ps (dz, _mm256_mul_ps (k, uz));
+  const __m256 axis_dist = _mm256_sqrt_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (rx, rx), _mm256_mul_ps (ry, ry)), _mm256_mul_ps (rz, rz)));
+  const __m256 weight_vec = _mm256_set1_ps (normal_distance_weight_);
+  const __m256 weighted_euclid_dist = _mm256_mul_ps (_mm256_sub_ps (_mm256_set1_ps (1.0f), weight_vec),
+                                                     _mm256_andnot_ps (abs_help, _mm256_sub_ps (axis_dist, _mm256_set1_ps (model_coefficients[6]))));
+  // Angle between the point normal and the normalized r
+  const __m256 inv_axis_dist = _mm256_div_ps (_mm256_set1_ps (1.0f), axis_dist);
+  const __m256 d_normal = getAcuteAngle3DAVX (_mm256_set_ps (NT(i  ).normal_x, NT(i+1).normal_x, NT(i+2).normal_x, NT(i+3).normal_x, NT(i+4).normal_x, NT(i+5).normal_x, NT(i+6).normal_x, NT(i+7).normal_x),
+                                              _mm256_set_ps (NT(i  ).normal_y, NT(i+1).normal_y, NT(i+2).normal_y, NT(i+3).normal_y, NT(i+4).normal_y, NT(i+5).normal_y, NT(i+6).normal_y, NT(i+7).normal_y),
+                                              _mm256_set_ps (NT(i  ).normal_z, NT(i+1).normal_z, NT(i+2).normal_z, NT(i+3).normal_z, NT(i+4).normal_z, NT(i+5).normal_z, NT(i+6).normal_z, NT(i+7).normal_z),
+                                              _mm256_mul_ps (rx, inv_axis_dist), _mm256_mul_ps (ry, inv_axis_dist), _mm256_mul_ps (rz, inv_axis_dist));
+  return _mm256_andnot_ps (abs_help, _mm256_add_ps (_mm256_mul_ps (weight_vec, d_normal), weighted_euclid_dist));
+}
+#endif // ifdef __AVX__
+
+#ifdef __SSE__
+// This function computes the distances of 4 points to the cylinder, see dist8
+template <typename PointT, typename PointNT> inline __m128
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::dist4 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m128 ux = _mm_set1_ps (model_coefficients[3]);
+  const __m128 uy = _mm_set1_ps (model_coefficients[4]);
+  const __m128 uz = _mm_set1_ps (model_coefficients[5]);
+  // Vector from the point on the axis to the points
+  const __m128 dx = _mm_sub_ps (_mm_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x), _mm_set1_ps (model_coefficients[0]));
+  const __m128 dy = _mm_sub_ps (_mm_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y), _mm_set1_ps (model_coefficients[1]));
+  const __m128 dz = _mm_sub_ps (_mm_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z), _mm_set1_ps (model_coefficients[2]));
+  // Remove the component along the axis: r = d - (d.u / u.u) u points from the axis to the points
+  const __m128 k = _mm_div_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, ux), _mm_mul_ps (dy, uy)), _mm_mul_ps (dz, uz)),
+                               _mm_set1_ps (model_coefficients[3] * model_coefficients[3] + model_coefficients[4] * model_coefficients[4] + model_coefficients[5] * model_coefficients[5]));
+  const __m128 rx = _mm_sub_ps (dx, _mm_mul_ps (k, ux));
+  const __m128 ry = _mm_sub_ps (dy, _mm_mul_ps (k, uy));
+  const __m128 rz = _mm_sub_ps (dz, _mm_mul_ps (k, uz));
+  const __m128 axis_dist = _mm_sqrt_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (rx, rx), _mm_mul_ps (ry, ry)), _mm_mul_ps (rz, rz)));
+  const __m128 weight_vec = _mm_set1_ps (normal_distance_weight_);
+  const __m128 weighted_euclid_dist = _mm_mul_ps (_mm_sub_ps (_mm_set1_ps (1.0f), weight_vec),
+                                                  _mm_andnot_ps (abs_help, _mm_sub_ps (axis_dist, _mm_set1_ps (model_coefficients[6]))));
+  // Angle between the point normal and the normalized r
+  const __m128 inv_axis_dist = _mm_div_ps (_mm_set1_ps (1.0f), axis_dist);
+  const __m128 d_normal = getAcuteAngle3DSSE (_mm_set_ps (NT(i  ).normal_x, NT(i+1).normal_x, NT(i+2).normal_x, NT(i+3).normal_x),
+                                              _mm_set_ps (NT(i  ).normal_y, NT(i+1).normal_y, NT(i+2).normal_y, NT(i+3).normal_y),
+                                              _mm_set_ps (NT(i  ).normal_z, NT(i+1).normal_z, NT(i+2).normal_z, NT(i+3).normal_z),
+                                              _mm_mul_ps (rx, inv_axis_dist), _mm_mul_ps (ry, inv_axis_dist), _mm_mul_ps (rz, inv_axis_dist));
+  return _mm_andnot_ps (abs_help, _mm_add_ps (_mm_mul_ps (weight_vec, d_normal), weighted_euclid_dist));
+}
+#endif // ifdef __SSE__
+
+#undef NT
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelCylinder<PointT, PointNT>::optimizeModelCoefficients (
@@ -119,8 +119,26 @@ pcl::SampleConsensusModelLine<PointT>::getDistancesToModel (
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   line_dir.normalize ();
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, _mm256_sqrt_ps (sqr_dist8 (i, model_coefficients)));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, _mm_sqrt_ps (sqr_dist4 (i, model_coefficients)));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the line
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the line
     // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
@@ -150,8 +168,48 @@ pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   line_dir.normalize ();
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 sqr_threshold_vec = _mm256_set1_ps (sqr_threshold);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = sqr_dist8 (i, model_coefficients);
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (dist_vec, sqr_threshold_vec, _CMP_LT_OQ)); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[7 - j]);
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 sqr_threshold_vec = _mm_set1_ps (sqr_threshold);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = sqr_dist4 (i, model_coefficients);
+    const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist_vec, sqr_threshold_vec)); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[3 - j]);
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the line
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the line
     // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
@@ -175,6 +233,20 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+#if defined (__AVX__) && defined (__AVX2__)
+  return countWithinDistanceAVX (model_coefficients, threshold);
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  return countWithinDistanceSSE (model_coefficients, threshold);
+#else
+  return countWithinDistanceStandard (model_coefficients, threshold);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
   double sqr_threshold = threshold * threshold;
 
   std::size_t nr_p = 0;
@@ -185,7 +257,7 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   line_dir.normalize ();
 
   // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the line
     // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
@@ -197,6 +269,106 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+#if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m128 sqr_threshold_vec = _mm_set1_ps (threshold * threshold);
+  __m128i res = _mm_set1_epi32(0); // This corresponds to nr_p: 4 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 mask = _mm_cmplt_ps (sqr_dist4 (i, model_coefficients), sqr_threshold_vec); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm_add_epi32 (res, _mm_and_si128 (_mm_set1_epi32 (1), _mm_castps_si128 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm_extract_epi32 (res, 0);
+  nr_p += _mm_extract_epi32 (res, 1);
+  nr_p += _mm_extract_epi32 (res, 2);
+  nr_p += _mm_extract_epi32 (res, 3);
+
+  // Process the remaining points (at most 3)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#if defined (__AVX__) && defined (__AVX2__)
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m256 sqr_threshold_vec = _mm256_set1_ps (threshold * threshold);
+  __m256i res = _mm256_set1_epi32(0); // This corresponds to nr_p: 8 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 mask = _mm256_cmp_ps (sqr_dist8 (i, model_coefficients), sqr_threshold_vec, _CMP_LT_OQ); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm256_add_epi32 (res, _mm256_and_si256 (_mm256_set1_epi32 (1), _mm256_castps_si256 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm256_extract_epi32 (res, 0);
+  nr_p += _mm256_extract_epi32 (res, 1);
+  nr_p += _mm256_extract_epi32 (res, 2);
+  nr_p += _mm256_extract_epi32 (res, 3);
+  nr_p += _mm256_extract_epi32 (res, 4);
+  nr_p += _mm256_extract_epi32 (res, 5);
+  nr_p += _mm256_extract_epi32 (res, 6);
+  nr_p += _mm256_extract_epi32 (res, 7);
+
+  // Process the remaining points (at most 7)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+#define AT(POS) ((*input_)[(*indices_)[(POS)]])
+
+#ifdef __AVX__
+// This function computes the squared distances of 8 points to the line. The distance of point i is in the highest element.
+template <typename PointT> inline __m256
+pcl::SampleConsensusModelLine<PointT>::sqr_dist8 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m256 ux = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 uy = _mm256_set1_ps (model_coefficients[4]);
+  const __m256 uz = _mm256_set1_ps (model_coefficients[5]);
+  // Vector from the point on the line to the points
+  const __m256 dx = _mm256_sub_ps (_mm256_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x, AT(i+4).x, AT(i+5).x, AT(i+6).x, AT(i+7).x), _mm256_set1_ps (model_coefficients[0]));
+  const __m256 dy = _mm256_sub_ps (_mm256_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y, AT(i+4).y, AT(i+5).y, AT(i+6).y, AT(i+7).y), _mm256_set1_ps (model_coefficients[1]));
+  const __m256 dz = _mm256_sub_ps (_mm256_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z, AT(i+4).z, AT(i+5).z, AT(i+6).z, AT(i+7).z), _mm256_set1_ps (model_coefficients[2]));
+  // D^2 = ||d x u||^2 / ||u||^2
+  const __m256 cx = _mm256_sub_ps (_mm256_mul_ps (dy, uz), _mm256_mul_ps (dz, uy));
+  const __m256 cy = _mm256_sub_ps (_mm256_mul_ps (dz, ux), _mm256_mul_ps (dx, uz));
+  const __m256 cz = _mm256_sub_ps (_mm256_mul_ps (dx, uy), _mm256_mul_ps (dy, ux));
+  return _mm256_div_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (cx, cx), _mm256_mul_ps (cy, cy)), _mm256_mul_ps (cz, cz)),
+                        _mm256_set1_ps (model_coefficients[3] * model_coefficients[3] + model_coefficients[4] * model_coefficients[4] + model_coefficients[5] * model_coefficients[5]));
+}
+#endif // ifdef __AVX__
+
+#ifdef __SSE__
+// This function computes the squared distances of 4 points to the line. The distance of point i is in the highest element.
+template <typename PointT> inline __m128
+pcl::SampleConsensusModelLine<PointT>::sqr_dist4 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m128 ux = _mm_set1_ps (model_coefficients[3]);
+  const __m128 uy = _mm_set1_ps (model_coefficients[4]);
+  const __m128 uz = _mm_set1_ps (model_coefficients[5]);
+  // Vector from the point on the line to the points
+  const __m128 dx = _mm_sub_ps (_mm_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x), _mm_set1_ps (model_coefficients[0]));
+  const __m128 dy = _mm_sub_ps (_mm_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y), _mm_set1_ps (model_coefficients[1]));
+  const __m128 dz = _mm_sub_ps (_mm_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z), _mm_set1_ps (model_coefficients[2]));
+  // D^2 = ||d x u||^2 / ||u||^2
+  const __m128 cx = _mm_sub_ps (_mm_mul_ps (dy, uz), _mm_mul_ps (dz, uy));
+  const __m128 cy = _mm_sub_ps (_mm_mul_ps (dz, ux), _mm_mul_ps (dx, uz));
+  const __m128 cz = _mm_sub_ps (_mm_mul_ps (dx, uy), _mm_mul_ps (dy, ux));
+  return _mm_div_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (cx, cx), _mm_mul_ps (cy, cy)), _mm_mul_ps (cz, cz)),
+                     _mm_set1_ps (model_coefficients[3] * model_coefficients[3] + model_coefficients[4] * model_coefficients[4] + model_coefficients[5] * model_coefficients[5]));
+}
+#endif // ifdef __SSE__
+
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelLine<PointT>::optimizeModelCoefficients (
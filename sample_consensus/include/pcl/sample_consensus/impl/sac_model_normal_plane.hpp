@@ -73,8 +73,60 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::selectWithinDistance (
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 normal_distance_weight_vec = _mm256_set1_ps (normal_distance_weight_);
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = dist8 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help);
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (dist_vec, threshold_vec, _CMP_LT_OQ)); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[7 - j]);
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 normal_distance_weight_vec = _mm_set1_ps (normal_distance_weight_);
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = dist4 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help);
+    const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist_vec, threshold_vec)); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[3 - j]);
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the plane
+  for (; i < indices_->size (); ++i)
   {
     const PointT  &pt = (*input_)[(*indices_)[i]];
     const PointNT &nt = (*normals_)[(*indices_)[i]];
@@ -162,6 +214,82 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceStanda
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+#ifdef __SSE__
+template <typename PointT, typename PointNT> inline __m128
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::dist4 (const std::size_t i, const __m128 &a_vec, const __m128 &b_vec, const __m128 &c_vec, const __m128 &d_vec, const __m128 &normal_distance_weight_vec, const __m128 &abs_help) const
+{
+  const __m128 d_euclid_vec = pcl::SampleConsensusModelPlane<PointT>::dist4 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
+
+  const __m128 d_normal_vec = getAcuteAngle3DSSE (
+                                _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_x,
+                                            (*normals_)[(*indices_)[i+1]].normal_x,
+                                            (*normals_)[(*indices_)[i+2]].normal_x,
+                                            (*normals_)[(*indices_)[i+3]].normal_x),
+                                _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_y,
+                                            (*normals_)[(*indices_)[i+1]].normal_y,
+                                            (*normals_)[(*indices_)[i+2]].normal_y,
+                                            (*normals_)[(*indices_)[i+3]].normal_y),
+                                _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_z,
+                                            (*normals_)[(*indices_)[i+1]].normal_z,
+                                            (*normals_)[(*indices_)[i+2]].normal_z,
+                                            (*normals_)[(*indices_)[i+3]].normal_z),
+                                a_vec, b_vec, c_vec);
+  const __m128 weight_vec = _mm_mul_ps (normal_distance_weight_vec, _mm_sub_ps (_mm_set1_ps (1.0f),
+                                _mm_set_ps ((*normals_)[(*indices_)[i  ]].curvature,
+                                            (*normals_)[(*indices_)[i+1]].curvature,
+                                            (*normals_)[(*indices_)[i+2]].curvature,
+                                            (*normals_)[(*indices_)[i+3]].curvature)));
+  return _mm_andnot_ps (abs_help, _mm_add_ps (_mm_mul_ps (weight_vec, d_normal_vec), _mm_mul_ps (_mm_sub_ps (_mm_set1_ps (1.0f), weight_vec), d_euclid_vec)));
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef __AVX__
+template <typename PointT, typename PointNT> inline __m256
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::dist8 (const std::size_t i, const __m256 &a_vec, const __m256 &b_vec, const __m256 &c_vec, const __m256 &d_vec, const __m256 &normal_distance_weight_vec, const __m256 &abs_help) const
+{
+  const __m256 d_euclid_vec = pcl::SampleConsensusModelPlane<PointT>::dist8 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
+
+  const __m256 d_normal_vec = getAcuteAngle3DAVX (
+                                _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_x,
+                                               (*normals_)[(*indices_)[i+1]].normal_x,
+                                               (*normals_)[(*indices_)[i+2]].normal_x,
+                                               (*normals_)[(*indices_)[i+3]].normal_x,
+                                               (*normals_)[(*indices_)[i+4]].normal_x,
+                                               (*normals_)[(*indices_)[i+5]].normal_x,
+                                               (*normals_)[(*indices_)[i+6]].normal_x,
+                                               (*normals_)[(*indices_)[i+7]].normal_x),
+                                _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_y,
+                                               (*normals_)[(*indices_)[i+1]].normal_y,
+                                               (*normals_)[(*indices_)[i+2]].normal_y,
+                                               (*normals_)[(*indices_)[i+3]].normal_y,
+                                               (*normals_)[(*indices_)[i+4]].normal_y,
+                                               (*normals_)[(*indices_)[i+5]].normal_y,
+                                               (*normals_)[(*indices_)[i+6]].normal_y,
+                                               (*normals_)[(*indices_)[i+7]].normal_y),
+                                _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_z,
+                                               (*normals_)[(*indices_)[i+1]].normal_z,
+                                               (*normals_)[(*indices_)[i+2]].normal_z,
+                                               (*normals_)[(*indices_)[i+3]].normal_z,
+                                               (*normals_)[(*indices_)[i+4]].normal_z,
+                                               (*normals_)[(*indices_)[i+5]].normal_z,
+                                               (*normals_)[(*indices_)[i+6]].normal_z,
+                                               (*normals_)[(*indices_)[i+7]].normal_z),
+                                a_vec, b_vec, c_vec);
+  const __m256 weight_vec = _mm256_mul_ps (normal_distance_weight_vec, _mm256_sub_ps (_mm256_set1_ps (1.0f),
+                                _mm256_set_ps ((*normals_)[(*indices_)[i  ]].curvature,
+                                               (*normals_)[(*indices_)[i+1]].curvature,
+                                               (*normals_)[(*indices_)[i+2]].curvature,
+                                               (*normals_)[(*indices_)[i+3]].curvature,
+                                               (*normals_)[(*indices_)[i+4]].curvature,
+                                               (*normals_)[(*indices_)[i+5]].curvature,
+                                               (*normals_)[(*indices_)[i+6]].curvature,
+                                               (*normals_)[(*indices_)[i+7]].curvature)));
+  return _mm256_andnot_ps (abs_help, _mm256_add_ps (_mm256_mul_ps (weight_vec, d_normal_vec), _mm256_mul_ps (_mm256_sub_ps (_mm256_set1_ps (1.0f), weight_vec), d_euclid_vec)));
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 #if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
 template <typename PointT, typename PointNT> std::size_t
@@ -179,28 +307,7 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceSSE (
   __m128i res = _mm_set1_epi32(0); // This corresponds to nr_p: 4 32bit integers that, summed together, hold the number of inliers
   for (; (i + 4) <= indices_->size (); i += 4)
   {
-    const __m128 d_euclid_vec = pcl::SampleConsensusModelPlane<PointT>::dist4 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
-
-    const __m128 d_normal_vec = getAcuteAngle3DSSE (
-                                  _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_x,
-                                              (*normals_)[(*indices_)[i+1]].normal_x,
-                                              (*normals_)[(*indices_)[i+2]].normal_x,
-                                              (*normals_)[(*indices_)[i+3]].normal_x),
-                                  _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_y,
-                                              (*normals_)[(*indices_)[i+1]].normal_y,
-                                              (*normals_)[(*indices_)[i+2]].normal_y,
-                                              (*normals_)[(*indices_)[i+3]].normal_y),
-                                  _mm_set_ps ((*normals_)[(*indices_)[i  ]].normal_z,
-                                              (*normals_)[(*indices_)[i+1]].normal_z,
-                                              (*normals_)[(*indices_)[i+2]].normal_z,
-                                              (*normals_)[(*indices_)[i+3]].normal_z),
-                                  a_vec, b_vec, c_vec);
-    const __m128 weight_vec = _mm_mul_ps (normal_distance_weight_vec, _mm_sub_ps (_mm_set1_ps (1.0f),
-                                  _mm_set_ps ((*normals_)[(*indices_)[i  ]].curvature,
-                                              (*normals_)[(*indices_)[i+1]].curvature,
-                                              (*normals_)[(*indices_)[i+2]].curvature,
-                                              (*normals_)[(*indices_)[i+3]].curvature)));
-    const __m128 dist = _mm_andnot_ps (abs_help, _mm_add_ps (_mm_mul_ps (weight_vec, d_normal_vec), _mm_mul_ps (_mm_sub_ps (_mm_set1_ps (1.0f), weight_vec), d_euclid_vec)));
+    const __m128 dist = dist4 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help);
     const __m128 mask = _mm_cmplt_ps (dist, threshold_vec); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
     res = _mm_add_epi32 (res, _mm_and_si128 (_mm_set1_epi32 (1), _mm_castps_si128 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
   }
@@ -232,44 +339,7 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceAVX (
   __m256i res = _mm256_set1_epi32(0); // This corresponds to nr_p: 8 32bit integers that, summed together, hold the number of inliers
   for (; (i + 8) <= indices_->size (); i += 8)
   {
-    const __m256 d_euclid_vec = pcl::SampleConsensusModelPlane<PointT>::dist8 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
-
-    const __m256 d_normal_vec = getAcuteAngle3DAVX (
-                                  _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_x,
-                                                 (*normals_)[(*indices_)[i+1]].normal_x,
-                                                 (*normals_)[(*indices_)[i+2]].normal_x,
-                                                 (*normals_)[(*indices_)[i+3]].normal_x,
-                                                 (*normals_)[(*indices_)[i+4]].normal_x,
-                                                 (*normals_)[(*indices_)[i+5]].normal_x,
-                                                 (*normals_)[(*indices_)[i+6]].normal_x,
-                                                 (*normals_)[(*indices_)[i+7]].normal_x),
-                                  _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_y,
-                                                 (*normals_)[(*indices_)[i+1]].normal_y,
-                                                 (*normals_)[(*indices_)[i+2]].normal_y,
-                                                 (*normals_)[(*indices_)[i+3]].normal_y,
-                                                 (*normals_)[(*indices_)[i+4]].normal_y,
-                                                 (*normals_)[(*indices_)[i+5]].normal_y,
-                                                 (*normals_)[(*indices_)[i+6]].normal_y,
-                                                 (*normals_)[(*indices_)[i+7]].normal_y),
-                                  _mm256_set_ps ((*normals_)[(*indices_)[i  ]].normal_z,
-                                                 (*normals_)[(*indices_)[i+1]].normal_z,
-                                                 (*normals_)[(*indices_)[i+2]].normal_z,
-                                                 (*normals_)[(*indices_)[i+3]].normal_z,
-                                                 (*normals_)[(*indices_)[i+4]].normal_z,
-                                                 (*normals_)[(*indices_)[i+5]].normal_z,
-                                                 (*normals_)[(*indices_)[i+6]].normal_z,
-                                                 (*normals_)[(*indices_)[i+7]].normal_z),
-                                  a_vec, b_vec, c_vec);
-    const __m256 weight_vec = _mm256_mul_ps (normal_distance_weight_vec, _mm256_sub_ps (_mm256_set1_ps (1.0f),
-                                  _mm256_set_ps ((*normals_)[(*indices_)[i  ]].curvature,
-                                                 (*normals_)[(*indices_)[i+1]].curvature,
-                                                 (*normals_)[(*indices_)[i+2]].curvature,
-                                                 (*normals_)[(*indices_)[i+3]].curvature,
-                                                 (*normals_)[(*indices_)[i+4]].curvature,
-                                                 (*normals_)[(*indices_)[i+5]].curvature,
-                                                 (*normals_)[(*indices_)[i+6]].curvature,
-                                                 (*normals_)[(*indices_)[i+7]].curvature)));
-    const __m256 dist = _mm256_andnot_ps (abs_help, _mm256_add_ps (_mm256_mul_ps (weight_vec, d_normal_vec), _mm256_mul_ps (_mm256_sub_ps (_mm256_set1_ps (1.0f), weight_vec), d_euclid_vec)));
+    const __m256 dist = dist8 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help);
     const __m256 mask = _mm256_cmp_ps (dist, threshold_vec, _CMP_LT_OQ); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
     res = _mm256_add_epi32 (res, _mm256_and_si256 (_mm256_set1_epi32 (1), _mm256_castps_si256 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
   }
@@ -312,8 +382,38 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 normal_distance_weight_vec = _mm256_set1_ps (normal_distance_weight_);
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist8 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 normal_distance_weight_vec = _mm_set1_ps (normal_distance_weight_);
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist4 (i, a_vec, b_vec, c_vec, d_vec, normal_distance_weight_vec, abs_help));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the plane
+  for (; i < indices_->size (); ++i)
   {
     const PointT  &pt = (*input_)[(*indices_)[i]];
     const PointNT &nt = (*normals_)[(*indices_)[i]];
@@ -334,6 +434,50 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> bool
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModelChunk (
+      const Eigen::VectorXf &model_coefficients, const Indices &chunk, std::vector<double> &distances) const
+{
+  if (!normals_)
+  {
+    PCL_ERROR ("[pcl::SampleConsensusModelNormalPlane::getDistancesToModelChunk] No input dataset containing normals was given!\n");
+    distances.clear ();
+    return (true);
+  }
+
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return (true);
+  }
+
+  // Obtain the plane normal
+  Eigen::Vector4f coeff = model_coefficients;
+  coeff[3] = 0.0f;
+
+  distances.resize (chunk.size ());
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+  {
+    const PointT  &pt = (*input_)[chunk[i]];
+    const PointNT &nt = (*normals_)[chunk[i]];
+    Eigen::Vector4f p (pt.x, pt.y, pt.z, 0.0f);
+    Eigen::Vector4f n (nt.normal_x, nt.normal_y, nt.normal_z, 0.0f);
+    double d_euclid = std::abs (coeff.dot (p) + model_coefficients[3]);
+
+    // Calculate the angular distance between the point normal and the plane normal
+    double d_normal = std::abs (getAngle3D (n, coeff));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+
+    // Weight with the point curvature. On flat surfaces, curvature -> 0, which means the normal will have a higher influence
+    double weight = normal_distance_weight_ * (1.0 - nt.curvature);
+
+    distances[i] = std::abs (weight * d_normal + (1.0 - weight) * d_euclid);
+  }
+  return (true);
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelNormalPlane(PointT, PointNT) template class PCL_EXPORTS pcl::SampleConsensusModelNormalPlane<PointT, PointNT>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_NORMAL_PLANE_H_
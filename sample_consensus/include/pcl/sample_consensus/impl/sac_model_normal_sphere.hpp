@@ -72,8 +72,48 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::selectWithinDistance (
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = dist8 (i, model_coefficients);
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (dist_vec, threshold_vec, _CMP_LT_OQ)); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[7 - j]);
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = dist4 (i, model_coefficients);
+    const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist_vec, threshold_vec)); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[3 - j]);
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the sphere
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the sphere center as the difference between
     // dist(point,sphere_origin) and sphere_radius
@@ -120,7 +160,20 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return(0);
 
+#if defined (__AVX__) && defined (__AVX2__)
+  return countWithinDistanceAVX (model_coefficients, threshold);
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  return countWithinDistanceSSE (model_coefficients, threshold);
+#else
+  return countWithinDistanceStandard (model_coefficients, threshold);
+#endif
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
   // Obtain the sphere centroid
   Eigen::Vector4f center = model_coefficients;
   center[3] = 0.0f;
@@ -128,7 +181,7 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistance (
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the sphere centroid as the difference between
     // dist(point,sphere_origin) and sphere_radius
@@ -156,6 +209,116 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistance (
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  __m128i res = _mm_set1_epi32(0); // This corresponds to nr_p: 4 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 mask = _mm_cmplt_ps (dist4 (i, model_coefficients), threshold_vec); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm_add_epi32 (res, _mm_and_si128 (_mm_set1_epi32 (1), _mm_castps_si128 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm_extract_epi32 (res, 0);
+  nr_p += _mm_extract_epi32 (res, 1);
+  nr_p += _mm_extract_epi32 (res, 2);
+  nr_p += _mm_extract_epi32 (res, 3);
+
+  // Process the remaining points (at most 3)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#if defined (__AVX__) && defined (__AVX2__)
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  std::size_t nr_p = 0;
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  __m256i res = _mm256_set1_epi32(0); // This corresponds to nr_p: 8 32bit integers that, summed together, hold the number of inliers
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 mask = _mm256_cmp_ps (dist8 (i, model_coefficients), threshold_vec, _CMP_LT_OQ); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
+    res = _mm256_add_epi32 (res, _mm256_and_si256 (_mm256_set1_epi32 (1), _mm256_castps_si256 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
+  }
+  nr_p += _mm256_extract_epi32 (res, 0);
+  nr_p += _mm256_extract_epi32 (res, 1);
+  nr_p += _mm256_extract_epi32 (res, 2);
+  nr_p += _mm256_extract_epi32 (res, 3);
+  nr_p += _mm256_extract_epi32 (res, 4);
+  nr_p += _mm256_extract_epi32 (res, 5);
+  nr_p += _mm256_extract_epi32 (res, 6);
+  nr_p += _mm256_extract_epi32 (res, 7);
+
+  // Process the remaining points (at most 7)
+  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
+  return (nr_p);
+}
+#endif
+
+#define AT(POS) ((*input_)[(*indices_)[(POS)]])
+#define NT(POS) ((*normals_)[(*indices_)[(POS)]])
+
+#ifdef __AVX__
+// This function computes the distances of 8 points to the sphere, combining the distance to the sphere surface and
+// the angle between the point normal and the sphere normal like countWithinDistanceStandard. The distance of point i
+// is in the highest element. The angle is computed with an approximate acos, see getAcuteAngle3DAVX.
+template <typename PointT, typename PointNT> inline __m256
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::dist8 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  // Vector from the sphere center to the points
+  const __m256 dx = _mm256_sub_ps (_mm256_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x, AT(i+4).x, AT(i+5).x, AT(i+6).x, AT(i+7).x), _mm256_set1_ps (model_coefficients[0]));
+  const __m256 dy = _mm256_sub_ps (_mm256_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y, AT(i+4).y, AT(i+5).y, AT(i+6).y, AT(i+7).y), _mm256_set1_ps (model_coefficients[1]));
+  const __m256 dz = _mm256_sub_ps (_mm256_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z, AT(i+4).z, AT(i+5).z, AT(i+6).z, AT(i+7).z), _mm256_set1_ps (model_coefficients[2]));
+  const __m256 center_dist = _mm256_sqrt_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy)), _mm256_mul_ps (dz, dz)));
+  const __m256 weight_vec = _mm256_set1_ps (normal_distance_weight_);
+  const __m256 weighted_euclid_dist = _mm256_mul_ps (_mm256_sub_ps (_mm256_set1_ps (1.0f), weight_vec),
+                                                     _mm256_andnot_ps (abs_help, _mm256_sub_ps (center_dist, _mm256_set1_ps (model_coefficients[3]))));
+  // Angle between the point normal and the normalized d
+  const __m256 inv_center_dist = _mm256_div_ps (_mm256_set1_ps (1.0f), center_dist);
+  const __m256 d_normal = getAcuteAngle3DAVX (_mm256_set_ps (NT(i  ).normal_x, NT(i+1).normal_x, NT(i+2).normal_x, NT(i+3).normal_x, NT(i+4).normal_x, NT(i+5).normal_x, NT(i+6).normal_x, NT(i+7).normal_x),
+                                              _mm256_set_ps (NT(i  ).normal_y, NT(i+1).normal_y, NT(i+2).normal_y, NT(i+3).normal_y, NT(i+4).normal_y, NT(i+5).normal_y, NT(i+6).normal_y, NT(i+7).normal_y),
+                                              _mm256_set_ps (NT(i  ).normal_z, NT(i+1).normal_z, NT(i+2).normal_z, NT(i+3).normal_z, NT(i+4).normal_z, NT(i+5).normal_z, NT(i+6).normal_z, NT(i+7).normal_z),
+                                              _mm256_mul_ps (dx, inv_center_dist), _mm256_mul_ps (dy, inv_center_dist), _mm256_mul_ps (dz, inv_center_dist));
+  return _mm256_andnot_ps (abs_help, _mm256_add_ps (_mm256_mul_ps (weight_vec, d_normal), weighted_euclid_dist));
+}
+#endif // ifdef __AVX__
+
+#ifdef __SSE__
+// This function computes the distances of 4 points to the sphere, see dist8
+template <typename PointT, typename PointNT> inline __m128
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::dist4 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const
+{
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  // Vector from the sphere center to the points
+  const __m128 dx = _mm_sub_ps (_mm_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x), _mm_set1_ps (model_coefficients[0]));
+  const __m128 dy = _mm_sub_ps (_mm_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y), _mm_set1_ps (model_coefficients[1]));
+  const __m128 dz = _mm_sub_ps (_mm_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z), _mm_set1_ps (model_coefficients[2]));
+  const __m128 center_dist = _mm_sqrt_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)), _mm_mul_ps (dz, dz)));
+  const __m128 weight_vec = _mm_set1_ps (normal_distance_weight_);
+  const __m128 weighted_euclid_dist = _mm_mul_ps (_mm_sub_ps (_mm_set1_ps (1.0f), weight_vec),
+                                                  _mm_andnot_ps (abs_help, _mm_sub_ps (center_dist, _mm_set1_ps (model_coefficients[3]))));
+  // Angle between the point normal and the normalized d
+  const __m128 inv_center_dist = _mm_div_ps (_mm_set1_ps (1.0f), center_dist);
+  const __m128 d_normal = getAcuteAngle3DSSE (_mm_set_ps (NT(i  ).normal_x, NT(i+1).normal_x, NT(i+2).normal_x, NT(i+3).normal_x),
+                                              _mm_set_ps (NT(i  ).normal_y, NT(i+1).normal_y, NT(i+2).normal_y, NT(i+3).normal_y),
+                                              _mm_set_ps (NT(i  ).normal_z, NT(i+1).normal_z, NT(i+2).normal_z, NT(i+3).normal_z),
+                                              _mm_mul_ps (dx, inv_center_dist), _mm_mul_ps (dy, inv_center_dist), _mm_mul_ps (dz, inv_center_dist));
+  return _mm_andnot_ps (abs_help, _mm_add_ps (_mm_mul_ps (weight_vec, d_normal), weighted_euclid_dist));
+}
+#endif // ifdef __SSE__
+
+#undef NT
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModel (
@@ -180,8 +343,26 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist8 (i, model_coefficients));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist4 (i, model_coefficients));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the sphere
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the sphere as the difference between
     // dist(point,sphere_origin) and sphere_radius
@@ -205,6 +386,47 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> bool
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModelChunk (
+      const Eigen::VectorXf &model_coefficients, const Indices &chunk, std::vector<double> &distances) const
+{
+  if (!normals_)
+  {
+    PCL_ERROR ("[pcl::SampleConsensusModelNormalSphere::getDistancesToModelChunk] No input dataset containing normals was given!\n");
+    distances.clear ();
+    return (true);
+  }
+
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return (true);
+  }
+
+  // Obtain the sphere centroid
+  Eigen::Vector4f center = model_coefficients;
+  center[3] = 0.0f;
+
+  distances.resize (chunk.size ());
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+  {
+    Eigen::Vector4f p ((*input_)[chunk[i]].x, (*input_)[chunk[i]].y, (*input_)[chunk[i]].z, 0.0f);
+
+    Eigen::Vector4f n_dir = (p-center);
+    const double weighted_euclid_dist = (1.0 - normal_distance_weight_) * std::abs (n_dir.norm () - model_coefficients[3]);
+
+    // Calculate the angular distance between the point normal and the sphere normal
+    Eigen::Vector4f n ((*normals_)[chunk[i]].normal[0], (*normals_)[chunk[i]].normal[1], (*normals_)[chunk[i]].normal[2], 0.0f);
+    double d_normal = std::abs (getAngle3D (n, n_dir));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+
+    distances[i] = std::abs (normal_distance_weight_ * d_normal + weighted_euclid_dist);
+  }
+  return (true);
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelNormalSphere(PointT, PointNT) template class PCL_EXPORTS pcl::SampleConsensusModelNormalSphere<PointT, PointNT>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_NORMAL_SPHERE_H_
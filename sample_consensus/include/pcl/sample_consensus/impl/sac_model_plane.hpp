@@ -154,8 +154,36 @@ pcl::SampleConsensusModelPlane<PointT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist8 (i, a_vec, b_vec, c_vec, d_vec, abs_help));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist4 (i, a_vec, b_vec, c_vec, d_vec, abs_help));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the plane
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the plane normal as the dot product
     // D = (P-A).N/|N|
@@ -171,6 +199,28 @@ pcl::SampleConsensusModelPlane<PointT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::SampleConsensusModelPlane<PointT>::getDistancesToModelChunk (
+      const Eigen::VectorXf &model_coefficients, const Indices &chunk, std::vector<double> &distances) const
+{
+  // Check if the model is valid given the user constraints (isModelValid is virtual, so this
+  // also covers the constraints of the parallel and perpendicular plane models)
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return (true);
+  }
+
+  distances.resize (chunk.size ());
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+  {
+    const PointT &pt = (*input_)[chunk[i]];
+    distances[i] = std::abs (model_coefficients[0] * pt.x + model_coefficients[1] * pt.y + model_coefficients[2] * pt.z + model_coefficients[3]);
+  }
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
@@ -188,8 +238,58 @@ pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 abs_help = _mm256_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m256 threshold_vec = _mm256_set1_ps (threshold);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = dist8 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (dist_vec, threshold_vec, _CMP_LT_OQ)); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[7 - j]);
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+  const __m128 threshold_vec = _mm_set1_ps (threshold);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = dist4 (i, a_vec, b_vec, c_vec, d_vec, abs_help);
+    const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist_vec, threshold_vec)); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (dist[3 - j]);
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the plane
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the plane normal as the dot product
     // D = (P-A).N/|N|
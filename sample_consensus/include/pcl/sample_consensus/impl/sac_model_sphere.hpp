@@ -166,8 +166,34 @@ pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
   distances.resize (indices_->size ());
 
   const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 radius_vec = _mm256_set1_ps (model_coefficients[3]);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, _mm256_andnot_ps (_mm256_set1_ps (-0.0F), _mm256_sub_ps (_mm256_sqrt_ps (sqr_dist8 (i, a_vec, b_vec, c_vec)), radius_vec)));
+    for (std::size_t j = 0; j < 8; ++j)
+      distances[i + j] = dist[7 - j]; // Point i is in the highest element
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 radius_vec = _mm_set1_ps (model_coefficients[3]);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, _mm_andnot_ps (_mm_set1_ps (-0.0F), _mm_sub_ps (_mm_sqrt_ps (sqr_dist4 (i, a_vec, b_vec, c_vec)), radius_vec)));
+    for (std::size_t j = 0; j < 4; ++j)
+      distances[i + j] = dist[3 - j]; // Point i is in the highest element
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the sphere
+  for (; i < indices_->size (); ++i)
   {
     // Calculate the distance from the point to the sphere as the difference between
     //dist(point,sphere_origin) and sphere_radius
@@ -175,6 +201,25 @@ pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::SampleConsensusModelSphere<PointT>::getDistancesToModelChunk (
+      const Eigen::VectorXf &model_coefficients, const Indices &chunk, std::vector<double> &distances) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return (true);
+  }
+  distances.resize (chunk.size ());
+
+  const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+    distances[i] = std::abs (((*input_)[chunk[i]].getVector3fMap () - center).norm () - model_coefficients[3]);
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
@@ -195,8 +240,56 @@ pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
   const float sqr_inner_radius = (model_coefficients[3] <= threshold ? 0.0f : (model_coefficients[3] - threshold) * (model_coefficients[3] - threshold));
   const float sqr_outer_radius = (model_coefficients[3] + threshold) * (model_coefficients[3] + threshold);
   const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  std::size_t i = 0;
+#if defined (__AVX__) && defined (__AVX2__)
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 sqr_inner_radius_vec = _mm256_set1_ps (sqr_inner_radius);
+  const __m256 sqr_outer_radius_vec = _mm256_set1_ps (sqr_outer_radius);
+  for (; (i + 8) <= indices_->size (); i += 8)
+  {
+    const __m256 dist_vec = sqr_dist8 (i, a_vec, b_vec, c_vec);
+    const int mask = _mm256_movemask_ps (_mm256_and_ps (_mm256_cmp_ps (dist_vec, sqr_outer_radius_vec, _CMP_LE_OQ), _mm256_cmp_ps (dist_vec, sqr_inner_radius_vec, _CMP_GE_OQ))); // Bit 7-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (32) float dist[8];
+    _mm256_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      if (mask & (1 << (7 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (static_cast<double> (std::abs (std::sqrt (dist[7 - j]) - model_coefficients[3])));
+      }
+    }
+  }
+#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 sqr_inner_radius_vec = _mm_set1_ps (sqr_inner_radius);
+  const __m128 sqr_outer_radius_vec = _mm_set1_ps (sqr_outer_radius);
+  for (; (i + 4) <= indices_->size (); i += 4)
+  {
+    const __m128 dist_vec = sqr_dist4 (i, a_vec, b_vec, c_vec);
+    const int mask = _mm_movemask_ps (_mm_and_ps (_mm_cmple_ps (dist_vec, sqr_outer_radius_vec), _mm_cmpge_ps (dist_vec, sqr_inner_radius_vec))); // Bit 3-j is set if point i+j is an inlier
+    if (mask == 0)
+      continue;
+    alignas (16) float dist[4];
+    _mm_store_ps (dist, dist_vec);
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      if (mask & (1 << (3 - j)))
+      {
+        inliers.push_back ((*indices_)[i + j]);
+        error_sqr_dists_.push_back (static_cast<double> (std::abs (std::sqrt (dist[3 - j]) - model_coefficients[3])));
+      }
+    }
+  }
+#endif
+  // Iterate through the remaining 3d points and calculate the distances from them to the sphere
+  for (; i < indices_->size (); ++i)
   {
     // To avoid sqrt computation: consider one larger sphere (radius + threshold) and one smaller sphere (radius - threshold).
     // Valid if point is in larger sphere, but not in smaller sphere.
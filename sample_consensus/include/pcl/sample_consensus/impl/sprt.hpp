@@ -0,0 +1,281 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_SPRT_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_SPRT_H_
+
+#include <pcl/sample_consensus/sprt.h>
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::SPRTSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
+{
+  // Warn and exit if no threshold was set
+  if (threshold_ == std::numeric_limits<double>::max())
+  {
+    PCL_ERROR ("[pcl::SPRTSampleConsensus::computeModel] No threshold set!\n");
+    return (false);
+  }
+
+  const Indices &indices = *sac_model_->getIndices ();
+  const std::size_t nr_points = indices.size ();
+  if (nr_points == 0)
+  {
+    PCL_ERROR ("[pcl::SPRTSampleConsensus::computeModel] No input points given!\n");
+    return (false);
+  }
+
+  const std::size_t chunk_size = (std::max<std::size_t>) (chunk_size_, 1);
+  // A hypothesis that survived the test on this many points is most likely a good model. Its remaining points are
+  // not looked at in random order, since counting all inliers at once is much faster.
+  const std::size_t max_tested = (std::max) (nr_points / 16, (std::min) (nr_points, 16 * chunk_size));
+
+  iterations_ = 0;
+  std::size_t n_best_inliers_count = 0;
+  double k = std::numeric_limits<double>::max ();
+
+  // Current estimates of the inlier ratio of a good model and of the fraction of points consistent with a bad model
+  double epsilon = initial_epsilon_;
+  double delta = initial_delta_;
+  double decision_threshold = computeDecisionThreshold (epsilon, delta);
+  double delta_sum = 0.0;
+  std::size_t n_rejected = 0;
+
+  Indices selection, chunk;
+  Eigen::VectorXf model_coefficients;
+  std::vector<double> distances;
+  bool chunked = true;
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Iterate
+  while (iterations_ < k && skipped_count < max_skip)
+  {
+    // Get X samples which satisfy the model criteria
+    sac_model_->getSamples (iterations_, selection);
+
+    if (selection.empty ())
+    {
+      PCL_ERROR ("[pcl::SPRTSampleConsensus::computeModel] No samples could be selected!\n");
+      break;
+    }
+
+    // Search for inliers in the point cloud for the current plane model M
+    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    {
+      //iterations_++;
+      ++skipped_count;
+      continue;
+    }
+
+    // Evaluate the points chunk by chunk, and stop as soon as the likelihood ratio exceeds the decision threshold
+    double lambda = 1.0;
+    std::size_t n_tested = 0, n_inliers_count = 0;
+    bool valid = true, rejected = false;
+    if (chunked)
+    {
+      const double inlier_factor = delta / epsilon;
+      const double outlier_factor = (1.0 - delta) / (1.0 - epsilon);
+      while (n_tested < max_tested && !rejected)
+      {
+        // The test assumes that the points are independent random draws
+        chunk.resize ((std::min) (chunk_size, max_tested - n_tested));
+        for (auto &index : chunk)
+          index = indices[(std::min) (nr_points - 1, static_cast<std::size_t> (static_cast<double> (nr_points) * this->rnd ()))];
+
+        if (!sac_model_->getDistancesToModelChunk (model_coefficients, chunk, distances))
+        {
+          if (debug_verbosity_level > 0)
+            PCL_DEBUG ("[pcl::SPRTSampleConsensus::computeModel] The model can not be evaluated in chunks, all hypotheses are verified on all points.\n");
+          chunked = false;
+          break;
+        }
+        if (distances.size () != chunk.size ())
+        {
+          valid = false;
+          break;
+        }
+
+        for (const double &distance : distances)
+        {
+          ++n_tested;
+          if (distance <= threshold_)
+          {
+            ++n_inliers_count;
+            lambda *= inlier_factor;
+          }
+          else
+            lambda *= outlier_factor;
+          if (lambda > decision_threshold)
+          {
+            rejected = true;
+            break;
+          }
+        }
+      }
+    }
+    if (!rejected && valid)
+      n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
+
+    ++iterations_;
+
+    if (rejected)
+    {
+      // Re-estimate the fraction of points consistent with a bad model from the rejected models, and adapt the
+      // test if the estimate changed noticeably
+      delta_sum += static_cast<double> (n_inliers_count) / static_cast<double> (n_tested);
+      ++n_rejected;
+      const double delta_estimate = (std::max) (delta_sum / static_cast<double> (n_rejected), 0.001);
+      if (std::abs (delta_estimate - delta) > 0.05 * delta)
+      {
+        delta = delta_estimate;
+        decision_threshold = computeDecisionThreshold (epsilon, delta);
+      }
+    }
+    // Better match ?
+    else if (valid && n_inliers_count > n_best_inliers_count)
+    {
+      const std::size_t n_previous_best_inliers_count = n_best_inliers_count;
+      n_best_inliers_count = n_inliers_count;
+
+      // Save the current model/coefficients selection as being the best so far
+      model_              = selection;
+      model_coefficients_ = model_coefficients;
+
+      // Refine the new best model by least squares fitting on its inliers. Gains that are within the statistical
+      // noise of the inlier count (one standard deviation) are not worth it.
+      if (static_cast<double> (n_best_inliers_count - n_previous_best_inliers_count) > std::sqrt (static_cast<double> (n_previous_best_inliers_count)))
+        optimizeBestModel (n_best_inliers_count);
+
+      // Design a new test for the inlier ratio of the best model
+      epsilon = static_cast<double> (n_best_inliers_count) / static_cast<double> (nr_points);
+      decision_threshold = computeDecisionThreshold (epsilon, delta);
+
+      // Compute the k parameter, taking into account that a good model is rejected with probability 1/A
+      // (k=std::log(z)/std::log(1-w^n*(1-1/A)))
+      double p_no_outliers = 1.0 - std::pow (epsilon, static_cast<double> (selection.size ())) * (1.0 - 1.0 / decision_threshold);
+      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+      k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+    }
+
+    if (debug_verbosity_level > 1)
+      PCL_DEBUG ("[pcl::SPRTSampleConsensus::computeModel] Trial %d out of %f: %s after %lu points (best is: %lu inliers so far).\n", iterations_, k, rejected ? "rejected" : "accepted", n_tested, n_best_inliers_count);
+    if (iterations_ > max_iterations_)
+    {
+      if (debug_verbosity_level > 0)
+        PCL_DEBUG ("[pcl::SPRTSampleConsensus::computeModel] SPRT RANSAC reached the maximum number of trials.\n");
+      break;
+    }
+  }
+
+  if (debug_verbosity_level > 0)
+    PCL_DEBUG ("[pcl::SPRTSampleConsensus::computeModel] Model: %lu size, %lu inliers, %lu of %d hypotheses rejected early.\n", model_.size (), n_best_inliers_count, n_rejected, iterations_);
+
+  if (model_.empty ())
+  {
+    PCL_ERROR ("[pcl::SPRTSampleConsensus::computeModel] Unable to find a solution!\n");
+    inliers_.clear ();
+    return (false);
+  }
+
+  // Get the set of inliers that correspond to the best model found so far
+  sac_model_->selectWithinDistance (model_coefficients_, threshold_, inliers_);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::SPRTSampleConsensus<PointT>::computeDecisionThreshold (double epsilon, double delta) const
+{
+  // The test can only tell good from bad models if good models have more inliers
+  if (delta <= 0.0 || epsilon >= 1.0 || delta >= epsilon)
+    return (std::numeric_limits<double>::max ());
+
+  // A is the solution of A = K1 + 1 + log (A), with K1 = t_M * C / m_S (here m_S = 1, one model per sample) and C
+  // the expected log likelihood ratio per point of a bad model. The fixed point iteration converges very fast.
+  const double c = (1.0 - delta) * std::log ((1.0 - delta) / (1.0 - epsilon)) + delta * std::log (delta / epsilon);
+  const double k1 = model_estimation_cost_ * c;
+  double a = k1 + 1.0;
+  for (int i = 0; i < 10; ++i)
+  {
+    const double a_next = k1 + 1.0 + std::log (a);
+    if (std::abs (a_next - a) < 1e-5)
+      return (a_next);
+    a = a_next;
+  }
+  return (a);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SPRTSampleConsensus<PointT>::optimizeBestModel (std::size_t &n_best_inliers_count)
+{
+  if (lo_iterations_ <= 0)
+    return;
+
+  Indices inliers;
+  Eigen::VectorXf refined_coefficients;
+  sac_model_->selectWithinDistance (model_coefficients_, threshold_, inliers);
+  for (int i = 0; i < lo_iterations_; ++i)
+  {
+    // Fit to a random subset of the inliers, as the fit to all of them can be expensive (e.g. the non-linear
+    // optimization of a cylinder)
+    const std::size_t lo_sample_size = (std::min<std::size_t>) (inliers.size (), 1000);
+    for (std::size_t j = 0; j < lo_sample_size; ++j)
+      std::swap (inliers[j], inliers[(std::min) (inliers.size () - 1, j + static_cast<std::size_t> (static_cast<double> (inliers.size () - j) * this->rnd ()))]);
+    inliers.resize (lo_sample_size);
+
+    sac_model_->optimizeModelCoefficients (inliers, model_coefficients_, refined_coefficients);
+    // Stop as soon as the refinement does not gain any inliers
+    const std::size_t n_refined_inliers_count = sac_model_->countWithinDistance (refined_coefficients, threshold_);
+    if (n_refined_inliers_count <= n_best_inliers_count)
+      break;
+    n_best_inliers_count = n_refined_inliers_count;
+    model_coefficients_ = refined_coefficients;
+    if (i + 1 < lo_iterations_)
+      sac_model_->selectWithinDistance (model_coefficients_, threshold_, inliers);
+  }
+}
+
+#define PCL_INSTANTIATE_SPRTSampleConsensus(T) template class PCL_EXPORTS pcl::SPRTSampleConsensus<T>;
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_SPRT_H_
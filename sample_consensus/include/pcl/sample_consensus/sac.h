@@ -46,9 +46,15 @@
 #include <boost/random/mersenne_twister.hpp> // for mt19937
 #include <boost/random/uniform_01.hpp> // for uniform_01
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
 #include <ctime>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace pcl
 {
@@ -165,7 +171,11 @@ namespace pcl
 
       /** \brief Set the number of threads to use or turn off parallelization.
         * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically, a negative number turns parallelization off)
-        * \note Not all SAC methods have a parallel implementation. Some will ignore this setting.
+        * \note Except for RANSAC, the methods draw their hypotheses sequentially and evaluate them in parallel
+        * batches, so the result of a call on a freshly seeded model does not depend on the number of threads.
+        * The last batch can draw more samples than are evaluated, so the state of the random number generator
+        * afterwards, and with it the result of further calls on the same model, does. SPRT RANSAC ignores
+        * this setting.
         */
       inline void
       setNumberOfThreads (const int nr_threads = -1) { threads_ = nr_threads; }
@@ -355,5 +365,75 @@ namespace pcl
       {
         return ((*rng_) ());
       }
+
+      /** \brief Get the number of threads used to evaluate hypotheses, resolved from threads_.
+        * Returns 1 if parallelization is turned off or OpenMP is not available.
+        */
+      inline int
+      getNumberOfEvaluationThreads () const
+      {
+#ifdef _OPENMP
+        if (threads_ == 0)
+          return (omp_get_num_procs ());
+        return ((std::max) (threads_, 1));
+#else
+        return (1);
+#endif
+      }
+
+      /** \brief Get the number of hypotheses that are drawn and evaluated together.
+        * This is 1 when running single-threaded, so that no hypotheses are evaluated in vain.
+        */
+      inline std::size_t
+      getHypothesisBatchSize () const
+      {
+        const int threads = getNumberOfEvaluationThreads ();
+        return (threads > 1 ? 2 * static_cast<std::size_t> (threads) : 1);
+      }
+
+      /** \brief Draw up to \a nr_samples consecutive samples from the model.
+        * The samples are drawn sequentially with the random number generator of the model, so the
+        * hypotheses only depend on the seed and not on the number of threads used to evaluate them.
+        * Samples that are drawn but not evaluated still advance the random number generator.
+        * Drawing stops at the first sample that could not be selected.
+        * \param[in] nr_samples the maximum number of samples to draw
+        * \param[out] samples the resultant samples
+        */
+      inline void
+      drawSamples (std::size_t nr_samples, std::vector<Indices> &samples)
+      {
+        samples.resize (nr_samples);
+        for (std::size_t i = 0; i < nr_samples; ++i)
+        {
+          int iterations = iterations_;
+          sac_model_->getSamples (iterations, samples[i]);
+          if (samples[i].empty ())
+          {
+            samples.resize (i);
+            return;
+          }
+        }
+      }
+
+      /** \brief Call \a evaluate for each hypothesis index in [0, nr_hypotheses), in parallel if requested.
+        * \a evaluate must only use the thread-safe (const) part of the model interface and must only
+        * write the results of the hypothesis it was called for.
+        * \param[in] nr_hypotheses the number of hypotheses to evaluate
+        * \param[in] evaluate the function evaluating a single hypothesis
+        */
+      template <typename Function> inline void
+      evaluateHypotheses (std::size_t nr_hypotheses, const Function &evaluate) const
+      {
+        int threads = getNumberOfEvaluationThreads ();
+        if (threads == 1 || nr_hypotheses < 2)
+        {
+          for (std::size_t i = 0; i < nr_hypotheses; ++i)
+            evaluate (i);
+          return;
+        }
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+        for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (nr_hypotheses); ++i)
+          evaluate (static_cast<std::size_t> (i));
+      }
    };
 }
@@ -240,6 +240,25 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients,
                            std::vector<double> &distances) const = 0;
 
+      /** \brief Compute the distances from a chunk of the cloud data to a given model.
+        * In contrast to getDistancesToModel, only the given points are looked at, which allows
+        * estimators such as SPRTSampleConsensus to evaluate a model chunk by chunk and to stop
+        * as soon as the model can be rejected. A model that changes the distances of a base model
+        * implementing this method has to override it as well.
+        * Implementations of this function must be thread-safe.
+        * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
+        * \param[in] chunk the indices of the points to compute the distances for (a subset of the indices of this model)
+        * \param[out] distances the resultant distances, one per entry of \a chunk, or empty if the model is invalid
+        * \return false if the model does not support evaluating chunks (the default), true otherwise
+        */
+      virtual bool
+      getDistancesToModelChunk (const Eigen::VectorXf &/*model_coefficients*/,
+                                const Indices &/*chunk*/,
+                                std::vector<double> &/*distances*/) const
+      {
+        return (false);
+      }
+
       /** \brief Select all the points which respect the given model
         * coefficients as inliers. Pure virtual.
         * 
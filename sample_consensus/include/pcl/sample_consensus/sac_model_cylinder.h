@@ -179,6 +179,17 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients,
                            std::vector<double> &distances) const override;
 
+      /** \brief Compute the distances from a chunk of the cloud data to a given cylinder model.
+        * \param[in] model_coefficients the coefficients of a cylinder model that we need to compute distances to
+        * \param[in] chunk the indices of the points to compute the distances for
+        * \param[out] distances the resultant estimated distances, one per entry of \a chunk
+        * \return true
+        */
+      bool
+      getDistancesToModelChunk (const Eigen::VectorXf &model_coefficients,
+                                const Indices &chunk,
+                                std::vector<double> &distances) const override;
+
       /** \brief Select all the points which respect the given model coefficients as inliers.
         * \param[in] model_coefficients the coefficients of a cylinder model that we need to compute distances to
         * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
@@ -289,6 +300,34 @@ namespace pcl
       bool
       isSampleGood (const Indices &samples) const override;
 
+      /** This implementation uses no SIMD instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceStandard (const Eigen::VectorXf &model_coefficients,
+                                   const double threshold,
+                                   std::size_t i = 0) const;
+
+#if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+      /** This implementation uses SSE, SSE2, and SSE4.1 instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceSSE (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t i = 0) const;
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+      /** This implementation uses AVX and AVX2 instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceAVX (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t i = 0) const;
+#endif
+
     private:
       /** \brief The axis along which we need to search for a cylinder direction. */
       Eigen::Vector3f axis_;
@@ -331,6 +370,14 @@ namespace pcl
         const pcl::SampleConsensusModelCylinder<PointT, PointNT> *model_;
         const Indices &indices_;
       };
+
+#ifdef __AVX__
+      inline __m256 dist8 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const;
+#endif
+
+#ifdef __SSE__
+      inline __m128 dist4 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const;
+#endif
   };
 }
 
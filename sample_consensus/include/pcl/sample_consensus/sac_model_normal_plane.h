@@ -155,6 +155,17 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients,
                            std::vector<double> &distances) const override;
 
+      /** \brief Compute the distances from a chunk of the cloud data to a given plane model.
+        * \param[in] model_coefficients the coefficients of a plane model that we need to compute distances to
+        * \param[in] chunk the indices of the points to compute the distances for
+        * \param[out] distances the resultant estimated distances, one per entry of \a chunk
+        * \return true
+        */
+      bool
+      getDistancesToModelChunk (const Eigen::VectorXf &model_coefficients,
+                                const Indices &chunk,
+                                std::vector<double> &distances) const override;
+
       /** \brief Return a unique id for this model (SACMODEL_NORMAL_PLANE). */
       inline pcl::SacModel 
       getModelType () const override { return (SACMODEL_NORMAL_PLANE); }
@@ -192,6 +203,15 @@ namespace pcl
                               const double threshold,
                               std::size_t i = 0) const;
 #endif
+
+    private:
+#ifdef __AVX__
+      inline __m256 dist8 (const std::size_t i, const __m256 &a_vec, const __m256 &b_vec, const __m256 &c_vec, const __m256 &d_vec, const __m256 &normal_distance_weight_vec, const __m256 &abs_help) const;
+#endif
+
+#ifdef __SSE__
+      inline __m128 dist4 (const std::size_t i, const __m128 &a_vec, const __m128 &b_vec, const __m128 &c_vec, const __m128 &d_vec, const __m128 &normal_distance_weight_vec, const __m128 &abs_help) const;
+#endif
   };
 }
 
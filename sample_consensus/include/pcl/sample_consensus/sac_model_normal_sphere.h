@@ -148,6 +148,17 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients,
                            std::vector<double> &distances) const override;
 
+      /** \brief Compute the distances from a chunk of the cloud data to a given sphere model.
+        * \param[in] model_coefficients the coefficients of a sphere model that we need to compute distances to
+        * \param[in] chunk the indices of the points to compute the distances for
+        * \param[out] distances the resultant estimated distances, one per entry of \a chunk
+        * \return true
+        */
+      bool
+      getDistancesToModelChunk (const Eigen::VectorXf &model_coefficients,
+                                const Indices &chunk,
+                                std::vector<double> &distances) const override;
+
       /** \brief Return a unique id for this model (SACMODEL_NORMAL_SPHERE). */
       inline pcl::SacModel 
       getModelType () const override { return (SACMODEL_NORMAL_SPHERE); }
@@ -158,6 +169,43 @@ namespace pcl
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
       using SampleConsensusModelSphere<PointT>::isModelValid;
+
+      /** This implementation uses no SIMD instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceStandard (const Eigen::VectorXf &model_coefficients,
+                                   const double threshold,
+                                   std::size_t i = 0) const;
+
+#if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
+      /** This implementation uses SSE, SSE2, and SSE4.1 instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceSSE (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t i = 0) const;
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+      /** This implementation uses AVX and AVX2 instructions. It is not intended for normal use.
+        * See countWithinDistance which automatically uses the fastest implementation.
+        */
+      std::size_t
+      countWithinDistanceAVX (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t i = 0) const;
+#endif
+
+    private:
+#ifdef __AVX__
+      inline __m256 dist8 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const;
+#endif
+
+#ifdef __SSE__
+      inline __m128 dist4 (const std::size_t i, const Eigen::VectorXf &model_coefficients) const;
+#endif
   };
 }
 
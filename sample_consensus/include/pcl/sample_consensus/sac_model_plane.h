@@ -196,6 +196,17 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients,
                            std::vector<double> &distances) const override;
 
+      /** \brief Compute the distances from a chunk of the cloud data to a given plane model.
+        * \param[in] model_coefficients the coefficients of a plane model that we need to compute distances to
+        * \param[in] chunk the indices of the points to compute the distances for
+        * \param[out] distances the resultant estimated distances, one per entry of \a chunk
+        * \return true
+        */
+      bool
+      getDistancesToModelChunk (const Eigen::VectorXf &model_coefficients,
+                                const Indices &chunk,
+                                std::vector<double> &distances) const override;
+
       /** \brief Select all the points which respect the given model coefficients as inliers.
         * \param[in] model_coefficients the coefficients of a plane model that we need to compute distances to
         * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
@@ -0,0 +1,203 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/sample_consensus/sac.h>
+#include <pcl/sample_consensus/sac_model.h>
+
+namespace pcl
+{
+  /** \brief @b SPRTSampleConsensus represents an implementation of RANSAC with randomized model verification
+    * by Wald's sequential probability ratio test (SPRT), as described in: "Optimal Randomized RANSAC",
+    * O. Chum and J. Matas, IEEE Transactions on Pattern Analysis and Machine Intelligence, vol 30, 2008.
+    * Each hypothesis is evaluated on the points in random order, chunk by chunk, and discarded as soon as the test
+    * decides that it is a bad model. Only the few hypotheses which pass the test are evaluated on all points, which
+    * makes this method much faster than RANSAC on large clouds. The probabilities needed by the test (the inlier
+    * ratio of a good model and the fraction of points consistent with a bad model) are estimated during the run.
+    * Every time a new best model is found, it is refined by iterative least squares fitting on (a random subset of at
+    * most 1000 of) its inliers (local optimization, as in "Locally Optimized RANSAC", O. Chum, J. Matas and J. Kittler,
+    * DAGM 2003).
+    * \note Early rejection requires the model to implement SampleConsensusModel::getDistancesToModelChunk. For other
+    * models, all hypotheses are evaluated on all points, as in RANSAC.
+    * \ingroup sample_consensus
+    */
+  template <typename PointT>
+  class SPRTSampleConsensus : public SampleConsensus<PointT>
+  {
+    using SampleConsensusModelPtr = typename SampleConsensusModel<PointT>::Ptr;
+
+    public:
+      using Ptr = shared_ptr<SPRTSampleConsensus<PointT> >;
+      using ConstPtr = shared_ptr<const SPRTSampleConsensus<PointT> >;
+
+      using SampleConsensus<PointT>::max_iterations_;
+      using SampleConsensus<PointT>::threshold_;
+      using SampleConsensus<PointT>::iterations_;
+      using SampleConsensus<PointT>::sac_model_;
+      using SampleConsensus<PointT>::model_;
+      using SampleConsensus<PointT>::model_coefficients_;
+      using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::probability_;
+
+      /** \brief SPRT RANSAC main constructor
+        * \param[in] model a Sample Consensus model
+        */
+      SPRTSampleConsensus (const SampleConsensusModelPtr &model)
+        : SampleConsensus<PointT> (model)
+        , initial_epsilon_ (0.1)
+        , initial_delta_ (0.01)
+        , model_estimation_cost_ (200.0)
+        , chunk_size_ (64)
+        , lo_iterations_ (10)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief SPRT RANSAC main constructor
+        * \param[in] model a Sample Consensus model
+        * \param[in] threshold distance to model threshold
+        */
+      SPRTSampleConsensus (const SampleConsensusModelPtr &model, double threshold)
+        : SampleConsensus<PointT> (model, threshold)
+        , initial_epsilon_ (0.1)
+        , initial_delta_ (0.01)
+        , model_estimation_cost_ (200.0)
+        , chunk_size_ (64)
+        , lo_iterations_ (10)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief Compute the actual model and find the inliers
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      bool
+      computeModel (int debug_verbosity_level = 0) override;
+
+      /** \brief Set the inlier ratio of a good model that is assumed until the first model passes the test.
+        * It is replaced by the inlier ratio of the best model found so far.
+        * \param[in] epsilon the initial inlier ratio (0.1 by default)
+        */
+      inline void
+      setInitialInlierRatio (double epsilon) { initial_epsilon_ = epsilon; }
+
+      /** \brief Get the inlier ratio of a good model that is assumed until the first model passes the test. */
+      inline double
+      getInitialInlierRatio () const { return (initial_epsilon_); }
+
+      /** \brief Set the fraction of points that is assumed to be consistent with a bad model, until it can be
+        * estimated from the rejected models.
+        * \param[in] delta the initial fraction of points consistent with a bad model (0.01 by default)
+        */
+      inline void
+      setInitialBadModelInlierRatio (double delta) { initial_delta_ = delta; }
+
+      /** \brief Get the fraction of points that is assumed to be consistent with a bad model at the start. */
+      inline double
+      getInitialBadModelInlierRatio () const { return (initial_delta_); }
+
+      /** \brief Set the time needed to compute a model from a sample, relative to the time needed to compute the
+        * distance of one point to a model. This is used to choose the decision threshold of the test.
+        * \param[in] cost the relative cost of computing a model (200 by default)
+        */
+      inline void
+      setModelEstimationCost (double cost) { model_estimation_cost_ = cost; }
+
+      /** \brief Get the time needed to compute a model, relative to the time needed to verify one point. */
+      inline double
+      getModelEstimationCost () const { return (model_estimation_cost_); }
+
+      /** \brief Set the number of points that are evaluated at once before the test is updated.
+        * \param[in] chunk_size the number of points per chunk (64 by default)
+        */
+      inline void
+      setChunkSize (std::size_t chunk_size) { chunk_size_ = chunk_size; }
+
+      /** \brief Get the number of points that are evaluated at once before the test is updated. */
+      inline std::size_t
+      getChunkSize () const { return (chunk_size_); }
+
+      /** \brief Set the maximum number of least squares refinements of a new best model.
+        * \param[in] lo_iterations the maximum number of local optimization iterations (10 by default, 0 disables it)
+        */
+      inline void
+      setLocalOptimizationIterations (int lo_iterations) { lo_iterations_ = lo_iterations; }
+
+      /** \brief Get the maximum number of least squares refinements of a new best model. */
+      inline int
+      getLocalOptimizationIterations () const { return (lo_iterations_); }
+
+    protected:
+      /** \brief Compute the decision threshold A of the test, given the inlier ratio of a good model and the
+        * fraction of points consistent with a bad model (equation 8 of the paper).
+        * \param[in] epsilon the inlier ratio of a good model
+        * \param[in] delta the fraction of points consistent with a bad model
+        * \return the decision threshold, or the largest double if the test cannot reject any model
+        */
+      double
+      computeDecisionThreshold (double epsilon, double delta) const;
+
+      /** \brief Refine the best model by least squares fitting on its inliers, as long as this increases the
+        * number of inliers.
+        * \param[in,out] n_best_inliers_count the number of inliers of the best model
+        */
+      void
+      optimizeBestModel (std::size_t &n_best_inliers_count);
+
+      /** \brief The inlier ratio of a good model that is assumed until the first model passes the test. */
+      double initial_epsilon_;
+
+      /** \brief The fraction of points consistent with a bad model that is assumed at the start. */
+      double initial_delta_;
+
+      /** \brief The time needed to compute a model, relative to the time needed to verify one point. */
+      double model_estimation_cost_;
+
+      /** \brief The number of points that are evaluated at once. */
+      std::size_t chunk_size_;
+
+      /** \brief The maximum number of local optimization iterations. */
+      int lo_iterations_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/sample_consensus/impl/sprt.hpp>
+#endif
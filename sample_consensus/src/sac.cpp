@@ -40,6 +40,7 @@
 #include <pcl/sample_consensus/impl/msac.hpp>
 #include <pcl/sample_consensus/impl/rmsac.hpp>
 #include <pcl/sample_consensus/impl/prosac.hpp>
+#include <pcl/sample_consensus/impl/sprt.hpp>
 #include <pcl/sample_consensus/impl/mlesac.hpp>
 #include <pcl/sample_consensus/impl/lmeds.hpp>
 
@@ -53,6 +54,7 @@
   PCL_INSTANTIATE(RandomizedMEstimatorSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(RandomizedRandomSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(ProgressiveSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
+  PCL_INSTANTIATE(SPRTSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(MaximumLikelihoodSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(LeastMedianSquares, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
 #else
@@ -61,6 +63,7 @@
   PCL_INSTANTIATE(RandomizedMEstimatorSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(RandomizedRandomSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(ProgressiveSampleConsensus, PCL_XYZ_POINT_TYPES)
+  PCL_INSTANTIATE(SPRTSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(MaximumLikelihoodSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(LeastMedianSquares, PCL_XYZ_POINT_TYPES)
 #endif
@@ -0,0 +1,316 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+#include <pcl/types.h> // for pcl::index_t
+
+#include <deque>
+#include <utility> // for std::pair
+#include <vector>
+
+namespace pcl
+{
+  namespace segmentation
+  {
+    /** \brief @b CompactMaxFlow solves the max-flow/min-cut problem on a graph with a fixed topology, using
+      * the algorithm of Boykov and Kolmogorov ("An Experimental Comparison of Min-Cut/Max-Flow Algorithms for
+      * Energy Minimization in Vision", PAMI 2004).
+      *
+      * The arcs are stored in compressed sparse row order, so a node's arcs are contiguous in memory. Every
+      * edge (u, v) of the graph results in the arc u->v and its reverse arc v->u, each with its own capacity.
+      * Every node is also connected to the source and to the sink terminal.
+      *
+      * The flow of the last call to \ref solve is kept. Changing terminal capacities with
+      * \ref setTerminalCapacities updates it in place (Kohli and Torr, "Dynamic Graph Cuts for Efficient
+      * Inference in Markov Random Fields", PAMI 2007), so the next \ref solve only augments the difference.
+      * Changing an edge capacity discards the flow and the next \ref solve starts from scratch.
+      *
+      * grabcut::BoykovKolmogorov implements the same algorithm for graphs that grow while they are built. It
+      * keeps the arcs of every node in a std::map and always solves from zero flow, so it can neither reuse a
+      * flow nor store large fixed graphs compactly.
+      * \ingroup segmentation
+      */
+    class PCL_EXPORTS CompactMaxFlow
+    {
+      public:
+        /** \brief Empty constructor. */
+        CompactMaxFlow ();
+
+        /** \brief Set the topology of the graph. All capacities are set to zero.
+          * \param[in] number_of_nodes the number of (non terminal) nodes
+          * \param[in] edges the edges of the graph, given as pairs of distinct nodes. The edge number used by
+          * the other methods is the position in this vector.
+          */
+        void
+        setGraph (std::size_t number_of_nodes, const std::vector<std::pair<index_t, index_t> > &edges);
+
+        /** \brief Get the number of (non terminal) nodes. */
+        inline std::size_t
+        getNumberOfNodes () const
+        {
+          return (source_capacity_.size ());
+        }
+
+        /** \brief Get the number of edges. */
+        inline std::size_t
+        getNumberOfEdges () const
+        {
+          return (edge_arcs_.size ());
+        }
+
+        /** \brief Get the two nodes connected by an edge.
+          * \param[in] edge the edge number
+          */
+        std::pair<index_t, index_t>
+        getEdge (std::size_t edge) const;
+
+        /** \brief Set the capacities of an edge. This discards the current flow.
+          * \param[in] edge the edge number
+          * \param[in] capacity_uv the capacity of the arc from the first to the second node of the edge
+          * \param[in] capacity_vu the capacity of the arc from the second to the first node of the edge
+          */
+        void
+        setEdgeCapacity (std::size_t edge, double capacity_uv, double capacity_vu);
+
+        /** \brief Get the capacities of the two arcs of an edge (first to second node, second to first node).
+          * \param[in] edge the edge number
+          */
+        std::pair<double, double>
+        getEdgeCapacity (std::size_t edge) const;
+
+        /** \brief Get the residual capacities of the two arcs of an edge after the last call to \ref solve.
+          * \param[in] edge the edge number
+          */
+        std::pair<double, double>
+        getEdgeResidualCapacity (std::size_t edge) const;
+
+        /** \brief Set the capacities of the arcs from the source to a node and from the node to the sink.
+          * The current flow is kept and adapted to the new capacities.
+          * \param[in] node the node
+          * \param[in] source_capacity the capacity of the arc from the source to the node
+          * \param[in] sink_capacity the capacity of the arc from the node to the sink
+          */
+        void
+        setTerminalCapacities (index_t node, double source_capacity, double sink_capacity);
+
+        /** \brief Get the capacity of the arc from the source to a node. */
+        inline double
+        getSourceCapacity (index_t node) const
+        {
+          return (source_capacity_[node]);
+        }
+
+        /** \brief Get the capacity of the arc from a node to the sink. */
+        inline double
+        getSinkCapacity (index_t node) const
+        {
+          return (sink_capacity_[node]);
+        }
+
+        /** \brief Get the residual capacity of the arc from the source to a node after the last call to
+          * \ref solve. Flow that goes straight from the source through the node to the sink is not counted.
+          */
+        inline double
+        getSourceResidualCapacity (index_t node) const
+        {
+          return (terminal_residual_[node] > 0.0 ? terminal_residual_[node] : 0.0);
+        }
+
+        /** \brief Get the residual capacity of the arc from a node to the sink after the last call to
+          * \ref solve. Flow that goes straight from the source through the node to the sink is not counted.
+          */
+        inline double
+        getSinkResidualCapacity (index_t node) const
+        {
+          return (terminal_residual_[node] < 0.0 ? -terminal_residual_[node] : 0.0);
+        }
+
+        /** \brief Compute the maximum flow, starting from the current flow if it is still valid.
+          * \return the value of the maximum flow, which equals the capacity of the minimum cut
+          */
+        double
+        solve ();
+
+        /** \brief Discard the current flow, so that the next call to \ref solve starts from scratch. */
+        inline void
+        discardFlow ()
+        {
+          flow_is_valid_ = false;
+        }
+
+        /** \brief Get the value of the flow computed by the last call to \ref solve. */
+        inline double
+        getFlow () const
+        {
+          return (flow_);
+        }
+
+        /** \brief Check on which side of the minimum cut a node is, after calling \ref solve. Returns true
+          * if the node can be reached from the source in the residual graph, so the source side is the
+          * smallest possible one.
+          * \param[in] node the node
+          */
+        inline bool
+        inSourceSegment (index_t node) const
+        {
+          return (tree_[node] == SOURCE);
+        }
+
+      protected:
+        /** \brief The search tree a node belongs to. */
+        enum TreeType : unsigned char { FREE = 0, SOURCE = 1, SINK = 2 };
+
+        /** \brief Reset the flow to zero, apart from the flow that goes straight from the source through a
+          * node to the sink.
+          */
+        void
+        resetFlow ();
+
+        /** \brief Build the initial search trees from the nodes with a residual terminal capacity. */
+        void
+        initializeTrees ();
+
+        /** \brief Grow the search tree of a node by its free neighbours.
+          * \param[in] node an active node
+          * \return the arc from the source tree to the sink tree that closes an augmenting path, NO_ARC if
+          * there is none
+          */
+        std::size_t
+        growTree (index_t node);
+
+        /** \brief Push the bottleneck capacity along the path through an arc and orphan the nodes whose
+          * parent arc got saturated.
+          * \param[in] arc the arc from the source tree to the sink tree
+          */
+        void
+        augment (std::size_t arc);
+
+        /** \brief Find a new parent for every orphan, or free it if there is none. */
+        void
+        adoptOrphans ();
+
+        /** \brief Find a new parent for an orphan, or free it and orphan its children.
+          * \param[in] node the orphan
+          */
+        void
+        processOrphan (index_t node);
+
+        /** \brief Add a node to the end of the active queue unless it is already there. */
+        inline void
+        markActive (index_t node)
+        {
+          if (!active_[node])
+          {
+            active_[node] = 1;
+            active_nodes_.push_back (node);
+          }
+        }
+
+        /** \brief Remove and return the first active node that is still in a tree, -1 if there is none. */
+        index_t
+        nextActive ();
+
+        /** \brief Parent value of a node whose parent is a terminal. */
+        static const std::size_t TERMINAL_ARC;
+
+        /** \brief Parent value of an orphan. */
+        static const std::size_t ORPHAN_ARC;
+
+        /** \brief Parent value of a free node, also returned when no arc was found. */
+        static const std::size_t NO_ARC;
+
+        /** \brief Index of the first arc of every node, the arcs of node i are first_arc_[i] .. first_arc_[i+1]-1. */
+        std::vector<std::size_t> first_arc_;
+
+        /** \brief The node every arc points to. */
+        std::vector<index_t> arc_head_;
+
+        /** \brief The reverse arc of every arc. */
+        std::vector<std::size_t> arc_sister_;
+
+        /** \brief The capacity of every arc. */
+        std::vector<double> arc_capacity_;
+
+        /** \brief The residual capacity of every arc. */
+        std::vector<double> arc_residual_;
+
+        /** \brief The arc from the first to the second node of every edge. */
+        std::vector<std::size_t> edge_arcs_;
+
+        /** \brief The capacity of the arc from the source to every node. */
+        std::vector<double> source_capacity_;
+
+        /** \brief The capacity of the arc from every node to the sink. */
+        std::vector<double> sink_capacity_;
+
+        /** \brief Residual capacity to the terminals: positive values from the source, negative ones to the sink. */
+        std::vector<double> terminal_residual_;
+
+        /** \brief The current flow value. */
+        double flow_;
+
+        /** \brief Whether the residual capacities match the capacities, false after an edge capacity changed. */
+        bool flow_is_valid_;
+
+        /** \brief The search tree of every node. */
+        std::vector<unsigned char> tree_;
+
+        /** \brief The arc from every node to its parent in the search tree. */
+        std::vector<std::size_t> parent_;
+
+        /** \brief The time at which the distance of a node to its terminal was last checked. */
+        std::vector<long> timestamp_;
+
+        /** \brief The distance of every node to its terminal, valid at timestamp_. */
+        std::vector<int> distance_;
+
+        /** \brief Whether a node is in the active queue. */
+        std::vector<unsigned char> active_;
+
+        /** \brief The queue of active nodes. */
+        std::deque<index_t> active_nodes_;
+
+        /** \brief The orphans left by the last augmentation. */
+        std::deque<index_t> orphans_;
+
+        /** \brief The number of augmentations done so far. */
+        long time_;
+    };
+  }
+}
@@ -43,6 +43,8 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
 
+#include <cstdint> // for std::uint8_t
+
 namespace pcl
 {
   /** \brief Comparator is the base class for comparators that compare two points given some function.
@@ -95,7 +97,25 @@ namespace pcl
         */
       virtual bool
       compare (int idx1, int idx2) const = 0;
-      
+
+      /** \brief Compares a run of consecutive points with the points at a fixed offset, i.e.
+        * result[i] = compare (first_idx + i, first_idx + i + offset) for i = 0 .. count-1.
+        * Used by OrganizedConnectedComponentSegmentation to compare whole image rows with their left and upper
+        * neighbors. Subclasses can override this with a vectorized implementation, which must give the same
+        * results as compare (). OrganizedConnectedComponentSegmentation only passes runs of points with a finite x
+        * coordinate, like the first points it passes to compare (); the points they are compared with are not checked.
+        * \param[in] first_idx the index of the first point of the run
+        * \param[in] count the number of points in the run
+        * \param[in] offset the offset from every point of the run to the point it is compared with
+        * \param[out] result the result of every comparison (1 or 0), must hold at least count elements
+        */
+      virtual void
+      compareRun (int first_idx, int count, int offset, std::uint8_t* result) const
+      {
+        for (int i = 0; i < count; ++i)
+          result[i] = compare (first_idx + i, first_idx + i + offset);
+      }
+
     protected:
       PointCloudConstPtr input_;
     public:
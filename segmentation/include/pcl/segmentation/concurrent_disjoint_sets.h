@@ -0,0 +1,121 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/types.h> // for pcl::index_t
+
+#include <atomic>
+#include <utility> // for std::swap
+#include <vector>
+
+namespace pcl
+{
+  /** \brief @b ConcurrentDisjointSets is a lock-free union-find over the elements 0 .. n-1, which can be
+    * merged from several threads at the same time.
+    *
+    * A root is always linked below the smaller of the two roots, so the root of every set is its smallest
+    * element, no matter in which order (or from which threads) the sets were merged. Callers use this to
+    * number the sets deterministically, e.g. in the order in which a serial algorithm would have found them.
+    * \ingroup segmentation
+    */
+  class ConcurrentDisjointSets
+  {
+    public:
+      /** \brief Constructor, every element starts in its own set.
+        * \param[in] size the number of elements
+        */
+      ConcurrentDisjointSets (std::size_t size) : parent_ (size)
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          parent_[i].store (static_cast<index_t> (i), std::memory_order_relaxed);
+      }
+
+      /** \brief Get the number of elements. */
+      inline std::size_t
+      size () const
+      {
+        return (parent_.size ());
+      }
+
+      /** \brief Find the root (smallest element) of the set containing an element. Uses path halving.
+        * \param[in] element the element to look up
+        */
+      inline index_t
+      find (index_t element)
+      {
+        index_t parent = parent_[element].load (std::memory_order_relaxed);
+        while (parent != element)
+        {
+          // If another thread changed the parent in between, this simply fails
+          index_t grand_parent = parent_[parent].load (std::memory_order_relaxed);
+          if (grand_parent != parent)
+            parent_[element].compare_exchange_weak (parent, grand_parent, std::memory_order_relaxed);
+          element = grand_parent;
+          parent = parent_[element].load (std::memory_order_relaxed);
+        }
+        return (element);
+      }
+
+      /** \brief Merge the sets containing two elements.
+        * \param[in] a an element of the first set
+        * \param[in] b an element of the second set
+        * \return true if the two elements were in different sets
+        */
+      inline bool
+      merge (index_t a, index_t b)
+      {
+        while (true)
+        {
+          a = find (a);
+          b = find (b);
+          if (a == b)
+            return (false);
+          if (a < b)
+            std::swap (a, b);
+          // Only succeeds if a is still a root, otherwise look for the new roots and try again
+          index_t root = a;
+          if (parent_[a].compare_exchange_strong (root, b, std::memory_order_relaxed))
+            return (true);
+        }
+      }
+
+    private:
+      /** \brief The parent of every element, a root is its own parent. */
+      std::vector<std::atomic<index_t> > parent_;
+  };
+}
@@ -43,6 +43,7 @@
 #include <pcl/console/print.h> // for PCL_WARN
 #include <pcl/search/search.h> // for Search
 
+#include <cstdint> // for std::uint8_t
 #include <functional>
 
 namespace pcl
@@ -78,6 +79,9 @@ namespace pcl
     * // The clusters that are too small or too large in size can also be extracted separately:
     * cec.getRemovedClusters (small_clusters, large_clusters);
     * \endcode
+    * With setNumberOfThreads() the neighborhoods are searched and the condition is evaluated by several threads.
+    * Expensive conditions can also be evaluated for a point and all of its neighbors at once, see
+    * setBatchConditionFunction().
     * \author Frits Florentinus
     * \ingroup segmentation
     */
@@ -93,6 +97,10 @@ namespace pcl
       using PCLBase<PointT>::deinitCompute;
 
     public:
+      /** \brief Condition evaluated for one point and a batch of its neighbors, see setBatchConditionFunction(). */
+      using BatchConditionFunction = std::function<void (const PointCloud<PointT>&, index_t, const Indices&,
+                                                         const std::vector<float>&, std::vector<std::uint8_t>&)>;
+
       /** \brief Constructor.
         * \param[in] extract_removed_clusters Set to true if you want to be able to extract the clusters that are too large or too small (default = false)
         */
@@ -104,7 +112,8 @@ namespace pcl
           max_cluster_size_ (std::numeric_limits<int>::max ()),
           extract_removed_clusters_ (extract_removed_clusters),
           small_clusters_ (new pcl::IndicesClusters),
-          large_clusters_ (new pcl::IndicesClusters)
+          large_clusters_ (new pcl::IndicesClusters),
+          threads_ (1)
       {
       }
 
@@ -146,6 +155,7 @@ namespace pcl
       setConditionFunction (bool (*condition_function) (const PointT&, const PointT&, float))
       {
         condition_function_ = condition_function;
+        batch_condition_function_ = nullptr;
       }
 
       /** \brief Set the condition that needs to hold for neighboring points to be considered part of the same cluster.
@@ -154,6 +164,27 @@ namespace pcl
       setConditionFunction (std::function<bool (const PointT&, const PointT&, float)> condition_function)
       {
         condition_function_ = condition_function;
+        batch_condition_function_ = nullptr;
+      }
+
+      /** \brief Set a condition that is evaluated for one point and a batch of its neighbors in a single call,
+        * which lets expensive conditions be vectorized. It replaces the condition set by setConditionFunction().
+        * \details The input arguments of the condition function are:
+        * <ul>
+        *  <li>PointCloud<PointT> The input cloud</li>
+        *  <li>index_t The index of the point that is part of the cluster</li>
+        *  <li>Indices The indices of the neighbors to test</li>
+        *  <li>std::vector<float> The squared distances between the point and the neighbors</li>
+        *  <li>std::vector<std::uint8_t> The output, already sized like the neighbors and set to 0. Setting an element
+        *      to a non-zero value merges that neighbor into the cluster of the point.</li>
+        * </ul>
+        * \param[in] condition_function The condition function that needs to hold for clustering
+        */
+      inline void
+      setBatchConditionFunction (BatchConditionFunction condition_function)
+      {
+        batch_condition_function_ = condition_function;
+        condition_function_ = nullptr;
       }
 
       /** \brief Set the spatial tolerance for new cluster candidates.
@@ -218,6 +249,24 @@ namespace pcl
       void
       segment (IndicesClusters &clusters);
 
+      /** \brief Set the number of threads used to segment the input.
+        * \details With more than one thread, the neighborhoods of all points are searched in parallel. The
+        * condition is evaluated once per pair of neighbors, with the point that comes first in the indices as
+        * first argument, and the pairs that hold are merged in a concurrent union-find. The condition function
+        * must therefore be thread safe. For a symmetric condition the clusters contain the same points as with one
+        * thread, in the same order of clusters, but the points of every cluster are sorted by index.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to segment the input. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Get the clusters that are invalidated due to size constraints.
         * \note The constructor of this class needs to be initialized with true, and the segment method needs to have been called prior to using this method.
         * \param[out] small_clusters The resultant clusters that contain less than min_cluster_size points
@@ -236,12 +285,28 @@ namespace pcl
       }
 
     private:
+      /** \brief Segment the input with several threads, see setNumberOfThreads().
+        * \param[out] clusters The resultant set of indices, indexing the points of the input cloud that correspond to the clusters
+        */
+      void
+      segmentParallel (IndicesClusters &clusters);
+
+      /** \brief Store a cluster in clusters or in the removed clusters, according to its size.
+        * \param[in] cluster The indices of the points of the cluster
+        * \param[out] clusters The resultant set of indices
+        */
+      void
+      addCluster (const Indices &cluster, IndicesClusters &clusters);
+
       /** \brief A pointer to the spatial search object */
       SearcherPtr searcher_;
 
       /** \brief The condition function that needs to hold for clustering */
       std::function<bool (const PointT&, const PointT&, float)> condition_function_;
 
+      /** \brief The condition function evaluated for a batch of neighbors, replaces condition_function_ if set */
+      BatchConditionFunction batch_condition_function_;
+
       /** \brief The distance to scan for cluster candidates (default = 0.0) */
       float cluster_tolerance_;
 
@@ -260,6 +325,9 @@ namespace pcl
       /** \brief The resultant clusters that contain more than max_cluster_size points */
       pcl::IndicesClustersPtr large_clusters_;
 
+      /** \brief The number of threads used to segment the input (default = 1) */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
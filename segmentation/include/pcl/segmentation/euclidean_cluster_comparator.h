@@ -45,6 +45,7 @@
 #include <pcl/segmentation/boost.h>
 #include <pcl/segmentation/comparator.h>
 
+#include <typeinfo> // for typeid
 
 namespace pcl
 {
@@ -177,6 +178,82 @@ namespace pcl
         return (dist < dist_threshold);
       }
 
+      /** \brief Compare a run of consecutive points with the points at a fixed offset, see Comparator::compareRun ().
+        * The distances of four pairs are compared at once with SSE instructions if available. Subclasses that
+        * override compare () are compared one pair at a time with their own compare ().
+        * \param[in] first_idx the index of the first point of the run
+        * \param[in] count the number of points in the run
+        * \param[in] offset the offset from every point of the run to the point it is compared with
+        * \param[out] result the result of every comparison (1 or 0)
+        */
+      void
+      compareRun (int first_idx, int count, int offset, std::uint8_t* result) const override
+      {
+        if (typeid (*this) != typeid (EuclideanClusterComparator<PointT, PointLT>))
+        {
+          Comparator<PointT>::compareRun (first_idx, count, offset, result);
+          return;
+        }
+
+        int i = 0;
+#ifdef __SSE__
+        const __m128 distance_threshold = _mm_set1_ps (distance_threshold_);
+        for (; (i + 3) < count; i += 4)
+        {
+          const int p = first_idx + i;
+          const int q = p + offset;
+
+          const __m128 x = _mm_set_ps ((*input_)[p+3].x, (*input_)[p+2].x, (*input_)[p+1].x, (*input_)[p].x);
+          const __m128 y = _mm_set_ps ((*input_)[p+3].y, (*input_)[p+2].y, (*input_)[p+1].y, (*input_)[p].y);
+          const __m128 z = _mm_set_ps ((*input_)[p+3].z, (*input_)[p+2].z, (*input_)[p+1].z, (*input_)[p].z);
+
+          __m128 threshold = distance_threshold;
+          if (depth_dependent_)
+          {
+            const __m128 depth = _mm_add_ps (_mm_add_ps (_mm_mul_ps (x, _mm_set1_ps (z_axis_[0])),
+                                                         _mm_mul_ps (y, _mm_set1_ps (z_axis_[1]))),
+                                             _mm_mul_ps (z, _mm_set1_ps (z_axis_[2])));
+            threshold = _mm_mul_ps (threshold, _mm_mul_ps (depth, depth));
+          }
+
+          const __m128 dx = _mm_sub_ps (x, _mm_set_ps ((*input_)[q+3].x, (*input_)[q+2].x, (*input_)[q+1].x, (*input_)[q].x));
+          const __m128 dy = _mm_sub_ps (y, _mm_set_ps ((*input_)[q+3].y, (*input_)[q+2].y, (*input_)[q+1].y, (*input_)[q].y));
+          const __m128 dz = _mm_sub_ps (z, _mm_set_ps ((*input_)[q+3].z, (*input_)[q+2].z, (*input_)[q+1].z, (*input_)[q].z));
+          // The square root is taken so that the results match compare () exactly
+          const __m128 dist = _mm_sqrt_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)),
+                                                       _mm_mul_ps (dz, dz)));
+
+          // Point p+j is in the j-th element and therefore in the j-th bit of the mask
+          const int mask = _mm_movemask_ps (_mm_cmplt_ps (dist, threshold));
+          for (int j = 0; j < 4; ++j)
+            result[i + j] = static_cast<std::uint8_t> ((mask >> j) & 1);
+        }
+
+        if (labels_ && exclude_labels_)
+        {
+          assert (labels_->size () == input_->size ());
+          // Neighboring points mostly share their label, so the last lookup is cached
+          std::uint32_t cached_label = 0;
+          bool cached_included = exclude_labels_->find (cached_label) != exclude_labels_->end ();
+          auto included = [&] (int idx)
+          {
+            const std::uint32_t label = (*labels_)[idx].label;
+            if (label != cached_label)
+            {
+              cached_label = label;
+              cached_included = exclude_labels_->find (label) != exclude_labels_->end ();
+            }
+            return (cached_included);
+          };
+          for (int j = 0; j < i; ++j)
+            if (result[j] && !(included (first_idx + j) && included (first_idx + j + offset)))
+              result[j] = 0;
+        }
+#endif
+        for (; i < count; ++i)
+          result[i] = compare (first_idx + i, first_idx + i + offset);
+      }
+
     protected:
 
 
@@ -82,6 +82,29 @@ namespace pcl
       const typename search::Search<PointT>::Ptr &tree, float tolerance, std::vector<PointIndices> &clusters,
       unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using
+    * several threads. The radius neighborhoods of all points are searched in parallel and merged with a
+    * lock-free union-find, instead of growing one cluster at a time. The clusters are the same, and returned
+    * in the same order, as the ones of the serial version.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tree the spatial locator (e.g., kd-tree) used for nearest neighbors searching
+    * \note the tree has to be created as a spatial locator on \a cloud and \a indices, and its radius search
+    * has to be safe to call concurrently (true for the kd-tree and organized search objects)
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain
+    * \param num_threads the number of threads to use (0: automatic)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void
+  extractEuclideanClusters (
+      const PointCloud<PointT> &cloud, const Indices &indices,
+      const typename search::Search<PointT>::Ptr &tree, float tolerance, std::vector<PointIndices> &clusters,
+      unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster, unsigned int num_threads);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
     * angular deviation between points. Each point added to the cluster is origin to another radius search. Each point
@@ -332,7 +355,8 @@ namespace pcl
       EuclideanClusterExtraction () : tree_ (), 
                                       cluster_tolerance_ (0),
                                       min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
+                                      threads_ (1)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -401,6 +425,20 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads used to extract the clusters. With more than one thread the
+        * neighborhoods are searched in parallel and merged with a union-find (the clusters do not change).
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to extract the clusters. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -426,6 +464,9 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads used to extract the clusters (default = 1). */
+      unsigned int threads_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
@@ -38,9 +38,12 @@
 #define PCL_SEGMENTATION_IMPL_CONDITIONAL_EUCLIDEAN_CLUSTERING_HPP_
 
 #include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+#include <algorithm> // for std::sort
+
 template<typename PointT> void
 pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clusters)
 {
@@ -53,7 +56,7 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
   }
 
   // Validity checks
-  if (!initCompute () || input_->points.empty () || indices_->empty () || !condition_function_)
+  if (!initCompute () || input_->points.empty () || indices_->empty () || (!condition_function_ && !batch_condition_function_))
     return;
 
   // Initialize the search class
@@ -66,10 +69,22 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
   }
   searcher_->setInputCloud (input_, indices_);
 
+  if (threads_ > 1)
+  {
+    segmentParallel (clusters);
+    deinitCompute ();
+    return;
+  }
+
   // Temp variables used by search class
   Indices nn_indices;
   std::vector<float> nn_distances;
 
+  // Temp variables used by the batch condition
+  Indices candidates;
+  std::vector<float> candidate_distances;
+  std::vector<std::uint8_t> candidate_results;
+
   // Create a bool vector of processed point indices, and initialize it to false
   // Need to have it contain all possible points because radius search can not return indices into indices
   std::vector<bool> processed (input_->size (), false);
@@ -99,6 +114,31 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
         continue;
       }
 
+      if (batch_condition_function_)
+      {
+        // Collect the unprocessed neighbors and test them all at once
+        candidates.clear ();
+        candidate_distances.clear ();
+        for (int nii = 1; nii < static_cast<int> (nn_indices.size ()); ++nii)
+        {
+          if (nn_indices[nii] == -1 || processed[nn_indices[nii]])
+            continue;
+          candidates.push_back (nn_indices[nii]);
+          candidate_distances.push_back (nn_distances[nii]);
+        }
+        candidate_results.assign (candidates.size (), 0);
+        batch_condition_function_ (*input_, current_cluster[cii], candidates, candidate_distances, candidate_results);
+        for (std::size_t ci = 0; ci < candidates.size (); ++ci)
+        {
+          if (!candidate_results[ci])
+            continue;
+          current_cluster.push_back (candidates[ci]);
+          processed[candidates[ci]] = true;
+        }
+        cii++;
+        continue;
+      }
+
       // Process the neighbors
       for (int nii = 1; nii < static_cast<int> (nn_indices.size ()); ++nii)  // nii = neighbor indices iterator
       {
@@ -117,27 +157,142 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
       cii++;
     }
 
-    // If extracting removed clusters, all clusters need to be saved, otherwise only the ones within the given cluster size range
-    if (extract_removed_clusters_ ||
-        (static_cast<int> (current_cluster.size ()) >= min_cluster_size_ &&
-         static_cast<int> (current_cluster.size ()) <= max_cluster_size_))
+    addCluster (current_cluster, clusters);
+  }
+
+  deinitCompute ();
+}
+
+template<typename PointT> void
+pcl::ConditionalEuclideanClustering<PointT>::segmentParallel (pcl::IndicesClusters &clusters)
+{
+  index_t nr_points = static_cast<index_t> (indices_->size ());
+
+  // Map every point back to its (first) position in indices, repeated indices are skipped like
+  // the processed points of the serial version
+  std::vector<index_t> position (input_->size (), -1);
+  for (index_t i = 0; i < nr_points; ++i)
+    if ((*indices_)[i] != -1 && position[(*indices_)[i]] == -1)
+      position[(*indices_)[i]] = i;
+
+  // Disjoint sets over the positions. Their roots are the first position of every cluster, which is
+  // the seed the serial version starts that cluster from
+  ConcurrentDisjointSets sets (nr_points);
+
+#pragma omp parallel \
+  default(none) \
+  shared(nr_points, position, sets) \
+  num_threads(threads_)
+  {
+    Indices nn_indices;
+    std::vector<float> nn_distances;
+    Indices candidates;
+    std::vector<float> candidate_distances;
+    std::vector<std::uint8_t> candidate_results;
+#pragma omp for schedule(dynamic, 256)
+    for (index_t i = 0; i < nr_points; ++i)
     {
-      pcl::PointIndices pi;
-      pi.header = input_->header;
-      pi.indices.resize (current_cluster.size ());
-      for (int ii = 0; ii < static_cast<int> (current_cluster.size ()); ++ii)  // ii = indices iterator
-        pi.indices[ii] = current_cluster[ii];
-
-      if (extract_removed_clusters_ && static_cast<int> (current_cluster.size ()) < min_cluster_size_)
-        small_clusters_->push_back (pi);
-      else if (extract_removed_clusters_ && static_cast<int> (current_cluster.size ()) > max_cluster_size_)
-        large_clusters_->push_back (pi);
+      const index_t iindex = (*indices_)[i];
+      if (iindex == -1 || position[iindex] != i)
+        continue;
+      if (searcher_->radiusSearch ((*input_)[iindex], cluster_tolerance_, nn_indices, nn_distances) < 1)
+        continue;
+
+      // Every pair is tested once, from the point that comes first. Pairs that are already connected
+      // through other points do not need to be tested at all.
+      candidates.clear ();
+      candidate_distances.clear ();
+      for (std::size_t nii = 0; nii < nn_indices.size (); ++nii)
+      {
+        if (nn_indices[nii] == -1 || position[nn_indices[nii]] <= i)
+          continue;
+        if (sets.find (i) == sets.find (position[nn_indices[nii]]))
+          continue;
+        candidates.push_back (nn_indices[nii]);
+        candidate_distances.push_back (nn_distances[nii]);
+      }
+      if (candidates.empty ())
+        continue;
+
+      if (batch_condition_function_)
+      {
+        candidate_results.assign (candidates.size (), 0);
+        batch_condition_function_ (*input_, iindex, candidates, candidate_distances, candidate_results);
+        for (std::size_t ci = 0; ci < candidates.size (); ++ci)
+          if (candidate_results[ci])
+            sets.merge (i, position[candidates[ci]]);
+      }
       else
-        clusters.push_back (pi);
+      {
+        for (std::size_t ci = 0; ci < candidates.size (); ++ci)
+          if (condition_function_ ((*input_)[iindex], (*input_)[candidates[ci]], candidate_distances[ci]))
+            sets.merge (i, position[candidates[ci]]);
+      }
     }
   }
 
-  deinitCompute ();
+  // Gather the clusters in the order of their seeds, with their points in the order of the indices
+  Indices labels (nr_points, -1);
+  std::vector<std::size_t> sizes (nr_points, 0);
+  for (index_t i = 0; i < nr_points; ++i)
+  {
+    if ((*indices_)[i] == -1 || position[(*indices_)[i]] != i)
+      continue;
+    labels[i] = sets.find (i);
+    ++sizes[labels[i]];
+  }
+
+  std::vector<Indices> point_clusters (nr_points);
+  for (index_t i = 0; i < nr_points; ++i)
+    if (labels[i] == i)
+      point_clusters[i].reserve (sizes[i]);
+  for (index_t i = 0; i < nr_points; ++i)
+    if (labels[i] != -1)
+      point_clusters[labels[i]].push_back ((*indices_)[i]);
+
+  for (index_t i = 0; i < nr_points; ++i)
+  {
+    if (labels[i] != i)
+      continue;
+    std::sort (point_clusters[i].begin (), point_clusters[i].end ());
+    addCluster (point_clusters[i], clusters);
+  }
+}
+
+template<typename PointT> void
+pcl::ConditionalEuclideanClustering<PointT>::addCluster (const Indices &cluster, pcl::IndicesClusters &clusters)
+{
+  // If extracting removed clusters, all clusters need to be saved, otherwise only the ones within the given cluster size range
+  if (extract_removed_clusters_ ||
+      (static_cast<int> (cluster.size ()) >= min_cluster_size_ &&
+       static_cast<int> (cluster.size ()) <= max_cluster_size_))
+  {
+    pcl::PointIndices pi;
+    pi.header = input_->header;
+    pi.indices.resize (cluster.size ());
+    for (int ii = 0; ii < static_cast<int> (cluster.size ()); ++ii)  // ii = indices iterator
+      pi.indices[ii] = cluster[ii];
+
+    if (extract_removed_clusters_ && static_cast<int> (cluster.size ()) < min_cluster_size_)
+      small_clusters_->push_back (pi);
+    else if (extract_removed_clusters_ && static_cast<int> (cluster.size ()) > max_cluster_size_)
+      large_clusters_->push_back (pi);
+    else
+      clusters.push_back (pi);
+  }
+}
+
+template<typename PointT> void
+pcl::ConditionalEuclideanClustering<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
 }
 
 #define PCL_INSTANTIATE_ConditionalEuclideanClustering(T) template class PCL_EXPORTS pcl::ConditionalEuclideanClustering<T>;
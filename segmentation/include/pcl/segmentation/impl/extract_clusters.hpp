@@ -39,6 +39,7 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -210,10 +211,139 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
+                               const Indices &indices,
+                               const typename search::Search<PointT>::Ptr &tree,
+                               float tolerance, std::vector<PointIndices> &clusters,
+                               unsigned int min_pts_per_cluster,
+                               unsigned int max_pts_per_cluster,
+                               unsigned int num_threads)
+{
+  if (tree->getInputCloud()->size() != cloud.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different point cloud "
+              "dataset (%zu) than the input cloud (%zu)!\n",
+              static_cast<std::size_t>(tree->getInputCloud()->size()),
+              static_cast<std::size_t>(cloud.size()));
+    return;
+  }
+  if (tree->getIndices()->size() != indices.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different set of "
+              "indices (%zu) than the input set (%zu)!\n",
+              static_cast<std::size_t>(tree->getIndices()->size()),
+              indices.size());
+    return;
+  }
+  if (num_threads == 0)
+#ifdef _OPENMP
+    num_threads = omp_get_num_procs ();
+#else
+    num_threads = 1;
+#endif
+
+  index_t nr_points = static_cast<index_t> (indices.size ());
+
+  // Map every point back to its (first) position in indices. Repeated indices are skipped, like the
+  // processed points of the serial version, so that they are not counted twice in the cluster sizes
+  std::vector<index_t> position (cloud.size (), -1);
+  for (index_t i = 0; i < nr_points; ++i)
+    if (position[indices[i]] == -1)
+      position[indices[i]] = i;
+
+  // Disjoint sets over the positions. Their roots are the first position of every cluster, i.e. the seed
+  // the serial version would start from
+  ConcurrentDisjointSets sets (nr_points);
+
+  bool search_failed = false;
+#pragma omp parallel \
+  default(none) \
+  shared(cloud, indices, tree, tolerance, nr_points, position, sets, search_failed) \
+  num_threads(num_threads)
+  {
+    Indices nn_indices;
+    std::vector<float> nn_distances;
+#pragma omp for schedule(dynamic, 256)
+    for (index_t i = 0; i < nr_points; ++i)
+    {
+      if (position[indices[i]] != i)
+        continue;
+
+      int ret = tree->radiusSearch (cloud[indices[i]], tolerance, nn_indices, nn_distances);
+      if (ret == -1)
+      {
+        search_failed = true;
+        continue;
+      }
+
+      for (const auto &nn_index : nn_indices)
+      {
+        if (nn_index == -1 || position[nn_index] == -1)
+          continue;
+        sets.merge (i, position[nn_index]);
+      }
+    }
+  }
+  if (search_failed)
+  {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
+  // Label every position with its root, and count the cluster sizes
+  Indices labels (nr_points, -1);
+  std::vector<unsigned int> sizes (nr_points, 0);
+  for (index_t i = 0; i < nr_points; ++i)
+  {
+    if (position[indices[i]] != i)
+      continue;
+    labels[i] = sets.find (i);
+    ++sizes[labels[i]];
+  }
+
+  // Emit the clusters in the order of their seeds, as the serial version does
+  Indices cluster_ids (nr_points, -1);
+  std::size_t first_cluster = clusters.size ();
+  for (index_t i = 0; i < nr_points; ++i)
+  {
+    if (labels[i] != i || sizes[i] < min_pts_per_cluster || sizes[i] > max_pts_per_cluster)
+      continue;
+    cluster_ids[i] = static_cast<index_t> (clusters.size ());
+    pcl::PointIndices r;
+    r.indices.reserve (sizes[i]);
+    r.header = cloud.header;
+    clusters.push_back (r);
+  }
+  for (index_t i = 0; i < nr_points; ++i)
+    if (labels[i] != -1 && cluster_ids[labels[i]] != -1)
+      clusters[cluster_ids[labels[i]]].indices.push_back (indices[i]);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(clusters, first_cluster) \
+  schedule(dynamic) \
+  num_threads(num_threads)
+  for (std::ptrdiff_t c = static_cast<std::ptrdiff_t> (first_cluster); c < static_cast<std::ptrdiff_t> (clusters.size ()); ++c)
+    std::sort (clusters[c].indices.begin (), clusters[c].indices.end ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::EuclideanClusterExtraction<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void 
 pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clusters)
 {
@@ -236,7 +366,10 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  if (threads_ > 1)
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+  else
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -250,5 +383,6 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
 #define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
 #define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters_indices_parallel(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
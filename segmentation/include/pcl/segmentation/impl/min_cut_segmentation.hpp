@@ -39,10 +39,12 @@
 #ifndef PCL_SEGMENTATION_MIN_CUT_SEGMENTATION_HPP_
 #define PCL_SEGMENTATION_MIN_CUT_SEGMENTATION_HPP_
 
+#include <pcl/console/print.h> // for PCL_WARN
 #include <pcl/segmentation/boost.h>
 #include <pcl/segmentation/min_cut_segmentation.h>
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <algorithm>
 #include <cmath>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -60,10 +62,14 @@ pcl::MinCutSegmentation<PointT>::MinCutSegmentation () :
   foreground_points_ (0),
   background_points_ (0),
   clusters_ (0),
+  flow_graph_ (),
+  graph_nodes_ (0),
+  threads_ (1),
+  reuse_flow_ (false),
   vertices_ (0),
   edge_marker_ (0),
-  source_ (),/////////////////////////////////
-  sink_ (),///////////////////////////////////
+  source_ (),
+  sink_ (),
   max_flow_ (0.0)
 {
 }
@@ -75,8 +81,7 @@ pcl::MinCutSegmentation<PointT>::~MinCutSegmentation ()
   foreground_points_.clear ();
   background_points_.clear ();
   clusters_.clear ();
-  vertices_.clear ();
-  edge_marker_.clear ();
+  graph_nodes_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -177,6 +182,20 @@ pcl::MinCutSegmentation<PointT>::setNumberOfNeighbours (unsigned int neighbour_n
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MinCutSegmentation<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> std::vector<PointT, Eigen::aligned_allocator<PointT> >
 pcl::MinCutSegmentation<PointT>::getForegroundPoints () const
@@ -271,12 +290,11 @@ pcl::MinCutSegmentation<PointT>::extract (std::vector <pcl::PointIndices>& clust
     binary_potentials_are_valid_ = true;
   }
 
-  //IndexMap index_map = boost::get (boost::vertex_index, *graph_);
-  ResidualCapacityMap residual_capacity = boost::get (boost::edge_residual_capacity, *graph_);
-
-  max_flow_ = boost::boykov_kolmogorov_max_flow (*graph_, source_, sink_);
+  if (!reuse_flow_)
+    flow_graph_.discardFlow ();
+  max_flow_ = flow_graph_.solve ();
 
-  assembleLabels (residual_capacity);
+  assembleLabels ();
 
   clusters.reserve (clusters_.size ());
   std::copy (clusters_.begin (), clusters_.end (), std::back_inserter (clusters));
@@ -295,7 +313,51 @@ pcl::MinCutSegmentation<PointT>::getMaxFlow () const
 template <typename PointT> typename pcl::MinCutSegmentation<PointT>::mGraphPtr
 pcl::MinCutSegmentation<PointT>::getGraph () const
 {
-  return (graph_);
+  if (!graph_is_valid_)
+    return (mGraphPtr ());
+
+  // Same layout as the graph that used to be built: one vertex per point, followed by the source and the sink,
+  // and a pair of opposite edges (each with its own zero capacity reverse edge) for every pair of neighbours
+  mGraphPtr graph (new mGraph);
+  const auto number_of_points = input_->size ();
+  for (std::size_t i_point = 0; i_point < number_of_points + 2; i_point++)
+    boost::add_vertex (*graph);
+  const VertexDescriptor source = number_of_points;
+  const VertexDescriptor sink = number_of_points + 1;
+
+  CapacityMap capacity = boost::get (boost::edge_capacity, *graph);
+  ResidualCapacityMap residual_capacity = boost::get (boost::edge_residual_capacity, *graph);
+  ReverseEdgeMap reverse_edges = boost::get (boost::edge_reverse, *graph);
+  const auto add_edge = [&] (VertexDescriptor from, VertexDescriptor to, double weight, double residual)
+  {
+    const EdgeDescriptor edge = boost::add_edge (from, to, *graph).first;
+    const EdgeDescriptor reverse_edge = boost::add_edge (to, from, *graph).first;
+    capacity[edge] = weight;
+    capacity[reverse_edge] = 0.0;
+    residual_capacity[edge] = residual;
+    residual_capacity[reverse_edge] = weight - residual;
+    reverse_edges[edge] = reverse_edge;
+    reverse_edges[reverse_edge] = edge;
+  };
+
+  for (std::size_t i_node = 0; i_node < graph_nodes_.size (); i_node++)
+  {
+    const auto node = static_cast<index_t> (i_node);
+    add_edge (source, graph_nodes_[i_node], flow_graph_.getSourceCapacity (node), flow_graph_.getSourceResidualCapacity (node));
+    add_edge (graph_nodes_[i_node], sink, flow_graph_.getSinkCapacity (node), flow_graph_.getSinkResidualCapacity (node));
+  }
+
+  for (std::size_t i_edge = 0; i_edge < flow_graph_.getNumberOfEdges (); i_edge++)
+  {
+    const std::pair<index_t, index_t> nodes = flow_graph_.getEdge (i_edge);
+    const double weight = flow_graph_.getEdgeCapacity (i_edge).first;
+    // Positive flow goes from the first to the second node
+    const double flow = weight - flow_graph_.getEdgeResidualCapacity (i_edge).first;
+    add_edge (graph_nodes_[nodes.first], graph_nodes_[nodes.second], weight, weight - std::max (flow, 0.0));
+    add_edge (graph_nodes_[nodes.second], graph_nodes_[nodes.first], weight, weight - std::max (-flow, 0.0));
+  }
+
+  return (graph);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -311,54 +373,84 @@ pcl::MinCutSegmentation<PointT>::buildGraph ()
   if (!search_)
     search_.reset (new pcl::search::KdTree<PointT>);
 
-  graph_.reset (new mGraph);
-
-  capacity_.reset (new CapacityMap);
-  *capacity_ = boost::get (boost::edge_capacity, *graph_);
-
-  reverse_edges_.reset (new ReverseEdgeMap);
-  *reverse_edges_ = boost::get (boost::edge_reverse, *graph_);
-
-  VertexDescriptor vertex_descriptor(0);
-  vertices_.clear ();
-  vertices_.resize (number_of_points + 2, vertex_descriptor);
-
-  std::set<int> out_edges_marker;
-  edge_marker_.clear ();
-  edge_marker_.resize (number_of_points + 2, out_edges_marker);
-
-  for (std::size_t i_point = 0; i_point < number_of_points + 2; i_point++)
-    vertices_[i_point] = boost::add_vertex (*graph_);
-
-  source_ = vertices_[number_of_points];
-  sink_ = vertices_[number_of_points + 1];
-
-  for (const auto& point_index : (*indices_))
+  // Every point becomes a node of the graph, repeated indices are ignored
+  std::vector<index_t> point_nodes (number_of_points, -1);
+  std::vector<std::size_t> node_positions;
+  node_positions.reserve (number_of_indices);
+  graph_nodes_.clear ();
+  graph_nodes_.reserve (number_of_indices);
+  for (std::size_t i_point = 0; i_point < number_of_indices; i_point++)
   {
-    double source_weight = 0.0;
-    double sink_weight = 0.0;
-    calculateUnaryPotential (point_index, source_weight, sink_weight);
-    addEdge (static_cast<int> (source_), point_index, source_weight);
-    addEdge (point_index, static_cast<int> (sink_), sink_weight);
+    const index_t point_index = (*indices_)[i_point];
+    if (point_nodes[point_index] != -1)
+      continue;
+    point_nodes[point_index] = static_cast<index_t> (graph_nodes_.size ());
+    graph_nodes_.push_back (point_index);
+    node_positions.push_back (i_point);
   }
+  std::ptrdiff_t number_of_nodes = static_cast<std::ptrdiff_t> (graph_nodes_.size ());
 
-  std::vector<int> neighbours;
-  std::vector<float> distances;
+  std::vector<Indices> neighbours (number_of_nodes);
   search_->setInputCloud (input_, indices_);
-  for (std::size_t i_point = 0; i_point < number_of_indices; i_point++)
+#pragma omp parallel for \
+  default(none) \
+  shared(neighbours, node_positions, number_of_nodes) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
   {
-    index_t point_index = (*indices_)[i_point];
-    search_->nearestKSearch (i_point, number_of_neighbours_, neighbours, distances);
-    for (std::size_t i_nghbr = 1; i_nghbr < neighbours.size (); i_nghbr++)
+    std::vector<float> distances;
+    search_->nearestKSearch (node_positions[i_node], number_of_neighbours_, neighbours[i_node], distances);
+  }
+
+  // Every pair of neighbours becomes one edge, stored with the smaller node first. Bucket the pairs
+  // by their first node, then sort and deduplicate every bucket on its own.
+  std::vector<std::size_t> bucket_begin (number_of_nodes + 1, 0);
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    for (const auto& neighbour : neighbours[i_node])
+    {
+      const index_t neighbour_node = point_nodes[neighbour];
+      if (neighbour_node != -1 && neighbour_node != i_node)
+        bucket_begin[std::min<std::ptrdiff_t> (neighbour_node, i_node) + 1]++;
+    }
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    bucket_begin[i_node + 1] += bucket_begin[i_node];
+
+  std::vector<index_t> partners (bucket_begin.back ());
+  std::vector<std::size_t> bucket_end (bucket_begin.begin (), bucket_begin.end () - 1);
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    for (const auto& neighbour : neighbours[i_node])
     {
-      double weight = calculateBinaryPotential (point_index, neighbours[i_nghbr]);
-      addEdge (point_index, neighbours[i_nghbr], weight);
-      addEdge (neighbours[i_nghbr], point_index, weight);
+      const index_t neighbour_node = point_nodes[neighbour];
+      if (neighbour_node == -1 || neighbour_node == i_node)
+        continue;
+      if (neighbour_node < i_node)
+        partners[bucket_end[neighbour_node]++] = static_cast<index_t> (i_node);
+      else
+        partners[bucket_end[i_node]++] = neighbour_node;
     }
-    neighbours.clear ();
-    distances.clear ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(partners, bucket_begin, bucket_end, number_of_nodes) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+  {
+    std::sort (partners.begin () + bucket_begin[i_node], partners.begin () + bucket_end[i_node]);
+    bucket_end[i_node] = std::unique (partners.begin () + bucket_begin[i_node], partners.begin () + bucket_end[i_node]) - partners.begin ();
   }
 
+  std::vector<std::pair<index_t, index_t> > edges;
+  edges.reserve (partners.size ());
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    for (std::size_t i_partner = bucket_begin[i_node]; i_partner < bucket_end[i_node]; i_partner++)
+      edges.emplace_back (static_cast<index_t> (i_node), partners[i_partner]);
+
+  flow_graph_.setGraph (graph_nodes_.size (), edges);
+  recalculateBinaryPotentials ();
+  recalculateUnaryPotentials ();
+
   return (true);
 }
 
@@ -422,26 +514,10 @@ pcl::MinCutSegmentation<PointT>::calculateUnaryPotential (int point, double& sou
 template <typename PointT> bool
 pcl::MinCutSegmentation<PointT>::addEdge (int source, int target, double weight)
 {
-  std::set<int>::iterator iter_out = edge_marker_[source].find (target);
-  if ( iter_out != edge_marker_[source].end () )
-    return (false);
-
-  EdgeDescriptor edge;
-  EdgeDescriptor reverse_edge;
-  bool edge_was_added, reverse_edge_was_added;
-
-  boost::tie (edge, edge_was_added) = boost::add_edge ( vertices_[source], vertices_[target], *graph_ );
-  boost::tie (reverse_edge, reverse_edge_was_added) = boost::add_edge ( vertices_[target], vertices_[source], *graph_ );
-  if ( !edge_was_added || !reverse_edge_was_added )
-    return (false);
-
-  (*capacity_)[edge] = weight;
-  (*capacity_)[reverse_edge] = 0.0;
-  (*reverse_edges_)[edge] = reverse_edge;
-  (*reverse_edges_)[reverse_edge] = edge;
-  edge_marker_[source].insert (target);
-
-  return (true);
+  // graph_ is not built anymore, so there is nothing the edge could be added to
+  utils::ignore (source, target, weight);
+  PCL_WARN ("[pcl::MinCutSegmentation::addEdge] The graph is stored in flow_graph_, the edge is not added.\n");
+  return (false);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -463,23 +539,20 @@ pcl::MinCutSegmentation<PointT>::calculateBinaryPotential (int source, int targe
 template <typename PointT> bool
 pcl::MinCutSegmentation<PointT>::recalculateUnaryPotentials ()
 {
-  OutEdgeIterator src_edge_iter;
-  OutEdgeIterator src_edge_end;
-  std::pair<EdgeDescriptor, bool> sink_edge;
+  std::ptrdiff_t number_of_nodes = static_cast<std::ptrdiff_t> (graph_nodes_.size ());
+  std::vector<double> source_weights (number_of_nodes);
+  std::vector<double> sink_weights (number_of_nodes);
 
-  for (boost::tie (src_edge_iter, src_edge_end) = boost::out_edges (source_, *graph_); src_edge_iter != src_edge_end; src_edge_iter++)
-  {
-    double source_weight = 0.0;
-    double sink_weight = 0.0;
-    sink_edge.second = false;
-    calculateUnaryPotential (static_cast<int> (boost::target (*src_edge_iter, *graph_)), source_weight, sink_weight);
-    sink_edge = boost::lookup_edge (boost::target (*src_edge_iter, *graph_), sink_, *graph_);
-    if (!sink_edge.second)
-      return (false);
-
-    (*capacity_)[*src_edge_iter] = source_weight;
-    (*capacity_)[sink_edge.first] = sink_weight;
-  }
+#pragma omp parallel for \
+  default(none) \
+  shared(source_weights, sink_weights, number_of_nodes) \
+  schedule(static) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    calculateUnaryPotential (graph_nodes_[i_node], source_weights[i_node], sink_weights[i_node]);
+
+  for (std::ptrdiff_t i_node = 0; i_node < number_of_nodes; i_node++)
+    flow_graph_.setTerminalCapacities (static_cast<index_t> (i_node), source_weights[i_node], sink_weights[i_node]);
 
   return (true);
 }
@@ -488,71 +561,44 @@ pcl::MinCutSegmentation<PointT>::recalculateUnaryPotentials ()
 template <typename PointT> bool
 pcl::MinCutSegmentation<PointT>::recalculateBinaryPotentials ()
 {
-  VertexIterator vertex_iter;
-  VertexIterator vertex_end;
-  OutEdgeIterator edge_iter;
-  OutEdgeIterator edge_end;
-
-  std::vector< std::set<VertexDescriptor> > edge_marker;
-  std::set<VertexDescriptor> out_edges_marker;
-  edge_marker.clear ();
-  edge_marker.resize (indices_->size () + 2, out_edges_marker);
-
-  for (boost::tie (vertex_iter, vertex_end) = boost::vertices (*graph_); vertex_iter != vertex_end; vertex_iter++)
+  std::ptrdiff_t number_of_edges = static_cast<std::ptrdiff_t> (flow_graph_.getNumberOfEdges ());
+  std::vector<double> weights (number_of_edges);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(weights, number_of_edges) \
+  schedule(static) \
+  num_threads(threads_)
+  for (std::ptrdiff_t i_edge = 0; i_edge < number_of_edges; i_edge++)
   {
-    VertexDescriptor source_vertex = *vertex_iter;
-    if (source_vertex == source_ || source_vertex == sink_)
-      continue;
-    for (boost::tie (edge_iter, edge_end) = boost::out_edges (source_vertex, *graph_); edge_iter != edge_end; edge_iter++)
-    {
-      //If this is not the edge of the graph, but the reverse fictitious edge that is needed for the algorithm then continue
-      EdgeDescriptor reverse_edge = (*reverse_edges_)[*edge_iter];
-      if ((*capacity_)[reverse_edge] != 0.0)
-        continue;
-
-      //If we already changed weight for this edge then continue
-      VertexDescriptor target_vertex = boost::target (*edge_iter, *graph_);
-      std::set<VertexDescriptor>::iterator iter_out = edge_marker[static_cast<int> (source_vertex)].find (target_vertex);
-      if ( iter_out != edge_marker[static_cast<int> (source_vertex)].end () )
-        continue;
-
-      if (target_vertex != source_ && target_vertex != sink_)
-      {
-        //Change weight and remember that this edges were updated
-        double weight = calculateBinaryPotential (static_cast<int> (target_vertex), static_cast<int> (source_vertex));
-        (*capacity_)[*edge_iter] = weight;
-        edge_marker[static_cast<int> (source_vertex)].insert (target_vertex);
-      }
-    }
+    const std::pair<index_t, index_t> nodes = flow_graph_.getEdge (i_edge);
+    weights[i_edge] = calculateBinaryPotential (graph_nodes_[nodes.first], graph_nodes_[nodes.second]);
   }
 
+  for (std::ptrdiff_t i_edge = 0; i_edge < number_of_edges; i_edge++)
+    flow_graph_.setEdgeCapacity (i_edge, weights[i_edge], weights[i_edge]);
+
   return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::MinCutSegmentation<PointT>::assembleLabels (ResidualCapacityMap& residual_capacity)
+pcl::MinCutSegmentation<PointT>::assembleLabels ()
 {
-  std::vector<int> labels;
-  labels.resize (input_->size (), 0);
-  for (const auto& i_point : (*indices_))
-    labels[i_point] = 1;
-
   clusters_.clear ();
 
   pcl::PointIndices segment;
   clusters_.resize (2, segment);
 
-  OutEdgeIterator edge_iter, edge_end;
-  for ( boost::tie (edge_iter, edge_end) = boost::out_edges (source_, *graph_); edge_iter != edge_end; edge_iter++ )
+  for (std::size_t i_node = 0; i_node < graph_nodes_.size (); i_node++)
   {
-    if (labels[edge_iter->m_target] == 1)
-    {
-      if (residual_capacity[*edge_iter] > epsilon_)
-        clusters_[1].indices.push_back (static_cast<int> (edge_iter->m_target));
-      else
-        clusters_[0].indices.push_back (static_cast<int> (edge_iter->m_target));
-    }
+    const auto node = static_cast<index_t> (i_node);
+    const bool in_foreground = reuse_flow_ ? flow_graph_.inSourceSegment (node) :
+                                             flow_graph_.getSourceResidualCapacity (node) > epsilon_;
+    if (in_foreground)
+      clusters_[1].indices.push_back (graph_nodes_[i_node]);
+    else
+      clusters_[0].indices.push_back (graph_nodes_[i_node]);
   }
 }
 
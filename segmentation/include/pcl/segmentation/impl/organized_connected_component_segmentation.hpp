@@ -41,6 +41,7 @@
 #define PCL_SEGMENTATION_IMPL_ORGANIZED_CONNECTED_COMPONENT_SEGMENTATION_H_
 
 #include <pcl/segmentation/organized_connected_component_segmentation.h>
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
 
 /**
  *  Directions: 1 2 3
@@ -113,19 +114,49 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::findLabeledRegion
   } while ( curr_idx != start_idx);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::compareFiniteRuns (int first_idx, int count, int offset, std::uint8_t* result) const
+{
+  // Organized clouds mostly have long runs of valid points, which are compared at once
+  int i = 0;
+  while (i < count)
+  {
+    if (!std::isfinite ((*input_)[first_idx + i].x))
+    {
+      result[i++] = 0;
+      continue;
+    }
+    int end = i + 1;
+    while (end < count && std::isfinite ((*input_)[first_idx + end].x))
+      ++end;
+    compare_->compareRun (first_idx + i, end - i, offset, result + i);
+    i = end;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointLT> void
 pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
 {
+  if (threads_ > 1)
+  {
+    segmentParallel (labels, label_indices);
+    return;
+  }
+
   std::vector<unsigned> run_ids;
 
   unsigned invalid_label = std::numeric_limits<unsigned>::max ();
   PointLT invalid_pt;
   invalid_pt.label = std::numeric_limits<unsigned>::max ();
-  labels.resize (input_->size (), invalid_pt);
-  labels.width = input_->width;
-  labels.height = input_->height;
+  // assign, unlike resize, also resets the labels of a previous call
+  labels.assign (input_->width, input_->height, invalid_pt);
   std::size_t clust_id = 0;
+
+  // Results of comparing every pixel of a row with its left and upper neighbor
+  std::vector<std::uint8_t> left_similar (input_->width);
+  std::vector<std::uint8_t> up_similar (input_->width);
   
   //First pixel
   if (std::isfinite ((*input_)[0].x))
@@ -135,11 +166,12 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
   }   
 
   // First row
+  compareFiniteRuns (1, static_cast<int> (input_->width) - 1, -1, left_similar.data () + 1);
   for (int colIdx = 1; colIdx < static_cast<int> (input_->width); ++colIdx)
   {
     if (!std::isfinite ((*input_)[colIdx].x))
       continue;
-    if (compare_->compare (colIdx, colIdx - 1 ))
+    if (left_similar[colIdx])
     {
       labels[colIdx].label = labels[colIdx - 1].label;
     }
@@ -155,10 +187,13 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
   unsigned int previous_row = 0;
   for (std::size_t rowIdx = 1; rowIdx < input_->height; ++rowIdx, previous_row = current_row, current_row += input_->width)
   {
+    compareFiniteRuns (current_row, static_cast<int> (input_->width), -static_cast<int> (input_->width), up_similar.data ());
+    compareFiniteRuns (current_row + 1, static_cast<int> (input_->width) - 1, -1, left_similar.data () + 1);
+
     // First pixel
     if (std::isfinite ((*input_)[current_row].x))
     {
-      if (compare_->compare (current_row, previous_row))
+      if (up_similar[0])
       {
         labels[current_row].label = labels[previous_row].label;
       }
@@ -174,11 +209,11 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
     {
       if (std::isfinite ((*input_)[current_row + colIdx].x))
       {
-        if (compare_->compare (current_row + colIdx, current_row + colIdx - 1))
+        if (left_similar[colIdx])
         {
           labels[current_row + colIdx].label = labels[current_row + colIdx - 1].label;
         }
-        if (compare_->compare (current_row + colIdx, previous_row + colIdx) )
+        if (up_similar[colIdx])
         {
           if (labels[current_row + colIdx].label == invalid_label)
             labels[current_row + colIdx].label = labels[previous_row + colIdx].label;
@@ -226,6 +261,114 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segmentParallel (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
+{
+  int width = static_cast<int> (input_->width);
+  int height = static_cast<int> (input_->height);
+  int nr_points = static_cast<int> (input_->size ());
+
+  PointLT invalid_pt;
+  invalid_pt.label = std::numeric_limits<unsigned>::max ();
+  // assign, unlike resize, also resets the labels of a previous call
+  labels.assign (input_->width, input_->height, invalid_pt);
+
+  // Every component is a set of pixels, whose root is its first pixel in row major order
+  ConcurrentDisjointSets components (input_->size ());
+
+  // Label the bands independently, a band only merges its own pixels
+  int nr_bands = std::min (static_cast<int> (threads_), height);
+#pragma omp parallel for \
+  default(none) \
+  shared(components, height, nr_bands, width) \
+  schedule(static, 1) \
+  num_threads(threads_)
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    const int first_row = band * height / nr_bands;
+    const int end_row = (band + 1) * height / nr_bands;
+    std::vector<std::uint8_t> left_similar (width);
+    std::vector<std::uint8_t> up_similar (width);
+    for (int row = first_row; row < end_row; ++row)
+    {
+      const int row_start = row * width;
+      compareFiniteRuns (row_start + 1, width - 1, -1, left_similar.data () + 1);
+      if (row > first_row)
+        compareFiniteRuns (row_start, width, -width, up_similar.data ());
+      for (int col = 0; col < width; ++col)
+      {
+        const int idx = row_start + col;
+        if (!std::isfinite ((*input_)[idx].x))
+          continue;
+        if (col > 0 && left_similar[col] && std::isfinite ((*input_)[idx - 1].x))
+          components.merge (idx, idx - 1);
+        if (row > first_row && up_similar[col] && std::isfinite ((*input_)[idx - width].x))
+          components.merge (idx, idx - width);
+      }
+    }
+  }
+
+  // Merge the components that touch at the seams, i.e. the first row of every band with the last row of the band above
+#pragma omp parallel for \
+  default(none) \
+  shared(components, height, nr_bands, width) \
+  schedule(static, 1) \
+  num_threads(threads_)
+  for (int band = 1; band < nr_bands; ++band)
+  {
+    const int row_start = (band * height / nr_bands) * width;
+    std::vector<std::uint8_t> up_similar (width);
+    compareFiniteRuns (row_start, width, -width, up_similar.data ());
+    for (int col = 0; col < width; ++col)
+    {
+      const int idx = row_start + col;
+      if (up_similar[col] && std::isfinite ((*input_)[idx].x) && std::isfinite ((*input_)[idx - width].x))
+        components.merge (idx, idx - width);
+    }
+  }
+
+  std::vector<index_t> roots (input_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(components, nr_points, roots) \
+  schedule(static) \
+  num_threads(threads_)
+  for (int idx = 0; idx < nr_points; ++idx)
+    roots[idx] = std::isfinite ((*input_)[idx].x) ? components.find (idx) : -1;
+
+  // Number the components in the order of their first pixel, like the serial labeling does
+  unsigned max_id = 0;
+  for (int idx = 0; idx < nr_points; ++idx)
+  {
+    if (roots[idx] == idx)
+      labels[idx].label = max_id++;
+    else if (roots[idx] >= 0)
+      labels[idx].label = labels[roots[idx]].label;
+  }
+
+  label_indices.resize (max_id + 1);
+  for (int idx = 0; idx < nr_points; ++idx)
+  {
+    if (roots[idx] >= 0)
+      label_indices[labels[idx].label].indices.push_back (idx);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 #define PCL_INSTANTIATE_OrganizedConnectedComponentSegmentation(T,LT) template class PCL_EXPORTS pcl::OrganizedConnectedComponentSegmentation<T,LT>;
 
 #endif //#ifndef PCL_SEGMENTATION_IMPL_ORGANIZED_CONNECTED_COMPONENT_SEGMENTATION_H_
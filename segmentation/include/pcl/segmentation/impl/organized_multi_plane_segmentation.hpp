@@ -118,8 +118,13 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
 
   // Calculate range part of planes' hessian normal form
   std::vector<float> plane_d (input_->size ());
-  
-  for (std::size_t i = 0; i < input_->size (); ++i)
+  int nr_points = static_cast<int> (input_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(nr_points, plane_d) \
+  schedule(static) \
+  num_threads(threads_)
+  for (int i = 0; i < nr_points; ++i)
     plane_d[i] = (*input_)[i].getVector3fMap ().dot ((*normals_)[i].getNormalVector3fMap ());
   
   // Make a comparator
@@ -133,59 +138,78 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
   // Set up the output
   OrganizedConnectedComponentSegmentation<PointT,PointLT> connected_component (compare_);
   connected_component.setInputCloud (input_);
+  connected_component.setNumberOfThreads (threads_);
   connected_component.segment (labels, label_indices);
 
-  Eigen::Vector4f clust_centroid = Eigen::Vector4f::Zero ();
+  // Fit planes to each cluster that is large enough
+  int nr_labels = static_cast<int> (label_indices.size ());
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > label_centroids (nr_labels, Eigen::Vector4f::Zero ());
+  std::vector<Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > label_covariances (nr_labels);
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > label_planes (nr_labels);
+  std::vector<float> label_curvatures (nr_labels);
+#pragma omp parallel for \
+  default(none) \
+  shared(label_centroids, label_covariances, label_curvatures, label_indices, label_planes, nr_labels) \
+  schedule(dynamic) \
+  num_threads(threads_)
+  for (int label = 0; label < nr_labels; ++label)
+  {
+    if (static_cast<unsigned> (label_indices[label].indices.size ()) <= min_inliers_)
+      continue;
+
+    Eigen::Vector4f &clust_centroid = label_centroids[label];
+    Eigen::Matrix3f &clust_cov = label_covariances[label];
+    pcl::computeMeanAndCovarianceMatrix (*input_, label_indices[label].indices, clust_cov, clust_centroid);
+    Eigen::Vector4f &plane_params = label_planes[label];
+
+    EIGEN_ALIGN16 Eigen::Vector3f::Scalar eigen_value;
+    EIGEN_ALIGN16 Eigen::Vector3f eigen_vector;
+    pcl::eigen33 (clust_cov, eigen_value, eigen_vector);
+    plane_params[0] = eigen_vector[0];
+    plane_params[1] = eigen_vector[1];
+    plane_params[2] = eigen_vector[2];
+    plane_params[3] = 0;
+    plane_params[3] = -1 * plane_params.dot (clust_centroid);
+
+    // Compute the curvature surface change
+    float eig_sum = clust_cov.coeff (0) + clust_cov.coeff (4) + clust_cov.coeff (8);
+    if (eig_sum != 0)
+      label_curvatures[label] = std::abs (eigen_value / eig_sum);
+    else
+      label_curvatures[label] = 0;
+  }
+
+  // Orient the planes and keep the ones that are flat enough. The viewpoint is moved by every fitted cluster,
+  // so this is done in the order of the labels.
   Eigen::Vector4f vp = Eigen::Vector4f::Zero ();
-  Eigen::Matrix3f clust_cov;
   pcl::ModelCoefficients model;
   model.values.resize (4);
-
-  // Fit Planes to each cluster
-  for (const auto &label_index : label_indices)
+  for (int label = 0; label < nr_labels; ++label)
   {
-    if (static_cast<unsigned> (label_index.indices.size ()) > min_inliers_)
+    if (static_cast<unsigned> (label_indices[label].indices.size ()) <= min_inliers_)
+      continue;
+
+    const Eigen::Vector4f &clust_centroid = label_centroids[label];
+    Eigen::Vector4f plane_params = label_planes[label];
+    vp -= clust_centroid;
+    float cos_theta = vp.dot (plane_params);
+    if (cos_theta < 0)
     {
-      pcl::computeMeanAndCovarianceMatrix (*input_, label_index.indices, clust_cov, clust_centroid);
-      Eigen::Vector4f plane_params;
-      
-      EIGEN_ALIGN16 Eigen::Vector3f::Scalar eigen_value;
-      EIGEN_ALIGN16 Eigen::Vector3f eigen_vector;
-      pcl::eigen33 (clust_cov, eigen_value, eigen_vector);
-      plane_params[0] = eigen_vector[0];
-      plane_params[1] = eigen_vector[1];
-      plane_params[2] = eigen_vector[2];
+      plane_params *= -1;
       plane_params[3] = 0;
       plane_params[3] = -1 * plane_params.dot (clust_centroid);
+    }
 
-      vp -= clust_centroid;
-      float cos_theta = vp.dot (plane_params);
-      if (cos_theta < 0)
-      {
-        plane_params *= -1;
-        plane_params[3] = 0;
-        plane_params[3] = -1 * plane_params.dot (clust_centroid);
-      }
-      
-      // Compute the curvature surface change
-      float curvature;
-      float eig_sum = clust_cov.coeff (0) + clust_cov.coeff (4) + clust_cov.coeff (8);
-      if (eig_sum != 0)
-        curvature = std::abs (eigen_value / eig_sum);
-      else
-        curvature = 0;
-
-      if (curvature < maximum_curvature_)
-      {
-        model.values[0] = plane_params[0];
-        model.values[1] = plane_params[1];
-        model.values[2] = plane_params[2];
-        model.values[3] = plane_params[3];
-        model_coefficients.push_back (model);
-        inlier_indices.push_back (label_index);
-        centroids.push_back (clust_centroid);
-        covariances.push_back (clust_cov);
-      }
+    if (label_curvatures[label] < maximum_curvature_)
+    {
+      model.values[0] = plane_params[0];
+      model.values[1] = plane_params[1];
+      model.values[2] = plane_params[2];
+      model.values[3] = plane_params[3];
+      model_coefficients.push_back (model);
+      inlier_indices.push_back (label_indices[label]);
+      centroids.push_back (clust_centroid);
+      covariances.push_back (label_covariances[label]);
     }
   }
   deinitCompute ();
@@ -200,32 +224,10 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
   PointCloudLPtr labels (new PointCloudL);
   std::vector<pcl::PointIndices> label_indices;
   std::vector<pcl::PointIndices> boundary_indices;
-  pcl::PointCloud<PointT> boundary_cloud;
   std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
   std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > covariances;
   segment (model_coefficients, inlier_indices, centroids, covariances, *labels, label_indices);
-  regions.resize (model_coefficients.size ());
-  boundary_indices.resize (model_coefficients.size ());
-  
-  for (std::size_t i = 0; i < model_coefficients.size (); i++)
-  {
-    boundary_cloud.resize (0);
-    pcl::OrganizedConnectedComponentSegmentation<PointT,PointLT>::findLabeledRegionBoundary (inlier_indices[i].indices[0], labels, boundary_indices[i]);
-    boundary_cloud.resize (boundary_indices[i].indices.size ());
-    for (std::size_t j = 0; j < boundary_indices[i].indices.size (); j++)
-      boundary_cloud[j] = (*input_)[boundary_indices[i].indices[j]];
-    
-    Eigen::Vector3f centroid = Eigen::Vector3f (centroids[i][0],centroids[i][1],centroids[i][2]);
-    Eigen::Vector4f model = Eigen::Vector4f (model_coefficients[i].values[0],
-                                             model_coefficients[i].values[1],
-                                             model_coefficients[i].values[2],
-                                             model_coefficients[i].values[3]);
-    regions[i] = PlanarRegion<PointT> (centroid,
-                                       covariances[i], 
-                                       static_cast<unsigned int> (inlier_indices[i].indices.size ()),
-                                       boundary_cloud.points,
-                                       model);
-  }
+  buildPlanarRegions (regions, model_coefficients, inlier_indices, centroids, covariances, labels, boundary_indices, false);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -237,39 +239,11 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segmentAndRefine
   PointCloudLPtr labels (new PointCloudL);
   std::vector<pcl::PointIndices> label_indices;
   std::vector<pcl::PointIndices> boundary_indices;
-  pcl::PointCloud<PointT> boundary_cloud;
   std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
   std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > covariances;
   segment (model_coefficients, inlier_indices, centroids, covariances, *labels, label_indices);
   refine (model_coefficients, inlier_indices, labels, label_indices);
-  regions.resize (model_coefficients.size ());
-  boundary_indices.resize (model_coefficients.size ());
-
-  for (std::size_t i = 0; i < model_coefficients.size (); i++)
-  {
-    boundary_cloud.resize (0);
-    int max_inlier_idx = static_cast<int> (inlier_indices[i].indices.size ()) - 1;
-    pcl::OrganizedConnectedComponentSegmentation<PointT,PointLT>::findLabeledRegionBoundary (inlier_indices[i].indices[max_inlier_idx], labels, boundary_indices[i]);
-    boundary_cloud.resize (boundary_indices[i].indices.size ());
-    for (std::size_t j = 0; j < boundary_indices[i].indices.size (); j++)
-      boundary_cloud[j] = (*input_)[boundary_indices[i].indices[j]];
-    
-    Eigen::Vector3f centroid = Eigen::Vector3f (centroids[i][0],centroids[i][1],centroids[i][2]);
-    Eigen::Vector4f model = Eigen::Vector4f (model_coefficients[i].values[0],
-                                             model_coefficients[i].values[1],
-                                             model_coefficients[i].values[2],
-                                             model_coefficients[i].values[3]);
-
-    Eigen::Vector3f vp (0.0, 0.0, 0.0);
-    if (project_points_)
-      boundary_cloud = projectToPlaneFromViewpoint (boundary_cloud, model, centroid, vp);
-
-    regions[i] = PlanarRegion<PointT> (centroid,
-                                       covariances[i], 
-                                       static_cast<unsigned int> (inlier_indices[i].indices.size ()),
-                                       boundary_cloud.points,
-                                       model);
-  }
+  buildPlanarRegions (regions, model_coefficients, inlier_indices, centroids, covariances, labels, boundary_indices, true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -281,39 +255,11 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segmentAndRefine
                                                                                   std::vector<pcl::PointIndices>& label_indices,
                                                                                   std::vector<pcl::PointIndices>& boundary_indices)
 {
-  pcl::PointCloud<PointT> boundary_cloud;
   std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > centroids;
   std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > covariances;
   segment (model_coefficients, inlier_indices, centroids, covariances, *labels, label_indices);
   refine (model_coefficients, inlier_indices, labels, label_indices);
-  regions.resize (model_coefficients.size ());
-  boundary_indices.resize (model_coefficients.size ());
-  
-  for (std::size_t i = 0; i < model_coefficients.size (); i++)
-  {
-    boundary_cloud.resize (0);
-    int max_inlier_idx = static_cast<int> (inlier_indices[i].indices.size ()) - 1;
-    pcl::OrganizedConnectedComponentSegmentation<PointT,PointLT>::findLabeledRegionBoundary (inlier_indices[i].indices[max_inlier_idx], labels, boundary_indices[i]);
-    boundary_cloud.resize (boundary_indices[i].indices.size ());
-    for (std::size_t j = 0; j < boundary_indices[i].indices.size (); j++)
-      boundary_cloud[j] = (*input_)[boundary_indices[i].indices[j]];
-
-    Eigen::Vector3f centroid = Eigen::Vector3f (centroids[i][0],centroids[i][1],centroids[i][2]);
-    Eigen::Vector4f model = Eigen::Vector4f (model_coefficients[i].values[0],
-                                             model_coefficients[i].values[1],
-                                             model_coefficients[i].values[2],
-                                             model_coefficients[i].values[3]);
-
-    Eigen::Vector3f vp (0.0, 0.0, 0.0);
-    if (project_points_ && !boundary_cloud.empty ())
-      boundary_cloud = projectToPlaneFromViewpoint (boundary_cloud, model, centroid, vp);
-
-    regions[i] = PlanarRegion<PointT> (centroid,
-                                       covariances[i], 
-                                       static_cast<unsigned int> (inlier_indices[i].indices.size ()),
-                                       boundary_cloud.points,
-                                       model);
-  }
+  buildPlanarRegions (regions, model_coefficients, inlier_indices, centroids, covariances, labels, boundary_indices, true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -415,6 +361,68 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::refine (std::vec
   }//row
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::buildPlanarRegions (std::vector<PlanarRegion<PointT>, Eigen::aligned_allocator<PlanarRegion<PointT> > >& regions,
+                                                                                    const std::vector<ModelCoefficients>& model_coefficients,
+                                                                                    const std::vector<PointIndices>& inlier_indices,
+                                                                                    const std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >& centroids,
+                                                                                    const std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> >& covariances,
+                                                                                    const PointCloudLPtr& labels,
+                                                                                    std::vector<pcl::PointIndices>& boundary_indices,
+                                                                                    bool refined) const
+{
+  int nr_regions = static_cast<int> (model_coefficients.size ());
+  regions.resize (nr_regions);
+  boundary_indices.resize (nr_regions);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(boundary_indices, centroids, covariances, inlier_indices, labels, model_coefficients, nr_regions, refined, regions) \
+  schedule(dynamic) \
+  num_threads(threads_)
+  for (int i = 0; i < nr_regions; i++)
+  {
+    // The refinement appends the new inliers, the boundary is traced from the last one
+    int start_idx = refined ? inlier_indices[i].indices.back () : inlier_indices[i].indices[0];
+    pcl::OrganizedConnectedComponentSegmentation<PointT,PointLT>::findLabeledRegionBoundary (start_idx, labels, boundary_indices[i]);
+    pcl::PointCloud<PointT> boundary_cloud;
+    boundary_cloud.resize (boundary_indices[i].indices.size ());
+    for (std::size_t j = 0; j < boundary_indices[i].indices.size (); j++)
+      boundary_cloud[j] = (*input_)[boundary_indices[i].indices[j]];
+
+    Eigen::Vector3f centroid = Eigen::Vector3f (centroids[i][0],centroids[i][1],centroids[i][2]);
+    Eigen::Vector4f model = Eigen::Vector4f (model_coefficients[i].values[0],
+                                             model_coefficients[i].values[1],
+                                             model_coefficients[i].values[2],
+                                             model_coefficients[i].values[3]);
+
+    Eigen::Vector3f vp (0.0, 0.0, 0.0);
+    if (refined && project_points_ && !boundary_cloud.empty ())
+      boundary_cloud = projectToPlaneFromViewpoint (boundary_cloud, model, centroid, vp);
+
+    regions[i] = PlanarRegion<PointT> (centroid,
+                                       covariances[i], 
+                                       static_cast<unsigned int> (inlier_indices[i].indices.size ()),
+                                       boundary_cloud.points,
+                                       model);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 #define PCL_INSTANTIATE_OrganizedMultiPlaneSegmentation(T,NT,LT) template class PCL_EXPORTS pcl::OrganizedMultiPlaneSegmentation<T,NT,LT>;
 
 #endif  // PCL_SEGMENTATION_IMPL_MULTI_PLANE_SEGMENTATION_H_
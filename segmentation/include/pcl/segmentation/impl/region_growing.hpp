@@ -47,7 +47,9 @@
 #include <pcl/console/print.h> // for PCL_ERROR
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <pcl/segmentation/concurrent_disjoint_sets.h>
 
+#include <atomic>
 #include <queue>
 #include <cmath>
 #include <ctime>
@@ -71,7 +73,8 @@ pcl::RegionGrowing<PointT, NormalT>::RegionGrowing () :
   normal_flag_ (true),
   num_pts_in_segment_ (0),
   clusters_ (0),
-  number_of_segments_ (0)
+  number_of_segments_ (0),
+  threads_ (1)
 {
 }
 
@@ -245,6 +248,27 @@ pcl::RegionGrowing<PointT, NormalT>::setInputNormals (const NormalPtr& norm)
   normals_ = norm;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> unsigned int
+pcl::RegionGrowing<PointT, NormalT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& clusters)
@@ -343,31 +367,24 @@ template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 {
   int point_number = static_cast<int> (indices_->size ());
-  std::vector<int> neighbours;
-  std::vector<float> distances;
 
-  point_neighbours_.resize (input_->size (), neighbours);
-  if (input_->is_dense)
+  point_neighbours_.resize (input_->size ());
+
+  // Every point writes its own list, so the searches can run in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(point_number) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (int i_point = 0; i_point < point_number; i_point++)
   {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      int point_index = (*indices_)[i_point];
-      neighbours.clear ();
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
-  }
-  else
-  {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      neighbours.clear ();
-      int point_index = (*indices_)[i_point];
-      if (!pcl::isFinite ((*input_)[point_index]))
-        continue;
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
+    int point_index = (*indices_)[i_point];
+    if (!input_->is_dense && !pcl::isFinite ((*input_)[point_index]))
+      continue;
+    std::vector<int> neighbours;
+    std::vector<float> distances;
+    search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
+    point_neighbours_[point_index].swap (neighbours);
   }
 }
 
@@ -375,6 +392,13 @@ pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
 {
+  // The tests only depend on the two points in smooth mode (or without normals), so the regions can be grown in parallel
+  if (threads_ > 1 && (smooth_mode_flag_ || !normal_flag_))
+  {
+    applyParallelRegionGrowingAlgorithm ();
+    return;
+  }
+
   int num_of_pts = static_cast<int> (indices_->size ());
   point_labels_.resize (input_->size (), -1);
 
@@ -428,6 +452,140 @@ pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::applyParallelRegionGrowingAlgorithm ()
+{
+  int num_of_pts = static_cast<int> (indices_->size ());
+  point_labels_.resize (input_->size (), -1);
+
+  // Same seed order as the serial version
+  std::vector< std::pair<float, int> > point_residual (num_of_pts);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    int point_index = (*indices_)[i_point];
+    point_residual[i_point].first = normal_flag_ ? (*normals_)[point_index].curvature : 0.0f;
+    point_residual[i_point].second = point_index;
+  }
+  if (normal_flag_)
+    std::sort (point_residual.begin (), point_residual.end (), comparePair);
+
+  // The disjoint sets work on the position of the points in the seed order, so that the root of every region
+  // is its first seed
+  std::vector<int> point_rank (input_->size (), -1);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+    point_rank[point_residual[i_point].second] = i_point;
+
+  // Link all neighbours which could grow into each other: each one is accepted, and can serve as a seed,
+  // with the other one as the current seed
+  ConcurrentDisjointSets regions (num_of_pts);
+#pragma omp parallel for \
+  default(none) \
+  shared(num_of_pts, point_residual, point_rank, regions) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    int point_index = point_residual[i_point].second;
+    const std::vector<int>& neighbours = point_neighbours_[point_index];
+    for (std::size_t i_nghbr = 0; i_nghbr < neighbour_number_ && i_nghbr < neighbours.size (); i_nghbr++)
+    {
+      int index = neighbours[i_nghbr];
+      if (point_rank[index] == -1 || regions.find (point_rank[index]) == regions.find (i_point))
+        continue;
+
+      bool nghbr_is_a_seed = false, point_is_a_seed = false;
+      if (validatePoint (point_index, point_index, index, nghbr_is_a_seed) && nghbr_is_a_seed &&
+          validatePoint (index, index, point_index, point_is_a_seed) && point_is_a_seed)
+        regions.merge (i_point, point_rank[index]);
+    }
+  }
+
+  // Number the linked regions in the order of their first seed
+  std::vector<int> region_root (num_of_pts);
+  std::vector<int> region_size (num_of_pts, 0);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    region_root[i_point] = regions.find (i_point);
+    region_size[region_root[i_point]]++;
+  }
+
+  int number_of_segments = 0;
+  std::vector<int> segment_of_root (num_of_pts, -1);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+    if (region_root[i_point] == i_point && region_size[i_point] > 1)
+      segment_of_root[i_point] = number_of_segments++;
+
+  // Points which were not linked to any other one are given to the first region which accepts them from
+  // one of its points, as the serial version would mostly do
+  std::vector<std::atomic<int> > claims (num_of_pts);
+  for (auto& claim : claims)
+    claim.store (std::numeric_limits<int>::max (), std::memory_order_relaxed);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(num_of_pts, point_residual, point_rank, region_root, segment_of_root, claims) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    int segment = segment_of_root[region_root[i_point]];
+    if (segment == -1)
+      continue;
+
+    int point_index = point_residual[i_point].second;
+    const std::vector<int>& neighbours = point_neighbours_[point_index];
+    for (std::size_t i_nghbr = 0; i_nghbr < neighbour_number_ && i_nghbr < neighbours.size (); i_nghbr++)
+    {
+      int index = neighbours[i_nghbr];
+      if (point_rank[index] == -1 || segment_of_root[region_root[point_rank[index]]] != -1)
+        continue;
+
+      std::atomic<int>& claim = claims[point_rank[index]];
+      int claimed = claim.load (std::memory_order_relaxed);
+      if (segment >= claimed)
+        continue;
+
+      bool is_a_seed = false;
+      if (!validatePoint (point_index, point_index, index, is_a_seed))
+        continue;
+
+      // Keep the smallest segment number, i.e. the region with the first seed
+      while (segment < claimed && !claim.compare_exchange_weak (claimed, segment, std::memory_order_relaxed))
+      {
+      }
+    }
+  }
+
+  num_pts_in_segment_.assign (number_of_segments, 0);
+  int segmented_pts_num = 0;
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    int segment = segment_of_root[region_root[i_point]];
+    if (segment == -1 && claims[i_point].load (std::memory_order_relaxed) != std::numeric_limits<int>::max ())
+      segment = claims[i_point].load (std::memory_order_relaxed);
+    if (segment == -1)
+      continue;
+
+    point_labels_[point_residual[i_point].second] = segment;
+    num_pts_in_segment_[segment]++;
+    segmented_pts_num++;
+  }
+
+  // The remaining points are grown serially, in seed order
+  for (int i_point = 0; i_point < num_of_pts && segmented_pts_num < num_of_pts; i_point++)
+  {
+    int index = point_residual[i_point].second;
+    if (point_labels_[index] != -1)
+      continue;
+
+    int pts_in_segment = growRegion (index, number_of_segments);
+    segmented_pts_num += pts_in_segment;
+    num_pts_in_segment_.push_back (pts_in_segment);
+    number_of_segments++;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> int
 pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_number)
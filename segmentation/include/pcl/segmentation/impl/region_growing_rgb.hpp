@@ -273,17 +273,21 @@ template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findPointNeighbours ()
 {
   int point_number = static_cast<int> (indices_->size ());
-  std::vector<int> neighbours;
-  std::vector<float> distances;
 
-  point_neighbours_.resize (input_->size (), neighbours);
-  point_distances_.resize (input_->size (), distances);
+  point_neighbours_.resize (input_->size ());
+  point_distances_.resize (input_->size ());
 
+  // Every point writes its own lists, so the searches can run in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(point_number) \
+  schedule(dynamic, 256) \
+  num_threads(threads_)
   for (int i_point = 0; i_point < point_number; i_point++)
   {
     int point_index = (*indices_)[i_point];
-    neighbours.clear ();
-    distances.clear ();
+    std::vector<int> neighbours;
+    std::vector<float> distances;
     search_->nearestKSearch (i_point, region_neighbour_number_, neighbours, distances);
     point_neighbours_[point_index].swap (neighbours);
     point_distances_[point_index].swap (distances);
@@ -294,11 +298,13 @@ pcl::RegionGrowingRGB<PointT, NormalT>::findPointNeighbours ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findSegmentNeighbours ()
 {
-  std::vector<int> neighbours;
-  std::vector<float> distances;
-  segment_neighbours_.resize (number_of_segments_, neighbours);
-  segment_distances_.resize (number_of_segments_, distances);
+  segment_neighbours_.resize (number_of_segments_);
+  segment_distances_.resize (number_of_segments_);
 
+#pragma omp parallel for \
+  default(none) \
+  schedule(dynamic) \
+  num_threads(threads_)
   for (int i_seg = 0; i_seg < number_of_segments_; i_seg++)
   {
     std::vector<int> nghbrs;
@@ -52,6 +52,7 @@
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/rransac.h>
 #include <pcl/sample_consensus/prosac.h>
+#include <pcl/sample_consensus/sprt.h>
 
 // Sample Consensus models
 #include <pcl/sample_consensus/sac_model.h>
@@ -72,6 +73,8 @@
 
 #include <pcl/memory.h>  // for static_pointer_cast
 
+#include <algorithm> // for remove_if
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients &model_coefficients)
@@ -130,6 +133,156 @@ pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients
   deinitCompute ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACSegmentation<PointT>::segment (std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients)
+{
+  inliers.clear ();
+  model_coefficients.clear ();
+
+  if (!initCompute ())
+    return;
+
+  // Initialize the Sample Consensus model and method once, they are reused for all models
+  if (!initSACModel (model_type_))
+  {
+    PCL_ERROR ("[pcl::%s::segment] Error initializing the SAC model!\n", getClassName ().c_str ());
+    deinitCompute ();
+    return;
+  }
+  initSAC (method_type_);
+
+  // The points that are not inliers of any model so far. The inliers of each model are removed in place.
+  IndicesPtr remaining (new Indices (*indices_));
+  std::vector<bool> extracted (input_->size (), false);
+  const std::size_t min_points = (std::max<std::size_t>) (model_->getSampleSize (), min_inliers_);
+
+  Eigen::VectorXf coeff, coeff_refined;
+  while (inliers.size () < max_models_ && remaining->size () >= min_points)
+  {
+    model_->setIndices (remaining);
+    if (!sac_->computeModel (0))
+      break;
+
+    PointIndices model_inliers;
+    model_inliers.header = input_->header;
+    sac_->getInliers (model_inliers.indices);
+    sac_->getModelCoefficients (coeff);
+
+    // If the user needs optimized coefficients
+    if (optimize_coefficients_)
+    {
+      model_->optimizeModelCoefficients (model_inliers.indices, coeff, coeff_refined);
+      coeff = coeff_refined;
+      // Refine inliers
+      model_->selectWithinDistance (coeff, threshold_, model_inliers.indices);
+    }
+
+    if (model_inliers.indices.empty () || model_inliers.indices.size () < min_inliers_)
+      break;
+
+    PCL_DEBUG ("[pcl::%s::segment] Model %lu has %lu inliers, %lu points left.\n", getClassName ().c_str (), inliers.size (), model_inliers.indices.size (), remaining->size () - model_inliers.indices.size ());
+
+    for (const auto &index : model_inliers.indices)
+      extracted[index] = true;
+    remaining->erase (std::remove_if (remaining->begin (), remaining->end (), [&extracted] (const index_t &index) { return (extracted[index]); }), remaining->end ());
+
+    ModelCoefficients coefficients;
+    coefficients.header = input_->header;
+    coefficients.values.assign (coeff.data (), coeff.data () + coeff.size ());
+    inliers.push_back (std::move (model_inliers));
+    model_coefficients.push_back (std::move (coefficients));
+  }
+
+  if (joint_refinement_ && inliers.size () > 1)
+    refineModelsJointly (inliers, model_coefficients);
+
+  // Leave the model with the indices given by the user
+  model_->setIndices (*indices_);
+
+  deinitCompute ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACSegmentation<PointT>::refineModelsJointly (std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients)
+{
+  const std::size_t nr_models = inliers.size ();
+
+  // All points that belong to a model, and the model each of them is assigned to
+  Indices points;
+  for (const auto &model_inliers : inliers)
+    points.insert (points.end (), model_inliers.indices.begin (), model_inliers.indices.end ());
+  std::vector<std::size_t> assignment (points.size (), nr_models);
+  model_->setIndices (points);
+
+  std::vector<Eigen::VectorXf> coefficients (nr_models);
+  for (std::size_t m = 0; m < nr_models; ++m)
+    coefficients[m] = Eigen::Map<const Eigen::VectorXf> (model_coefficients[m].values.data (), model_coefficients[m].values.size ());
+
+  std::vector<Indices> assigned (nr_models);
+  std::vector<double> distances, min_distances (points.size ());
+  Eigen::VectorXf coeff_refined;
+  // The assignment usually settles after a few iterations. The points are assigned once more after the last refit,
+  // so that the inliers always match the coefficients returned.
+  const int max_refinement_iterations = 10;
+  for (int iteration = 0; ; ++iteration)
+  {
+    // Assign every point to the closest model that it is an inlier of
+    std::fill (min_distances.begin (), min_distances.end (), std::numeric_limits<double>::max ());
+    std::vector<std::size_t> new_assignment (points.size (), nr_models);
+    for (std::size_t m = 0; m < nr_models; ++m)
+    {
+      model_->getDistancesToModel (coefficients[m], distances);
+      if (distances.size () != points.size ())
+        continue;
+      for (std::size_t i = 0; i < points.size (); ++i)
+      {
+        if (distances[i] <= threshold_ && distances[i] < min_distances[i])
+        {
+          min_distances[i] = distances[i];
+          new_assignment[i] = m;
+        }
+      }
+    }
+    if (new_assignment == assignment)
+      break;
+    assignment.swap (new_assignment);
+
+    // Fit the models to their points again
+    for (auto &model_points : assigned)
+      model_points.clear ();
+    for (std::size_t i = 0; i < points.size (); ++i)
+      if (assignment[i] < nr_models)
+        assigned[assignment[i]].push_back (points[i]);
+    if (!optimize_coefficients_ || iteration == max_refinement_iterations)
+      break;
+    for (std::size_t m = 0; m < nr_models; ++m)
+    {
+      if (assigned[m].size () < model_->getSampleSize ())
+        continue;
+      model_->optimizeModelCoefficients (assigned[m], coefficients[m], coeff_refined);
+      coefficients[m] = coeff_refined;
+    }
+    PCL_DEBUG ("[pcl::%s::refineModelsJointly] Iteration %d: reassigned the points of %lu models.\n", getClassName ().c_str (), iteration, nr_models);
+  }
+
+  // Drop the models that lost (too many of) their points to other models
+  std::size_t nr_kept = 0;
+  for (std::size_t m = 0; m < nr_models; ++m)
+  {
+    if (assigned[m].empty () || assigned[m].size () < min_inliers_)
+      continue;
+    inliers[nr_kept].header = inliers[m].header;
+    inliers[nr_kept].indices.swap (assigned[m]);
+    model_coefficients[nr_kept].header = model_coefficients[m].header;
+    model_coefficients[nr_kept].values.assign (coefficients[m].data (), coefficients[m].data () + coefficients[m].size ());
+    ++nr_kept;
+  }
+  inliers.resize (nr_kept);
+  model_coefficients.resize (nr_kept);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SACSegmentation<PointT>::initSACModel (const int model_type)
@@ -319,6 +472,12 @@ pcl::SACSegmentation<PointT>::initSAC (const int method_type)
       sac_.reset (new ProgressiveSampleConsensus<PointT> (model_, threshold_));
       break;
     }
+    case SAC_SPRT:
+    {
+      PCL_DEBUG ("[pcl::%s::initSAC] Using a method of type: SAC_SPRT with a model threshold of %f\n", getClassName ().c_str (), threshold_);
+      sac_.reset (new SPRTSampleConsensus<PointT> (model_, threshold_));
+      break;
+    }
   }
   // Set the Sample Consensus parameters if they are given/changed
   if (sac_->getProbability () != probability_)
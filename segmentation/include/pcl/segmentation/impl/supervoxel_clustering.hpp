@@ -43,6 +43,8 @@
 #include <pcl/segmentation/supervoxel_clustering.h>
 #include <pcl/common/io.h> // for copyPointCloud
 
+#include <unordered_map>
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 pcl::SupervoxelClustering<PointT>::SupervoxelClustering (float voxel_resolution, float seed_resolution) :
@@ -53,7 +55,8 @@ pcl::SupervoxelClustering<PointT>::SupervoxelClustering (float voxel_resolution,
   color_importance_ (0.1f),
   spatial_importance_ (0.4f),
   normal_importance_ (1.0f),
-  use_default_transform_behaviour_ (true)
+  use_default_transform_behaviour_ (true),
+  threads_ (1)
 {
   adjacency_octree_.reset (new OctreeAdjacencyT (resolution_));
 }
@@ -157,9 +160,19 @@ pcl::SupervoxelClustering<PointT>::refineSupervoxels (int num_itr, std::map<std:
   int max_depth = static_cast<int> (1.8f*seed_resolution_/resolution_);
   for (int i = 0; i < num_itr; ++i)
   {
+    //Every supervoxel only changes the normals of its own voxels
+    std::vector<SupervoxelHelper*> helpers;
     for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+      helpers.push_back (&(*sv_itr));
+    int num_helpers = static_cast<int> (helpers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers, num_helpers) \
+  schedule(dynamic) \
+  num_threads(threads_)
+    for (int h = 0; h < num_helpers; ++h)
     {
-      sv_itr->refineNormals ();
+      helpers[h]->refineNormals ();
     }
     
     reseedSupervoxels ();
@@ -208,8 +221,9 @@ pcl::SupervoxelClustering<PointT>::prepareForSegmentation ()
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::computeVoxelData ()
 {
+  int num_leaves = static_cast<int> (adjacency_octree_->getLeafCount ());
   voxel_centroid_cloud_.reset (new PointCloudT);
-  voxel_centroid_cloud_->resize (adjacency_octree_->getLeafCount ());
+  voxel_centroid_cloud_->resize (num_leaves);
   typename LeafVectorT::iterator leaf_itr = adjacency_octree_->begin ();
   typename PointCloudT::iterator cent_cloud_itr = voxel_centroid_cloud_->begin ();
   for (int idx = 0 ; leaf_itr != adjacency_octree_->end (); ++leaf_itr, ++cent_cloud_itr, ++idx)
@@ -243,28 +257,40 @@ pcl::SupervoxelClustering<PointT>::computeVoxelData ()
       voxel_data.curvature_ += normal_itr->curvature;
     }
     //Now iterate through the leaves and normalize 
-    for (leaf_itr = adjacency_octree_->begin (); leaf_itr != adjacency_octree_->end (); ++leaf_itr)
+#pragma omp parallel for \
+  default(none) \
+  shared(num_leaves) \
+  num_threads(threads_)
+    for (int idx = 0; idx < num_leaves; ++idx)
     {
-      VoxelData& voxel_data = (*leaf_itr)->getData ();
+      LeafContainerT* leaf = adjacency_octree_->at (idx);
+      VoxelData& voxel_data = leaf->getData ();
       voxel_data.normal_.normalize ();
       voxel_data.owner_ = nullptr;
       voxel_data.distance_ = std::numeric_limits<float>::max ();
       //Get the number of points in this leaf
-      int num_points = (*leaf_itr)->getPointCounter ();
+      int num_points = leaf->getPointCounter ();
       voxel_data.curvature_ /= num_points;
     }
   }
   else //Otherwise just compute the normals
   {
-    for (leaf_itr = adjacency_octree_->begin (); leaf_itr != adjacency_octree_->end (); ++leaf_itr)
+    //Every leaf only writes its own data, so they can be done in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(num_leaves) \
+  schedule(dynamic, 64) \
+  num_threads(threads_)
+    for (int idx = 0; idx < num_leaves; ++idx)
     {
-      VoxelData& new_voxel_data = (*leaf_itr)->getData ();
+      LeafContainerT* leaf = adjacency_octree_->at (idx);
+      VoxelData& new_voxel_data = leaf->getData ();
       //For every point, get its neighbors, build an index vector, compute normal
       Indices indices;
       indices.reserve (81); 
       //Push this point
       indices.push_back (new_voxel_data.idx_);
-      for (typename LeafContainerT::const_iterator neighb_itr=(*leaf_itr)->cbegin (); neighb_itr!=(*leaf_itr)->cend (); ++neighb_itr)
+      for (typename LeafContainerT::const_iterator neighb_itr=leaf->cbegin (); neighb_itr!=leaf->cend (); ++neighb_itr)
       {
         VoxelData& neighb_voxel_data = (*neighb_itr)->getData ();
         //Push neighbor index
@@ -293,7 +319,11 @@ pcl::SupervoxelClustering<PointT>::computeVoxelData ()
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
 {
-  
+  if (threads_ > 1)
+  {
+    expandSupervoxelsParallel (depth);
+    return;
+  }
   
   for (int i = 1; i < depth; ++i)
   {
@@ -321,6 +351,95 @@ pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::expandSupervoxelsParallel (int depth)
+{
+  //The supervoxel which takes over each voxel in the current iteration
+  std::vector<SupervoxelHelper*> new_owners (adjacency_octree_->getLeafCount (), nullptr);
+  std::vector<LeafContainerT*> changed_leaves;
+  std::vector<SupervoxelHelper*> helpers;
+  std::vector<std::vector<std::pair<LeafContainerT*, float> > > candidates;
+  std::unordered_map<const SupervoxelHelper*, int> helper_numbers;
+  std::vector<std::size_t> taken_leaves;
+
+  for (int i = 1; i < depth; ++i)
+  {
+    helpers.clear ();
+    for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+      helpers.push_back (&(*sv_itr));
+    int num_helpers = static_cast<int> (helpers.size ());
+
+    //Every supervoxel looks for the voxels it is closer to than their current owner, nothing is changed yet
+    candidates.resize (num_helpers);
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers, candidates, num_helpers) \
+  schedule(dynamic) \
+  num_threads(threads_)
+    for (int h = 0; h < num_helpers; ++h)
+      helpers[h]->getExpansionCandidates (candidates[h]);
+
+    //Give every voxel to the closest candidate, the first supervoxel wins a tie. As in the serial expansion, a
+    //supervoxel whose voxels have all been taken by the supervoxels before it has nothing left to expand from.
+    helper_numbers.clear ();
+    for (int h = 0; h < num_helpers; ++h)
+      helper_numbers[helpers[h]] = h;
+    taken_leaves.assign (num_helpers, 0);
+    changed_leaves.clear ();
+    for (int h = 0; h < num_helpers; ++h)
+    {
+      if (taken_leaves[h] == helpers[h]->size ())
+        continue;
+      for (const auto &candidate : candidates[h])
+      {
+        VoxelData& voxel = candidate.first->getData ();
+        if (candidate.second < voxel.distance_)
+        {
+          voxel.distance_ = candidate.second;
+          if (!new_owners[voxel.idx_])
+          {
+            changed_leaves.push_back (candidate.first);
+            if (voxel.owner_)
+              ++taken_leaves[helper_numbers[voxel.owner_]];
+          }
+          new_owners[voxel.idx_] = helpers[h];
+        }
+      }
+    }
+    for (const auto &leaf : changed_leaves)
+    {
+      VoxelData& voxel = leaf->getData ();
+      if (voxel.owner_)
+        voxel.owner_->removeLeaf (leaf);
+      new_owners[voxel.idx_]->addLeaf (leaf);
+      new_owners[voxel.idx_] = nullptr;
+    }
+
+    //Update the centers to reflect new centers
+    helpers.clear ();
+    for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); )
+    {
+      if (sv_itr->size () == 0)
+      {
+        sv_itr = supervoxel_helpers_.erase (sv_itr);
+      }
+      else
+      {
+        helpers.push_back (&(*sv_itr));
+        ++sv_itr;
+      }
+    }
+    num_helpers = static_cast<int> (helpers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers, num_helpers) \
+  num_threads(threads_)
+    for (int h = 0; h < num_helpers; ++h)
+      helpers[h]->updateCentroid ();
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::makeSupervoxels (std::map<std::uint32_t,typename Supervoxel<PointT>::Ptr > &supervoxel_clusters)
@@ -391,27 +510,35 @@ pcl::SupervoxelClustering<PointT>::selectInitialSupervoxelSeeds (Indices &seed_i
     voxel_kdtree_ ->setInputCloud (voxel_centroid_cloud_);
   }
   
-  for (int i = 0; i < num_seeds; ++i)  
-  {
-    voxel_kdtree_->nearestKSearch (voxel_centers[i], 1, closest_index, distance);
-    seed_indices_orig[i] = closest_index[0];
-  }
-  
-  std::vector<int> neighbors;
-  std::vector<float> sqr_distances;
   seed_indices.reserve (seed_indices_orig.size ());
   float search_radius = 0.5f*seed_resolution_;
   // This is 1/20th of the number of voxels which fit in a planar slice through search volume
   // Area of planar slice / area of voxel side. (Note: This is smaller than the value mentioned in the original paper)
   float min_points = 0.05f * (search_radius)*(search_radius) * 3.1415926536f  / (resolution_*resolution_);
-  for (const auto &index_orig : seed_indices_orig)
+  std::vector<char> keep_seed_flags (num_seeds, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(num_seeds, voxel_centers, seed_indices_orig, search_radius, min_points, keep_seed_flags) \
+  firstprivate(closest_index, distance) \
+  schedule(dynamic, 16) \
+  num_threads(threads_)
+  for (int i = 0; i < num_seeds; ++i)  
   {
-    int num = voxel_kdtree_->radiusSearch (index_orig, search_radius , neighbors, sqr_distances);
-    if ( num > min_points)
+    voxel_kdtree_->nearestKSearch (voxel_centers[i], 1, closest_index, distance);
+    seed_indices_orig[i] = closest_index[0];
+
+    std::vector<int> neighbors;
+    std::vector<float> sqr_distances;
+    int num = voxel_kdtree_->radiusSearch (seed_indices_orig[i], search_radius , neighbors, sqr_distances);
+    keep_seed_flags[i] = (num > min_points);
+  }
+
+  for (int i = 0; i < num_seeds; ++i)
+  {
+    if (keep_seed_flags[i])
     {
-      seed_indices.push_back (index_orig);
+      seed_indices.push_back (seed_indices_orig[i]);
     }
-    
   }
  // std::cout << "Number of seed points after filtering="<<seed_points.size ()<<std::endl;
   
@@ -428,16 +555,32 @@ pcl::SupervoxelClustering<PointT>::reseedSupervoxels ()
     sv_itr->removeAllLeaves ();
   }
   
-  Indices closest_index;
-  std::vector<float> distance;
-  //Now go through each supervoxel, find voxel closest to its center, add it in
+  std::vector<SupervoxelHelper*> helpers;
   for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+    helpers.push_back (&(*sv_itr));
+  int num_helpers = static_cast<int> (helpers.size ());
+
+  //Now go through each supervoxel, find voxel closest to its center
+  Indices closest_indices (num_helpers);
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers, num_helpers, closest_indices) \
+  num_threads(threads_)
+  for (int h = 0; h < num_helpers; ++h)
   {
+    Indices closest_index;
+    std::vector<float> distance;
     PointT point;
-    sv_itr->getXYZ (point.x, point.y, point.z);
+    helpers[h]->getXYZ (point.x, point.y, point.z);
     voxel_kdtree_->nearestKSearch (point, 1, closest_index, distance);
-    
-    LeafContainerT* seed_leaf = adjacency_octree_->at (closest_index[0]);
+    closest_indices[h] = closest_index[0];
+  }
+
+  //And add it in
+  typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin ();
+  for (int h = 0; h < num_helpers; ++h, ++sv_itr)
+  {
+    LeafContainerT* seed_leaf = adjacency_octree_->at (closest_indices[h]);
     if (seed_leaf)
     {
       sv_itr->addLeaf (seed_leaf);
@@ -678,6 +821,20 @@ pcl::SupervoxelClustering<PointT>::setUseSingleCameraTransform (bool val)
   use_single_camera_transform_ = val;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::SupervoxelClustering<PointT>::getMaxLabel () const
@@ -828,6 +985,28 @@ pcl::SupervoxelClustering<PointT>::SupervoxelHelper::expand ()
   }  
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::SupervoxelHelper::getExpansionCandidates (std::vector<std::pair<LeafContainerT*, float> > &candidates) const
+{
+  candidates.clear ();
+  //For each leaf belonging to this supervoxel
+  for (auto leaf_itr = leaves_.cbegin (); leaf_itr != leaves_.cend (); ++leaf_itr)
+  {
+    //for each neighbor of the leaf
+    for (typename LeafContainerT::const_iterator neighb_itr=(*leaf_itr)->cbegin (); neighb_itr!=(*leaf_itr)->cend (); ++neighb_itr)
+    {
+      const VoxelData& neighbor_voxel = ((*neighb_itr)->getData ());
+      if (neighbor_voxel.owner_ == this)
+        continue;
+      //Same test as in expand (), but only remember the voxels we would steal
+      float dist = parent_->voxelDataDistance (centroid_, neighbor_voxel);
+      if (dist < neighbor_voxel.distance_)
+        candidates.emplace_back (*neighb_itr, dist);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::SupervoxelHelper::refineNormals ()
@@ -38,7 +38,9 @@
 
 #pragma once
 
+#include <pcl/common/utils.h> // for pcl::utils::ignore
 #include <pcl/segmentation/boost.h>
+#include <pcl/segmentation/compact_max_flow.h>
 #include <pcl/memory.h>
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
@@ -54,6 +56,14 @@ namespace pcl
     * The description can be found in the article:
     * "Min-Cut Based Segmentation of Point Clouds"
     * \author: Aleksey Golovinskiy and Thomas Funkhouser.
+    *
+    * The graph is kept between calls to \ref extract, so if only the foreground or background points, the
+    * radius or the source weight change, only the unary potentials are recalculated. By default a point
+    * belongs to the foreground if its edge from the source keeps some residual capacity, as in the original
+    * implementation. Since that depends on how the flow is routed, the flow is computed from scratch on every
+    * call. \ref setReuseFlow lets the flow of the previous segmentation be reused instead, which makes
+    * interactive segmentation much faster; the foreground is then the smallest source side of the minimum cut,
+    * which does not depend on the routing.
     */
   template <typename PointT>
   class PCL_EXPORTS MinCutSegmentation : public pcl::PCLBase<PointT>
@@ -172,6 +182,20 @@ namespace pcl
       void
       setNumberOfNeighbours (unsigned int neighbour_number);
 
+      /** \brief Set the number of threads used to build the graph and compute its edge weights.
+        * The minimum cut itself is computed by a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Returns the number of threads used to build the graph. */
+      unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Returns the points that must belong to foreground. */
       std::vector<PointT, Eigen::aligned_allocator<PointT> >
       getForegroundPoints () const;
@@ -200,11 +224,33 @@ namespace pcl
       void
       extract (std::vector <pcl::PointIndices>& clusters);
 
+      /** \brief Allows to reuse the flow of the previous segmentation when only the unary potentials changed.
+        * The foreground then consists of the points on the source side of the minimum cut. Points whose edge
+        * from the source is saturated can still be reached through their neighbours, so the foreground is
+        * usually larger than with the default labelling by the residual capacity of the edges from the source.
+        * \param[in] reuse_flow true to reuse the flow between calls to \ref extract (default: false)
+        */
+      inline void
+      setReuseFlow (bool reuse_flow)
+      {
+        reuse_flow_ = reuse_flow;
+      }
+
+      /** \brief Returns true if the flow of the previous segmentation is reused. */
+      inline bool
+      getReuseFlow () const
+      {
+        return (reuse_flow_);
+      }
+
       /** \brief Returns that flow value that was calculated during the segmentation. */
       double
       getMaxFlow () const;
 
-      /** \brief Returns the graph that was build for finding the minimum cut. */
+      /** \brief Returns the graph that was build for finding the minimum cut, with the residual capacities
+        * of the last segmentation. It is converted from the internal graph on every call, so it is only meant
+        * for inspection. Returns an empty pointer if the graph was not built yet.
+        */
       mGraphPtr
       getGraph () const;
 
@@ -227,14 +273,6 @@ namespace pcl
       void
       calculateUnaryPotential (int point, double& source_weight, double& sink_weight) const;
 
-      /** \brief This method simply adds the edge from the source point to the target point with a given weight.
-        * \param[in] source index of the source point of the edge
-        * \param[in] target index of the target point of the edge
-        * \param[in] weight weight that will be assigned to the (source, target) edge
-        */
-      bool
-      addEdge (int source, int target, double weight);
-
       /** \brief Returns the binary potential(smooth cost) for the given indices of points.
         * In other words it returns weight that must be assigned to the edge from source to target point.
         * \param[in] source index of the source point of the edge
@@ -243,19 +281,43 @@ namespace pcl
       double
       calculateBinaryPotential (int source, int target) const;
 
-      /** \brief This method recalculates unary potentials(data cost) if some changes were made, instead of creating new graph. */
+      /** \brief Does nothing and returns false. The graph is no longer built in \ref graph_, so edges can not be
+        * added to it anymore.
+        * \param[in] source index of the source point of the edge
+        * \param[in] target index of the target point of the edge
+        * \param[in] weight weight that would be assigned to the (source, target) edge
+        * \deprecated The graph is stored in flow_graph_ and built by \ref buildGraph.
+        */
+      PCL_DEPRECATED(1, 14, "addEdge() does nothing, the graph is built by buildGraph() and can be inspected with getGraph()")
+      bool
+      addEdge (int source, int target, double weight);
+
+      /** \brief This method recalculates unary potentials(data cost) if some changes were made, instead of creating new graph.
+        * The flow of the previous segmentation is kept if \ref setReuseFlow was enabled.
+        */
       bool
       recalculateUnaryPotentials ();
 
-      /** \brief This method recalculates binary potentials(smooth cost) if some changes were made, instead of creating new graph. */
+      /** \brief This method recalculates binary potentials(smooth cost) if some changes were made, instead of creating new graph.
+        * The flow of the previous segmentation is discarded.
+        */
       bool
       recalculateBinaryPotentials ();
 
+      /** \brief This method analyzes the residual network and assigns a label to every point in the cloud. */
+      void
+      assembleLabels ();
+
       /** \brief This method analyzes the residual network and assigns a label to every point in the cloud.
-        * \param[in] residual_capacity residual network that was obtained during the segmentation
+        * \param[in] residual_capacity ignored, the labels are taken from the internal graph
         */
+      PCL_DEPRECATED(1, 14, "the residual capacities are not needed anymore, use assembleLabels() instead")
       void
-      assembleLabels (ResidualCapacityMap& residual_capacity);
+      assembleLabels (ResidualCapacityMap& residual_capacity)
+      {
+        utils::ignore (residual_capacity);
+        assembleLabels ();
+      }
 
     protected:
 
@@ -295,25 +357,51 @@ namespace pcl
       /** \brief After the segmentation it will contain the segments. */
       std::vector <pcl::PointIndices> clusters_;
 
-      /** \brief Stores the graph for finding the maximum flow. */
+      /** \brief Stores the graph for finding the maximum flow. Node i of the graph is the point graph_nodes_[i]. */
+      pcl::segmentation::CompactMaxFlow flow_graph_;
+
+      /** \brief Stores the point index of every node of the graph. */
+      Indices graph_nodes_;
+
+      /** \brief Stores the number of threads used to build the graph. */
+      unsigned int threads_;
+
+      /** \brief Signalizes if the flow of the previous segmentation is reused. */
+      bool reuse_flow_;
+
+      /** \brief Stores the graph for finding the maximum flow.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       mGraphPtr graph_;
 
-      /** \brief Stores the capacity of every edge in the graph. */
+      /** \brief Stores the capacity of every edge in the graph.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       std::shared_ptr<CapacityMap> capacity_;
 
-      /** \brief Stores reverse edges for every edge in the graph. */
+      /** \brief Stores reverse edges for every edge in the graph.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       std::shared_ptr<ReverseEdgeMap> reverse_edges_;
 
-      /** \brief Stores the vertices of the graph. */
+      /** \brief Stores the vertices of the graph.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       std::vector< VertexDescriptor > vertices_;
 
-      /** \brief Stores the information about the edges that were added to the graph. It is used to avoid the duplicate edges. */
+      /** \brief Stores the information about the edges that were added to the graph. It is used to avoid the duplicate edges.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       std::vector< std::set<int> > edge_marker_;
 
-      /** \brief Stores the vertex that serves as source. */
+      /** \brief Stores the vertex that serves as source.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       VertexDescriptor source_;
 
-      /** \brief Stores the vertex that serves as sink. */
+      /** \brief Stores the vertex that serves as sink.
+        * \deprecated No longer used by the segmentation, will be removed in PCL 1.14. Use getGraph () instead.
+        */
       VertexDescriptor sink_;
 
       /** \brief Stores the maximum flow value that was calculated during the segmentation. */
@@ -51,6 +51,7 @@ namespace pcl
     * output a PointCloud of labels, giving each connected component a unique
     * id, along with a vector of PointIndices corresponding to each component.
     * See OrganizedMultiPlaneSegmentation for an example application.
+    * With setNumberOfThreads() horizontal bands of the image are labeled in parallel and merged at their seams.
     *
     * \author Alex Trevor, Suat Gedikli
     */
@@ -80,6 +81,7 @@ namespace pcl
         */
       OrganizedConnectedComponentSegmentation (const ComparatorConstPtr& compare)
         : compare_ (compare)
+        , threads_ (1)
       {
       }
 
@@ -102,6 +104,22 @@ namespace pcl
       ComparatorConstPtr
       getComparator () const { return (compare_); }
 
+      /** \brief Set the number of threads used to segment the input.
+        * \details With more than one thread, the image is split into horizontal bands that are labeled in parallel,
+        * and the components that touch at the seams between the bands are merged afterwards. The labels and label
+        * indices are the same as with one thread. The comparator must be thread safe.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to segment the input. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Perform the connected component segmentation.
         * \param[out] labels a PointCloud of labels: each connected component will have a unique id.
         * \param[out] label_indices a vector of PointIndices corresponding to each label / component id.
@@ -120,6 +138,9 @@ namespace pcl
 
     protected:
       ComparatorConstPtr compare_;
+
+      /** \brief The number of threads used to segment the input (default = 1) */
+      unsigned int threads_;
       
       inline unsigned
       findRoot (const std::vector<unsigned>& runs, unsigned index) const
@@ -132,6 +153,23 @@ namespace pcl
       }
 
     private:
+      /** \brief Compare a run of consecutive points with the points at a fixed offset with Comparator::compareRun (),
+        * skipping the points whose x coordinate is not finite, as the point by point comparison did.
+        * \param[in] first_idx the index of the first point of the run
+        * \param[in] count the number of points in the run
+        * \param[in] offset the offset from every point of the run to the point it is compared with
+        * \param[out] result the result of every comparison (1 or 0, always 0 for skipped points)
+        */
+      void
+      compareFiniteRuns (int first_idx, int count, int offset, std::uint8_t* result) const;
+
+      /** \brief Perform the connected component segmentation with several threads, see setNumberOfThreads().
+        * \param[out] labels a PointCloud of labels: each connected component will have a unique id.
+        * \param[out] label_indices a vector of PointIndices corresponding to each label / component id.
+        */
+      void
+      segmentParallel (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const;
+
       struct Neighbor
       {
         Neighbor (int dx, int dy, int didx)
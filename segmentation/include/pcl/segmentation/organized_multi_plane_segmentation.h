@@ -56,6 +56,7 @@ namespace pcl
     * of point clouds corresponding to the inliers of each detected plane.  Only
     * planes with more than min_inliers points are detected.
     * Templated on point type, normal type, and label type
+    * With setNumberOfThreads() the connected components are labeled, and the planes fitted to them, in parallel.
     *
     * \author Alex Trevor, Suat Gedikli
     */
@@ -96,7 +97,8 @@ namespace pcl
         distance_threshold_ (0.02),
         maximum_curvature_ (0.001),
         project_points_ (false), 
-        compare_ (new PlaneComparator ()), refinement_compare_ (new PlaneRefinementComparator ())
+        compare_ (new PlaneComparator ()), refinement_compare_ (new PlaneRefinementComparator ()),
+        threads_ (1)
       {
       }
 
@@ -213,6 +215,23 @@ namespace pcl
         project_points_ = project_points;
       }
 
+      /** \brief Set the number of threads used to segment the input.
+        * \details With more than one thread, the connected components are labeled in parallel (see
+        * OrganizedConnectedComponentSegmentation::setNumberOfThreads()), and the plane fitting and boundary extraction
+        * run in parallel for all regions. The refinement sweeps in refine() depend on the order in which the pixels are
+        * visited and are always done by one thread. The results are the same as with one thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to segment the input. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Segmentation of all planes in a point cloud given by setInputCloud(), setIndices()
         * \param[out] model_coefficients a vector of model_coefficients for each plane found in the input cloud
         * \param[out] inlier_indices a vector of inliers for each detected plane
@@ -279,6 +298,26 @@ namespace pcl
               std::vector<pcl::PointIndices>& label_indices);
 
     protected:
+      /** \brief Extract the boundary of every plane and build the planar regions, in parallel if setNumberOfThreads() is used.
+        * \param[out] regions the resultant planar regions
+        * \param[in] model_coefficients the model coefficients of every plane
+        * \param[in] inlier_indices the inliers of every plane
+        * \param[in] centroids the centroid of every plane
+        * \param[in] covariances the covariance matrix of every plane
+        * \param[in] labels the labels of the segmentation
+        * \param[out] boundary_indices the indices of the boundary points of every plane
+        * \param[in] refined whether the planes were refined, in which case the boundary is traced from the last inlier
+        * instead of the first one and the boundary points may be projected to the plane
+        */
+      void
+      buildPlanarRegions (std::vector<PlanarRegion<PointT>, Eigen::aligned_allocator<PlanarRegion<PointT> > >& regions,
+                          const std::vector<ModelCoefficients>& model_coefficients,
+                          const std::vector<PointIndices>& inlier_indices,
+                          const std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >& centroids,
+                          const std::vector <Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> >& covariances,
+                          const PointCloudLPtr& labels,
+                          std::vector<pcl::PointIndices>& boundary_indices,
+                          bool refined) const;
 
       /** \brief A pointer to the input normals */
       PointCloudNConstPtr normals_;
@@ -304,6 +343,9 @@ namespace pcl
       /** \brief A comparator for use on the refinement step.  Compares points to regions segmented in the first pass. */
       PlaneRefinementComparatorPtr refinement_compare_;
 
+      /** \brief The number of threads used to segment the input (default = 1) */
+      unsigned int threads_;
+
       /** \brief Class getName method. */
       virtual std::string
       getClassName () const
@@ -44,6 +44,8 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/segmentation/comparator.h>
 
+#include <typeinfo> // for typeid
+
 namespace pcl
 {
   /** \brief PlaneCoefficientComparator is a Comparator that operates on plane coefficients, for use in planar segmentation.
@@ -198,6 +200,64 @@ namespace pcl
                  && ((*normals_)[idx1].getNormalVector3fMap ().dot ((*normals_)[idx2].getNormalVector3fMap () ) > angular_threshold_ ) );
       }
 
+      /** \brief Compare a run of consecutive points with the points at a fixed offset, see Comparator::compareRun ().
+        * Four pairs are compared at once with SSE instructions if available. Subclasses that override compare ()
+        * are compared one pair at a time with their own compare ().
+        * \param[in] first_idx the index of the first point of the run
+        * \param[in] count the number of points in the run
+        * \param[in] offset the offset from every point of the run to the point it is compared with
+        * \param[out] result the result of every comparison (1 or 0)
+        */
+      void
+      compareRun (int first_idx, int count, int offset, std::uint8_t* result) const override
+      {
+        if (typeid (*this) != typeid (PlaneCoefficientComparator<PointT, PointNT>))
+        {
+          Comparator<PointT>::compareRun (first_idx, count, offset, result);
+          return;
+        }
+
+        int i = 0;
+#ifdef __SSE__
+        const std::vector<float> &plane_d = *plane_coeff_d_;
+        const __m128 abs_help = _mm_set1_ps (-0.0F); // -0.0F (negative zero) means that all bits are 0, only the sign bit is 1
+        const __m128 distance_threshold = _mm_set1_ps (distance_threshold_);
+        const __m128 angular_threshold = _mm_set1_ps (angular_threshold_);
+        for (; (i + 3) < count; i += 4)
+        {
+          const int p = first_idx + i;
+          const int q = p + offset;
+
+          __m128 threshold = distance_threshold;
+          if (depth_dependent_)
+          {
+            const __m128 z = _mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_set_ps ((*input_)[p+3].x, (*input_)[p+2].x, (*input_)[p+1].x, (*input_)[p].x), _mm_set1_ps (z_axis_[0])),
+                                                     _mm_mul_ps (_mm_set_ps ((*input_)[p+3].y, (*input_)[p+2].y, (*input_)[p+1].y, (*input_)[p].y), _mm_set1_ps (z_axis_[1]))),
+                                         _mm_mul_ps (_mm_set_ps ((*input_)[p+3].z, (*input_)[p+2].z, (*input_)[p+1].z, (*input_)[p].z), _mm_set1_ps (z_axis_[2])));
+            threshold = _mm_mul_ps (threshold, _mm_mul_ps (z, z));
+          }
+          // The andnot-function realizes an abs-operation: the sign bit is removed
+          const __m128 d_diff = _mm_andnot_ps (abs_help, _mm_sub_ps (_mm_loadu_ps (&plane_d[p]), _mm_loadu_ps (&plane_d[q])));
+
+          const __m128 normal_dot =
+            _mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_set_ps ((*normals_)[p+3].normal_x, (*normals_)[p+2].normal_x, (*normals_)[p+1].normal_x, (*normals_)[p].normal_x),
+                                                _mm_set_ps ((*normals_)[q+3].normal_x, (*normals_)[q+2].normal_x, (*normals_)[q+1].normal_x, (*normals_)[q].normal_x)),
+                                    _mm_mul_ps (_mm_set_ps ((*normals_)[p+3].normal_y, (*normals_)[p+2].normal_y, (*normals_)[p+1].normal_y, (*normals_)[p].normal_y),
+                                                _mm_set_ps ((*normals_)[q+3].normal_y, (*normals_)[q+2].normal_y, (*normals_)[q+1].normal_y, (*normals_)[q].normal_y))),
+                        _mm_mul_ps (_mm_set_ps ((*normals_)[p+3].normal_z, (*normals_)[p+2].normal_z, (*normals_)[p+1].normal_z, (*normals_)[p].normal_z),
+                                    _mm_set_ps ((*normals_)[q+3].normal_z, (*normals_)[q+2].normal_z, (*normals_)[q+1].normal_z, (*normals_)[q].normal_z)));
+
+          // Point p+j is in the j-th element and therefore in the j-th bit of the mask
+          const int mask = _mm_movemask_ps (_mm_and_ps (_mm_cmplt_ps (d_diff, threshold),
+                                                        _mm_cmpgt_ps (normal_dot, angular_threshold)));
+          for (int j = 0; j < 4; ++j)
+            result[i + j] = static_cast<std::uint8_t> ((mask >> j) & 1);
+        }
+#endif
+        for (; i < count; ++i)
+          result[i] = compare (first_idx + i, first_idx + i + offset);
+      }
+
     protected:
       PointCloudNConstPtr normals_;
       shared_ptr<std::vector<float> > plane_coeff_d_;
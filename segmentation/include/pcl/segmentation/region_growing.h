@@ -200,6 +200,20 @@ namespace pcl
       void
       setInputNormals (const NormalPtr& norm);
 
+      /** \brief Returns the number of threads used for the segmentation. */
+      unsigned int
+      getNumberOfThreads () const;
+
+      /** \brief Allows to set the number of threads used for the segmentation. With more than one thread the
+        * neighbours are searched in parallel, and in smooth mode the regions are grown by linking all pairs of
+        * neighbours that pass the tests in both directions, in parallel, instead of flooding them one by one from
+        * the seeds. The regions can then differ from the serial ones where two regions touch, because the serial
+        * result depends on which region reaches a point first.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief This method launches the segmentation algorithm and returns the clusters that were
         * obtained during the segmentation.
         * \param[out] clusters clusters that were obtained. Each cluster is an array of point indices.
@@ -253,6 +267,14 @@ namespace pcl
       void
       applySmoothRegionGrowingAlgorithm ();
 
+      /** \brief Parallel version of applySmoothRegionGrowingAlgorithm (), used when more than one thread is set and
+        * the tests do not depend on the initial seed. All neighbours that can grow into each other are linked into
+        * regions with a concurrent union-find, the remaining points are then given to the first neighbouring region
+        * which accepts them, and the points which are still left over are grown serially as before.
+        */
+      void
+      applyParallelRegionGrowingAlgorithm ();
+
       /** \brief This method grows a segment for the given seed point. And returns the number of its points.
         * \param[in] initial_seed index of the point that will serve as the seed point
         * \param[in] segment_number indicates which number this segment will have
@@ -331,6 +353,9 @@ namespace pcl
       /** \brief Stores the number of segments. */
       int number_of_segments_;
 
+      /** \brief The number of threads used for the segmentation. */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
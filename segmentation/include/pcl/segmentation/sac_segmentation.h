@@ -98,6 +98,9 @@ namespace pcl
         , threads_ (-1)
         , probability_ (0.99)
         , random_ (random)
+        , max_models_ (10)
+        , min_inliers_ (0)
+        , joint_refinement_ (false)
       {
       }
 
@@ -250,6 +253,50 @@ namespace pcl
       virtual void 
       segment (PointIndices &inliers, ModelCoefficients &model_coefficients);
 
+      /** \brief Set the maximum number of models to extract with the multi-model segment method.
+        * \param[in] max_models the maximum number of models (10 by default)
+        */
+      inline void
+      setMaxModels (unsigned int max_models) { max_models_ = max_models; }
+
+      /** \brief Get the maximum number of models to extract with the multi-model segment method. */
+      inline unsigned int
+      getMaxModels () const { return (max_models_); }
+
+      /** \brief Set the minimum number of inliers a model needs to be extracted by the multi-model segment method.
+        * \param[in] min_inliers the minimum number of inliers per model (0 by default)
+        */
+      inline void
+      setMinInliers (unsigned int min_inliers) { min_inliers_ = min_inliers; }
+
+      /** \brief Get the minimum number of inliers a model needs to be extracted by the multi-model segment method. */
+      inline unsigned int
+      getMinInliers () const { return (min_inliers_); }
+
+      /** \brief Set whether the models extracted by the multi-model segment method are refined jointly.
+        * A model extracted early also takes the points it shares with later models (e.g. near the intersection of
+        * two planes). If enabled, all inliers are assigned to the model they are closest to, and the models are
+        * fitted to their points again, until the assignment does not change anymore.
+        * \param[in] joint_refinement true to enable the joint refinement, false otherwise (default)
+        */
+      inline void
+      setJointRefinement (bool joint_refinement) { joint_refinement_ = joint_refinement; }
+
+      /** \brief Get whether the models extracted by the multi-model segment method are refined jointly. */
+      inline bool
+      getJointRefinement () const { return (joint_refinement_); }
+
+      /** \brief Segment several models one after another in a PointCloud given by <setInputCloud (), setIndices ()>.
+        * Each model is searched for among the points that are not inliers of a previous model, until
+        * getMaxModels () models are found, no model with at least getMinInliers () inliers can be found, or too few
+        * points are left. The SAC model and method are set up only once, and work on the shrinking set of
+        * indices directly, so the cloud (and the normals) are not copied between the models.
+        * \param[out] inliers the point indices that support each model found (inliers)
+        * \param[out] model_coefficients the coefficients of each model found
+        */
+      void
+      segment (std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients);
+
     protected:
       /** \brief Initialize the Sample Consensus model and set its parameters.
         * \param[in] model_type the type of SAC model that is to be used
@@ -263,6 +310,14 @@ namespace pcl
       virtual void 
       initSAC (const int method_type);
 
+      /** \brief Assign the inliers of all models to the model they are closest to, and fit the models to their
+        * points again, until the assignment does not change anymore.
+        * \param[in,out] inliers the point indices that support each model
+        * \param[in,out] model_coefficients the coefficients of each model
+        */
+      void
+      refineModelsJointly (std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients);
+
       /** \brief The model that needs to be segmented. */
       SampleConsensusModelPtr model_;
 
@@ -308,6 +363,15 @@ namespace pcl
       /** \brief Set to true if we need a random seed. */
       bool random_;
 
+      /** \brief The maximum number of models to extract with the multi-model segment method. */
+      unsigned int max_models_;
+
+      /** \brief The minimum number of inliers a model needs to be extracted by the multi-model segment method. */
+      unsigned int min_inliers_;
+
+      /** \brief Set to true if the models extracted by the multi-model segment method are refined jointly. */
+      bool joint_refinement_;
+
       /** \brief Class get name method. */
       virtual std::string 
       getClassName () const { return ("SACSegmentation"); }
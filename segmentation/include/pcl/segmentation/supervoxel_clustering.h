@@ -242,6 +242,18 @@ namespace pcl
       void
       setUseSingleCameraTransform (bool val);
 
+      /** \brief Set the number of threads used to compute the voxel data, select the seeds and expand the supervoxels
+       *  \note With more than one thread, each expansion step first lets every supervoxel compute its distance to the
+       *  voxels on its border concurrently, and then gives every voxel to the closest supervoxel (the one with the
+       *  smallest label on a tie). As in the serial expansion, a supervoxel that has lost all its voxels to supervoxels
+       *  with smaller labels in the same step does not expand. The result does not depend on the number of threads.
+       *  It can still differ from the serial expansion, where every supervoxel already sees the voxels taken over by
+       *  the ones before it, typically by a few percent of the supervoxels.
+       *  \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief This method launches the segmentation algorithm and returns the supervoxels that were
        * obtained during the segmentation.
        * \param[out] supervoxel_clusters A map of labels to pointers to supervoxel structures
@@ -334,6 +346,10 @@ namespace pcl
       void
       expandSupervoxels (int depth);
 
+      /** \brief This performs the superpixel evolution with several threads, see setNumberOfThreads () */
+      void
+      expandSupervoxelsParallel (int depth);
+
       /** \brief This sets the data of the voxels in the tree */
       void
       computeVoxelData ();
@@ -387,6 +403,9 @@ namespace pcl
       /** \brief Whether to use default transform behavior or not */
       bool use_default_transform_behaviour_;
 
+      /** \brief The number of threads used for the supervoxel clustering */
+      unsigned int threads_;
+
       /** \brief Internal storage class for supervoxels
        * \note Stores pointers to leaves of clustering internal octree,
        * \note so should not be used outside of clustering class
@@ -427,6 +446,9 @@ namespace pcl
           void
           expand ();
 
+          void
+          getExpansionCandidates (std::vector<std::pair<LeafContainerT*, float> > &candidates) const;
+
           void
           refineNormals ();
 
@@ -0,0 +1,463 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/segmentation/compact_max_flow.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+const std::size_t pcl::segmentation::CompactMaxFlow::TERMINAL_ARC = std::numeric_limits<std::size_t>::max () - 2;
+const std::size_t pcl::segmentation::CompactMaxFlow::ORPHAN_ARC = std::numeric_limits<std::size_t>::max () - 1;
+const std::size_t pcl::segmentation::CompactMaxFlow::NO_ARC = std::numeric_limits<std::size_t>::max ();
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::segmentation::CompactMaxFlow::CompactMaxFlow ()
+  : flow_ (0.0)
+  , flow_is_valid_ (false)
+  , time_ (0)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::setGraph (std::size_t number_of_nodes,
+                                             const std::vector<std::pair<index_t, index_t> > &edges)
+{
+  // Count the arcs of every node, then place them with a prefix sum
+  first_arc_.assign (number_of_nodes + 1, 0);
+  for (const auto &edge : edges)
+  {
+    assert (edge.first != edge.second);
+    ++first_arc_[edge.first + 1];
+    ++first_arc_[edge.second + 1];
+  }
+  for (std::size_t i_node = 0; i_node < number_of_nodes; ++i_node)
+    first_arc_[i_node + 1] += first_arc_[i_node];
+
+  const std::size_t number_of_arcs = 2 * edges.size ();
+  arc_head_.resize (number_of_arcs);
+  arc_sister_.resize (number_of_arcs);
+  edge_arcs_.resize (edges.size ());
+  std::vector<std::size_t> next_arc (first_arc_.begin (), first_arc_.end () - 1);
+  for (std::size_t i_edge = 0; i_edge < edges.size (); ++i_edge)
+  {
+    const index_t u = edges[i_edge].first;
+    const index_t v = edges[i_edge].second;
+    const std::size_t arc_uv = next_arc[u]++;
+    const std::size_t arc_vu = next_arc[v]++;
+    arc_head_[arc_uv] = v;
+    arc_head_[arc_vu] = u;
+    arc_sister_[arc_uv] = arc_vu;
+    arc_sister_[arc_vu] = arc_uv;
+    edge_arcs_[i_edge] = arc_uv;
+  }
+
+  arc_capacity_.assign (number_of_arcs, 0.0);
+  arc_residual_.assign (number_of_arcs, 0.0);
+  source_capacity_.assign (number_of_nodes, 0.0);
+  sink_capacity_.assign (number_of_nodes, 0.0);
+  terminal_residual_.assign (number_of_nodes, 0.0);
+  tree_.assign (number_of_nodes, FREE);
+  flow_ = 0.0;
+  flow_is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::pair<pcl::index_t, pcl::index_t>
+pcl::segmentation::CompactMaxFlow::getEdge (std::size_t edge) const
+{
+  const std::size_t arc = edge_arcs_[edge];
+  return (std::make_pair (arc_head_[arc_sister_[arc]], arc_head_[arc]));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::setEdgeCapacity (std::size_t edge, double capacity_uv, double capacity_vu)
+{
+  assert (capacity_uv >= 0.0 && capacity_vu >= 0.0);
+  const std::size_t arc = edge_arcs_[edge];
+  arc_capacity_[arc] = capacity_uv;
+  arc_capacity_[arc_sister_[arc]] = capacity_vu;
+  flow_is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::pair<double, double>
+pcl::segmentation::CompactMaxFlow::getEdgeCapacity (std::size_t edge) const
+{
+  const std::size_t arc = edge_arcs_[edge];
+  return (std::make_pair (arc_capacity_[arc], arc_capacity_[arc_sister_[arc]]));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::pair<double, double>
+pcl::segmentation::CompactMaxFlow::getEdgeResidualCapacity (std::size_t edge) const
+{
+  const std::size_t arc = edge_arcs_[edge];
+  return (std::make_pair (arc_residual_[arc], arc_residual_[arc_sister_[arc]]));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::setTerminalCapacities (index_t node, double source_capacity, double sink_capacity)
+{
+  assert (source_capacity >= 0.0 && sink_capacity >= 0.0);
+  if (flow_is_valid_)
+  {
+    // Only the difference of the two terminal capacities enters the residual graph, the rest goes
+    // straight from the source to the sink. The flow value is chosen such that it plus the cut
+    // of the residual graph still gives the cut of the new graph, whichever side the node is on.
+    const double source_change = source_capacity - source_capacity_[node];
+    const double old_residual = terminal_residual_[node];
+    double new_residual = old_residual + source_change - (sink_capacity - sink_capacity_[node]);
+    // Do not leave rounding noise behind, it would connect the node to a terminal
+    const double magnitude = std::abs (old_residual) + source_capacity_[node] + sink_capacity_[node] +
+                             source_capacity + sink_capacity;
+    if (std::abs (new_residual) <= 4.0 * std::numeric_limits<double>::epsilon () * magnitude)
+      new_residual = 0.0;
+    flow_ += std::max (old_residual, 0.0) + source_change - std::max (new_residual, 0.0);
+    terminal_residual_[node] = new_residual;
+  }
+  source_capacity_[node] = source_capacity;
+  sink_capacity_[node] = sink_capacity;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+double
+pcl::segmentation::CompactMaxFlow::solve ()
+{
+  if (!flow_is_valid_)
+    resetFlow ();
+
+  initializeTrees ();
+
+  index_t current_node = -1;
+  while (true)
+  {
+    // Keep growing from the node that found the last path, it probably finds more
+    index_t node = current_node;
+    if (node != -1)
+    {
+      active_[node] = 0;
+      if (tree_[node] == FREE)
+        node = -1;
+    }
+    if (node == -1)
+      node = nextActive ();
+    if (node == -1)
+      break;
+
+    const std::size_t arc = growTree (node);
+    if (arc == NO_ARC)
+    {
+      current_node = -1;
+      continue;
+    }
+
+    // Marking the node as active keeps it out of the queue while it is the current node
+    active_[node] = 1;
+    current_node = node;
+    ++time_;
+    augment (arc);
+    adoptOrphans ();
+  }
+
+  return (flow_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::resetFlow ()
+{
+  arc_residual_ = arc_capacity_;
+  flow_ = 0.0;
+  for (std::size_t i_node = 0; i_node < source_capacity_.size (); ++i_node)
+  {
+    terminal_residual_[i_node] = source_capacity_[i_node] - sink_capacity_[i_node];
+    flow_ += std::min (source_capacity_[i_node], sink_capacity_[i_node]);
+  }
+  flow_is_valid_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::initializeTrees ()
+{
+  const std::size_t number_of_nodes = source_capacity_.size ();
+  tree_.assign (number_of_nodes, FREE);
+  parent_.assign (number_of_nodes, NO_ARC);
+  timestamp_.assign (number_of_nodes, 0);
+  distance_.assign (number_of_nodes, 0);
+  active_.assign (number_of_nodes, 0);
+  active_nodes_.clear ();
+  orphans_.clear ();
+  time_ = 0;
+
+  for (std::size_t i_node = 0; i_node < number_of_nodes; ++i_node)
+  {
+    if (terminal_residual_[i_node] == 0.0)
+      continue;
+    const auto node = static_cast<index_t> (i_node);
+    tree_[node] = (terminal_residual_[node] > 0.0) ? SOURCE : SINK;
+    parent_[node] = TERMINAL_ARC;
+    distance_[node] = 1;
+    markActive (node);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::index_t
+pcl::segmentation::CompactMaxFlow::nextActive ()
+{
+  while (!active_nodes_.empty ())
+  {
+    const index_t node = active_nodes_.front ();
+    active_nodes_.pop_front ();
+    active_[node] = 0;
+    if (tree_[node] != FREE)
+      return (node);
+  }
+  return (-1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::segmentation::CompactMaxFlow::growTree (index_t node)
+{
+  const bool source_tree = (tree_[node] == SOURCE);
+  for (std::size_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc)
+  {
+    // The source tree grows along arcs leaving it, the sink tree along arcs entering it
+    const std::size_t sister = arc_sister_[arc];
+    if ((source_tree ? arc_residual_[arc] : arc_residual_[sister]) <= 0.0)
+      continue;
+
+    const index_t neighbour = arc_head_[arc];
+    if (tree_[neighbour] == FREE)
+    {
+      tree_[neighbour] = tree_[node];
+      parent_[neighbour] = sister;
+      timestamp_[neighbour] = timestamp_[node];
+      distance_[neighbour] = distance_[node] + 1;
+      markActive (neighbour);
+    }
+    else if (tree_[neighbour] != tree_[node])
+      return (source_tree ? arc : sister);
+    else if (timestamp_[neighbour] <= timestamp_[node] && distance_[neighbour] > distance_[node])
+    {
+      // Prefer the shorter path to the terminal
+      parent_[neighbour] = sister;
+      timestamp_[neighbour] = timestamp_[node];
+      distance_[neighbour] = distance_[node] + 1;
+    }
+  }
+  return (NO_ARC);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::augment (std::size_t arc)
+{
+  const index_t source_side = arc_head_[arc_sister_[arc]];
+  const index_t sink_side = arc_head_[arc];
+
+  // Find the bottleneck capacity
+  double bottleneck = arc_residual_[arc];
+  index_t node = source_side;
+  while (parent_[node] != TERMINAL_ARC)
+  {
+    const std::size_t parent_arc = parent_[node];
+    bottleneck = std::min (bottleneck, arc_residual_[arc_sister_[parent_arc]]);
+    node = arc_head_[parent_arc];
+  }
+  bottleneck = std::min (bottleneck, terminal_residual_[node]);
+
+  node = sink_side;
+  while (parent_[node] != TERMINAL_ARC)
+  {
+    const std::size_t parent_arc = parent_[node];
+    bottleneck = std::min (bottleneck, arc_residual_[parent_arc]);
+    node = arc_head_[parent_arc];
+  }
+  bottleneck = std::min (bottleneck, -terminal_residual_[node]);
+
+  // Push it along the path, the nodes behind saturated arcs become orphans
+  arc_residual_[arc_sister_[arc]] += bottleneck;
+  arc_residual_[arc] -= bottleneck;
+
+  node = source_side;
+  while (parent_[node] != TERMINAL_ARC)
+  {
+    const std::size_t parent_arc = parent_[node];
+    arc_residual_[parent_arc] += bottleneck;
+    arc_residual_[arc_sister_[parent_arc]] -= bottleneck;
+    if (arc_residual_[arc_sister_[parent_arc]] == 0.0)
+    {
+      parent_[node] = ORPHAN_ARC;
+      orphans_.push_front (node);
+    }
+    node = arc_head_[parent_arc];
+  }
+  terminal_residual_[node] -= bottleneck;
+  if (terminal_residual_[node] == 0.0)
+  {
+    parent_[node] = ORPHAN_ARC;
+    orphans_.push_front (node);
+  }
+
+  node = sink_side;
+  while (parent_[node] != TERMINAL_ARC)
+  {
+    const std::size_t parent_arc = parent_[node];
+    arc_residual_[arc_sister_[parent_arc]] += bottleneck;
+    arc_residual_[parent_arc] -= bottleneck;
+    if (arc_residual_[parent_arc] == 0.0)
+    {
+      parent_[node] = ORPHAN_ARC;
+      orphans_.push_front (node);
+    }
+    node = arc_head_[parent_arc];
+  }
+  terminal_residual_[node] += bottleneck;
+  if (terminal_residual_[node] == 0.0)
+  {
+    parent_[node] = ORPHAN_ARC;
+    orphans_.push_front (node);
+  }
+
+  flow_ += bottleneck;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::adoptOrphans ()
+{
+  while (!orphans_.empty ())
+  {
+    const index_t node = orphans_.front ();
+    orphans_.pop_front ();
+    processOrphan (node);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::segmentation::CompactMaxFlow::processOrphan (index_t node)
+{
+  const bool source_tree = (tree_[node] == SOURCE);
+  const int infinite_distance = std::numeric_limits<int>::max ();
+
+  // Look for the neighbour in the same tree with the shortest valid path to the terminal
+  std::size_t best_arc = NO_ARC;
+  int best_distance = infinite_distance;
+  for (std::size_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc)
+  {
+    if ((source_tree ? arc_residual_[arc_sister_[arc]] : arc_residual_[arc]) <= 0.0)
+      continue;
+    index_t neighbour = arc_head_[arc];
+    if (tree_[neighbour] != tree_[node])
+      continue;
+
+    // Walk up to the terminal, or to a node whose distance was already checked in this round
+    int distance = 0;
+    while (true)
+    {
+      if (timestamp_[neighbour] == time_)
+      {
+        distance += distance_[neighbour];
+        break;
+      }
+      const std::size_t parent_arc = parent_[neighbour];
+      ++distance;
+      if (parent_arc == TERMINAL_ARC)
+      {
+        timestamp_[neighbour] = time_;
+        distance_[neighbour] = 1;
+        break;
+      }
+      if (parent_arc == ORPHAN_ARC)
+      {
+        distance = infinite_distance;
+        break;
+      }
+      neighbour = arc_head_[parent_arc];
+    }
+    if (distance == infinite_distance)
+      continue;
+
+    if (distance < best_distance)
+    {
+      best_arc = arc;
+      best_distance = distance;
+    }
+    // Remember the distances along the path for the next orphans
+    for (neighbour = arc_head_[arc]; timestamp_[neighbour] != time_; neighbour = arc_head_[parent_[neighbour]])
+    {
+      timestamp_[neighbour] = time_;
+      distance_[neighbour] = distance--;
+    }
+  }
+
+  if (best_arc != NO_ARC)
+  {
+    parent_[node] = best_arc;
+    timestamp_[node] = time_;
+    distance_[node] = best_distance + 1;
+    return;
+  }
+
+  // No parent found: free the node, its children become orphans and the neighbours
+  // that could grow into it become active
+  for (std::size_t arc = first_arc_[node]; arc < first_arc_[node + 1]; ++arc)
+  {
+    const index_t neighbour = arc_head_[arc];
+    if (tree_[neighbour] != tree_[node])
+      continue;
+    if ((source_tree ? arc_residual_[arc_sister_[arc]] : arc_residual_[arc]) > 0.0)
+      markActive (neighbour);
+    const std::size_t parent_arc = parent_[neighbour];
+    if (parent_arc != TERMINAL_ARC && parent_arc != ORPHAN_ARC && arc_head_[parent_arc] == node)
+    {
+      parent_[neighbour] = ORPHAN_ARC;
+      orphans_.push_back (neighbour);
+    }
+  }
+  tree_[node] = FREE;
+  parent_[node] = NO_ARC;
+}
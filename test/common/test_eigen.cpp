@@ -797,6 +797,143 @@ TEST (PCL, eigen33f)
   EXPECT_LE (float(r_fail_count) / float(iterations), 0.01);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> void
+testEigen33Batch (Scalar epsilon)
+{
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  using Vector = Eigen::Matrix<Scalar, 3, 1>;
+  // an odd batch size covers both the SIMD kernels and the scalar tail
+  constexpr std::size_t size = 1003;
+
+  std::vector<Matrix, Eigen::aligned_allocator<Matrix> > matrices (size);
+  std::vector<Scalar> coefficients[6], eigen_values[3], eigen_vectors[3];
+  for (auto &c : coefficients)
+    c.resize (size);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    eigen_values[i].resize (size);
+    eigen_vectors[i].resize (size);
+  }
+
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    generateSymPosMatrix3x3 (matrices[i]);
+    coefficients[0][i] = matrices[i] (0, 0);
+    coefficients[1][i] = matrices[i] (0, 1);
+    coefficients[2][i] = matrices[i] (0, 2);
+    coefficients[3][i] = matrices[i] (1, 1);
+    coefficients[4][i] = matrices[i] (1, 2);
+    coefficients[5][i] = matrices[i] (2, 2);
+  }
+
+  const Scalar* const mat[6] = {coefficients[0].data (), coefficients[1].data (), coefficients[2].data (),
+                                coefficients[3].data (), coefficients[4].data (), coefficients[5].data ()};
+  Scalar* const evals[3] = {eigen_values[0].data (), eigen_values[1].data (), eigen_values[2].data ()};
+  Scalar* const evecs[3] = {eigen_vectors[0].data (), eigen_vectors[1].data (), eigen_vectors[2].data ()};
+
+  for (int evec_index = 0; evec_index < 3; evec_index += 2)
+  {
+    eigen33Batch (mat, size, evals, evecs, evec_index);
+
+    unsigned fail_count = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      Vector expected_values;
+      eigen33 (matrices[i], expected_values);
+      const Vector values (eigen_values[0][i], eigen_values[1][i], eigen_values[2][i]);
+      EXPECT_LE ((values - expected_values).cwiseAbs ().maxCoeff (), epsilon);
+
+      // the eigenvector is only unique (up to its sign) for a simple eigenvalue
+      const Scalar gap = std::min (std::abs (values[(evec_index + 1) % 3] - values[evec_index]),
+                                   std::abs (values[(evec_index + 2) % 3] - values[evec_index]));
+      if (gap <= epsilon)
+        continue;
+      const Vector vector (eigen_vectors[0][i], eigen_vectors[1][i], eigen_vectors[2][i]);
+      EXPECT_NEAR (vector.norm (), 1, epsilon);
+      if ((matrices[i] * vector - values[evec_index] * vector).cwiseAbs ().sum () > epsilon)
+        ++fail_count;
+    }
+    // some matrices are bad conditioned, see eigen33f: less than 1% failure rate
+    EXPECT_LE (float (fail_count) / float (size), 0.01);
+  }
+}
+
+TEST (PCL, eigen33Batchf)
+{
+  testEigen33Batch<float> (1e-3f);
+}
+
+TEST (PCL, eigen33Batchd)
+{
+  testEigen33Batch<double> (2e-5);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> void
+testEigen33BatchDegenerate (Scalar epsilon)
+{
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  using Vector = Eigen::Matrix<Scalar, 3, 1>;
+
+  // Covariance matrices of identical points (zero), of collinear points (rank 1) and of an isotropic
+  // neighborhood, where the requested eigenvalue is repeated. Enough of them to fill the SIMD kernels.
+  std::vector<Matrix, Eigen::aligned_allocator<Matrix> > matrices;
+  const Vector direction = Vector (1, 2, -0.5).normalized ();
+  for (int i = 0; i < 12; ++i)
+  {
+    matrices.push_back (Matrix::Zero ());
+    matrices.push_back (Scalar (0.01 * (i + 1)) * direction * direction.transpose ());
+    matrices.push_back (Scalar (i + 1) * Matrix::Identity ());
+  }
+  const std::size_t size = matrices.size ();
+
+  std::vector<Scalar> coefficients[6], eigen_values[3], eigen_vectors[3];
+  for (auto &c : coefficients)
+    c.resize (size);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    eigen_values[i].resize (size);
+    eigen_vectors[i].resize (size);
+  }
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    coefficients[0][i] = matrices[i] (0, 0);
+    coefficients[1][i] = matrices[i] (0, 1);
+    coefficients[2][i] = matrices[i] (0, 2);
+    coefficients[3][i] = matrices[i] (1, 1);
+    coefficients[4][i] = matrices[i] (1, 2);
+    coefficients[5][i] = matrices[i] (2, 2);
+  }
+
+  const Scalar* const mat[6] = {coefficients[0].data (), coefficients[1].data (), coefficients[2].data (),
+                                coefficients[3].data (), coefficients[4].data (), coefficients[5].data ()};
+  Scalar* const evals[3] = {eigen_values[0].data (), eigen_values[1].data (), eigen_values[2].data ()};
+  Scalar* const evecs[3] = {eigen_vectors[0].data (), eigen_vectors[1].data (), eigen_vectors[2].data ()};
+
+  for (int evec_index = 0; evec_index < 3; evec_index += 2)
+  {
+    eigen33Batch (mat, size, evals, evecs, evec_index);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const Vector vector (eigen_vectors[0][i], eigen_vectors[1][i], eigen_vectors[2][i]);
+      ASSERT_TRUE (vector.allFinite ());
+      EXPECT_NEAR (vector.norm (), 1, epsilon);
+      EXPECT_LE ((matrices[i] * vector - eigen_values[evec_index][i] * vector).cwiseAbs ().sum (), epsilon);
+    }
+  }
+}
+
+TEST (PCL, eigen33BatchDegeneratef)
+{
+  testEigen33BatchDegenerate<float> (1e-4f);
+}
+
+TEST (PCL, eigen33BatchDegenerated)
+{
+  testEigen33BatchDegenerate<double> (1e-8);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, transformLine)
 {
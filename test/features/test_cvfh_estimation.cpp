@@ -41,6 +41,9 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/cvfh.h>
+#include <pcl/features/our_cvfh.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/batch_estimation.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/filters/voxel_grid.h>
 
@@ -118,6 +121,102 @@ TEST (PCL, CVFHEstimationMilk)
   EXPECT_EQ (static_cast<int>(vfhs->size ()), 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CVFHEstimationMilkParallel)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud_milk);
+  n.setSearchMethod (tree_milk);
+  n.setRadiusSearch (leaf_size_ * 4);
+  n.compute (*normals);
+
+  CVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setInputCloud (cloud_milk);
+  cvfh.setInputNormals (normals);
+  cvfh.setSearchMethod (tree_milk);
+  cvfh.setClusterTolerance (leaf_size_ * 3);
+  cvfh.setEPSAngleThreshold (0.13f);
+  cvfh.setCurvatureThreshold (0.025f);
+  cvfh.setNormalizeBins (false);
+  cvfh.setRadiusNormals (leaf_size_ * 4);
+
+  PointCloud<VFHSignature308> vfhs_serial, vfhs_parallel;
+  cvfh.compute (vfhs_serial);
+  cvfh.setNumberOfThreads (4);
+  cvfh.compute (vfhs_parallel);
+
+  ASSERT_EQ (vfhs_serial.size (), vfhs_parallel.size ());
+  for (std::size_t i = 0; i < vfhs_serial.size (); ++i)
+    for (int d = 0; d < 308; ++d)
+      EXPECT_EQ (vfhs_serial[i].histogram[d], vfhs_parallel[i].histogram[d]);
+
+  OURCVFHEstimation<PointXYZ, Normal, VFHSignature308> ourcvfh;
+  ourcvfh.setInputCloud (cloud_milk);
+  ourcvfh.setInputNormals (normals);
+  ourcvfh.setSearchMethod (tree_milk);
+  ourcvfh.setClusterTolerance (leaf_size_ * 3);
+  ourcvfh.setEPSAngleThreshold (0.13f);
+  ourcvfh.setCurvatureThreshold (0.025f);
+  ourcvfh.setNormalizeBins (false);
+  ourcvfh.setRadiusNormals (leaf_size_ * 4);
+
+  ourcvfh.compute (vfhs_serial);
+  ourcvfh.setNumberOfThreads (4);
+  ourcvfh.compute (vfhs_parallel);
+
+  EXPECT_GE (vfhs_serial.size (), 2);
+  ASSERT_EQ (vfhs_serial.size (), vfhs_parallel.size ());
+  for (std::size_t i = 0; i < vfhs_serial.size (); ++i)
+    for (int d = 0; d < 308; ++d)
+      EXPECT_EQ (vfhs_serial[i].histogram[d], vfhs_parallel[i].histogram[d]);
+
+  // The batch API computes the same descriptors as the estimator it copies
+  ourcvfh.setSearchMethod (nullptr);
+  std::vector<PointCloud<VFHSignature308> > vfhs_batch;
+  computeFeatureBatch (ourcvfh, {cloud_milk, cloud_milk}, {normals, normals}, vfhs_batch, 2);
+  ASSERT_EQ (vfhs_batch.size (), 2);
+  for (const auto &vfhs : vfhs_batch)
+  {
+    ASSERT_EQ (vfhs_serial.size (), vfhs.size ());
+    for (std::size_t i = 0; i < vfhs_serial.size (); ++i)
+      for (int d = 0; d < 308; ++d)
+        EXPECT_EQ (vfhs_serial[i].histogram[d], vfhs[i].histogram[d]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ESFEstimationParallel)
+{
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud_milk);
+  esf.setSeed (42);
+
+  PointCloud<ESFSignature640> esf_serial, esf_parallel;
+  esf.compute (esf_serial);
+  esf.setNumberOfThreads (4);
+  esf.compute (esf_parallel);
+
+  ASSERT_EQ (esf_serial.size (), 1);
+  ASSERT_EQ (esf_parallel.size (), 1);
+  float sum = 0.0f;
+  for (int d = 0; d < 640; ++d)
+  {
+    EXPECT_EQ (esf_serial[0].histogram[d], esf_parallel[0].histogram[d]);
+    sum += esf_serial[0].histogram[d];
+  }
+  EXPECT_NEAR (sum, 1.0f, 1e-4f);
+
+  std::vector<PointCloud<ESFSignature640> > esf_batch;
+  computeFeatureBatch (esf, {cloud_milk, cloud.makeShared (), cloud_milk}, esf_batch, 3);
+  ASSERT_EQ (esf_batch.size (), 3);
+  for (int d = 0; d < 640; ++d)
+  {
+    EXPECT_EQ (esf_serial[0].histogram[d], esf_batch[0][0].histogram[d]);
+    EXPECT_EQ (esf_serial[0].histogram[d], esf_batch[2][0].histogram[d]);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
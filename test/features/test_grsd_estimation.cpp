@@ -41,9 +41,12 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/grsd.h>
+#include <pcl/features/rsd.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/io/pcd_io.h>
 
+#include <numeric>
+
 using namespace pcl;
 using namespace pcl::io;
 
@@ -90,6 +93,91 @@ TEST (PCL, GRSDEstimation)
   
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RSDEstimationParallel)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (0.02);
+  n.compute (*normals);
+
+  const double rsd_radius = 0.03;
+  RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD> rsd;
+  rsd.setInputCloud (cloud);
+  rsd.setInputNormals (normals);
+  rsd.setSearchMethod (tree);
+  rsd.setRadiusSearch (rsd_radius);
+  rsd.setSaveHistograms (true);
+
+  PointCloud<PrincipalRadiiRSD> radii_serial, radii_parallel, radii_shared;
+  rsd.compute (radii_serial);
+  const auto histograms = rsd.getHistograms ();
+  ASSERT_TRUE (histograms);
+  ASSERT_EQ (histograms->size (), cloud->size ());
+
+  // Histograms are only kept when requested
+  rsd.setSaveHistograms (false);
+  rsd.setNumberOfThreads (4);
+  rsd.compute (radii_parallel);
+  EXPECT_FALSE (rsd.getHistograms ());
+
+  // Neighborhoods shared with other features give the same result
+  pcl::Indices all_indices (cloud->size ());
+  std::iota (all_indices.begin (), all_indices.end (), 0);
+  shared_ptr<std::vector<pcl::Indices> > neighborhoods (new std::vector<pcl::Indices>);
+  shared_ptr<std::vector<std::vector<float> > > sqr_dists (new std::vector<std::vector<float> >);
+  tree->radiusSearch (*cloud, all_indices, rsd_radius, *neighborhoods, *sqr_dists);
+  rsd.setNeighborhoods (neighborhoods, sqr_dists);
+  rsd.compute (radii_shared);
+
+  ASSERT_EQ (radii_serial.size (), cloud->size ());
+  ASSERT_EQ (radii_parallel.size (), cloud->size ());
+  ASSERT_EQ (radii_shared.size (), cloud->size ());
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    EXPECT_LE (radii_serial[i].r_min, radii_serial[i].r_max);
+    EXPECT_EQ (radii_serial[i].r_min, radii_parallel[i].r_min);
+    EXPECT_EQ (radii_serial[i].r_max, radii_parallel[i].r_max);
+    EXPECT_EQ (radii_serial[i].r_min, radii_shared[i].r_min);
+    EXPECT_EQ (radii_serial[i].r_max, radii_shared[i].r_max);
+    EXPECT_EQ (static_cast<std::size_t> ((*histograms)[i].sum ()) + 1, (*neighborhoods)[i].size ());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RSDEstimationNaNNormal)
+{
+  // A reference normal and two tilted neighbors in different distance bins
+  PointCloud<Normal> normals;
+  normals.push_back (Normal (0.0f, 0.0f, 1.0f));
+  normals.push_back (Normal (0.0f, std::sin (0.2f), std::cos (0.2f)));
+  normals.push_back (Normal (std::sin (0.5f), 0.0f, std::cos (0.5f)));
+  pcl::Indices indices {0, 1, 2};
+  std::vector<float> sqr_dists {0.0f, 0.012f * 0.012f, 0.032f * 0.032f};
+
+  const double max_dist = 0.05, plane_radius = 0.2;
+  const int nr_subdiv = 5;
+  PrincipalRadiiRSD radii;
+  const Eigen::MatrixXf histogram = computeRSD (normals, indices, sqr_dists, max_dist, nr_subdiv, plane_radius, radii, true);
+  EXPECT_EQ (2, histogram.sum ());
+
+  // A neighbor without a valid normal in an already filled bin must not change the result
+  const float nan = std::numeric_limits<float>::quiet_NaN ();
+  normals.push_back (Normal (nan, nan, nan));
+  indices.push_back (3);
+  sqr_dists.push_back (0.031f * 0.031f);
+
+  PrincipalRadiiRSD radii_nan;
+  const Eigen::MatrixXf histogram_nan = computeRSD (normals, indices, sqr_dists, max_dist, nr_subdiv, plane_radius, radii_nan, true);
+  EXPECT_TRUE (std::isfinite (radii_nan.r_min));
+  EXPECT_TRUE (std::isfinite (radii_nan.r_max));
+  EXPECT_EQ (radii.r_min, radii_nan.r_min);
+  EXPECT_EQ (radii.r_max, radii_nan.r_max);
+  EXPECT_EQ (histogram, histogram_nan);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
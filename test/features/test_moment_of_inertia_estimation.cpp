@@ -76,6 +76,63 @@ TEST (MomentOfInertia, FeatureExtraction)
   EXPECT_NE (0, m_size);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (MomentOfInertia, ParallelAndBoundingBoxOnly)
+{
+  pcl::MomentOfInertiaEstimation <pcl::PointXYZ> feature_extractor;
+  feature_extractor.setInputCloud (cloud);
+  feature_extractor.compute ();
+
+  std::vector <float> moment_of_inertia;
+  feature_extractor.getMomentOfInertia (moment_of_inertia);
+  ASSERT_FALSE (moment_of_inertia.empty ());
+
+  // The first axis of the sweep is the major axis, compare against the definition
+  Eigen::Vector3f mass_center, major_vec, middle_vec, minor_vec;
+  feature_extractor.getMassCenter (mass_center);
+  feature_extractor.getEigenVectors (major_vec, middle_vec, minor_vec);
+  double expected_moment = 0.0;
+  for (const auto& point : *cloud)
+    expected_moment += (mass_center - point.getVector3fMap ()).cross (major_vec).squaredNorm ();
+  expected_moment /= static_cast <double> (cloud->size ()) * static_cast <double> (cloud->size ());
+  EXPECT_NEAR (expected_moment, moment_of_inertia[0], 1e-4 * expected_moment);
+
+  pcl::PointXYZ min_point, max_point, position;
+  Eigen::Matrix3f rotational_matrix;
+  feature_extractor.getOBB (min_point, max_point, position, rotational_matrix);
+
+  pcl::MomentOfInertiaEstimation <pcl::PointXYZ> parallel_extractor;
+  parallel_extractor.setInputCloud (cloud);
+  parallel_extractor.setNumberOfThreads (4);
+  parallel_extractor.compute ();
+
+  std::vector <float> parallel_moment_of_inertia;
+  parallel_extractor.getMomentOfInertia (parallel_moment_of_inertia);
+  ASSERT_EQ (moment_of_inertia.size (), parallel_moment_of_inertia.size ());
+  for (std::size_t i = 0; i < moment_of_inertia.size (); i++)
+    EXPECT_EQ (moment_of_inertia[i], parallel_moment_of_inertia[i]);
+
+  parallel_extractor.setBoundingBoxOnlyFlag (true);
+  parallel_extractor.compute ();
+  std::vector <float> eccentricity;
+  parallel_extractor.getMomentOfInertia (parallel_moment_of_inertia);
+  parallel_extractor.getEccentricity (eccentricity);
+  EXPECT_TRUE (parallel_moment_of_inertia.empty ());
+  EXPECT_TRUE (eccentricity.empty ());
+
+  pcl::PointXYZ parallel_min_point, parallel_max_point, parallel_position;
+  Eigen::Matrix3f parallel_rotational_matrix;
+  EXPECT_TRUE (parallel_extractor.getOBB (parallel_min_point, parallel_max_point, parallel_position, parallel_rotational_matrix));
+  EXPECT_EQ (min_point.x, parallel_min_point.x);
+  EXPECT_EQ (min_point.y, parallel_min_point.y);
+  EXPECT_EQ (min_point.z, parallel_min_point.z);
+  EXPECT_EQ (max_point.x, parallel_max_point.x);
+  EXPECT_EQ (max_point.y, parallel_max_point.y);
+  EXPECT_EQ (max_point.z, parallel_max_point.z);
+  EXPECT_EQ (position.getVector3fMap (), parallel_position.getVector3fMap ());
+  EXPECT_EQ (rotational_matrix, parallel_rotational_matrix);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (MomentOfInertia, InvalidParameters)
 {
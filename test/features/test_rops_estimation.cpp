@@ -73,6 +73,38 @@ TEST (ROPSFeature, FeatureExtraction)
   EXPECT_NE (0, histograms->size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ROPSFeature, FeatureExtractionParallel)
+{
+  float support_radius = 0.0285f;
+
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr search_method (new pcl::search::KdTree<pcl::PointXYZ>);
+  search_method->setInputCloud (cloud);
+
+  pcl::ROPSEstimation <pcl::PointXYZ, pcl::Histogram <135> > feature_estimator;
+  feature_estimator.setSearchMethod (search_method);
+  feature_estimator.setSearchSurface (cloud);
+  feature_estimator.setInputCloud (cloud);
+  feature_estimator.setIndices (indices);
+  feature_estimator.setTriangles (triangles);
+  feature_estimator.setRadiusSearch (support_radius);
+  feature_estimator.setNumberOfPartitionBins (5);
+  feature_estimator.setNumberOfRotations (3);
+  feature_estimator.setSupportRadius (support_radius);
+
+  pcl::PointCloud<pcl::Histogram <135> > histograms, histograms_parallel;
+  feature_estimator.compute (histograms);
+  // The second run reuses the triangle lists built by the first one
+  feature_estimator.setNumberOfThreads (4);
+  feature_estimator.compute (histograms_parallel);
+
+  ASSERT_EQ (indices->indices.size (), histograms.size ());
+  ASSERT_EQ (histograms.size (), histograms_parallel.size ());
+  for (std::size_t i = 0; i < histograms.size (); ++i)
+    for (int j = 0; j < 135; ++j)
+      EXPECT_EQ (histograms[i].histogram[j], histograms_parallel[i].histogram[j]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ROPSFeature, InvalidParameters)
 {
@@ -231,6 +231,40 @@ TEST (PCL, SpinImageEstimation)
   EXPECT_NEAR ((*spin_images)[300].histogram[144], 0.272542, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SpinImageEstimationParallel)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (0.04);
+  n.compute (*normals);
+
+  using SpinImage = Histogram<153>;
+  SpinImageEstimation<PointXYZ, Normal, SpinImage> spin_est (8, 0.5, 16);
+  spin_est.setInputCloud (cloud.makeShared ());
+  spin_est.setInputNormals (normals);
+  spin_est.setSearchMethod (tree);
+  spin_est.setRadiusSearch (0.08);
+  spin_est.setRadialStructure ();
+
+  PointCloud<SpinImage> spin_images, spin_images_parallel;
+  spin_est.compute (spin_images);
+  spin_est.setNumberOfThreads (4);
+  spin_est.compute (spin_images_parallel);
+
+  ASSERT_EQ (spin_images.size (), cloud.size ());
+  ASSERT_EQ (spin_images_parallel.size (), spin_images.size ());
+  for (std::size_t i = 0; i < spin_images.size (); ++i)
+    for (int j = 0; j < 153; ++j)
+      EXPECT_EQ (spin_images[i].histogram[j], spin_images_parallel[i].histogram[j]);
+
+  // Errors raised by single points are still reported to the caller
+  spin_est.setMinPointCountInNeighbourhood (static_cast<unsigned int> (cloud.size ()) + 1);
+  EXPECT_THROW (spin_est.compute (spin_images_parallel), PCLException);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IntensitySpinEstimation)
 {
@@ -119,6 +119,71 @@ TEST (CorrespondenceEstimation, CorrespondenceEstimationSetSearchMethod)
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+TEST (CorrespondenceEstimation, CorrespondenceEstimationParallel)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud1 (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud2 (new pcl::PointCloud<pcl::PointXYZ> ());
+  srand (42);
+  for (std::size_t i = 0; i < 1000; i++)
+  {
+    cloud1->points.emplace_back (float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX);
+    cloud2->points.emplace_back (float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX);
+  }
+
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud (cloud1);
+  ne.setKSearch (10);
+  pcl::PointCloud<pcl::Normal>::Ptr cloud1_normals (new pcl::PointCloud<pcl::Normal>);
+  ne.compute (*cloud1_normals);
+
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> ce;
+  pcl::registration::CorrespondenceEstimationNormalShooting<pcl::PointXYZ, pcl::PointXYZ, pcl::Normal> ce_ns;
+  ce_ns.setSourceNormals (cloud1_normals);
+  ce_ns.setKSearch (10);
+
+  const auto expect_equal = [] (const pcl::Correspondences& a, const pcl::Correspondences& b)
+  {
+    ASSERT_EQ (a.size (), b.size ());
+    for (std::size_t i = 0; i < a.size (); i++)
+    {
+      EXPECT_EQ (a[i].index_query, b[i].index_query);
+      EXPECT_EQ (a[i].index_match, b[i].index_match);
+      EXPECT_EQ (a[i].distance, b[i].distance);
+    }
+  };
+
+  using CorrespondenceEstimationBase = pcl::registration::CorrespondenceEstimationBase<pcl::PointXYZ, pcl::PointXYZ>;
+  // Normal shooting compares the squared distance to the normal line against the threshold
+  const std::vector<std::pair<CorrespondenceEstimationBase*, double> > estimators = {{&ce, 0.05}, {&ce_ns, 0.0005}};
+  for (const auto& estimator_and_distance : estimators)
+  {
+    CorrespondenceEstimationBase* estimator = estimator_and_distance.first;
+    const double max_distance = estimator_and_distance.second;
+    estimator->setInputSource (cloud1);
+    estimator->setInputTarget (cloud2);
+
+    pcl::Correspondences corr_serial, corr_parallel, reciprocal_serial, reciprocal_parallel;
+    estimator->setNumberOfThreads (1);
+    estimator->determineCorrespondences (corr_serial, max_distance);
+    estimator->determineReciprocalCorrespondences (reciprocal_serial);
+    estimator->setNumberOfThreads (4);
+    EXPECT_EQ (4, estimator->getNumberOfThreads ());
+    estimator->determineCorrespondences (corr_parallel, max_distance);
+    estimator->determineReciprocalCorrespondences (reciprocal_parallel);
+
+    EXPECT_LT (0, corr_serial.size ());
+    EXPECT_GT (cloud1->size (), corr_serial.size ());
+    EXPECT_LT (0, reciprocal_serial.size ());
+    expect_equal (corr_serial, corr_parallel);
+    expect_equal (reciprocal_serial, reciprocal_parallel);
+
+    // The correspondences are sorted by source index
+    for (std::size_t i = 1; i < corr_parallel.size (); i++)
+      EXPECT_LT (corr_parallel[i - 1].index_query, corr_parallel[i].index_query);
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
@@ -86,6 +86,58 @@ TEST (PCL, FPCSInitialAlignment)
   //    EXPECT_NEAR (transform_res_from_fpcs (i,j), transform_from_fpcs[i][j], 0.5);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+class FPCSPairSearch : public FPCSInitialAlignment <PointT, PointT>
+{
+  public:
+    using FPCSInitialAlignment <PointT, PointT>::initCompute;
+    using FPCSInitialAlignment <PointT, PointT>::bruteForceCorrespondences;
+};
+
+TEST (PCL, FPCSInitialAlignmentPairSearch)
+{
+  PointCloud<PointXYZ>::Ptr cloud_ptr = cloud_source.makeShared ();
+
+  // the pair index has to find exactly the pairs of an exhaustive search
+  const float pair_delta = 0.002f;
+  FPCSPairSearch<PointXYZ> fpcs_ia;
+  fpcs_ia.setInputSource (cloud_ptr);
+  fpcs_ia.setInputTarget (cloud_ptr);
+  fpcs_ia.setDelta (pair_delta, false);
+  ASSERT_TRUE (fpcs_ia.initCompute ());
+
+  const float max_pair_diff = 2.f * pair_delta;
+  const int nr_points = static_cast<int> (cloud_ptr->size ());
+  for (int k = 0; k < 5; ++k)
+  {
+    const int idx1 = (k * 37) % nr_points;
+    const int idx2 = (k * 101 + 13) % nr_points;
+    Correspondences pairs;
+    fpcs_ia.bruteForceCorrespondences (idx1, idx2, pairs);
+
+    const float ref_dist = euclideanDistance ((*cloud_ptr)[idx1], (*cloud_ptr)[idx2]);
+    Correspondences pairs_ref;
+    for (int i = 0; i < nr_points - 1; ++i)
+      for (int j = i + 1; j < nr_points; ++j)
+      {
+        const float dist = euclideanDistance ((*cloud_ptr)[i], (*cloud_ptr)[j]);
+        if (std::abs (dist - ref_dist) < max_pair_diff)
+        {
+          pairs_ref.push_back (Correspondence (j, i, dist));
+          pairs_ref.push_back (Correspondence (i, j, dist));
+        }
+      }
+
+    EXPECT_FALSE (pairs_ref.empty ());
+    ASSERT_EQ (pairs.size (), pairs_ref.size ());
+    for (std::size_t i = 0; i < pairs.size (); ++i)
+    {
+      EXPECT_EQ (pairs[i].index_query, pairs_ref[i].index_query);
+      EXPECT_EQ (pairs[i].index_match, pairs_ref[i].index_match);
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
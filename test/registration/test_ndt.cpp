@@ -43,6 +43,9 @@
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/registration/ndt.h>
+#include <pcl/registration/ndt_multi_resolution.h>
+
+#include <sstream>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -94,6 +97,106 @@ TEST (PCL, NormalDistributionsTransform)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformNeighborSearchAndThreads)
+{
+  using PointT = PointNormal;
+  using NDT = NormalDistributionsTransform<PointT, PointT>;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+
+  for (const auto method : {NDT::NeighborSearchMethod::KDTREE, NDT::NeighborSearchMethod::DIRECT26,
+                            NDT::NeighborSearchMethod::DIRECT7, NDT::NeighborSearchMethod::DIRECT1})
+  {
+    PointCloud<PointT> output_serial, output_parallel;
+
+    NDT reg;
+    reg.setStepSize (0.05);
+    reg.setResolution (0.025f);
+    reg.setInputSource (src);
+    reg.setInputTarget (tgt);
+    reg.setMaximumIterations (50);
+    reg.setTransformationEpsilon (1e-8);
+    reg.setNeighborSearchMethod (method);
+    EXPECT_EQ (reg.getNeighborSearchMethod (), method);
+    reg.align (output_serial);
+    EXPECT_EQ (output_serial.size (), cloud_source.size ());
+    EXPECT_LT (reg.getFitnessScore (), 0.001);
+    const Eigen::Matrix4f serial_transformation = reg.getFinalTransformation ();
+    const int serial_iterations = reg.getFinalNumIteration ();
+
+    // The result does not depend on the number of threads
+    reg.setNumberOfThreads (4);
+    EXPECT_EQ (reg.getNumberOfThreads (), 4u);
+    reg.align (output_parallel);
+    EXPECT_EQ (reg.getFinalNumIteration (), serial_iterations);
+    EXPECT_EQ (reg.getFinalTransformation (), serial_transformation);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformMultiResolution)
+{
+  using PointT = PointNormal;
+  using NDT = NormalDistributionsTransformMultiResolution<PointT, PointT>;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  NDT reg;
+  reg.setStepSize (0.05);
+  reg.setResolutions ({0.1f, 0.05f, 0.025f});
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  // The pyramid is only built when it is needed
+  EXPECT_EQ (reg.getTargetPyramid (), nullptr);
+  reg.align (output);
+  EXPECT_EQ (output.size (), cloud_source.size ());
+  EXPECT_LT (reg.getFitnessScore (), 0.001);
+  const NDT::TargetPyramidConstPtr built_pyramid = reg.getTargetPyramid ();
+  ASSERT_NE (built_pyramid, nullptr);
+  EXPECT_EQ (built_pyramid->size (), 3u);
+  // and is reused for the next source
+  reg.align (output);
+  EXPECT_EQ (reg.getTargetPyramid (), built_pyramid);
+
+  // A pyramid restored from a stream gives the same result as the one it was written from
+  std::stringstream stream;
+  reg.getTargetPyramid ()->serialize (stream);
+  NDT::TargetPyramidPtr pyramid (new NDT::TargetPyramid);
+  ASSERT_TRUE (pyramid->deserialize (stream));
+  EXPECT_EQ (pyramid->getResolutions (), reg.getResolutions ());
+
+  // The given pyramid is used as is, whether it is set before or after the target
+  for (const bool pyramid_first : {true, false})
+  {
+    NDT reg_restored;
+    reg_restored.setStepSize (0.05);
+    reg_restored.setInputSource (src);
+    if (pyramid_first)
+      reg_restored.setTargetPyramid (pyramid);
+    reg_restored.setInputTarget (tgt);
+    if (!pyramid_first)
+      reg_restored.setTargetPyramid (pyramid);
+    reg_restored.setMaximumIterations (50);
+    reg_restored.setTransformationEpsilon (1e-8);
+    reg_restored.align (output);
+    EXPECT_EQ (reg_restored.getTargetPyramid (), pyramid);
+    EXPECT_EQ (reg_restored.getFinalNumIteration (), reg.getFinalNumIteration ());
+    EXPECT_EQ (reg_restored.getFinalTransformation (), reg.getFinalTransformation ());
+  }
+
+  // A truncated stream is rejected
+  std::stringstream truncated (stream.str ().substr (0, stream.str ().size () / 2));
+  EXPECT_FALSE (NDT::TargetPyramid ().deserialize (truncated));
+}
+
 int
 main (int argc, char** argv)
 {
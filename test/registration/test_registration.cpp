@@ -48,6 +48,7 @@
 #include <pcl/registration/icp_nl.h>
 #include <pcl/registration/gicp.h>
 #include <pcl/registration/gicp6d.h>
+#include <pcl/registration/target_model.h>
 #include <pcl/registration/transformation_estimation_point_to_plane.h>
 #include <pcl/registration/transformation_validation_euclidean.h>
 #include <pcl/registration/correspondence_rejection_median_distance.h>
@@ -57,6 +58,7 @@
 #include <pcl/registration/pyramid_feature_matching.h>
 #include <pcl/features/ppf.h>
 #include <pcl/registration/ppf_registration.h>
+#include <pcl/registration/lum.h>
 #include <pcl/filters/voxel_grid.h>
 // We need Histogram<2> to function, so we'll explicitly add kdtree_flann.hpp here
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
@@ -585,6 +587,164 @@ TEST (PCL, GeneralizedIterativeClosestPoint)
   EXPECT_LT (reg.getFitnessScore (), 0.0001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointParallel)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output_serial, output_parallel, output_cached;
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_serial;
+  reg_serial.setInputSource (src);
+  reg_serial.setInputTarget (tgt);
+  reg_serial.setMaximumIterations (50);
+  reg_serial.setTransformationEpsilon (1e-8);
+  reg_serial.align (output_serial);
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_parallel;
+  reg_parallel.setNumberOfThreads (4);
+  EXPECT_EQ (reg_parallel.getNumberOfThreads (), 4u);
+  reg_parallel.setInputSource (src);
+  reg_parallel.setInputTarget (tgt);
+  reg_parallel.setMaximumIterations (50);
+  reg_parallel.setTransformationEpsilon (1e-8);
+  reg_parallel.align (output_parallel);
+
+  // The result does not depend on the number of threads
+  EXPECT_EQ (reg_parallel.getFinalTransformation (), reg_serial.getFinalTransformation ());
+
+  // Reusing the covariances computed by another registration object
+  ASSERT_NE (reg_serial.getSourceCovariances (), nullptr);
+  ASSERT_NE (reg_serial.getTargetCovariances (), nullptr);
+  EXPECT_EQ (reg_serial.getSourceCovariances ()->size (), src->size ());
+  EXPECT_EQ (reg_serial.getTargetCovariances ()->size (), tgt->size ());
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_cached;
+  reg_cached.setInputSource (src);
+  reg_cached.setSourceCovariances (reg_serial.getSourceCovariances ());
+  reg_cached.setInputTarget (tgt);
+  reg_cached.setTargetCovariances (reg_serial.getTargetCovariances ());
+  reg_cached.setMaximumIterations (50);
+  reg_cached.setTransformationEpsilon (1e-8);
+  reg_cached.align (output_cached);
+  EXPECT_EQ (reg_cached.getFinalTransformation (), reg_serial.getFinalTransformation ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointDegenerateCovariances)
+{
+  using PointT = PointXYZ;
+  // A cluster of identical points and, far away from it, a line of collinear points: their neighborhoods
+  // have zero and rank 1 covariance matrices
+  PointCloud<PointT>::Ptr cloud (new PointCloud<PointT>);
+  for (int i = 0; i < 40; ++i)
+    cloud->push_back (PointT (1.0f, 2.0f, 3.0f));
+  for (int i = 0; i < 40; ++i)
+    cloud->push_back (PointT (10.0f + 0.01f * i, 10.0f - 0.02f * i, 10.0f + 0.005f * i));
+
+  pcl::search::KdTree<PointT>::Ptr tree (new pcl::search::KdTree<PointT>);
+  tree->setInputCloud (cloud);
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg;
+  GeneralizedIterativeClosestPoint<PointT, PointT>::MatricesVector covariances;
+  reg.computeCovariances<PointT> (cloud, tree, covariances);
+  ASSERT_EQ (cloud->size (), covariances.size ());
+
+  // Every covariance must be I - (1 - epsilon) * v * v' for a unit vector v
+  for (const auto& covariance : covariances)
+  {
+    ASSERT_TRUE (covariance.allFinite ());
+    EXPECT_TRUE (covariance.isApprox (covariance.transpose ()));
+    const double epsilon = covariance.trace () - 2.0;
+    EXPECT_GT (epsilon, 0.0);
+    EXPECT_LT (epsilon, 1.0);
+    const Eigen::Matrix3d projection = (Eigen::Matrix3d::Identity () - covariance) / (1.0 - epsilon);
+    EXPECT_NEAR (projection.trace (), 1.0, 1e-6);
+    EXPECT_LT ((projection * projection - projection).cwiseAbs ().maxCoeff (), 1e-6);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TargetModel)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  registration::TargetModel<PointT> model (tgt);
+  EXPECT_EQ (model.getTarget (), tgt);
+  ASSERT_NE (model.getSearchMethodTarget (), nullptr);
+  EXPECT_EQ (model.getSearchMethodTarget ()->getInputCloud (), tgt);
+
+  IterativeClosestPoint<PointT, PointT> icp;
+  icp.setInputSource (src);
+  icp.setInputTarget (tgt);
+  icp.setMaximumIterations (50);
+  icp.setTransformationEpsilon (1e-8);
+  icp.align (output);
+
+  // Several registration objects share the model, and align in parallel
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transformations (4);
+#pragma omp parallel for num_threads(4)
+  for (int i = 0; i < 4; ++i)
+  {
+    PointCloud<PointT> output_model;
+    IterativeClosestPoint<PointT, PointT> icp_model;
+    model.apply (icp_model);
+    icp_model.setInputSource (src);
+    icp_model.setMaximumIterations (50);
+    icp_model.setTransformationEpsilon (1e-8);
+    icp_model.align (output_model);
+    transformations[i] = icp_model.getFinalTransformation ();
+  }
+  for (const auto& transformation : transformations)
+    EXPECT_EQ (transformation, icp.getFinalTransformation ());
+  // The shared tree is never rebuilt on another cloud
+  EXPECT_EQ (model.getSearchMethodTarget ()->getInputCloud (), tgt);
+
+  // Covariances computed once for the target
+  EXPECT_EQ (model.getCovariances (), nullptr);
+  model.computeCovariances ();
+  ASSERT_NE (model.getCovariances (), nullptr);
+  EXPECT_EQ (model.getCovariances ()->size (), tgt->size ());
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> gicp;
+  gicp.setInputSource (src);
+  gicp.setInputTarget (tgt);
+  gicp.setMaximumIterations (50);
+  gicp.setTransformationEpsilon (1e-8);
+  gicp.align (output);
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> gicp_model;
+  model.apply (gicp_model);
+  EXPECT_EQ (gicp_model.getTargetCovariances (), model.getCovariances ());
+  gicp_model.setInputSource (src);
+  gicp_model.setMaximumIterations (50);
+  gicp_model.setTransformationEpsilon (1e-8);
+  gicp_model.align (output);
+  EXPECT_EQ (gicp_model.getFinalTransformation (), gicp.getFinalTransformation ());
+
+  // Normals of the target, for point to plane registration
+  PointCloud<PointNormal>::Ptr tgt_normals (new PointCloud<PointNormal>);
+  copyPointCloud (cloud_target, *tgt_normals);
+  registration::TargetModel<PointNormal> model_normals (tgt_normals);
+  model_normals.computeNormals (10);
+  ASSERT_EQ (model_normals.getTarget ()->size (), tgt_normals->size ());
+  EXPECT_NE (model_normals.getTarget (), tgt_normals);
+  EXPECT_EQ (model_normals.getSearchMethodTarget ()->getInputCloud (), model_normals.getTarget ());
+  for (std::size_t i = 0; i < tgt_normals->size (); ++i)
+  {
+    const PointNormal& point = (*model_normals.getTarget ())[i];
+    EXPECT_EQ (point.getVector3fMap (), (*tgt_normals)[i].getVector3fMap ());
+    EXPECT_NEAR (point.getNormalVector3fMap ().norm (), 1.0f, 1e-4);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeneralizedIterativeClosestPoint6D)
 {
@@ -805,6 +965,135 @@ TEST (PCL, PPFRegistration)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PPFRegistrationParallel)
+{
+  // Rotate and translate the source cloud by a small amount
+  Eigen::Vector3f initial_offset (0.1f, 0.0f, 0.0f);
+  float angle = static_cast<float> (M_PI) / 6.0f;
+  Eigen::Quaternionf initial_rotation (std::cos (angle / 2), 0, 0, std::sin (angle / 2));
+  PointCloud<PointXYZ>::Ptr cloud_source_transformed_ptr (new PointCloud<PointXYZ>);
+  transformPointCloud (cloud_source, *cloud_source_transformed_ptr, initial_offset, initial_rotation);
+  PointCloud<PointXYZ>::Ptr cloud_target_ptr = cloud_target.makeShared ();
+
+  // Estimate normals for both clouds
+  NormalEstimation<PointXYZ, Normal> normal_estimation;
+  search::KdTree<PointXYZ>::Ptr search_tree (new search::KdTree<PointXYZ> ());
+  normal_estimation.setSearchMethod (search_tree);
+  normal_estimation.setRadiusSearch (0.03);
+  PointCloud<Normal>::Ptr normals_target (new PointCloud<Normal> ()),
+      normals_source_transformed (new PointCloud<Normal> ());
+  normal_estimation.setInputCloud (cloud_target_ptr);
+  normal_estimation.compute (*normals_target);
+  normal_estimation.setInputCloud (cloud_source_transformed_ptr);
+  normal_estimation.compute (*normals_source_transformed);
+
+  PointCloud<PointNormal>::Ptr cloud_target_with_normals (new PointCloud<PointNormal> ()),
+      cloud_source_transformed_with_normals (new PointCloud<PointNormal> ());
+  concatenateFields (*cloud_target_ptr, *normals_target, *cloud_target_with_normals);
+  concatenateFields (*cloud_source_transformed_ptr, *normals_source_transformed, *cloud_source_transformed_with_normals);
+
+  // Compute PPFSignature feature clouds for source cloud
+  PPFEstimation<PointXYZ, Normal, PPFSignature> ppf_estimator;
+  PointCloud<PPFSignature>::Ptr features_source_transformed (new PointCloud<PPFSignature> ());
+  ppf_estimator.setInputCloud (cloud_source_transformed_ptr);
+  ppf_estimator.setInputNormals (normals_source_transformed);
+  ppf_estimator.compute (*features_source_transformed);
+
+  // Every pair of the model is found in the bin of its own feature
+  PPFHashMapSearch::Ptr hash_map_search (new PPFHashMapSearch (12.0f / 180.0f * static_cast<float> (M_PI), 0.005f));
+  hash_map_search->setInputFeatureCloud (features_source_transformed);
+  const std::size_t n = cloud_source_transformed_ptr->size ();
+  for (std::size_t i = 0; i < n; i += 7)
+    for (std::size_t j = 0; j < n; j += 11)
+    {
+      PPFSignature feature = (*features_source_transformed)[i * n + j];
+      std::vector<std::pair<std::size_t, std::size_t> > indices;
+      hash_map_search->nearestNeighborSearch (feature.f1, feature.f2, feature.f3, feature.f4, indices);
+      EXPECT_NE (std::find (indices.begin (), indices.end (), std::make_pair (i, j)), indices.end ());
+      const auto pairs = hash_map_search->getPairsInBin (feature.f1, feature.f2, feature.f3, feature.f4);
+      EXPECT_TRUE (std::equal (indices.begin (), indices.end (), pairs.first, pairs.second));
+    }
+
+  // The result does not depend on the number of threads
+  Eigen::Matrix4f transformation_serial;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    PPFRegistration<PointNormal, PointNormal> ppf_registration;
+    ppf_registration.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (ppf_registration.getNumberOfThreads (), nr_threads);
+    ppf_registration.setSceneReferencePointSamplingRate (2);
+    ppf_registration.setPositionClusteringThreshold (0.01f);
+    ppf_registration.setRotationClusteringThreshold (20.0f / 180.0f * static_cast<float> (M_PI));
+    ppf_registration.setSearchMethod (hash_map_search);
+    ppf_registration.setInputSource (cloud_source_transformed_with_normals);
+    ppf_registration.setInputTarget (cloud_target_with_normals);
+
+    PointCloud<PointNormal> cloud_output;
+    ppf_registration.align (cloud_output);
+    EXPECT_TRUE (ppf_registration.hasConverged ());
+    EXPECT_EQ (cloud_output.size (), cloud_source.size ());
+    if (nr_threads == 1)
+      transformation_serial = ppf_registration.getFinalTransformation ();
+    else
+      EXPECT_EQ (ppf_registration.getFinalTransformation (), transformation_serial);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LUM)
+{
+  // A loop of scans of the same cloud, with perturbed initial poses and a loop closure
+  const int nr_scans = 12;
+  std::vector<Eigen::Vector6f, Eigen::aligned_allocator<Eigen::Vector6f> > poses (nr_scans);
+  std::vector<PointCloud<PointXYZ>::Ptr> scans (nr_scans);
+  for (int i = 0; i < nr_scans; ++i)
+  {
+    const float angle = 2.0f * static_cast<float> (M_PI) * static_cast<float> (i) / nr_scans;
+    poses[i] << 0.1f * std::sin (angle), 0.1f * (1.0f - std::cos (angle)), 0.0f, 0.0f, 0.0f, 0.1f * angle;
+    scans[i].reset (new PointCloud<PointXYZ>);
+    transformPointCloud (cloud_source, *scans[i],
+                         getTransformation (poses[i] (0), poses[i] (1), poses[i] (2), poses[i] (3), poses[i] (4), poses[i] (5)).inverse ());
+    // LUM needs a residual to estimate the covariances of the pose differences
+    for (std::size_t k = 0; k < scans[i]->size (); ++k)
+      (*scans[i])[k].x += 1e-4f * static_cast<float> ((k * 7 + i) % 5) - 2e-4f;
+  }
+  pcl::CorrespondencesPtr corrs (new pcl::Correspondences);
+  for (std::size_t i = 0; i < cloud_source.size (); i += 4)
+    corrs->push_back (pcl::Correspondence (static_cast<int> (i), static_cast<int> (i), 0.0f));
+
+  // The result does not depend on the number of threads
+  std::vector<Eigen::Vector6f, Eigen::aligned_allocator<Eigen::Vector6f> > result_serial;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    registration::LUM<PointXYZ> lum;
+    lum.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (lum.getNumberOfThreads (), nr_threads);
+    lum.setMaxIterations (10);
+    for (int i = 0; i < nr_scans; ++i)
+    {
+      Eigen::Vector6f initial_pose = poses[i];
+      if (i > 0)
+        initial_pose += 0.005f * Eigen::Vector6f::Constant (static_cast<float> (i % 3) - 1.0f);
+      lum.addPointCloud (scans[i], initial_pose);
+    }
+    for (int i = 1; i < nr_scans; ++i)
+      lum.setCorrespondences (i - 1, i, corrs);
+    lum.setCorrespondences (0, nr_scans - 1, corrs);
+    lum.compute ();
+
+    for (int i = 0; i < nr_scans; ++i)
+    {
+      for (int j = 0; j < 6; ++j)
+        EXPECT_NEAR (lum.getPose (i) (j), poses[i] (j), 1e-3);
+      if (nr_threads == 1)
+        result_serial.push_back (lum.getPose (i));
+      else
+        EXPECT_EQ (lum.getPose (i), result_serial[i]);
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -57,6 +57,7 @@
 #include <pcl/registration/transformation_estimation_dual_quaternion.h>
 #include <pcl/registration/transformation_estimation_point_to_plane_lls.h>
 #include <pcl/registration/transformation_estimation_point_to_plane.h>
+#include <pcl/registration/transformation_estimation_point_to_plane_robust.h>
 #include <pcl/registration/transformation_estimation_symmetric_point_to_plane_lls.h>
 #include <pcl/features/normal_3d.h>
 
@@ -511,6 +512,88 @@ TEST (PCL, TransformationEstimationPointToPlaneLLS)
       EXPECT_NEAR (estimated_transform (i, j), ground_truth_tform (i, j), 1e-2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformationEstimationPointToPlaneRobust)
+{
+  using TransformationEstimationRobust =
+    pcl::registration::TransformationEstimationPointToPlaneRobust<pcl::PointNormal, pcl::PointNormal>;
+
+  // Create a test cloud
+  pcl::PointCloud<pcl::PointNormal>::Ptr src (new pcl::PointCloud<pcl::PointNormal>);
+  src->height = 1;
+  src->is_dense = true;
+  for (float x = -5.0f; x <= 5.0f; x += 0.25f)
+    for (float y = -5.0f; y <= 5.0f; y += 0.25f)
+    {
+      pcl::PointNormal p;
+      p.x = x;
+      p.y = y;
+      p.z = 0.1f * powf (x, 2.0f) + 0.2f * p.x * p.y - 0.3f * y + 1.0f;
+      Eigen::Vector3f normal (-0.2f * p.x - 0.2f * p.y, -0.2f * p.x + 0.3f, 1.0f);
+      p.getNormalVector3fMap () = normal.normalized ();
+      src->points.push_back (p);
+    }
+  src->width = src->size ();
+
+  // Create a test matrix
+  Eigen::Matrix4f ground_truth_tform = Eigen::Matrix4f::Identity ();
+  ground_truth_tform.topLeftCorner<3, 3> () = (Eigen::AngleAxisf (0.1f, Eigen::Vector3f::UnitZ ()) *
+                                               Eigen::AngleAxisf (-0.05f, Eigen::Vector3f::UnitY ()) *
+                                               Eigen::AngleAxisf (0.02f, Eigen::Vector3f::UnitX ())).matrix ();
+  ground_truth_tform.topRightCorner<3, 1> () = Eigen::Vector3f (0.1f, -0.2f, 0.3f);
+
+  pcl::PointCloud<pcl::PointNormal>::Ptr tgt (new pcl::PointCloud<pcl::PointNormal>);
+  pcl::transformPointCloudWithNormals (*src, *tgt, ground_truth_tform);
+
+  // Without outliers the Gauss-Newton iterations converge to the exact solution
+  TransformationEstimationRobust transform_estimator;
+  transform_estimator.setKernel (TransformationEstimationRobust::RobustKernel::NONE);
+  Eigen::Matrix4f estimated_transform;
+  transform_estimator.estimateRigidTransformation (*src, *tgt, estimated_transform);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (estimated_transform (i, j), ground_truth_tform (i, j), 1e-4);
+
+  // Move every fifth target point far away from the surface
+  for (std::size_t i = 0; i < tgt->size (); i += 5)
+    (*tgt)[i].getVector3fMap () += 0.5f * (*tgt)[i].getNormalVector3fMap ();
+
+  const TransformationEstimationRobust::RobustKernel kernels[] = {
+    TransformationEstimationRobust::RobustKernel::HUBER,
+    TransformationEstimationRobust::RobustKernel::CAUCHY,
+    TransformationEstimationRobust::RobustKernel::GEMAN_MCCLURE,
+    TransformationEstimationRobust::RobustKernel::TUKEY};
+  for (const auto& kernel : kernels)
+  {
+    transform_estimator.setKernel (kernel);
+    transform_estimator.setMaximumIterations (30);
+    transform_estimator.setNumberOfThreads (1);
+    transform_estimator.estimateRigidTransformation (*src, *tgt, estimated_transform);
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 4; ++j)
+        EXPECT_NEAR (estimated_transform (i, j), ground_truth_tform (i, j), 1e-3);
+
+    // The blocked accumulation does not depend on the number of threads
+    Eigen::Matrix4f estimated_transform_mt;
+    transform_estimator.setNumberOfThreads (4);
+    transform_estimator.estimateRigidTransformation (*src, *tgt, estimated_transform_mt);
+    EXPECT_EQ (estimated_transform, estimated_transform_mt);
+  }
+
+  // More than half of the residuals are exactly zero, the automatic width must still
+  // suppress the outliers instead of falling back to least squares in the first step
+  pcl::PointCloud<pcl::PointNormal> aligned_tgt (*src);
+  for (std::size_t i = 0; i < aligned_tgt.size (); i += 5)
+    aligned_tgt[i].getVector3fMap () += 0.5f * aligned_tgt[i].getNormalVector3fMap ();
+  transform_estimator.setMaximumIterations (1);
+  for (const auto& kernel : kernels)
+  {
+    transform_estimator.setKernel (kernel);
+    transform_estimator.estimateRigidTransformation (*src, aligned_tgt, estimated_transform);
+    EXPECT_TRUE (estimated_transform.isApprox (Eigen::Matrix4f::Identity (), 1e-3f));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationLM)
 {
@@ -235,6 +235,108 @@ TEST (PCL, SampleConsensusPrerejective)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SampleConsensusParallel)
+{
+  // Transform the source cloud by a large amount
+  Eigen::Vector3f initial_offset (100, 0, 0);
+  float angle = static_cast<float> (M_PI) / 2.0f;
+  Eigen::Quaternionf initial_rotation (std::cos (angle / 2), 0, 0, sin (angle / 2));
+  PointCloud<PointXYZ> cloud_source_transformed;
+  transformPointCloud (cloud_source, cloud_source_transformed, initial_offset, initial_rotation);
+
+  // Create shared pointers
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr, cloud_target_ptr;
+  cloud_source_ptr = cloud_source_transformed.makeShared ();
+  cloud_target_ptr = cloud_target.makeShared ();
+
+  // Estimate the normals and the FPFH features for both clouds
+  search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  NormalEstimation<PointXYZ, Normal> norm_est;
+  norm_est.setSearchMethod (tree);
+  norm_est.setRadiusSearch (0.05);
+  PointCloud<Normal> normals;
+
+  FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh_est;
+  fpfh_est.setSearchMethod (tree);
+  fpfh_est.setRadiusSearch (0.05);
+  PointCloud<FPFHSignature33>::Ptr features_source (new PointCloud<FPFHSignature33>);
+  PointCloud<FPFHSignature33>::Ptr features_target (new PointCloud<FPFHSignature33>);
+
+  norm_est.setInputCloud (cloud_source_ptr);
+  norm_est.compute (normals);
+  fpfh_est.setInputCloud (cloud_source_ptr);
+  fpfh_est.setInputNormals (normals.makeShared ());
+  fpfh_est.compute (*features_source);
+
+  norm_est.setInputCloud (cloud_target_ptr);
+  norm_est.compute (normals);
+  fpfh_est.setInputCloud (cloud_target_ptr);
+  fpfh_est.setInputNormals (normals.makeShared ());
+  fpfh_est.compute (*features_target);
+
+  // SAC-IA gives the same result for the same seed, whatever the number of threads
+  Eigen::Matrix4f sac_ia_transformation;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    SampleConsensusInitialAlignment<PointXYZ, PointXYZ, FPFHSignature33> reg;
+    reg.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (reg.getNumberOfThreads (), nr_threads);
+    reg.setMinSampleDistance (0.05f);
+    reg.setMaxCorrespondenceDistance (0.1);
+    reg.setMaximumIterations (200);
+    reg.setInputSource (cloud_source_ptr);
+    reg.setInputTarget (cloud_target_ptr);
+    reg.setSourceFeatures (features_source);
+    reg.setTargetFeatures (features_target);
+
+    srand (0);
+    reg.align (cloud_reg);
+    EXPECT_TRUE (reg.hasConverged ());
+    EXPECT_EQ (cloud_reg.size (), cloud_source.size ());
+    if (nr_threads == 1)
+      sac_ia_transformation = reg.getFinalTransformation ();
+    else
+      EXPECT_EQ (reg.getFinalTransformation (), sac_ia_transformation);
+  }
+
+  // Same for the prerejective RANSAC, also when stopping early
+  Eigen::Matrix4f prerejective_transformation;
+  std::vector<int> prerejective_inliers;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    SampleConsensusPrerejective<PointXYZ, PointXYZ, FPFHSignature33> reg;
+    reg.setNumberOfThreads (nr_threads);
+    reg.setMaxCorrespondenceDistance (0.1);
+    reg.setMaximumIterations (5000);
+    reg.setSimilarityThreshold (0.6f);
+    reg.setCorrespondenceRandomness (2);
+    reg.setInlierFraction (0.25f);
+    reg.setProbability (0.99);
+    reg.setInputSource (cloud_source_ptr);
+    reg.setInputTarget (cloud_target_ptr);
+    reg.setSourceFeatures (features_source);
+    reg.setTargetFeatures (features_target);
+
+    srand (0);
+    reg.align (cloud_reg);
+    ASSERT_TRUE (reg.hasConverged ());
+    EXPECT_EQ (cloud_reg.size (), cloud_source.size ());
+    const float inlier_fraction = static_cast<float> (reg.getInliers ().size ()) / static_cast<float> (cloud_source.size ());
+    EXPECT_GT (inlier_fraction, 0.95f);
+    if (nr_threads == 1)
+    {
+      prerejective_transformation = reg.getFinalTransformation ();
+      prerejective_inliers = reg.getInliers ();
+    }
+    else
+    {
+      EXPECT_EQ (reg.getFinalTransformation (), prerejective_transformation);
+      EXPECT_EQ (reg.getInliers (), prerejective_inliers);
+    }
+  }
+}
+
 int
 main (int argc, char** argv)
 {
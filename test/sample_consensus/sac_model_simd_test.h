@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/types.h>
+
+#include <Eigen/Core>
+
+#include <algorithm> // for std::set_symmetric_difference
+#include <iterator> // for std::back_inserter
+#include <vector>
+
+// getDistancesToModel and selectWithinDistance process blocks of points with SSE/AVX and the rest in a scalar
+// loop. A model with a single index only runs the scalar loop, so evaluating every point on its own gives the
+// scalar results to compare the SIMD results with.
+template <typename ModelT> void
+compareSIMDWithScalar (ModelT &model, const Eigen::VectorXf &model_coefficients, const double threshold,
+                       const double max_distance_error, const std::size_t max_inlier_difference)
+{
+  const pcl::Indices indices = *model.getIndices ();
+  std::vector<double> distances;
+  model.getDistancesToModel (model_coefficients, distances);
+  ASSERT_EQ (indices.size (), distances.size ());
+  pcl::Indices inliers;
+  model.selectWithinDistance (model_coefficients, threshold, inliers);
+
+  pcl::Indices scalar_inliers;
+  for (std::size_t i = 0; i < indices.size (); ++i)
+  {
+    model.setIndices (pcl::Indices (1, indices[i]));
+    std::vector<double> scalar_distances;
+    model.getDistancesToModel (model_coefficients, scalar_distances);
+    ASSERT_EQ (1u, scalar_distances.size ());
+    EXPECT_NEAR (scalar_distances[0], distances[i], max_distance_error) << "index " << indices[i];
+    pcl::Indices point_inliers;
+    model.selectWithinDistance (model_coefficients, threshold, point_inliers);
+    scalar_inliers.insert (scalar_inliers.end (), point_inliers.begin (), point_inliers.end ());
+  }
+  model.setIndices (indices);
+
+  // Both lists are sorted like the indices of the model
+  pcl::Indices differences;
+  std::set_symmetric_difference (scalar_inliers.begin (), scalar_inliers.end (), inliers.begin (), inliers.end (),
+                                 std::back_inserter (differences));
+  EXPECT_LE (differences.size (), max_inlier_difference) << "threshold=" << threshold;
+}
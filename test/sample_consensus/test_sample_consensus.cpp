@@ -42,8 +42,11 @@
 #include <pcl/sample_consensus/lmeds.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
+#include <pcl/sample_consensus/prosac.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/sprt.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
 
 #include <chrono>
@@ -53,6 +56,7 @@
 
 using namespace pcl;
 
+using SampleConsensusModelPlanePtr = SampleConsensusModelPlane<PointXYZ>::Ptr;
 using SampleConsensusModelSpherePtr = SampleConsensusModelSphere<PointXYZ>::Ptr;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -89,7 +93,8 @@ using sacTypes = ::testing::Types<
   MEstimatorSampleConsensus<PointXYZ>,
   RandomizedRandomSampleConsensus<PointXYZ>,
   RandomizedMEstimatorSampleConsensus<PointXYZ>,
-  MaximumLikelihoodSampleConsensus<PointXYZ>
+  MaximumLikelihoodSampleConsensus<PointXYZ>,
+  SPRTSampleConsensus<PointXYZ>
 >;
 TYPED_TEST_SUITE(SacTest, sacTypes);
 
@@ -137,6 +142,112 @@ TYPED_TEST(SacTest, InfiniteLoop)
   thread.join ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test if the result of the methods evaluating hypotheses in parallel batches does not depend on the number of threads.
+template <typename SacT>
+class SacThreadsTest : public ::testing::Test {};
+
+using sacThreadsTypes = ::testing::Types<
+  LeastMedianSquares<PointXYZ>,
+  MEstimatorSampleConsensus<PointXYZ>,
+  RandomizedRandomSampleConsensus<PointXYZ>,
+  RandomizedMEstimatorSampleConsensus<PointXYZ>,
+  MaximumLikelihoodSampleConsensus<PointXYZ>,
+  ProgressiveSampleConsensus<PointXYZ>
+>;
+TYPED_TEST_SUITE(SacThreadsTest, sacThreadsTypes);
+
+TYPED_TEST(SacThreadsTest, Reproducible)
+{
+  // A noisy plane z = 0.1 x + 0.2 y + 0.5 with 40% outliers
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  cloud->resize (2000);
+  srand (0);
+  for (std::size_t idx = 0; idx < cloud->size (); ++idx)
+  {
+    const float x = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    const float y = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    const float noise = 0.01f * static_cast<float> (rand ()) / RAND_MAX;
+    (*cloud)[idx].x = x;
+    (*cloud)[idx].y = y;
+    if (idx % 5 < 3)
+      (*cloud)[idx].z = 0.1f * x + 0.2f * y + 0.5f + noise;
+    else
+      (*cloud)[idx].z = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+  }
+
+  bool result_serial = false, result_parallel = false;
+  pcl::Indices model_serial, model_parallel, inliers_serial, inliers_parallel;
+  Eigen::VectorXf coeff_serial, coeff_parallel;
+  for (const int threads : {-1, 4})
+  {
+    SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+    TypeParam sac (model, 0.02);
+    sac.setNumberOfThreads (threads);
+    (threads < 0 ? result_serial : result_parallel) = sac.computeModel ();
+    sac.getModel (threads < 0 ? model_serial : model_parallel);
+    sac.getInliers (threads < 0 ? inliers_serial : inliers_parallel);
+    sac.getModelCoefficients (threads < 0 ? coeff_serial : coeff_parallel);
+  }
+
+  EXPECT_EQ (result_serial, result_parallel);
+  EXPECT_EQ (model_serial, model_parallel);
+  EXPECT_EQ (inliers_serial, inliers_parallel);
+  ASSERT_EQ (coeff_serial.size (), coeff_parallel.size ());
+  for (Eigen::Index i = 0; i < coeff_serial.size (); ++i)
+    EXPECT_EQ (coeff_serial[i], coeff_parallel[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensus, SPRT)
+{
+  // A noisy plane z = 0.1 x + 0.2 y + 0.5 with 70% outliers
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  cloud->resize (20000);
+  srand (0);
+  for (std::size_t idx = 0; idx < cloud->size (); ++idx)
+  {
+    const float x = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    const float y = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    const float noise = 0.01f * static_cast<float> (rand ()) / RAND_MAX;
+    (*cloud)[idx].x = x;
+    (*cloud)[idx].y = y;
+    if (idx % 10 < 3)
+      (*cloud)[idx].z = 0.1f * x + 0.2f * y + 0.5f + noise;
+    else
+      (*cloud)[idx].z = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+  }
+
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+
+  // The distances of a chunk are the same as the ones of all points
+  Eigen::VectorXf plane (4);
+  plane << 0.1f, 0.2f, -1.0f, 0.5f;
+  plane /= plane.head<3> ().norm ();
+  std::vector<double> distances, chunk_distances;
+  model->getDistancesToModel (plane, distances);
+  const pcl::Indices chunk {7, 3, 19999, 0, 12345};
+  ASSERT_TRUE (model->getDistancesToModelChunk (plane, chunk, chunk_distances));
+  ASSERT_EQ (chunk.size (), chunk_distances.size ());
+  for (std::size_t i = 0; i < chunk.size (); ++i)
+    EXPECT_NEAR (distances[chunk[i]], chunk_distances[i], 1e-6);
+
+  SPRTSampleConsensus<PointXYZ> sac (model, 0.02);
+  ASSERT_TRUE (sac.computeModel ());
+
+  pcl::Indices inliers;
+  sac.getInliers (inliers);
+  EXPECT_LE (6000, inliers.size ());
+
+  Eigen::VectorXf coeff;
+  sac.getModelCoefficients (coeff);
+  ASSERT_EQ (4, coeff.size ());
+  if (coeff[2] > 0.0f)
+    coeff = -coeff;
+  for (Eigen::Index i = 0; i < coeff.size (); ++i)
+    EXPECT_NEAR (plane[i], coeff[i], 2e-2);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -53,6 +53,8 @@
 #include <pcl/sample_consensus/sac_model_normal_plane.h>
 #include <pcl/sample_consensus/sac_model_normal_parallel_plane.h>
 
+#include "sac_model_simd_test.h"
+
 using namespace pcl;
 using namespace pcl::io;
 
@@ -447,6 +449,94 @@ TEST (SampleConsensusModelNormalPlane, SIMD_countWithinDistance) // Test if all
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, SIMD_selectWithinDistance) // Test if the SIMD and scalar distances and inliers are the same
+{
+  const auto seed = static_cast<unsigned> (std::time (nullptr));
+  srand (seed);
+  for (size_t i=0; i<10; i++) // Every point is evaluated on its own too, so this runs fewer models
+  {
+    // Generate a cloud with 1000 random points
+    PointCloud<PointXYZ> cloud;
+    pcl::Indices indices;
+    cloud.resize (1000);
+    for (std::size_t idx = 0; idx < cloud.size (); ++idx)
+    {
+      cloud[idx].x = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].y = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].z = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      if (rand () % 3 != 0)
+      {
+        indices.push_back (static_cast<int> (idx));
+      }
+    }
+    SampleConsensusModelPlane<PointXYZ> model (cloud.makeShared (), indices, true);
+
+    // Generate random model parameters
+    Eigen::VectorXf model_coefficients(4);
+    model_coefficients << 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0, 0.0;
+    model_coefficients.normalize ();
+    model_coefficients(3) = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0; // Last parameter
+
+    const double threshold = 0.1 * static_cast<double> (rand ()) / RAND_MAX; // threshold in [0; 0.1]
+    PCL_DEBUG ("seed=%lu, i=%lu, threshold=%f\n", seed, i, threshold);
+    compareSIMDWithScalar (model, model_coefficients, threshold, 1e-5, 0);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelNormalPlane, SIMD_selectWithinDistance) // Test if the SIMD and scalar distances and inliers are the same
+{
+  const auto seed = static_cast<unsigned> (std::time (nullptr));
+  srand (seed);
+  for (size_t i=0; i<10; i++) // Every point is evaluated on its own too, so this runs fewer models
+  {
+    // Generate a cloud with 1000 random points and random unit normals
+    PointCloud<PointXYZ> cloud;
+    PointCloud<Normal> normal_cloud;
+    pcl::Indices indices;
+    cloud.resize (1000);
+    normal_cloud.resize (1000);
+    for (std::size_t idx = 0; idx < cloud.size (); ++idx)
+    {
+      cloud[idx].x = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].y = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].z = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      const double a = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      const double b = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      const double c = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      const double factor = 1.0 / sqrt(a * a + b * b + c * c);
+      normal_cloud[idx].normal[0] = a * factor;
+      normal_cloud[idx].normal[1] = b * factor;
+      normal_cloud[idx].normal[2] = c * factor;
+      if (rand () % 3 != 0)
+      {
+        indices.push_back (static_cast<int> (idx));
+      }
+    }
+    SampleConsensusModelNormalPlane<PointXYZ, Normal> model (cloud.makeShared (), indices, true);
+
+    const double normal_distance_weight = 0.3 * static_cast<double> (rand ()) / RAND_MAX; // in [0; 0.3]
+    model.setNormalDistanceWeight (normal_distance_weight);
+    model.setInputNormals (normal_cloud.makeShared ());
+
+    // Generate random model parameters
+    Eigen::VectorXf model_coefficients(4);
+    model_coefficients << 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0, 0.0;
+    model_coefficients.normalize ();
+    model_coefficients(3) = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0; // Last parameter
+
+    const double threshold = 0.1 * static_cast<double> (rand ()) / RAND_MAX; // threshold in [0; 0.1]
+    PCL_DEBUG ("seed=%lu, i=%lu, threshold=%f\n", seed, i, threshold);
+    // The approximated acos used by the SIMD implementations may put a few points on the other side of the threshold
+    compareSIMDWithScalar (model, model_coefficients, threshold, 1e-2 * normal_distance_weight + 1e-5, 2);
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -76,6 +76,64 @@ TEST (SACSegmentation, Segmentation)
   EXPECT_NEAR (static_cast<int> (inliers->indices.size ()), 3516, 15);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SACSegmentation, MultipleModels)
+{
+  // The corner of a room: a floor and two walls, with noise and outliers
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  srand (0);
+  const auto rnd = [] () { return (static_cast<float> (rand ()) / static_cast<float> (RAND_MAX)); };
+  for (int i = 0; i < 3000; ++i)
+    cloud->push_back (PointXYZ (rnd (), rnd (), 0.004f * rnd () - 0.002f));
+  for (int i = 0; i < 2000; ++i)
+    cloud->push_back (PointXYZ (0.004f * rnd () - 0.002f, rnd (), rnd ()));
+  for (int i = 0; i < 1500; ++i)
+    cloud->push_back (PointXYZ (rnd (), 0.004f * rnd () - 0.002f, rnd ()));
+  for (int i = 0; i < 500; ++i)
+    cloud->push_back (PointXYZ (rnd (), rnd (), rnd ()));
+
+  for (const bool joint_refinement : {false, true})
+  {
+    SACSegmentation<PointXYZ> seg;
+    seg.setModelType (SACMODEL_PLANE);
+    seg.setMethodType (SAC_RANSAC);
+    seg.setMaxIterations (1000);
+    seg.setDistanceThreshold (0.01);
+    seg.setMaxModels (5);
+    seg.setMinInliers (500);
+    seg.setJointRefinement (joint_refinement);
+    seg.setInputCloud (cloud);
+
+    std::vector<PointIndices> inliers;
+    std::vector<ModelCoefficients> coefficients;
+    seg.segment (inliers, coefficients);
+    ASSERT_EQ (3, inliers.size ());
+    ASSERT_EQ (3, coefficients.size ());
+
+    // The planes are found from the largest to the smallest one
+    const int axes[3] = {2, 0, 1};
+    const std::size_t sizes[3] = {3000, 2000, 1500};
+    std::vector<bool> used (cloud->size (), false);
+    for (std::size_t m = 0; m < 3; ++m)
+    {
+      ASSERT_EQ (4, coefficients[m].values.size ());
+      EXPECT_NEAR (1.0, std::abs (coefficients[m].values[axes[m]]), 1e-2);
+      EXPECT_NEAR (0.0, coefficients[m].values[3], 1e-2);
+      EXPECT_NEAR (sizes[m], inliers[m].indices.size (), 60);
+      const Eigen::Vector4f plane (coefficients[m].values.data ());
+      for (const auto &index : inliers[m].indices)
+      {
+        EXPECT_FALSE (used[index]);
+        used[index] = true;
+        // The inliers belong to the coefficients returned
+        EXPECT_LE (std::abs (plane.dot ((*cloud)[index].getVector4fMap ())), 0.01f + 1e-6f);
+      }
+    }
+    // The model is left with the indices given by the user
+    EXPECT_EQ (cloud->size (), seg.getModel ()->getIndices ()->size ());
+  }
+}
+
 //* ---[ */
 int
   main (int argc, char** argv)
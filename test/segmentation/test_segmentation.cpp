@@ -44,11 +44,20 @@
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
 #include <pcl/segmentation/region_growing_rgb.h>
 #include <pcl/segmentation/min_cut_segmentation.h>
+#include <pcl/segmentation/euclidean_cluster_comparator.h>
+#include <pcl/segmentation/organized_connected_component_segmentation.h>
+#include <pcl/segmentation/organized_multi_plane_segmentation.h>
+#include <pcl/segmentation/supervoxel_clustering.h>
+
+#include <algorithm> // for std::sort
+#include <atomic>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -79,6 +88,38 @@ TEST (RegionGrowingRGBTest, Segment)
   EXPECT_NE (0, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingRGBTest, SegmentParallel)
+{
+  RegionGrowingRGB<pcl::PointXYZRGB> rg;
+
+  rg.setInputCloud (colored_cloud);
+  rg.setDistanceThreshold (10);
+  rg.setRegionColorThreshold (5);
+  rg.setPointColorThreshold (6);
+  rg.setMinClusterSize (20);
+
+  std::vector <pcl::PointIndices> serial_clusters, parallel_clusters;
+  rg.extract (serial_clusters);
+  rg.setNumberOfThreads (4);
+  rg.extract (parallel_clusters);
+
+  // The clusters are the same, but may be listed in a different order
+  const auto sorted_indices = [] (const std::vector <pcl::PointIndices> &clusters)
+  {
+    std::vector <pcl::Indices> indices;
+    for (const auto &cluster : clusters)
+    {
+      indices.push_back (cluster.indices);
+      std::sort (indices.back ().begin (), indices.back ().end ());
+    }
+    std::sort (indices.begin (), indices.end ());
+    return (indices);
+  };
+  ASSERT_EQ (serial_clusters.size (), parallel_clusters.size ());
+  EXPECT_EQ (sorted_indices (serial_clusters), sorted_indices (parallel_clusters));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RegionGrowingTest, Segment)
 {
@@ -92,6 +133,37 @@ TEST (RegionGrowingTest, Segment)
   EXPECT_NE (0, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, SegmentParallel)
+{
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (another_cloud_);
+  rg.setInputNormals (another_normals_);
+
+  std::vector <pcl::PointIndices> serial_clusters;
+  rg.extract (serial_clusters);
+
+  // The result must not depend on the number of threads
+  std::vector <pcl::PointIndices> clusters_2, clusters_4;
+  rg.setNumberOfThreads (2);
+  rg.extract (clusters_2);
+  rg.setNumberOfThreads (4);
+  rg.extract (clusters_4);
+
+  ASSERT_EQ (clusters_2.size (), clusters_4.size ());
+  std::size_t number_of_points = 0;
+  for (std::size_t i = 0; i < clusters_2.size (); ++i)
+  {
+    EXPECT_EQ (clusters_2[i].indices, clusters_4[i].indices);
+    number_of_points += clusters_2[i].indices.size ();
+  }
+  EXPECT_EQ (another_cloud_->size (), number_of_points);
+
+  // Only the borders between touching regions may be assigned differently
+  const double ratio = static_cast<double> (clusters_2.size ()) / static_cast<double> (serial_clusters.size ());
+  EXPECT_NEAR (1.0, ratio, 0.05);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RegionGrowingTest, SegmentWithoutCloud)
 {
@@ -233,7 +305,66 @@ TEST (MinCutSegmentationTest, Segment)
   std::vector <pcl::PointIndices> clusters;
   mcSeg.extract (clusters);
   const auto num_of_segments = clusters.size ();
-  EXPECT_EQ (2, num_of_segments);
+  ASSERT_EQ (2, num_of_segments);
+  // The labels depend slightly on how the flow is routed by the max-flow solver
+  EXPECT_NEAR (4351, clusters[0].indices.size (), 10);
+  EXPECT_NEAR (5680, clusters[1].indices.size (), 10);
+  EXPECT_NEAR (6195.121, mcSeg.getMaxFlow (), 1e-3);
+
+  // A larger radius leaves only a few points in the background, the graph is reused
+  mcSeg.setRadius (5.0);
+  mcSeg.extract (clusters);
+  ASSERT_EQ (2, clusters.size ());
+  EXPECT_NEAR (66, clusters[0].indices.size (), 5);
+  EXPECT_NEAR (9965, clusters[1].indices.size (), 5);
+  EXPECT_NEAR (4741.88883, mcSeg.getMaxFlow (), 1e-3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (MinCutSegmentationTest, SegmentReusingGraph)
+{
+  for (const bool reuse_flow : {false, true})
+  {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr foreground_points (new pcl::PointCloud<pcl::PointXYZ> ());
+    foreground_points->points.emplace_back (-36.01f, -64.73f, -6.18f);
+
+    pcl::MinCutSegmentation<pcl::PointXYZ> mcSeg;
+    mcSeg.setForegroundPoints (foreground_points);
+    mcSeg.setInputCloud (another_cloud_);
+    mcSeg.setRadius (3.8003856);
+    mcSeg.setSigma (0.25);
+    mcSeg.setNumberOfThreads (4);
+    mcSeg.setReuseFlow (reuse_flow);
+
+    std::vector <pcl::PointIndices> clusters;
+    mcSeg.extract (clusters);
+    ASSERT_EQ (2, clusters.size ());
+    EXPECT_EQ (another_cloud_->size (), clusters[0].indices.size () + clusters[1].indices.size ());
+
+    // Moving the foreground point and the radius only changes the unary potentials, so the graph of the
+    // first segmentation is reused, and its flow too if enabled. The result must be the same as when
+    // starting from scratch.
+    foreground_points->points[0] = pcl::PointXYZ (-34.0f, -62.0f, -6.0f);
+    mcSeg.setForegroundPoints (foreground_points);
+    mcSeg.setRadius (5.0);
+    mcSeg.extract (clusters);
+
+    pcl::MinCutSegmentation<pcl::PointXYZ> fresh_mcSeg;
+    fresh_mcSeg.setForegroundPoints (foreground_points);
+    fresh_mcSeg.setInputCloud (another_cloud_);
+    fresh_mcSeg.setRadius (5.0);
+    fresh_mcSeg.setSigma (0.25);
+    fresh_mcSeg.setReuseFlow (reuse_flow);
+    std::vector <pcl::PointIndices> fresh_clusters;
+    fresh_mcSeg.extract (fresh_clusters);
+
+    EXPECT_NEAR (fresh_mcSeg.getMaxFlow (), mcSeg.getMaxFlow (), 1e-6 * fresh_mcSeg.getMaxFlow ());
+    ASSERT_EQ (fresh_clusters.size (), clusters.size ());
+    if (!reuse_flow)
+      EXPECT_NEAR (6306, fresh_clusters[0].indices.size (), 10);
+    EXPECT_EQ (fresh_clusters[0].indices, clusters[0].indices);
+    EXPECT_EQ (fresh_clusters[1].indices, clusters[1].indices);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -385,6 +516,270 @@ TEST (ExtractPolygonalPrism, Segmentation)
   EXPECT_EQ (output.indices.size (), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, ParallelSegment)
+{
+  pcl::IndicesPtr indices (new pcl::Indices);
+  for (std::size_t i = 0; i < another_cloud_->size (); i += 2)
+    indices->push_back (static_cast<pcl::index_t> (i));
+
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (another_cloud_);
+  ec.setIndices (indices);
+  ec.setClusterTolerance (0.1);
+  ec.setMinClusterSize (20);
+  ec.setMaxClusterSize (1000);
+
+  std::vector<pcl::PointIndices> serial_clusters;
+  ec.extract (serial_clusters);
+  ASSERT_LT (1, serial_clusters.size ());
+
+  ec.setNumberOfThreads (4);
+  EXPECT_EQ (4, ec.getNumberOfThreads ());
+  std::vector<pcl::PointIndices> parallel_clusters;
+  ec.extract (parallel_clusters);
+
+  ASSERT_EQ (serial_clusters.size (), parallel_clusters.size ());
+  for (std::size_t i = 0; i < serial_clusters.size (); ++i)
+  {
+    EXPECT_LE (20, parallel_clusters[i].indices.size ());
+    EXPECT_GE (1000, parallel_clusters[i].indices.size ());
+    EXPECT_EQ (serial_clusters[i].indices, parallel_clusters[i].indices);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+similarHeight (const pcl::PointXYZ& point_a, const pcl::PointXYZ& point_b, float)
+{
+  return (std::abs (point_a.z - point_b.z) < 0.05f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalEuclideanClustering, ParallelSegment)
+{
+  pcl::IndicesPtr indices (new pcl::Indices);
+  for (std::size_t i = 0; i < another_cloud_->size (); i += 2)
+    indices->push_back (static_cast<pcl::index_t> (i));
+
+  pcl::ConditionalEuclideanClustering<pcl::PointXYZ> cec (true);
+  cec.setInputCloud (another_cloud_);
+  cec.setIndices (indices);
+  cec.setConditionFunction (&similarHeight);
+  cec.setClusterTolerance (0.1f);
+  cec.setMinClusterSize (20);
+  cec.setMaxClusterSize (1000);
+
+  pcl::IndicesClusters serial_clusters, serial_small, serial_large;
+  pcl::IndicesClustersPtr small_clusters, large_clusters;
+  cec.segment (serial_clusters);
+  cec.getRemovedClusters (small_clusters, large_clusters);
+  serial_small = *small_clusters;
+  serial_large = *large_clusters;
+  ASSERT_LT (0, serial_clusters.size ());
+
+  // The parallel version sorts the points of every cluster
+  for (auto* cluster_set : {&serial_clusters, &serial_small, &serial_large})
+    for (auto& cluster : *cluster_set)
+      std::sort (cluster.indices.begin (), cluster.indices.end ());
+
+  cec.setNumberOfThreads (4);
+  pcl::IndicesClusters parallel_clusters;
+  cec.segment (parallel_clusters);
+  cec.getRemovedClusters (small_clusters, large_clusters);
+  ASSERT_EQ (serial_clusters.size (), parallel_clusters.size ());
+  for (std::size_t i = 0; i < serial_clusters.size (); ++i)
+    EXPECT_EQ (serial_clusters[i].indices, parallel_clusters[i].indices);
+  ASSERT_EQ (serial_small.size (), small_clusters->size ());
+  for (std::size_t i = 0; i < serial_small.size (); ++i)
+    EXPECT_EQ (serial_small[i].indices, (*small_clusters)[i].indices);
+  EXPECT_EQ (serial_large.size (), large_clusters->size ());
+
+  // Same condition, evaluated for a batch of neighbors at a time
+  cec.setBatchConditionFunction ([] (const pcl::PointCloud<pcl::PointXYZ>& cloud, pcl::index_t index,
+                                     const pcl::Indices& neighbors, const std::vector<float>&,
+                                     std::vector<std::uint8_t>& results)
+  {
+    for (std::size_t i = 0; i < neighbors.size (); ++i)
+      results[i] = std::abs (cloud[index].z - cloud[neighbors[i]].z) < 0.05f;
+  });
+  for (const unsigned int threads : {1u, 4u})
+  {
+    cec.setNumberOfThreads (threads);
+    pcl::IndicesClusters batch_clusters;
+    cec.segment (batch_clusters);
+    ASSERT_EQ (serial_clusters.size (), batch_clusters.size ());
+    for (std::size_t i = 0; i < serial_clusters.size (); ++i)
+    {
+      std::sort (batch_clusters[i].indices.begin (), batch_clusters[i].indices.end ());
+      EXPECT_EQ (serial_clusters[i].indices, batch_clusters[i].indices);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SupervoxelClustering, ParallelExtract)
+{
+  std::vector<pcl::PointCloud<pcl::PointXYZL>::Ptr> labeled_voxels;
+  std::vector<std::size_t> number_of_supervoxels;
+  for (const unsigned int threads : {1u, 2u, 4u})
+  {
+    pcl::SupervoxelClustering<pcl::PointXYZRGB> super (0.02f, 0.1f);
+    super.setInputCloud (colored_cloud);
+    super.setNumberOfThreads (threads);
+
+    std::map<std::uint32_t, pcl::Supervoxel<pcl::PointXYZRGB>::Ptr> supervoxel_clusters;
+    super.extract (supervoxel_clusters);
+    EXPECT_LT (1, supervoxel_clusters.size ());
+    number_of_supervoxels.push_back (supervoxel_clusters.size ());
+    super.refineSupervoxels (2, supervoxel_clusters);
+
+    std::size_t number_of_voxels = 0;
+    for (const auto& cluster : supervoxel_clusters)
+      number_of_voxels += cluster.second->voxels_->size ();
+    EXPECT_EQ (super.getVoxelCentroidCloud ()->size (), number_of_voxels);
+    labeled_voxels.push_back (super.getLabeledVoxelCloud ());
+  }
+
+  // The parallel expansion only differs from the serial one where supervoxels compete for the same voxels
+  const double ratio = static_cast<double> (number_of_supervoxels[1]) / static_cast<double> (number_of_supervoxels[0]);
+  EXPECT_NEAR (1.0, ratio, 0.15);
+
+  // The result must not depend on the number of threads
+  ASSERT_EQ (labeled_voxels[1]->size (), labeled_voxels[2]->size ());
+  for (std::size_t i = 0; i < labeled_voxels[1]->size (); ++i)
+  {
+    EXPECT_EQ ((*labeled_voxels[1])[i].label, (*labeled_voxels[2])[i].label);
+    EXPECT_EQ ((*labeled_voxels[1])[i].x, (*labeled_voxels[2])[i].x);
+  }
+}
+
+// Counts the comparisons whose first point is not finite
+class FiniteCheckComparator : public pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label>
+{
+  public:
+    bool
+    compare (int idx1, int idx2) const override
+    {
+      if (!std::isfinite ((*input_)[idx1].x))
+        ++invalid_comparisons_;
+      return (pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label>::compare (idx1, idx2));
+    }
+
+    mutable std::atomic<int> invalid_comparisons_ {0};
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OrganizedMultiPlaneSegmentation, ParallelSegment)
+{
+  // Two planes seen by a depth camera, with a hole and some scattered invalid pixels
+  const int width = 160, height = 120;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr organized_cloud (new pcl::PointCloud<pcl::PointXYZ> (width, height));
+  pcl::PointCloud<pcl::Normal>::Ptr organized_normals (new pcl::PointCloud<pcl::Normal> (width, height));
+  const Eigen::Vector3f tilted_normal = Eigen::Vector3f (0.5f, 0.0f, -1.0f).normalized ();
+  for (int row = 0; row < height; ++row)
+    for (int col = 0; col < width; ++col)
+    {
+      pcl::PointXYZ& point = (*organized_cloud) (col, row);
+      pcl::Normal& normal = (*organized_normals) (col, row);
+      if ((row > 50 && row < 60 && col > 20 && col < 40) || (row * 7 + col * 13) % 97 == 0)
+      {
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+        normal.normal_x = normal.normal_y = normal.normal_z = std::numeric_limits<float>::quiet_NaN ();
+        continue;
+      }
+      const float x = static_cast<float> (col - width / 2) / 100.0f;
+      const float y = static_cast<float> (row - height / 2) / 100.0f;
+      const float z = (col < width / 2) ? 2.0f : 1.5f + 0.5f * x;
+      point.x = x * z;
+      point.y = y * z;
+      point.z = z;
+      normal.getNormalVector3fMap () = (col < width / 2) ? Eigen::Vector3f (0.0f, 0.0f, -1.0f) : tilted_normal;
+    }
+  organized_cloud->is_dense = false;
+
+  std::vector<pcl::PointCloud<pcl::Label>::Ptr> all_labels;
+  std::vector<std::vector<pcl::ModelCoefficients> > all_coefficients;
+  std::vector<std::vector<pcl::PointIndices> > all_inliers;
+  for (const unsigned int threads : {1u, 4u})
+  {
+    pcl::OrganizedMultiPlaneSegmentation<pcl::PointXYZ, pcl::Normal, pcl::Label> mps;
+    mps.setInputCloud (organized_cloud);
+    mps.setInputNormals (organized_normals);
+    mps.setMinInliers (500);
+    mps.setNumberOfThreads (threads);
+    EXPECT_EQ (threads, mps.getNumberOfThreads ());
+
+    std::vector<pcl::PlanarRegion<pcl::PointXYZ>, Eigen::aligned_allocator<pcl::PlanarRegion<pcl::PointXYZ> > > regions;
+    std::vector<pcl::ModelCoefficients> model_coefficients;
+    std::vector<pcl::PointIndices> inlier_indices, label_indices, boundary_indices;
+    pcl::PointCloud<pcl::Label>::Ptr labels (new pcl::PointCloud<pcl::Label>);
+    mps.segmentAndRefine (regions, model_coefficients, inlier_indices, labels, label_indices, boundary_indices);
+    EXPECT_EQ (2, regions.size ());
+    ASSERT_EQ (regions.size (), boundary_indices.size ());
+    for (std::size_t i = 0; i < regions.size (); ++i)
+    {
+      EXPECT_EQ (inlier_indices[i].indices.size (), regions[i].getCount ());
+      EXPECT_EQ (boundary_indices[i].indices.size (), regions[i].getContour ().size ());
+    }
+
+    all_labels.push_back (labels);
+    all_coefficients.push_back (model_coefficients);
+    all_inliers.push_back (inlier_indices);
+  }
+
+  // The result must not depend on the number of threads
+  ASSERT_EQ (all_labels[0]->size (), all_labels[1]->size ());
+  for (std::size_t i = 0; i < all_labels[0]->size (); ++i)
+    EXPECT_EQ ((*all_labels[0])[i].label, (*all_labels[1])[i].label);
+  ASSERT_EQ (all_coefficients[0].size (), all_coefficients[1].size ());
+  for (std::size_t i = 0; i < all_coefficients[0].size (); ++i)
+  {
+    EXPECT_EQ (all_coefficients[0][i].values, all_coefficients[1][i].values);
+    EXPECT_EQ (all_inliers[0][i].indices, all_inliers[1][i].indices);
+  }
+
+  // Euclidean clusters of the same cloud, the comparator is evaluated on whole rows at once
+  pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label>::Ptr comparator (new pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label>);
+  comparator->setInputCloud (organized_cloud);
+  comparator->setDistanceThreshold (0.02f, false);
+  std::vector<std::uint8_t> row_result (width);
+  comparator->compareRun (width + 1, width - 1, -width, row_result.data ());
+  for (int col = 0; col < width - 1; ++col)
+    EXPECT_EQ (comparator->compare (width + 1 + col, 1 + col), static_cast<bool> (row_result[col]));
+
+  pcl::OrganizedConnectedComponentSegmentation<pcl::PointXYZ, pcl::Label> connected_component (comparator);
+  connected_component.setInputCloud (organized_cloud);
+  pcl::PointCloud<pcl::Label> serial_labels, parallel_labels;
+  std::vector<pcl::PointIndices> serial_indices, parallel_indices;
+  connected_component.segment (serial_labels, serial_indices);
+  EXPECT_LT (1, serial_indices.size ());
+  connected_component.setNumberOfThreads (4);
+  connected_component.segment (parallel_labels, parallel_indices);
+  ASSERT_EQ (serial_labels.size (), parallel_labels.size ());
+  for (std::size_t i = 0; i < serial_labels.size (); ++i)
+    EXPECT_EQ (serial_labels[i].label, parallel_labels[i].label);
+  ASSERT_EQ (serial_indices.size (), parallel_indices.size ());
+  for (std::size_t i = 0; i < serial_indices.size (); ++i)
+    EXPECT_EQ (serial_indices[i].indices, parallel_indices[i].indices);
+
+  // Like the point by point comparison, the runs never start from an invalid pixel
+  pcl::shared_ptr<FiniteCheckComparator> finite_check (new FiniteCheckComparator);
+  finite_check->setInputCloud (organized_cloud);
+  finite_check->setDistanceThreshold (0.02f, false);
+  for (const unsigned int nr_threads : {1u, 4u})
+  {
+    pcl::OrganizedConnectedComponentSegmentation<pcl::PointXYZ, pcl::Label> checked_component (finite_check);
+    checked_component.setInputCloud (organized_cloud);
+    checked_component.setNumberOfThreads (nr_threads);
+    pcl::PointCloud<pcl::Label> checked_labels;
+    std::vector<pcl::PointIndices> checked_indices;
+    checked_component.segment (checked_labels, checked_indices);
+    EXPECT_EQ (0, finite_check->invalid_comparisons_.load ());
+    EXPECT_EQ (serial_indices.size (), checked_indices.size ());
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)